@@ -60,9 +60,9 @@ class pyFps {
   int read_keys() {
     int k = 0;
     while ((k < fps_.md->NBparamMAX) &&
-           (fps_.parray[k].keywordfull[0] != '\0')) {
-      int offset = strlen(fps_.parray[k].keyword[0]) + 1;
-      char *key = fps_.parray[k].keywordfull + offset;
+           (fps_.pdescr[k].keywordfull[0] != '\0')) {
+      int offset = strlen(fps_.pdescr[k].keyword[0]) + 1;
+      char *key = fps_.pdescr[k].keywordfull + offset;
       keys_[key] = static_cast<FPS_type>(fps_.parray[k].type);
       k++;
     }
@@ -89,6 +89,10 @@ class pyFps {
   pyFps(std::string fps_name, bool create, int NBparamMAX) : name_(fps_name) {
     fps_.md = nullptr;
     fps_.parray = nullptr;  // array of function parameters
+    fps_.pdescr = nullptr;  // parameter names
+    fps_.phash = nullptr;   // parameter name hash table
+    fps_.notify = nullptr;  // change notification
+    fps_.notifydefer = 0;
 
     // these variables are local to each process
     fps_.localstatus = 0;  // 1 if conf loop should be active
@@ -195,8 +199,8 @@ class pyFps {
   std::vector<std::string> get_levelKeys(int level) {
     std::vector<std::string> levelKeys = std::vector<std::string>();
     int k = 0;
-    while (fps_.parray[k].keywordfull[0] != '\0' && k < fps_.md->NBparamMAX) {
-      std::string tmp = fps_.parray[k].keyword[level];
+    while (fps_.pdescr[k].keywordfull[0] != '\0' && k < fps_.md->NBparamMAX) {
+      std::string tmp = fps_.pdescr[k].keyword[level];
       auto exist = std::find(levelKeys.begin(), levelKeys.end(), tmp);
       if (exist == levelKeys.end()) {
         levelKeys.push_back(tmp);
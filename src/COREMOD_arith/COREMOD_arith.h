@@ -10,7 +10,9 @@
 #include "COREMOD_arith/image_crop.h"
 #include "COREMOD_arith/image_merge3D.h"
 #include "COREMOD_arith/image_total.h"
+#include "COREMOD_arith/image_reduce.h"
 #include "COREMOD_arith/image_stats.h"
+#include "COREMOD_arith/image_percentile.h"
 #include "COREMOD_arith/image_dxdy.h"
 #include "COREMOD_arith/imfunctions.h"
 #include "COREMOD_arith/image_arith__im__im.h"
@@ -23,6 +23,7 @@
 #include "image_arith__Cim_Cim__Cim.h"
 #include "image_arith__im_f__im.h"
 #include "image_arith__im_f_f__im.h"
+#include "execute_arith_fused.h"
 
 
 
@@ -336,6 +337,12 @@ int execute_arith(const char *cmd1)
 
     int Debug = 0;
 
+    // elementwise image expressions: single pass, no temporary images
+    if(execute_arith_fused(cmd1) == 1)
+    {
+        return(0);
+    }
+
     //  if( Debug > 0 )   fprintf(stdout, "[execute_arith]\n");
     //  if( Debug > 0 )   fprintf(stdout, "[execute_arith] str: [%s]\n", cmd1);
 
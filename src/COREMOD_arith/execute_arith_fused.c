@@ -0,0 +1,971 @@
+/**
+ * @file    execute_arith_fused.c
+ * @brief   fused single-pass evaluation of image arithmetic expressions
+ *
+ * Expressions of the form out=expr, where expr only uses elementwise
+ * operations (+ - * /, single-argument math functions), images of the
+ * same size, variables and numbers, are compiled into an expression DAG
+ * and evaluated in a single pass over the pixels.
+ *
+ * - Identical subexpressions are computed once (hash-consing at compile time).
+ * - Subexpressions that do not depend on images are computed once per call.
+ * - Pixels are processed in tiles of EXPRFUSED_TILESIZE elements; each DAG
+ *   node result lives in a tile buffer, reused once the node is consumed,
+ *   so intermediates stay in L1 cache.
+ * - Compiled plans are cached by expression string: repeated calls skip
+ *   parsing. Plans store names, not IDs, and are revalidated on use.
+ *
+ * Results are identical to the operator-by-operator path of execute_arith():
+ * intermediate images that would be single precision there are rounded to
+ * single precision here.
+ *
+ * Anything else (reductions, multi-argument functions, "^", mismatched
+ * image sizes, complex images) is left to execute_arith().
+ */
+
+#include <math.h>
+#include <ctype.h>
+
+#include "CommandLineInterface/CLIcore.h"
+#include "COREMOD_memory/COREMOD_memory.h"
+
+#include "mathfuncs.h"
+#include "execute_arith_fused.h"
+
+
+#ifdef _OPENMP
+#include <omp.h>
+#define OMP_NELEMENT_LIMIT 1000000
+#endif
+
+
+#define EXPRFUSED_MAXNODE  100
+#define EXPRFUSED_MAXLEAF  50
+#define EXPRFUSED_TILESIZE 512
+#define EXPRFUSED_NBPLAN   16   // plan cache size
+
+
+#define EXPRNODE_CONST   0  // number
+#define EXPRNODE_VAR     1  // variable
+#define EXPRNODE_IMAGE   2  // image pixel
+#define EXPRNODE_ADD     3
+#define EXPRNODE_SUB     4
+#define EXPRNODE_MULT    5
+#define EXPRNODE_DIV     6
+#define EXPRNODE_FUNC    7  // single-argument math function
+
+
+typedef struct
+{
+    int     op;            // EXPRNODE_*
+    int     arg0;          // child node index
+    int     arg1;          // child node index (binary operators)
+    double (*func)(double);
+    int     leaf;          // leaf name index (VAR, IMAGE)
+    double  value;         // CONST value
+
+    int     isimage;       // 1 if node depends on an image
+    int     lastuse;       // index of last node using this result
+    int     slot;          // tile buffer index (image nodes)
+} EXPRNODE;
+
+
+typedef struct
+{
+    char     *expr;        // cache key, NULL if unused
+    uint64_t  lastused;    // for LRU replacement
+
+    char      outname[STRINGMAXLEN_IMGNAME];
+
+    int       NBnode;
+    EXPRNODE  node[EXPRFUSED_MAXNODE];
+
+    int       NBleaf;
+    char      leafname[EXPRFUSED_MAXLEAF][STRINGMAXLEN_IMGNAME];
+    int       leafisimage[EXPRFUSED_MAXLEAF];
+
+    int       NBslot;      // tile buffers needed
+} EXPRPLAN;
+
+
+static EXPRPLAN planbuff[EXPRFUSED_NBPLAN];
+static uint64_t plancnt = 0;
+
+
+
+
+// ==========================================
+// Compiler
+// ==========================================
+
+
+typedef struct
+{
+    const char *str;
+    int         pos;
+    EXPRPLAN   *plan;
+    int         err;
+} EXPRPARSER;
+
+
+
+static const struct
+{
+    const char *name;
+    double (*func)(double);
+} exprfunctable[] =
+{
+    { "acos",  Pacos     },
+    { "asin",  Pasin     },
+    { "atan",  Patan     },
+    { "ceil",  Pceil     },
+    { "cos",   Pcos      },
+    { "cosh",  Pcosh     },
+    { "exp",   Pexp      },
+    { "fabs",  Pfabs     },
+    { "floor", Pfloor    },
+    { "ln",    Pln       },
+    { "log",   Plog      },
+    { "sqrt",  Psqrt     },
+    { "sin",   Psin      },
+    { "sinh",  Psinh     },
+    { "tan",   Ptan      },
+    { "tanh",  Ptanh     },
+    { "posi",  Ppositive }
+};
+#define NB_EXPRFUNC ((int)(sizeof(exprfunctable) / sizeof(exprfunctable[0])))
+
+
+// names that execute_arith() handles, but not elementwise
+static const char *exprnonfused[] =
+{
+    "imedian", "itot", "imean", "imin", "imax", "imdx", "imdy", "fmod", "trunc"
+};
+#define NB_EXPRNONFUSED ((int)(sizeof(exprnonfused) / sizeof(exprnonfused[0])))
+
+
+
+
+/** @brief Add node to plan, or return index of identical node
+ */
+static int exprplan_addnode(
+    EXPRPARSER *p,
+    EXPRNODE   *nd
+)
+{
+    EXPRPLAN *plan = p->plan;
+
+    for(int n = 0; n < plan->NBnode; n++)
+    {
+        EXPRNODE *ndn = &plan->node[n];
+        if((ndn->op == nd->op) && (ndn->arg0 == nd->arg0) && (ndn->arg1 == nd->arg1)
+                && (ndn->func == nd->func) && (ndn->leaf == nd->leaf)
+                && (ndn->value == nd->value))
+        {
+            return n;
+        }
+    }
+
+    if(plan->NBnode == EXPRFUSED_MAXNODE)
+    {
+        p->err = 1;
+        return -1;
+    }
+
+    nd->isimage = 0;
+    if(nd->op == EXPRNODE_IMAGE)
+    {
+        nd->isimage = 1;
+    }
+    if(nd->arg0 >= 0)
+    {
+        nd->isimage |= plan->node[nd->arg0].isimage;
+    }
+    if(nd->arg1 >= 0)
+    {
+        nd->isimage |= plan->node[nd->arg1].isimage;
+    }
+
+    plan->node[plan->NBnode] = *nd;
+    plan->NBnode ++;
+
+    return plan->NBnode - 1;
+}
+
+
+
+static int exprplan_binary(
+    EXPRPARSER *p,
+    int         op,
+    int         arg0,
+    int         arg1
+)
+{
+    EXPRNODE nd = { op, arg0, arg1, NULL, -1, 0.0, 0, 0, 0 };
+
+    if((arg0 < 0) || (arg1 < 0))
+    {
+        p->err = 1;
+        return -1;
+    }
+    return exprplan_addnode(p, &nd);
+}
+
+
+
+/** @brief Read next word, same separators as execute_arith()
+ */
+static int exprparser_word(
+    EXPRPARSER *p,
+    char       *word
+)
+{
+    const char *s = p->str;
+    int         l = 0;
+
+    while((s[p->pos] != '\0') && (strchr("+-*/^()=,", s[p->pos]) == NULL))
+    {
+        // + or - in number exponent
+        if((l > 0) && ((s[p->pos] == 'e') || (s[p->pos] == 'E'))
+                && isdigit(s[p->pos - 1])
+                && ((s[p->pos + 1] == '+') || (s[p->pos + 1] == '-'))
+                && isdigit(s[p->pos + 2]))
+        {
+            word[l++] = s[p->pos++];
+            word[l++] = s[p->pos++];
+        }
+        if(l > STRINGMAXLEN_IMGNAME - 3)
+        {
+            p->err = 1;
+            return 0;
+        }
+        word[l++] = s[p->pos++];
+    }
+    word[l] = '\0';
+
+    return l;
+}
+
+
+
+static int exprparser_expr(EXPRPARSER *p);
+
+
+static int exprparser_primary(
+    EXPRPARSER *p
+)
+{
+    char word[STRINGMAXLEN_IMGNAME];
+
+    if(p->str[p->pos] == '(')
+    {
+        p->pos ++;
+        int n = exprparser_expr(p);
+        if(p->str[p->pos] != ')')
+        {
+            p->err = 1;
+            return -1;
+        }
+        p->pos ++;
+        return n;
+    }
+
+    if(exprparser_word(p, word) == 0)
+    {
+        p->err = 1;
+        return -1;
+    }
+
+
+    // number
+    {
+        char  *endptr;
+        double value = strtod(word, &endptr);
+        if((endptr != word) && (*endptr == '\0'))
+        {
+            EXPRNODE nd = { EXPRNODE_CONST, -1, -1, NULL, -1, value, 0, 0, 0 };
+            return exprplan_addnode(p, &nd);
+        }
+    }
+
+
+    // function
+    for(int f = 0; f < NB_EXPRNONFUSED; f++)
+    {
+        if(strcmp(word, exprnonfused[f]) == 0)
+        {
+            p->err = 1;
+            return -1;
+        }
+    }
+    for(int f = 0; f < NB_EXPRFUNC; f++)
+    {
+        if(strcmp(word, exprfunctable[f].name) == 0)
+        {
+            if(p->str[p->pos] != '(')
+            {
+                p->err = 1;
+                return -1;
+            }
+            int arg = exprparser_primary(p);
+            if(arg < 0)
+            {
+                p->err = 1;
+                return -1;
+            }
+            EXPRNODE nd = { EXPRNODE_FUNC, arg, -1, exprfunctable[f].func, -1, 0.0, 0, 0, 0 };
+            return exprplan_addnode(p, &nd);
+        }
+    }
+
+
+    // variable or image, variables take precedence as in execute_arith()
+    {
+        EXPRPLAN *plan = p->plan;
+        int       isimage;
+        int       leaf;
+
+        if(variable_ID(word) != -1)
+        {
+            isimage = 0;
+        }
+        else if(image_ID(word) != -1)
+        {
+            isimage = 1;
+        }
+        else
+        {
+            p->err = 1;
+            return -1;
+        }
+
+        for(leaf = 0; leaf < plan->NBleaf; leaf++)
+        {
+            if(strcmp(plan->leafname[leaf], word) == 0)
+            {
+                break;
+            }
+        }
+        if(leaf == plan->NBleaf)
+        {
+            if(plan->NBleaf == EXPRFUSED_MAXLEAF)
+            {
+                p->err = 1;
+                return -1;
+            }
+            strcpy(plan->leafname[leaf], word);
+            plan->leafisimage[leaf] = isimage;
+            plan->NBleaf ++;
+        }
+
+        EXPRNODE nd = { isimage ? EXPRNODE_IMAGE : EXPRNODE_VAR, -1, -1, NULL, leaf, 0.0, 0, 0, 0 };
+        return exprplan_addnode(p, &nd);
+    }
+}
+
+
+
+static int exprparser_term(
+    EXPRPARSER *p
+)
+{
+    int n = exprparser_primary(p);
+
+    while((p->err == 0) && ((p->str[p->pos] == '*') || (p->str[p->pos] == '/')))
+    {
+        int op = (p->str[p->pos] == '*') ? EXPRNODE_MULT : EXPRNODE_DIV;
+        p->pos ++;
+        n = exprplan_binary(p, op, n, exprparser_primary(p));
+    }
+
+    return n;
+}
+
+
+
+/** @brief Parse sum of terms
+ *
+ * A leading sign is applied as in execute_arith(): "-a*b" is "0-a*b".
+ */
+static int exprparser_expr(
+    EXPRPARSER *p
+)
+{
+    int n;
+
+    if(p->str[p->pos] == '-')
+    {
+        EXPRNODE nd = { EXPRNODE_CONST, -1, -1, NULL, -1, 0.0, 0, 0, 0 };
+        n = exprplan_addnode(p, &nd);
+    }
+    else
+    {
+        if(p->str[p->pos] == '+')
+        {
+            p->pos ++;
+        }
+        n = exprparser_term(p);
+    }
+
+    while((p->err == 0) && ((p->str[p->pos] == '+') || (p->str[p->pos] == '-')))
+    {
+        int op = (p->str[p->pos] == '+') ? EXPRNODE_ADD : EXPRNODE_SUB;
+        p->pos ++;
+        n = exprplan_binary(p, op, n, exprparser_term(p));
+    }
+
+    return n;
+}
+
+
+
+/** @brief Compile expression into plan
+ *
+ * Returns RETURN_SUCCESS if expression can be evaluated by fused path.
+ */
+static errno_t exprplan_compile(
+    EXPRPLAN   *plan,
+    const char *cmd
+)
+{
+    EXPRPARSER p;
+    char       str[STRINGMAXLEN_DEFAULT];
+    int        l = 0;
+
+    // remove spaces
+    for(int i = 0; cmd[i] != '\0'; i++)
+    {
+        if(cmd[i] != ' ')
+        {
+            if(l == STRINGMAXLEN_DEFAULT - 1)
+            {
+                return RETURN_FAILURE;
+            }
+            str[l++] = cmd[i];
+        }
+    }
+    str[l] = '\0';
+
+    memset(plan, 0, sizeof(EXPRPLAN));
+    p.str  = str;
+    p.pos  = 0;
+    p.plan = plan;
+    p.err  = 0;
+
+    // output name
+    if(exprparser_word(&p, plan->outname) == 0)
+    {
+        return RETURN_FAILURE;
+    }
+    if((p.err != 0) || (str[p.pos] != '='))
+    {
+        return RETURN_FAILURE;
+    }
+    p.pos ++;
+
+    int root = exprparser_expr(&p);
+    if((p.err != 0) || (root < 0) || (str[p.pos] != '\0'))
+    {
+        return RETURN_FAILURE;
+    }
+
+    // only worth it if result is an image computed from at least one operation
+    if((plan->node[root].isimage == 0) || (plan->node[root].op == EXPRNODE_IMAGE))
+    {
+        return RETURN_FAILURE;
+    }
+
+    // root is created last, as it depends on every other node
+    if(root != plan->NBnode - 1)
+    {
+        return RETURN_FAILURE;
+    }
+
+
+    // tile buffer allocation: slot freed after last use
+    {
+        int slotfree[EXPRFUSED_MAXNODE];
+        int NBslotfree = 0;
+
+        for(int n = 0; n < plan->NBnode; n++)
+        {
+            plan->node[n].lastuse = n;
+        }
+        for(int n = 0; n < plan->NBnode; n++)
+        {
+            if(plan->node[n].arg0 >= 0)
+            {
+                plan->node[plan->node[n].arg0].lastuse = n;
+            }
+            if(plan->node[n].arg1 >= 0)
+            {
+                plan->node[plan->node[n].arg1].lastuse = n;
+            }
+        }
+
+        plan->NBslot = 0;
+        for(int n = 0; n < plan->NBnode; n++)
+        {
+            EXPRNODE *nd = &plan->node[n];
+            if(nd->isimage == 0)
+            {
+                continue;
+            }
+            if(NBslotfree > 0)
+            {
+                nd->slot = slotfree[--NBslotfree];
+            }
+            else
+            {
+                nd->slot = plan->NBslot++;
+            }
+            // release inputs whose last use is this node
+            if((nd->arg0 >= 0) && plan->node[nd->arg0].isimage
+                    && (plan->node[nd->arg0].lastuse == n))
+            {
+                slotfree[NBslotfree++] = plan->node[nd->arg0].slot;
+            }
+            if((nd->arg1 >= 0) && (nd->arg1 != nd->arg0) && plan->node[nd->arg1].isimage
+                    && (plan->node[nd->arg1].lastuse == n))
+            {
+                slotfree[NBslotfree++] = plan->node[nd->arg1].slot;
+            }
+        }
+    }
+
+    return RETURN_SUCCESS;
+}
+
+
+
+/** @brief Check that names still resolve as when plan was compiled
+ */
+static int exprplan_valid(
+    EXPRPLAN *plan
+)
+{
+    for(int leaf = 0; leaf < plan->NBleaf; leaf++)
+    {
+        int isvar = (variable_ID(plan->leafname[leaf]) != -1);
+        if(plan->leafisimage[leaf])
+        {
+            if(isvar || (image_ID(plan->leafname[leaf]) == -1))
+            {
+                return 0;
+            }
+        }
+        else if(!isvar)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+
+static EXPRPLAN *exprplan_get(
+    const char *cmd
+)
+{
+    EXPRPLAN *plan = NULL;
+
+    plancnt ++;
+    for(int i = 0; i < EXPRFUSED_NBPLAN; i++)
+    {
+        if((planbuff[i].expr != NULL) && (strcmp(planbuff[i].expr, cmd) == 0))
+        {
+            if(exprplan_valid(&planbuff[i]))
+            {
+                planbuff[i].lastused = plancnt;
+                return &planbuff[i];
+            }
+            plan = &planbuff[i];
+            break;
+        }
+    }
+
+    // least recently used entry
+    if(plan == NULL)
+    {
+        plan = &planbuff[0];
+        for(int i = 1; i < EXPRFUSED_NBPLAN; i++)
+        {
+            if(planbuff[i].lastused < plan->lastused)
+            {
+                plan = &planbuff[i];
+            }
+        }
+    }
+    free(plan->expr);
+    plan->expr = NULL;
+
+    if(exprplan_compile(plan, cmd) != RETURN_SUCCESS)
+    {
+        memset(plan, 0, sizeof(EXPRPLAN));
+        return NULL;
+    }
+    plan->expr = strdup(cmd);
+    plan->lastused = plancnt;
+
+    return plan;
+}
+
+
+
+
+// ==========================================
+// Evaluation
+// ==========================================
+
+
+static void exprfused_load(
+    double  *dst,
+    IMAGE   *img,
+    long     offset,
+    long     n
+)
+{
+    switch(img->md[0].datatype)
+    {
+#define EXPRFUSED_LOAD(member)                      \
+    for(long ii = 0; ii < n; ii++)                  \
+    {                                               \
+        dst[ii] = (double) img->array.member[offset + ii]; \
+    }                                               \
+    break;
+
+    case _DATATYPE_UINT8:
+        EXPRFUSED_LOAD(UI8)
+    case _DATATYPE_INT8:
+        EXPRFUSED_LOAD(SI8)
+    case _DATATYPE_UINT16:
+        EXPRFUSED_LOAD(UI16)
+    case _DATATYPE_INT16:
+        EXPRFUSED_LOAD(SI16)
+    case _DATATYPE_UINT32:
+        EXPRFUSED_LOAD(UI32)
+    case _DATATYPE_INT32:
+        EXPRFUSED_LOAD(SI32)
+    case _DATATYPE_UINT64:
+        EXPRFUSED_LOAD(UI64)
+    case _DATATYPE_INT64:
+        EXPRFUSED_LOAD(SI64)
+    case _DATATYPE_FLOAT:
+        EXPRFUSED_LOAD(F)
+    case _DATATYPE_DOUBLE:
+        EXPRFUSED_LOAD(D)
+
+#undef EXPRFUSED_LOAD
+    }
+}
+
+
+
+// x, y : operand values, a/b : operand tile or NULL if scalar sa/sb
+#define EXPRFUSED_BINLOOP(expr)                                  \
+    if((a != NULL) && (b != NULL))                               \
+        for(long ii = 0; ii < n; ii++)                           \
+        {                                                        \
+            double x = a[ii];                                    \
+            double y = b[ii];                                    \
+            out[ii] = (expr);                                    \
+        }                                                        \
+    else if(a != NULL)                                           \
+        for(long ii = 0; ii < n; ii++)                           \
+        {                                                        \
+            double x = a[ii];                                    \
+            double y = sb;                                       \
+            out[ii] = (expr);                                    \
+        }                                                        \
+    else                                                         \
+        for(long ii = 0; ii < n; ii++)                           \
+        {                                                        \
+            double x = sa;                                       \
+            double y = b[ii];                                    \
+            out[ii] = (expr);                                    \
+        }
+
+
+/** @brief Evaluate image nodes of plan over one tile
+ */
+static void exprfused_tile(
+    EXPRPLAN *plan,
+    IMAGE   **leafimg,
+    double   *scalar,
+    int      *isfloat,
+    double   *tilebuff,
+    long      offset,
+    long      n
+)
+{
+    for(int nn = 0; nn < plan->NBnode; nn++)
+    {
+        EXPRNODE *nd = &plan->node[nn];
+        if(nd->isimage == 0)
+        {
+            continue;
+        }
+
+        double       *out = tilebuff + EXPRFUSED_TILESIZE * nd->slot;
+        const double *a = NULL;
+        const double *b = NULL;
+        double        sa = 0.0;
+        double        sb = 0.0;
+
+        if(nd->arg0 >= 0)
+        {
+            if(plan->node[nd->arg0].isimage)
+            {
+                a = tilebuff + EXPRFUSED_TILESIZE * plan->node[nd->arg0].slot;
+            }
+            else
+            {
+                sa = scalar[nd->arg0];
+            }
+        }
+        if(nd->arg1 >= 0)
+        {
+            if(plan->node[nd->arg1].isimage)
+            {
+                b = tilebuff + EXPRFUSED_TILESIZE * plan->node[nd->arg1].slot;
+            }
+            else
+            {
+                sb = scalar[nd->arg1];
+            }
+        }
+
+        switch(nd->op)
+        {
+        case EXPRNODE_IMAGE:
+            exprfused_load(out, leafimg[nd->leaf], offset, n);
+            break;
+
+        case EXPRNODE_ADD:
+            EXPRFUSED_BINLOOP(x + y)
+            break;
+
+        case EXPRNODE_SUB:
+            EXPRFUSED_BINLOOP(x - y)
+            break;
+
+        case EXPRNODE_MULT:
+            EXPRFUSED_BINLOOP(x * y)
+            break;
+
+        case EXPRNODE_DIV:
+            EXPRFUSED_BINLOOP(x / y)
+            break;
+
+        case EXPRNODE_FUNC:
+            for(long ii = 0; ii < n; ii++)
+            {
+                out[ii] = nd->func(a[ii]);
+            }
+            break;
+        }
+
+        // single precision intermediate, as in operator-by-operator evaluation
+        if(isfloat[nn] && (nd->op != EXPRNODE_IMAGE))
+        {
+            for(long ii = 0; ii < n; ii++)
+            {
+                out[ii] = (double)((float) out[ii]);
+            }
+        }
+    }
+}
+
+
+
+/** @brief Evaluate arithmetic expression in a single fused pass
+ *
+ * Returns 1 if expression was evaluated, 0 if it must be evaluated by
+ * execute_arith(). Nothing is modified if 0 is returned.
+ */
+int execute_arith_fused(
+    const char *cmd
+)
+{
+    EXPRPLAN *plan = exprplan_get(cmd);
+    if(plan == NULL)
+    {
+        return 0;
+    }
+
+
+    // resolve leaves, all images must have the same shape and be real
+    IMAGE   *leafimg[EXPRFUSED_MAXLEAF];
+    imageID  IDref = -1;
+
+    for(int leaf = 0; leaf < plan->NBleaf; leaf++)
+    {
+        leafimg[leaf] = NULL;
+        if(plan->leafisimage[leaf] == 0)
+        {
+            continue;
+        }
+
+        imageID ID = image_ID(plan->leafname[leaf]);
+        uint8_t datatype = data.image[ID].md[0].datatype;
+        if((datatype == _DATATYPE_COMPLEX_FLOAT) || (datatype == _DATATYPE_COMPLEX_DOUBLE))
+        {
+            return 0;
+        }
+        if(IDref == -1)
+        {
+            IDref = ID;
+        }
+        else
+        {
+            if(data.image[ID].md[0].naxis != data.image[IDref].md[0].naxis)
+            {
+                return 0;
+            }
+            for(int ax = 0; ax < data.image[ID].md[0].naxis; ax++)
+            {
+                if(data.image[ID].md[0].size[ax] != data.image[IDref].md[0].size[ax])
+                {
+                    return 0;
+                }
+            }
+        }
+        leafimg[leaf] = &data.image[ID];
+    }
+
+
+    // scalar nodes, and node precision
+    double scalar[EXPRFUSED_MAXNODE];
+    int    isfloat[EXPRFUSED_MAXNODE];
+
+    for(int n = 0; n < plan->NBnode; n++)
+    {
+        EXPRNODE *nd = &plan->node[n];
+
+        scalar[n] = 0.0;
+        isfloat[n] = 0;
+        if(nd->isimage)
+        {
+            // double if any input image is double
+            if(nd->op == EXPRNODE_IMAGE)
+            {
+                isfloat[n] = (leafimg[nd->leaf]->md[0].datatype != _DATATYPE_DOUBLE);
+            }
+            else
+            {
+                int f0 = ((nd->arg0 >= 0) && plan->node[nd->arg0].isimage) ? isfloat[nd->arg0] : 1;
+                int f1 = ((nd->arg1 >= 0) && plan->node[nd->arg1].isimage) ? isfloat[nd->arg1] : 1;
+                isfloat[n] = f0 && f1;
+            }
+            continue;
+        }
+
+        switch(nd->op)
+        {
+        case EXPRNODE_CONST:
+            scalar[n] = nd->value;
+            break;
+        case EXPRNODE_VAR:
+            scalar[n] = data.variable[variable_ID(plan->leafname[nd->leaf])].value.f;
+            break;
+        case EXPRNODE_ADD:
+            scalar[n] = scalar[nd->arg0] + scalar[nd->arg1];
+            break;
+        case EXPRNODE_SUB:
+            scalar[n] = scalar[nd->arg0] - scalar[nd->arg1];
+            break;
+        case EXPRNODE_MULT:
+            scalar[n] = scalar[nd->arg0] * scalar[nd->arg1];
+            break;
+        case EXPRNODE_DIV:
+            scalar[n] = scalar[nd->arg0] / scalar[nd->arg1];
+            break;
+        case EXPRNODE_FUNC:
+            scalar[n] = nd->func(scalar[nd->arg0]);
+            break;
+        }
+    }
+
+
+    // output, written under temporary name then renamed as in execute_arith()
+    EXPRNODE *root = &plan->node[plan->NBnode - 1];
+    uint8_t   datatypeout = isfloat[plan->NBnode - 1] ? _DATATYPE_FLOAT : _DATATYPE_DOUBLE;
+    uint32_t  naxes[3];
+    uint8_t   naxis = data.image[IDref].md[0].naxis;
+    long      nelement = data.image[IDref].md[0].nelement;
+    imageID   IDout;
+
+    for(int ax = 0; ax < naxis; ax++)
+    {
+        naxes[ax] = data.image[IDref].md[0].size[ax];
+    }
+
+    CREATE_IMAGENAME(tmpname, "_tmpfused_%d", (int) getpid());
+    create_image_ID(tmpname, naxis, naxes, datatypeout, data.SHARED_DFT,
+                    data.NBKEYWORD_DFT, 0, &IDout);
+    if(IDout == -1)
+    {
+        return 0;
+    }
+
+
+    long NBtile = (nelement + EXPRFUSED_TILESIZE - 1) / EXPRFUSED_TILESIZE;
+
+# ifdef _OPENMP
+    #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
+# endif
+    {
+        double *tilebuff = (double *) malloc(sizeof(double) * EXPRFUSED_TILESIZE *
+                                             plan->NBslot);
+        if(tilebuff == NULL)
+        {
+            PRINT_ERROR("malloc error");
+            abort();
+        }
+
+# ifdef _OPENMP
+        #pragma omp for
+# endif
+        for(long tile = 0; tile < NBtile; tile++)
+        {
+            long offset = tile * EXPRFUSED_TILESIZE;
+            long n = nelement - offset;
+            if(n > EXPRFUSED_TILESIZE)
+            {
+                n = EXPRFUSED_TILESIZE;
+            }
+
+            exprfused_tile(plan, leafimg, scalar, isfloat, tilebuff, offset, n);
+
+            double *res = tilebuff + EXPRFUSED_TILESIZE * root->slot;
+            if(datatypeout == _DATATYPE_FLOAT)
+            {
+                float *dst = data.image[IDout].array.F + offset;
+                for(long ii = 0; ii < n; ii++)
+                {
+                    dst[ii] = (float) res[ii];
+                }
+            }
+            else
+            {
+                memcpy(data.image[IDout].array.D + offset, res, sizeof(double) * n);
+            }
+        }
+
+        free(tilebuff);
+    }
+
+
+    if(variable_ID(plan->outname) != -1)
+    {
+        delete_variable_ID(plan->outname);
+    }
+    if(image_ID(plan->outname) != -1)
+    {
+        delete_image_ID(plan->outname, DELETE_IMAGE_ERRMODE_WARNING);
+    }
+    chname_image_ID(tmpname, plan->outname);
+
+    return 1;
+}
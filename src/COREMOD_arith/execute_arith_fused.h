@@ -0,0 +1,11 @@
+/**
+ * @file    execute_arith_fused.h
+ * @brief   fused single-pass evaluation of image arithmetic expressions
+ */
+
+#ifndef COREMOD_ARITH_EXECUTE_ARITH_FUSED_H
+#define COREMOD_ARITH_EXECUTE_ARITH_FUSED_H
+
+int execute_arith_fused(const char *cmd);
+
+#endif
@@ -0,0 +1,410 @@
+/**
+ * @file    image_percentile.c
+ * @brief   image percentiles by selection
+ *
+ * Percentile of fraction f is element (long)(f * nelement) of the sorted
+ * pixel values, computed without sorting:
+ * - 8 and 16-bit integer images : histogram (counting) selection
+ * - other types : introselect on a copy of the pixel values
+ *
+ * Several percentiles are computed in one pass. Copies are made into a
+ * scratch buffer that is kept between calls (one per thread), so no
+ * allocation is needed once it has reached the image size.
+ */
+
+#include "CommandLineInterface/CLIcore.h"
+#include "COREMOD_memory/COREMOD_memory.h"
+
+#include "image_percentile.h"
+
+
+
+// below this size, clearing a 16-bit histogram costs more than selecting
+#define PERCENTILE_HIST16_MINNELEMENT 16384
+
+// maximum number of percentiles per call
+#define PERCENTILE_MAXNB 1000
+
+
+
+static __thread void   *scratch = NULL;
+static __thread size_t  scratchsize = 0;
+
+
+
+static void *percentile_scratch(
+    size_t size
+)
+{
+    if(size > scratchsize)
+    {
+        void *ptr = realloc(scratch, size);
+        if(ptr == NULL)
+        {
+            PRINT_ERROR("realloc error");
+            abort();
+        }
+        scratch = ptr;
+        scratchsize = size;
+    }
+    return scratch;
+}
+
+
+
+/** @brief Release percentile scratch buffer of calling thread
+ */
+void arith_image_percentile_scratch_free()
+{
+    free(scratch);
+    scratch = NULL;
+    scratchsize = 0;
+}
+
+
+
+
+/** @brief Rank of each requested fraction, clamped to [0, nelement-1]
+ */
+static void percentile_ranks(
+    const double *fraction,
+    int           NBfraction,
+    long          nelement,
+    long         *rank
+)
+{
+    for(int i = 0; i < NBfraction; i++)
+    {
+        long k = (long)(fraction[i] * nelement);
+        if(k < 0)
+        {
+            k = 0;
+        }
+        if(k > nelement - 1)
+        {
+            k = nelement - 1;
+        }
+        rank[i] = k;
+    }
+}
+
+
+
+/** @brief Sort rank indices so ranks are processed in increasing order
+ */
+static void percentile_rankorder(
+    const long *rank,
+    int         NBfraction,
+    int        *order
+)
+{
+    for(int i = 0; i < NBfraction; i++)
+    {
+        order[i] = i;
+    }
+    // insertion sort, NBfraction is small
+    for(int i = 1; i < NBfraction; i++)
+    {
+        int o = order[i];
+        int j = i - 1;
+        while((j >= 0) && (rank[order[j]] > rank[o]))
+        {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = o;
+    }
+}
+
+
+
+
+// ==========================================
+// Histogram selection, 8 and 16-bit types
+// ==========================================
+
+// hist has nbin entries, bin b holds value (b + offset)
+#define PERCENTILE_HISTDEF(name, T, nbin, offset)                            \
+    static void name(const T *array, long nelement, uint32_t *hist,          \
+                     const long *rank, const int *order, int NBfraction,     \
+                     double *value)                                          \
+    {                                                                        \
+        memset(hist, 0, sizeof(uint32_t) * (nbin));                          \
+        for(long ii = 0; ii < nelement; ii++)                                \
+        {                                                                    \
+            hist[(long) array[ii] - (offset)] ++;                            \
+        }                                                                    \
+        long cumul = 0;                                                      \
+        long bin = 0;                                                        \
+        for(int i = 0; i < NBfraction; i++)                                  \
+        {                                                                    \
+            long k = rank[order[i]];                                         \
+            while(cumul + hist[bin] <= k)                                    \
+            {                                                                \
+                cumul += hist[bin];                                          \
+                bin ++;                                                      \
+            }                                                                \
+            value[order[i]] = (double)(bin + (offset));                      \
+        }                                                                    \
+    }
+
+PERCENTILE_HISTDEF(percentile_hist_UI8,  uint8_t,  256,   0)
+PERCENTILE_HISTDEF(percentile_hist_SI8,  int8_t,   256,   -128)
+PERCENTILE_HISTDEF(percentile_hist_UI16, uint16_t, 65536, 0)
+PERCENTILE_HISTDEF(percentile_hist_SI16, int16_t,  65536, -32768)
+
+
+
+
+// ==========================================
+// Introselect, other types
+// ==========================================
+
+// quickselect with median-of-3 pivot
+// after 2*log2(n) partitioning rounds, remaining range is sorted with qsort
+#define PERCENTILE_SELECTDEF(name, T)                                        \
+    static int name##_cmp(const void *a, const void *b)                      \
+    {                                                                        \
+        T va = *(const T *) a;                                               \
+        T vb = *(const T *) b;                                               \
+        return (va > vb) - (va < vb);                                        \
+    }                                                                        \
+                                                                             \
+    static void name(T *a, long lo, long hi, long k)                         \
+    {                                                                        \
+        int depthlimit = 2;                                                  \
+        for(long n = hi - lo; n > 1; n >>= 1)                                \
+        {                                                                    \
+            depthlimit += 2;                                                 \
+        }                                                                    \
+        while(hi - lo > 16)                                                  \
+        {                                                                    \
+            if(depthlimit-- == 0)                                            \
+            {                                                                \
+                qsort(a + lo, hi - lo + 1, sizeof(T), name##_cmp);           \
+                return;                                                      \
+            }                                                                \
+            long mid = lo + (hi - lo) / 2;                                   \
+            T    tmp;                                                        \
+            if(a[mid] < a[lo])                                               \
+            {                                                                \
+                tmp = a[mid]; a[mid] = a[lo]; a[lo] = tmp;                   \
+            }                                                                \
+            if(a[hi] < a[lo])                                                \
+            {                                                                \
+                tmp = a[hi]; a[hi] = a[lo]; a[lo] = tmp;                     \
+            }                                                                \
+            if(a[hi] < a[mid])                                               \
+            {                                                                \
+                tmp = a[hi]; a[hi] = a[mid]; a[mid] = tmp;                   \
+            }                                                                \
+            T    pivot = a[mid];                                             \
+            long i = lo;                                                     \
+            long j = hi;                                                     \
+            while(i <= j)                                                    \
+            {                                                                \
+                while(a[i] < pivot)                                          \
+                {                                                            \
+                    i++;                                                     \
+                }                                                            \
+                while(a[j] > pivot)                                          \
+                {                                                            \
+                    j--;                                                     \
+                }                                                            \
+                if(i <= j)                                                   \
+                {                                                            \
+                    tmp = a[i]; a[i] = a[j]; a[j] = tmp;                     \
+                    i++;                                                     \
+                    j--;                                                     \
+                }                                                            \
+            }                                                                \
+            /* [lo,j] <= pivot, [i,hi] >= pivot, (j,i) == pivot */           \
+            if(k <= j)                                                       \
+            {                                                                \
+                hi = j;                                                      \
+            }                                                                \
+            else if(k >= i)                                                  \
+            {                                                                \
+                lo = i;                                                      \
+            }                                                                \
+            else                                                             \
+            {                                                                \
+                return;                                                      \
+            }                                                                \
+        }                                                                    \
+        /* insertion sort of small range */                                  \
+        for(long i = lo + 1; i <= hi; i++)                                   \
+        {                                                                    \
+            T    v = a[i];                                                   \
+            long j = i - 1;                                                  \
+            while((j >= lo) && (a[j] > v))                                   \
+            {                                                                \
+                a[j + 1] = a[j];                                             \
+                j--;                                                         \
+            }                                                                \
+            a[j + 1] = v;                                                    \
+        }                                                                    \
+    }                                                                        \
+                                                                             \
+    static void name##_multi(const T *array, long nelement,                  \
+                             const long *rank, const int *order,             \
+                             int NBfraction, double *value)                  \
+    {                                                                        \
+        T   *a = (T *) percentile_scratch(sizeof(T) * nelement);             \
+        long lo = 0;                                                         \
+        memcpy(a, array, sizeof(T) * nelement);                              \
+        for(int i = 0; i < NBfraction; i++)                                  \
+        {                                                                    \
+            long k = rank[order[i]];                                         \
+            /* elements after previous rank are all >= it */                 \
+            name(a, lo, nelement - 1, k);                                    \
+            value[order[i]] = (double) a[k];                                 \
+            lo = k;                                                          \
+        }                                                                    \
+    }
+
+PERCENTILE_SELECTDEF(percentile_select_UI16, uint16_t)
+PERCENTILE_SELECTDEF(percentile_select_SI16, int16_t)
+PERCENTILE_SELECTDEF(percentile_select_UI32, uint32_t)
+PERCENTILE_SELECTDEF(percentile_select_SI32, int32_t)
+PERCENTILE_SELECTDEF(percentile_select_UI64, uint64_t)
+PERCENTILE_SELECTDEF(percentile_select_SI64, int64_t)
+PERCENTILE_SELECTDEF(percentile_select_F,    float)
+PERCENTILE_SELECTDEF(percentile_select_D,    double)
+
+
+
+
+// ==========================================
+// API
+// ==========================================
+
+
+/** @brief Compute several percentiles of an image
+ *
+ * value[i] is the percentile for fraction[i].
+ */
+errno_t arith_image_percentiles_byID(
+    imageID       ID,
+    const double *fraction,
+    int           NBfraction,
+    double       *value
+)
+{
+    long     rank[PERCENTILE_MAXNB];
+    int      order[PERCENTILE_MAXNB];
+    long     nelement = data.image[ID].md[0].nelement;
+    uint8_t  datatype = data.image[ID].md[0].datatype;
+
+    if((NBfraction < 1) || (NBfraction > PERCENTILE_MAXNB) || (nelement < 1))
+    {
+        PRINT_ERROR("invalid number of percentiles (%d) or empty image", NBfraction);
+        return RETURN_FAILURE;
+    }
+
+    percentile_ranks(fraction, NBfraction, nelement, rank);
+    percentile_rankorder(rank, NBfraction, order);
+
+    switch(datatype)
+    {
+    case _DATATYPE_UINT8 :
+    {
+        uint32_t hist[256];
+        percentile_hist_UI8(data.image[ID].array.UI8, nelement, hist, rank, order,
+                            NBfraction, value);
+    }
+    break;
+
+    case _DATATYPE_INT8 :
+    {
+        uint32_t hist[256];
+        percentile_hist_SI8(data.image[ID].array.SI8, nelement, hist, rank, order,
+                            NBfraction, value);
+    }
+    break;
+
+    case _DATATYPE_UINT16 :
+        if(nelement >= PERCENTILE_HIST16_MINNELEMENT)
+        {
+            percentile_hist_UI16(data.image[ID].array.UI16, nelement,
+                                 (uint32_t *) percentile_scratch(sizeof(uint32_t) * 65536),
+                                 rank, order, NBfraction, value);
+        }
+        else
+        {
+            percentile_select_UI16_multi(data.image[ID].array.UI16, nelement, rank, order,
+                                         NBfraction, value);
+        }
+        break;
+
+    case _DATATYPE_INT16 :
+        if(nelement >= PERCENTILE_HIST16_MINNELEMENT)
+        {
+            percentile_hist_SI16(data.image[ID].array.SI16, nelement,
+                                 (uint32_t *) percentile_scratch(sizeof(uint32_t) * 65536),
+                                 rank, order, NBfraction, value);
+        }
+        else
+        {
+            percentile_select_SI16_multi(data.image[ID].array.SI16, nelement, rank, order,
+                                         NBfraction, value);
+        }
+        break;
+
+    case _DATATYPE_UINT32 :
+        percentile_select_UI32_multi(data.image[ID].array.UI32, nelement, rank, order,
+                                     NBfraction, value);
+        break;
+
+    case _DATATYPE_INT32 :
+        percentile_select_SI32_multi(data.image[ID].array.SI32, nelement, rank, order,
+                                     NBfraction, value);
+        break;
+
+    case _DATATYPE_UINT64 :
+        percentile_select_UI64_multi(data.image[ID].array.UI64, nelement, rank, order,
+                                     NBfraction, value);
+        break;
+
+    case _DATATYPE_INT64 :
+        percentile_select_SI64_multi(data.image[ID].array.SI64, nelement, rank, order,
+                                     NBfraction, value);
+        break;
+
+    case _DATATYPE_FLOAT :
+        percentile_select_F_multi(data.image[ID].array.F, nelement, rank, order,
+                                  NBfraction, value);
+        break;
+
+    case _DATATYPE_DOUBLE :
+        percentile_select_D_multi(data.image[ID].array.D, nelement, rank, order,
+                                  NBfraction, value);
+        break;
+
+    default:
+        PRINT_ERROR("Image type not supported");
+        return RETURN_FAILURE;
+    }
+
+    return RETURN_SUCCESS;
+}
+
+
+
+errno_t arith_image_percentiles(
+    const char   *ID_name,
+    const double *fraction,
+    int           NBfraction,
+    double       *value
+)
+{
+    imageID ID = image_ID(ID_name);
+
+    if(ID == -1)
+    {
+        PRINT_ERROR("image %s does not exist", ID_name);
+        return RETURN_FAILURE;
+    }
+
+    return arith_image_percentiles_byID(ID, fraction, NBfraction, value);
+}
@@ -0,0 +1,26 @@
+/**
+ * @file    image_percentile.h
+ * @brief   image percentiles by selection
+ */
+
+#ifndef COREMOD_ARITH_IMAGE_PERCENTILE_H
+#define COREMOD_ARITH_IMAGE_PERCENTILE_H
+
+
+errno_t arith_image_percentiles_byID(
+    imageID       ID,
+    const double *fraction,
+    int           NBfraction,
+    double       *value
+);
+
+errno_t arith_image_percentiles(
+    const char   *ID_name,
+    const double *fraction,
+    int           NBfraction,
+    double       *value
+);
+
+void arith_image_percentile_scratch_free();
+
+#endif
@@ -0,0 +1,30 @@
+/**
+ * @file    image_reduce.h
+ * @brief   fused image reduction : sum, sum of squares, min, max
+ */
+
+#ifndef COREMOD_ARITH_IMAGE_REDUCE_H
+#define COREMOD_ARITH_IMAGE_REDUCE_H
+
+
+typedef struct
+{
+    uint64_t nelement;
+    double   sum;
+    double   sumsq;
+    double   min;
+    double   max;
+} ARITH_IMAGE_STATS;
+
+
+errno_t arith_image_reduce_byID(
+    imageID            ID,
+    ARITH_IMAGE_STATS *stats
+);
+
+errno_t arith_image_reduce(
+    const char        *ID_name,
+    ARITH_IMAGE_STATS *stats
+);
+
+#endif
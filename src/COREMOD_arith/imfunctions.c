@@ -10,6 +10,8 @@
 #include "CommandLineInterface/CLIcore.h"
 #include "COREMOD_memory/COREMOD_memory.h"
 
+#include "imfunctions_kernels.h"
+
 
 
 
@@ -85,6 +87,13 @@ errno_t arith_image_function_im_im__d_d(
     nelement = data.image[ID].md[0].nelement;
 
 
+    // specialized kernel for float/double and common functions
+    if(imfunctions_kernel_1_1(pt2function, datatype,
+                              data.image[ID].array.raw, data.image[IDout].array.raw, nelement) == 1)
+    {
+        return RETURN_SUCCESS;
+    }
+
 # ifdef _OPENMP
     #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
     {
@@ -269,6 +278,13 @@ errno_t arith_image_function_imd_im__dd_d(
     nelement = data.image[ID].md[0].nelement;
 
 
+    // specialized kernel for float/double and common functions
+    if(imfunctions_kernel_1f_1(pt2function, datatype,
+                               data.image[ID].array.raw, v0, data.image[IDout].array.raw, nelement) == 1)
+    {
+        return RETURN_SUCCESS;
+    }
+
 # ifdef _OPENMP
     #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
     {
@@ -643,6 +659,13 @@ errno_t arith_image_function_1_1_byID(
     nelement = data.image[ID].md[0].nelement;
 
 
+    // specialized kernel for float/double and common functions
+    if(imfunctions_kernel_1_1(pt2function, datatype,
+                              data.image[ID].array.raw, data.image[IDout].array.raw, nelement) == 1)
+    {
+        return RETURN_SUCCESS;
+    }
+
 # ifdef _OPENMP
     #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
     {
@@ -826,6 +849,13 @@ errno_t arith_image_function_1_1(
     nelement = data.image[ID].md[0].nelement;
 
 
+    // specialized kernel for float/double and common functions
+    if(imfunctions_kernel_1_1(pt2function, datatype,
+                              data.image[ID].array.raw, data.image[IDout].array.raw, nelement) == 1)
+    {
+        return RETURN_SUCCESS;
+    }
+
 # ifdef _OPENMP
     #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
     {
@@ -980,6 +1010,14 @@ errno_t arith_image_function_1_1_inplace_byID(
     nelement = data.image[ID].md[0].nelement;
 
     data.image[ID].md[0].write = 0;
+    // specialized kernel for float/double and common functions
+    if(imfunctions_kernel_1_1(pt2function, datatype,
+                              data.image[ID].array.raw, data.image[ID].array.raw, nelement) == 1)
+    {
+        data.image[ID].md[0].cnt0++;
+        return RETURN_SUCCESS;
+    }
+
 # ifdef _OPENMP
     #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
     {
@@ -1139,6 +1177,14 @@ errno_t arith_image_function_1_1_inplace(
     nelement = data.image[ID].md[0].nelement;
 
     data.image[ID].md[0].write = 0;
+    // specialized kernel for float/double and common functions
+    if(imfunctions_kernel_1_1(pt2function, datatype,
+                              data.image[ID].array.raw, data.image[ID].array.raw, nelement) == 1)
+    {
+        data.image[ID].md[0].cnt0++;
+        return RETURN_SUCCESS;
+    }
+
 # ifdef _OPENMP
     #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
     {
@@ -1408,6 +1454,39 @@ errno_t arith_image_function_2_1(
         }
 
 
+    // specialized kernel for float/double and common functions
+    if(op3D2Dto3D == 0)
+    {
+        if(imfunctions_kernel_2_1(pt2function, datatype1, datatype2,
+                                  data.image[ID1].array.raw, data.image[ID2].array.raw,
+                                  data.image[IDout].array.raw, nelement) == 1)
+        {
+            free(naxes);
+            free(naxes2);
+            return RETURN_SUCCESS;
+        }
+    }
+    else
+    {
+        size_t slicesize = ImageStreamIO_typesize(datatype1) * xysize;
+
+        if(imfunctions_kernel_2_1(pt2function, datatype1, datatype2,
+                                  data.image[ID1].array.raw, data.image[ID2].array.raw,
+                                  data.image[IDout].array.raw, xysize) == 1)
+        {
+            for(kk = 1; kk < naxes[2]; kk++)
+            {
+                imfunctions_kernel_2_1(pt2function, datatype1, datatype2,
+                                       (char *) data.image[ID1].array.raw + slicesize * kk,
+                                       data.image[ID2].array.raw,
+                                       (char *) data.image[IDout].array.raw + slicesize * kk, xysize);
+            }
+            free(naxes);
+            free(naxes2);
+            return RETURN_SUCCESS;
+        }
+    }
+
 
 
 //# ifdef _OPENMP
@@ -4016,6 +4095,16 @@ errno_t arith_image_function_2_1_inplace_byID(
 
     data.image[ID1].md[0].write = 1;
 
+    // specialized kernel for float/double and common functions
+    if(imfunctions_kernel_2_1(pt2function, datatype1, datatype2,
+                              data.image[ID1].array.raw, data.image[ID2].array.raw,
+                              data.image[ID1].array.raw, nelement) == 1)
+    {
+        data.image[ID1].md[0].write = 0;
+        data.image[ID1].md[0].cnt0++;
+        return EXIT_SUCCESS;
+    }
+
 # ifdef _OPENMP
     #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
     {
@@ -4523,6 +4612,13 @@ int arith_image_function_1f_1(const char *ID_name, double f1,
 
 
 
+    // specialized kernel for float/double and common functions
+    if(imfunctions_kernel_1f_1(pt2function, datatype,
+                               data.image[ID].array.raw, f1, data.image[IDout].array.raw, nelement) == 1)
+    {
+        return EXIT_SUCCESS;
+    }
+
 # ifdef _OPENMP
     #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
     {
@@ -4664,6 +4760,13 @@ int arith_image_function_1f_1_inplace_byID(long ID, double f1,
     datatype = data.image[ID].md[0].datatype;
     nelement = data.image[ID].md[0].nelement;
 
+    // specialized kernel for float/double and common functions
+    if(imfunctions_kernel_1f_1(pt2function, datatype,
+                               data.image[ID].array.raw, f1, data.image[ID].array.raw, nelement) == 1)
+    {
+        return EXIT_SUCCESS;
+    }
+
 # ifdef _OPENMP
     #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
     {
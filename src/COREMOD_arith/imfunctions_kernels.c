@@ -0,0 +1,415 @@
+/**
+ * @file    imfunctions_kernels.c
+ * @brief   type-specialized elementwise kernels
+ *
+ * The generic arith_image_function_* loops call a double(*)(double) math
+ * function pointer per pixel. For float and double images, and the most
+ * common math functions, the loops below are used instead : the operator
+ * is inlined, so the compiler can vectorize each loop.
+ *
+ * On x86_64, each kernel is compiled for AVX-512, AVX2 and baseline
+ * instruction sets, and the best version is selected at load time
+ * (target_clones). Float results are identical to the generic path:
+ * operations that are not exact in single precision are computed in double.
+ */
+
+#include <math.h>
+
+#include "CommandLineInterface/CLIcore.h"
+
+#include "mathfuncs.h"
+#include "imfunctions_kernels.h"
+
+
+#ifdef _OPENMP
+#include <omp.h>
+#define OMP_NELEMENT_LIMIT 1000000
+#endif
+
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define KERNEL_ATTR __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define KERNEL_ATTR
+#endif
+
+
+// chunks processed by OpenMP threads are aligned to this many elements
+#define KERNEL_CHUNKALIGN 64
+
+
+
+typedef void (*KERNEL_1_1)(const void *in, void *out, long n);
+typedef void (*KERNEL_2_1)(const void *in1, const void *in2, void *out, long n);
+typedef void (*KERNEL_1f_1)(const void *in, double f1, void *out, long n);
+
+
+
+
+// ==========================================
+// Kernel definitions
+// ==========================================
+
+// a : input pixel value
+#define KERNEL_DEF_1_1(name, T, expr)                                   \
+    static KERNEL_ATTR void name(const void *in, void *out, long n)      \
+    {                                                                    \
+        const T *pin  = (const T *) in;                                  \
+        T       *pout = (T *) out;                                       \
+        for(long ii = 0; ii < n; ii++)                                   \
+        {                                                                \
+            T a = pin[ii];                                               \
+            pout[ii] = (T)(expr);                                        \
+        }                                                                \
+    }
+
+// a, b : input pixel values
+#define KERNEL_DEF_2_1(name, T, expr)                                   \
+    static KERNEL_ATTR void name(const void *in1, const void *in2,       \
+                                 void *out, long n)                      \
+    {                                                                    \
+        const T *pin1 = (const T *) in1;                                 \
+        const T *pin2 = (const T *) in2;                                 \
+        T       *pout = (T *) out;                                       \
+        for(long ii = 0; ii < n; ii++)                                   \
+        {                                                                \
+            T a = pin1[ii];                                              \
+            T b = pin2[ii];                                              \
+            pout[ii] = (T)(expr);                                        \
+        }                                                                \
+    }
+
+// a : input pixel value (converted to double), b : scalar
+#define KERNEL_DEF_1f_1(name, T, expr)                                  \
+    static KERNEL_ATTR void name(const void *in, double f1,              \
+                                 void *out, long n)                      \
+    {                                                                    \
+        const T *pin  = (const T *) in;                                  \
+        T       *pout = (T *) out;                                       \
+        for(long ii = 0; ii < n; ii++)                                   \
+        {                                                                \
+            double a = (double) pin[ii];                                 \
+            double b = f1;                                               \
+            pout[ii] = (T)(expr);                                        \
+        }                                                                \
+    }
+
+
+// unary
+
+KERNEL_DEF_1_1(kernel_fabs_F,  float,  fabsf(a))
+KERNEL_DEF_1_1(kernel_fabs_D,  double, fabs(a))
+KERNEL_DEF_1_1(kernel_sqrt_F,  float,  sqrt((double) a))
+KERNEL_DEF_1_1(kernel_sqrt_D,  double, sqrt(a))
+KERNEL_DEF_1_1(kernel_exp_F,   float,  exp((double) a))
+KERNEL_DEF_1_1(kernel_exp_D,   double, exp(a))
+KERNEL_DEF_1_1(kernel_ln_F,    float,  log((double) a))
+KERNEL_DEF_1_1(kernel_ln_D,    double, log(a))
+KERNEL_DEF_1_1(kernel_log_F,   float,  log10((double) a))
+KERNEL_DEF_1_1(kernel_log_D,   double, log10(a))
+
+
+// binary, image image
+// single precision add/sub/mult/div round identically to the double path
+
+KERNEL_DEF_2_1(kernel_add_FF,    float,  a + b)
+KERNEL_DEF_2_1(kernel_add_DD,    double, a + b)
+KERNEL_DEF_2_1(kernel_sub_FF,    float,  a - b)
+KERNEL_DEF_2_1(kernel_sub_DD,    double, a - b)
+KERNEL_DEF_2_1(kernel_subm_FF,   float,  b - a)
+KERNEL_DEF_2_1(kernel_subm_DD,   double, b - a)
+KERNEL_DEF_2_1(kernel_mult_FF,   float,  a * b)
+KERNEL_DEF_2_1(kernel_mult_DD,   double, a * b)
+KERNEL_DEF_2_1(kernel_div_FF,    float,  a / b)
+KERNEL_DEF_2_1(kernel_div_DD,    double, a / b)
+KERNEL_DEF_2_1(kernel_div1_FF,   float,  b / a)
+KERNEL_DEF_2_1(kernel_div1_DD,   double, b / a)
+KERNEL_DEF_2_1(kernel_minv_FF,   float,  (a < b) ? a : b)
+KERNEL_DEF_2_1(kernel_minv_DD,   double, (a < b) ? a : b)
+KERNEL_DEF_2_1(kernel_maxv_FF,   float,  (a > b) ? a : b)
+KERNEL_DEF_2_1(kernel_maxv_DD,   double, (a > b) ? a : b)
+KERNEL_DEF_2_1(kernel_testlt_FF, float,  (a < b) ? 1.0f : 0.0f)
+KERNEL_DEF_2_1(kernel_testlt_DD, double, (a < b) ? 1.0 : 0.0)
+KERNEL_DEF_2_1(kernel_testmt_FF, float,  (a < b) ? 0.0f : 1.0f)
+KERNEL_DEF_2_1(kernel_testmt_DD, double, (a < b) ? 0.0 : 1.0)
+
+
+// binary, image scalar
+
+KERNEL_DEF_1f_1(kernel_add_Ff,    float,  a + b)
+KERNEL_DEF_1f_1(kernel_add_Df,    double, a + b)
+KERNEL_DEF_1f_1(kernel_sub_Ff,    float,  a - b)
+KERNEL_DEF_1f_1(kernel_sub_Df,    double, a - b)
+KERNEL_DEF_1f_1(kernel_subm_Ff,   float,  b - a)
+KERNEL_DEF_1f_1(kernel_subm_Df,   double, b - a)
+KERNEL_DEF_1f_1(kernel_mult_Ff,   float,  a * b)
+KERNEL_DEF_1f_1(kernel_mult_Df,   double, a * b)
+KERNEL_DEF_1f_1(kernel_div_Ff,    float,  a / b)
+KERNEL_DEF_1f_1(kernel_div_Df,    double, a / b)
+KERNEL_DEF_1f_1(kernel_div1_Ff,   float,  b / a)
+KERNEL_DEF_1f_1(kernel_div1_Df,   double, b / a)
+KERNEL_DEF_1f_1(kernel_minv_Ff,   float,  (a < b) ? a : b)
+KERNEL_DEF_1f_1(kernel_minv_Df,   double, (a < b) ? a : b)
+KERNEL_DEF_1f_1(kernel_maxv_Ff,   float,  (a > b) ? a : b)
+KERNEL_DEF_1f_1(kernel_maxv_Df,   double, (a > b) ? a : b)
+KERNEL_DEF_1f_1(kernel_testlt_Ff, float,  (a < b) ? 1.0 : 0.0)
+KERNEL_DEF_1f_1(kernel_testlt_Df, double, (a < b) ? 1.0 : 0.0)
+KERNEL_DEF_1f_1(kernel_testmt_Ff, float,  (a < b) ? 0.0 : 1.0)
+KERNEL_DEF_1f_1(kernel_testmt_Df, double, (a < b) ? 0.0 : 1.0)
+
+
+
+
+// ==========================================
+// Kernel tables
+// ==========================================
+
+static const struct
+{
+    double (*pt2function)(double);
+    KERNEL_1_1 kernelF;
+    KERNEL_1_1 kernelD;
+} kerneltable_1_1[] =
+{
+    { Pfabs, kernel_fabs_F, kernel_fabs_D },
+    { Psqrt, kernel_sqrt_F, kernel_sqrt_D },
+    { Pexp,  kernel_exp_F,  kernel_exp_D  },
+    { Pln,   kernel_ln_F,   kernel_ln_D   },
+    { Plog,  kernel_log_F,  kernel_log_D  }
+};
+
+
+static const struct
+{
+    double (*pt2function)(double, double);
+    KERNEL_2_1  kernelFF;
+    KERNEL_2_1  kernelDD;
+    KERNEL_1f_1 kernelFf;
+    KERNEL_1f_1 kernelDf;
+} kerneltable_2_1[] =
+{
+    { Padd,    kernel_add_FF,    kernel_add_DD,    kernel_add_Ff,    kernel_add_Df    },
+    { Psub,    kernel_sub_FF,    kernel_sub_DD,    kernel_sub_Ff,    kernel_sub_Df    },
+    { Psubm,   kernel_subm_FF,   kernel_subm_DD,   kernel_subm_Ff,   kernel_subm_Df   },
+    { Pmult,   kernel_mult_FF,   kernel_mult_DD,   kernel_mult_Ff,   kernel_mult_Df   },
+    { Pdiv,    kernel_div_FF,    kernel_div_DD,    kernel_div_Ff,    kernel_div_Df    },
+    { Pdiv1,   kernel_div1_FF,   kernel_div1_DD,   kernel_div1_Ff,   kernel_div1_Df   },
+    { Pminv,   kernel_minv_FF,   kernel_minv_DD,   kernel_minv_Ff,   kernel_minv_Df   },
+    { Pmaxv,   kernel_maxv_FF,   kernel_maxv_DD,   kernel_maxv_Ff,   kernel_maxv_Df   },
+    { Ptestlt, kernel_testlt_FF, kernel_testlt_DD, kernel_testlt_Ff, kernel_testlt_Df },
+    { Ptestmt, kernel_testmt_FF, kernel_testmt_DD, kernel_testmt_Ff, kernel_testmt_Df }
+};
+
+
+#define NB_KERNEL_1_1 ((int)(sizeof(kerneltable_1_1) / sizeof(kerneltable_1_1[0])))
+#define NB_KERNEL_2_1 ((int)(sizeof(kerneltable_2_1) / sizeof(kerneltable_2_1[0])))
+
+
+
+static int kernel_lookup_1_1(
+    double (*pt2function)(double)
+)
+{
+    for(int k = 0; k < NB_KERNEL_1_1; k++)
+    {
+        if(kerneltable_1_1[k].pt2function == pt2function)
+        {
+            return k;
+        }
+    }
+    return -1;
+}
+
+
+static int kernel_lookup_2_1(
+    double (*pt2function)(double, double)
+)
+{
+    for(int k = 0; k < NB_KERNEL_2_1; k++)
+    {
+        if(kerneltable_2_1[k].pt2function == pt2function)
+        {
+            return k;
+        }
+    }
+    return -1;
+}
+
+
+
+/** @brief Element range processed by calling thread
+ */
+static inline void kernel_threadrange(
+    long  nelement,
+    long *i0,
+    long *n
+)
+{
+#ifdef _OPENMP
+    long nt = omp_get_num_threads();
+    long it = omp_get_thread_num();
+    long chunk = (nelement + nt - 1) / nt;
+    chunk = ((chunk + KERNEL_CHUNKALIGN - 1) / KERNEL_CHUNKALIGN) * KERNEL_CHUNKALIGN;
+
+    *i0 = chunk * it;
+    if(*i0 > nelement)
+    {
+        *i0 = nelement;
+    }
+    *n = chunk;
+    if(*i0 + *n > nelement)
+    {
+        *n = nelement - *i0;
+    }
+#else
+    *i0 = 0;
+    *n  = nelement;
+#endif
+}
+
+
+
+
+// ==========================================
+// API
+// ==========================================
+
+
+int imfunctions_kernel_1_1(
+    double (*pt2function)(double),
+    uint8_t     datatype,
+    const void *in,
+    void       *out,
+    long        nelement
+)
+{
+    KERNEL_1_1 kernel;
+    size_t     elemsize;
+    int        k = kernel_lookup_1_1(pt2function);
+
+    if(k == -1)
+    {
+        return 0;
+    }
+    switch(datatype)
+    {
+    case _DATATYPE_FLOAT:
+        kernel = kerneltable_1_1[k].kernelF;
+        elemsize = sizeof(float);
+        break;
+    case _DATATYPE_DOUBLE:
+        kernel = kerneltable_1_1[k].kernelD;
+        elemsize = sizeof(double);
+        break;
+    default:
+        return 0;
+    }
+
+# ifdef _OPENMP
+    #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
+# endif
+    {
+        long i0, n;
+        kernel_threadrange(nelement, &i0, &n);
+        kernel((const char *) in + elemsize * i0, (char *) out + elemsize * i0, n);
+    }
+
+    return 1;
+}
+
+
+
+int imfunctions_kernel_2_1(
+    double (*pt2function)(double, double),
+    uint8_t     datatype1,
+    uint8_t     datatype2,
+    const void *in1,
+    const void *in2,
+    void       *out,
+    long        nelement
+)
+{
+    KERNEL_2_1 kernel;
+    size_t     elemsize;
+    int        k;
+
+    if(datatype1 != datatype2)
+    {
+        return 0;
+    }
+    k = kernel_lookup_2_1(pt2function);
+    if(k == -1)
+    {
+        return 0;
+    }
+    switch(datatype1)
+    {
+    case _DATATYPE_FLOAT:
+        kernel = kerneltable_2_1[k].kernelFF;
+        elemsize = sizeof(float);
+        break;
+    case _DATATYPE_DOUBLE:
+        kernel = kerneltable_2_1[k].kernelDD;
+        elemsize = sizeof(double);
+        break;
+    default:
+        return 0;
+    }
+
+# ifdef _OPENMP
+    #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
+# endif
+    {
+        long i0, n;
+        kernel_threadrange(nelement, &i0, &n);
+        kernel((const char *) in1 + elemsize * i0, (const char *) in2 + elemsize * i0,
+               (char *) out + elemsize * i0, n);
+    }
+
+    return 1;
+}
+
+
+
+int imfunctions_kernel_1f_1(
+    double (*pt2function)(double, double),
+    uint8_t     datatype,
+    const void *in,
+    double      f1,
+    void       *out,
+    long        nelement
+)
+{
+    KERNEL_1f_1 kernel;
+    size_t      elemsize;
+    int         k = kernel_lookup_2_1(pt2function);
+
+    if(k == -1)
+    {
+        return 0;
+    }
+    switch(datatype)
+    {
+    case _DATATYPE_FLOAT:
+        kernel = kerneltable_2_1[k].kernelFf;
+        elemsize = sizeof(float);
+        break;
+    case _DATATYPE_DOUBLE:
+        kernel = kerneltable_2_1[k].kernelDf;
+        elemsize = sizeof(double);
+        break;
+    default:
+        return 0;
+    }
+
+# ifdef _OPENMP
+    #pragma omp parallel if (nelement>OMP_NELEMENT_LIMIT)
+# endif
+    {
+        long i0, n;
+        kernel_threadrange(nelement, &i0, &n);
+        kernel((const char *) in + elemsize * i0, f1, (char *) out + elemsize * i0, n);
+    }
+
+    return 1;
+}
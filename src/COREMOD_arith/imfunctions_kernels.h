@@ -0,0 +1,40 @@
+/**
+ * @file    imfunctions_kernels.h
+ * @brief   type-specialized elementwise kernels
+ *
+ * Each function returns 1 if the operation was performed by a specialized
+ * kernel, 0 if the caller must use the generic function pointer path.
+ */
+
+#ifndef COREMOD_ARITH_IMFUNCTIONS_KERNELS_H
+#define COREMOD_ARITH_IMFUNCTIONS_KERNELS_H
+
+
+int imfunctions_kernel_1_1(
+    double (*pt2function)(double),
+    uint8_t     datatype,
+    const void *in,
+    void       *out,
+    long        nelement
+);
+
+int imfunctions_kernel_2_1(
+    double (*pt2function)(double, double),
+    uint8_t     datatype1,
+    uint8_t     datatype2,
+    const void *in1,
+    const void *in2,
+    void       *out,
+    long        nelement
+);
+
+int imfunctions_kernel_1f_1(
+    double (*pt2function)(double, double),
+    uint8_t     datatype,
+    const void *in,
+    double      f1,
+    void       *out,
+    long        nelement
+);
+
+#endif
@@ -7,6 +7,7 @@
 #include "COREMOD_iofits/data_type_code.h"
 #include "COREMOD_iofits/breakcube.h"
 #include "COREMOD_iofits/file_exists.h"
+#include "COREMOD_iofits/fitsstream.h"
 #include "COREMOD_iofits/images2cube.h"
 #include "COREMOD_iofits/is_fits_file.h"
 #include "COREMOD_iofits/loadfits.h"
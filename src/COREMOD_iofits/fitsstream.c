@@ -0,0 +1,549 @@
+/**
+ * @file    fitsstream.c
+ * @brief   streaming FITS cube writer
+ *
+ * Writes a 3D FITS cube frame by frame, without an intermediate image
+ * and without going through cfitsio for the pixel data:
+ * - header (image keywords + optional imported header) written once
+ * - frames appended with pwrite(), byte-swapped through a bounce buffer
+ *   for multi-byte types
+ * - written data is flushed and dropped from page cache as the file
+ *   grows, so that long logs do not evict other data
+ * - NAXIS3 set on close to the number of frames written
+ *
+ * File is written as <fname>.tmp and renamed on close.
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <time.h>
+
+#include "CommandLineInterface/CLIcore.h"
+
+#include "COREMOD_iofits_common.h"
+#include "check_fitsio_status.h"
+#include "is_fits_file.h"
+#include "fitsstream.h"
+
+extern COREMOD_IOFITS_DATA COREMOD_iofits_data;
+
+
+// flush written data from page cache every this many bytes
+#define FITSSTREAM_SYNCSIZE (4 * FITSSTREAM_SWAPBUFFSIZE)
+
+
+
+
+static errno_t fitsstream_pwrite_all(
+    int         fd,
+    const char *buff,
+    long        nbyte,
+    off_t       offset
+)
+{
+    while(nbyte > 0)
+    {
+        ssize_t rs = pwrite(fd, buff, nbyte, offset);
+        if(rs < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return RETURN_FAILURE;
+        }
+        buff   += rs;
+        nbyte  -= rs;
+        offset += rs;
+    }
+    return RETURN_SUCCESS;
+}
+
+
+
+/** @brief Append 80-char card to header buffer
+ *
+ * Card is truncated or space-padded to 80 char.
+ * Returns offset of card in header.
+ */
+static long fitsstream_hdrcard(
+    char      **hdr,
+    long       *hdrsize,
+    long       *hdralloc,
+    const char *card
+)
+{
+    if(*hdrsize + 80 > *hdralloc)
+    {
+        *hdralloc += 4 * FITSSTREAM_BLOCKSIZE;
+        *hdr = (char *) realloc(*hdr, *hdralloc);
+        if(*hdr == NULL)
+        {
+            PRINT_ERROR("realloc error");
+            abort();
+        }
+    }
+
+    long cardoffset = *hdrsize;
+    long len = strlen(card);
+    if(len > 80)
+    {
+        len = 80;
+    }
+    memset(*hdr + cardoffset, ' ', 80);
+    memcpy(*hdr + cardoffset, card, len);
+    *hdrsize += 80;
+
+    return cardoffset;
+}
+
+
+
+/** @brief Convert pixels to FITS byte order
+ *
+ * signflip: flip sign bit, for unsigned types stored with BZERO
+ */
+static void fitsstream_convert(
+    char       *dst,
+    const char *src,
+    long        nelem,
+    int         bytepix,
+    int         signflip
+)
+{
+    switch(bytepix)
+    {
+        case 1:
+        {
+            const uint8_t *s = (const uint8_t *) src;
+            uint8_t       *d = (uint8_t *) dst;
+            for(long ii = 0; ii < nelem; ii++)
+            {
+                d[ii] = signflip ? (s[ii] ^ 0x80) : s[ii];
+            }
+        }
+        break;
+
+        case 2:
+        {
+            const uint16_t *s = (const uint16_t *) src;
+            uint16_t       *d = (uint16_t *) dst;
+            uint16_t        flip = signflip ? 0x8000 : 0;
+            for(long ii = 0; ii < nelem; ii++)
+            {
+                d[ii] = __builtin_bswap16(s[ii] ^ flip);
+            }
+        }
+        break;
+
+        case 4:
+        {
+            const uint32_t *s = (const uint32_t *) src;
+            uint32_t       *d = (uint32_t *) dst;
+            uint32_t        flip = signflip ? 0x80000000U : 0;
+            for(long ii = 0; ii < nelem; ii++)
+            {
+                d[ii] = __builtin_bswap32(s[ii] ^ flip);
+            }
+        }
+        break;
+
+        case 8:
+        {
+            const uint64_t *s = (const uint64_t *) src;
+            uint64_t       *d = (uint64_t *) dst;
+            uint64_t        flip = signflip ? 0x8000000000000000ULL : 0;
+            for(long ii = 0; ii < nelem; ii++)
+            {
+                d[ii] = __builtin_bswap64(s[ii] ^ flip);
+            }
+        }
+        break;
+    }
+}
+
+
+
+/** @brief Open FITS cube for streaming write
+ *
+ * Frame size and datatype are taken from image (size[0] x size[1]).
+ * Image keywords are written to header, together with the header of
+ * importheaderfile if it is a FITS file.
+ */
+errno_t fitsstream_open(
+    FITSSTREAM *fs,
+    const char *fname,
+    IMAGE      *image,
+    const char *importheaderfile
+)
+{
+    int         bitpix;
+    const char *bzero = NULL;
+    char        card[200];
+    char       *hdr = NULL;
+    long        hdrsize = 0;
+    long        hdralloc = 0;
+
+    memset(fs, 0, sizeof(FITSSTREAM));
+    fs->fd = -1;
+    fs->datatype = image->md[0].datatype;
+
+    switch(fs->datatype)
+    {
+        case _DATATYPE_UINT8:
+            bitpix = 8;
+            fs->bytepix = 1;
+            fs->swapmode = 0;
+            break;
+        case _DATATYPE_INT8:
+            bitpix = 8;
+            bzero = "-128";
+            fs->bytepix = 1;
+            fs->swapmode = 2;
+            break;
+
+        case _DATATYPE_UINT16:
+            bitpix = 16;
+            bzero = "32768";
+            fs->bytepix = 2;
+            fs->swapmode = 2;
+            break;
+        case _DATATYPE_INT16:
+            bitpix = 16;
+            fs->bytepix = 2;
+            fs->swapmode = 1;
+            break;
+
+        case _DATATYPE_UINT32:
+            bitpix = 32;
+            bzero = "2147483648";
+            fs->bytepix = 4;
+            fs->swapmode = 2;
+            break;
+        case _DATATYPE_INT32:
+            bitpix = 32;
+            fs->bytepix = 4;
+            fs->swapmode = 1;
+            break;
+
+        case _DATATYPE_UINT64:
+            bitpix = 64;
+            bzero = "9223372036854775808";
+            fs->bytepix = 8;
+            fs->swapmode = 2;
+            break;
+        case _DATATYPE_INT64:
+            bitpix = 64;
+            fs->bytepix = 8;
+            fs->swapmode = 1;
+            break;
+
+        case _DATATYPE_FLOAT:
+            bitpix = -32;
+            fs->bytepix = 4;
+            fs->swapmode = 1;
+            break;
+        case _DATATYPE_DOUBLE:
+            bitpix = -64;
+            fs->bytepix = 8;
+            fs->swapmode = 1;
+            break;
+
+        default:
+            PRINT_WARNING("datatype %d not supported by streaming FITS writer",
+                          (int) fs->datatype);
+            return RETURN_FAILURE;
+    }
+
+    fs->framesize = (long) fs->bytepix * image->md[0].size[0] * image->md[0].size[1];
+
+
+    // build header
+
+    fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc,
+                       "SIMPLE  =                    T / file does conform to FITS standard");
+    sprintf(card, "BITPIX  = %20d / number of bits per data pixel", bitpix);
+    fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc, card);
+    fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc,
+                       "NAXIS   =                    3 / number of data axes");
+    sprintf(card, "NAXIS1  = %20u / length of data axis 1", image->md[0].size[0]);
+    fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc, card);
+    sprintf(card, "NAXIS2  = %20u / length of data axis 2", image->md[0].size[1]);
+    fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc, card);
+    fs->naxis3offset = fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc,
+                                          "NAXIS3  =                    0 / length of data axis 3") + 10;
+    if(bzero != NULL)
+    {
+        sprintf(card, "BZERO   = %20s / offset data range to that of unsigned", bzero);
+        fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc, card);
+        fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc,
+                           "BSCALE  =                    1 / default scaling factor");
+    }
+    {
+        time_t    t = time(NULL);
+        struct tm tmdate;
+        gmtime_r(&t, &tmdate);
+        sprintf(card,
+                "DATE    = '%04d-%02d-%02dT%02d:%02d:%02d' / file creation date (YYYY-MM-DDThh:mm:ss UT)",
+                tmdate.tm_year + 1900, tmdate.tm_mon + 1, tmdate.tm_mday,
+                tmdate.tm_hour, tmdate.tm_min, tmdate.tm_sec);
+        fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc, card);
+    }
+
+
+    // image keywords
+    for(int kw = 0; kw < image->md[0].NBkw; kw++)
+    {
+        switch(image->kw[kw].type)
+        {
+            case 'L':
+                snprintf(card, 200, "%-8.8s= %20ld / %s", image->kw[kw].name,
+                         (long) image->kw[kw].value.numl, image->kw[kw].comment);
+                fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc, card);
+                break;
+
+            case 'D':
+                snprintf(card, 200, "%-8.8s= %#20.12G / %s", image->kw[kw].name,
+                         image->kw[kw].value.numf, image->kw[kw].comment);
+                fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc, card);
+                break;
+
+            case 'S':
+                snprintf(card, 200, "%-8.8s= '%-8s' / %s", image->kw[kw].name,
+                         image->kw[kw].value.valstr, image->kw[kw].comment);
+                fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc, card);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+
+    // imported header (optional)
+    if((importheaderfile != NULL) && (strlen(importheaderfile) > 0))
+    {
+        if(is_fits_file(importheaderfile) == 1)
+        {
+            fitsfile *fptr_header = NULL;
+            int       nkeys;
+            char     *header;
+
+            // local cfitsio status: save threads may run concurrently
+            int status = 0;
+            fits_open_file(&fptr_header, importheaderfile, READONLY, &status);
+            if(status != 0)
+            {
+                PRINT_WARNING("cannot open header file %s, cfitsio status %d",
+                              importheaderfile, status);
+            }
+            else
+            {
+                fits_hdr2str(fptr_header, 1, NULL, 0, &header, &nkeys, &status);
+                if(status != 0)
+                {
+                    PRINT_WARNING("cannot read header file %s, cfitsio status %d",
+                                  importheaderfile, status);
+                }
+                else
+                {
+                    // keywords to not overwrite
+                    char *keyexcl[] = {"BITPIX", "NAXIS", "SIMPLE", "EXTEND",
+                                       "BZERO", "BSCALE", "END     ", 0
+                                      };
+
+                    for(char *hptr = header; *hptr; hptr += 80)
+                    {
+                        int writecard = 1;
+                        for(int ki = 0; keyexcl[ki]; ki++)
+                        {
+                            if(strncmp(keyexcl[ki], hptr, strlen(keyexcl[ki])) == 0)
+                            {
+                                writecard = 0;
+                                break;
+                            }
+                        }
+                        if(writecard == 1)
+                        {
+                            snprintf(card, 81, "%.80s", hptr);
+                            fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc, card);
+                        }
+                    }
+
+                    status = 0;
+                    fits_free_memory(header, &status);
+                }
+
+                status = 0;
+                fits_close_file(fptr_header, &status);
+            }
+        }
+    }
+
+    fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc, "END");
+
+    // pad header to block size
+    while(hdrsize % FITSSTREAM_BLOCKSIZE != 0)
+    {
+        fitsstream_hdrcard(&hdr, &hdrsize, &hdralloc, "");
+    }
+    fs->hdrsize = hdrsize;
+
+
+    // open file and write header
+    strncpy(fs->fname, fname, STRINGMAXLEN_FULLFILENAME - 1);
+    WRITE_FULLFILENAME(fs->fnametmp, "%s.tmp", fname);
+
+    fs->fd = open(fs->fnametmp, O_WRONLY | O_CREAT | O_TRUNC, (mode_t) 0644);
+    if(fs->fd == -1)
+    {
+        PRINT_ERROR("cannot create file %s", fs->fnametmp);
+        free(hdr);
+        return RETURN_FAILURE;
+    }
+
+    if(fitsstream_pwrite_all(fs->fd, hdr, hdrsize, 0) != RETURN_SUCCESS)
+    {
+        PRINT_ERROR("header write error on file %s", fs->fnametmp);
+        free(hdr);
+        close(fs->fd);
+        fs->fd = -1;
+        return RETURN_FAILURE;
+    }
+    free(hdr);
+
+    fs->offset     = hdrsize;
+    fs->offsetsync = hdrsize;
+    fs->NBframe    = 0;
+
+    if(fs->swapmode != 0)
+    {
+        fs->swapbuff = (char *) malloc(FITSSTREAM_SWAPBUFFSIZE);
+        if(fs->swapbuff == NULL)
+        {
+            PRINT_ERROR("malloc error");
+            abort();
+        }
+    }
+
+    return RETURN_SUCCESS;
+}
+
+
+
+/** @brief Append frames to FITS cube
+ *
+ * frames points to NBframe contiguous frames, for example a range of a
+ * circular log buffer.
+ */
+errno_t fitsstream_write(
+    FITSSTREAM *fs,
+    const char *frames,
+    long        NBframe
+)
+{
+    long nbyte = fs->framesize * NBframe;
+
+    if(fs->swapmode == 0)
+    {
+        if(fitsstream_pwrite_all(fs->fd, frames, nbyte, fs->offset) != RETURN_SUCCESS)
+        {
+            PRINT_ERROR("write error on file %s", fs->fnametmp);
+            return RETURN_FAILURE;
+        }
+    }
+    else
+    {
+        for(long b = 0; b < nbyte; b += FITSSTREAM_SWAPBUFFSIZE)
+        {
+            long n = nbyte - b;
+            if(n > FITSSTREAM_SWAPBUFFSIZE)
+            {
+                n = FITSSTREAM_SWAPBUFFSIZE;
+            }
+            fitsstream_convert(fs->swapbuff, frames + b, n / fs->bytepix, fs->bytepix,
+                               (fs->swapmode == 2));
+            if(fitsstream_pwrite_all(fs->fd, fs->swapbuff, n, fs->offset + b) != RETURN_SUCCESS)
+            {
+                PRINT_ERROR("write error on file %s", fs->fnametmp);
+                return RETURN_FAILURE;
+            }
+        }
+    }
+
+    fs->offset  += nbyte;
+    fs->NBframe += NBframe;
+
+    if(fs->offset - fs->offsetsync >= FITSSTREAM_SYNCSIZE)
+    {
+        // wait for writeback, then drop pages from cache
+        sync_file_range(fs->fd, fs->offsetsync, fs->offset - fs->offsetsync,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        posix_fadvise(fs->fd, fs->offsetsync, fs->offset - fs->offsetsync,
+                      POSIX_FADV_DONTNEED);
+        fs->offsetsync = fs->offset;
+    }
+
+    return RETURN_SUCCESS;
+}
+
+
+
+/** @brief Pad data, set NAXIS3 and rename file to final name
+ */
+errno_t fitsstream_close(
+    FITSSTREAM *fs
+)
+{
+    errno_t ret = RETURN_SUCCESS;
+
+    if(fs->fd == -1)
+    {
+        return RETURN_FAILURE;
+    }
+
+    long datasize = fs->offset - fs->hdrsize;
+    long padsize = (FITSSTREAM_BLOCKSIZE - datasize % FITSSTREAM_BLOCKSIZE) %
+                   FITSSTREAM_BLOCKSIZE;
+    if(padsize > 0)
+    {
+        char zeros[FITSSTREAM_BLOCKSIZE];
+        memset(zeros, 0, FITSSTREAM_BLOCKSIZE);
+        if(fitsstream_pwrite_all(fs->fd, zeros, padsize, fs->offset) != RETURN_SUCCESS)
+        {
+            ret = RETURN_FAILURE;
+        }
+    }
+
+    char naxis3str[21];
+    snprintf(naxis3str, 21, "%20ld", fs->NBframe);
+    if(fitsstream_pwrite_all(fs->fd, naxis3str, 20, fs->naxis3offset) != RETURN_SUCCESS)
+    {
+        ret = RETURN_FAILURE;
+    }
+
+    if(close(fs->fd) != 0)
+    {
+        ret = RETURN_FAILURE;
+    }
+    fs->fd = -1;
+
+    free(fs->swapbuff);
+    fs->swapbuff = NULL;
+
+    if(ret == RETURN_SUCCESS)
+    {
+        if(rename(fs->fnametmp, fs->fname) != 0)
+        {
+            PRINT_ERROR("cannot rename %s to %s", fs->fnametmp, fs->fname);
+            ret = RETURN_FAILURE;
+        }
+    }
+    else
+    {
+        PRINT_ERROR("write error on file %s", fs->fnametmp);
+    }
+
+    return ret;
+}
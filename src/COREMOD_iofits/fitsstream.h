@@ -0,0 +1,60 @@
+/**
+ * @file    fitsstream.h
+ * @brief   streaming FITS cube writer
+ */
+
+#ifndef MILK_COREMOD_IOFITS_FITSSTREAM_H
+#define MILK_COREMOD_IOFITS_FITSSTREAM_H
+
+
+#define FITSSTREAM_BLOCKSIZE 2880
+
+// bounce buffer for byte-swapped data [byte]
+#define FITSSTREAM_SWAPBUFFSIZE (4 * 1024 * 1024)
+
+
+/** @brief Streaming FITS cube writer state
+ *
+ * Header is written once on open, frames are appended as they come,
+ * NAXIS3 is finalized on close.
+ */
+typedef struct
+{
+    int      fd;
+    char     fname[STRINGMAXLEN_FULLFILENAME];     // final file name
+    char     fnametmp[STRINGMAXLEN_FULLFILENAME];  // renamed to fname on close
+
+    uint8_t  datatype;
+    int      bytepix;
+    int      swapmode;     // 0: write as is, 1: byte swap, 2: byte swap + sign flip
+    long     framesize;    // [byte]
+
+    long     hdrsize;      // [byte], multiple of FITSSTREAM_BLOCKSIZE
+    off_t    naxis3offset; // file offset of NAXIS3 value field
+    off_t    offset;       // current data write offset
+    off_t    offsetsync;   // data before this offset was flushed from page cache
+    long     NBframe;      // frames written
+
+    char    *swapbuff;
+} FITSSTREAM;
+
+
+
+errno_t fitsstream_open(
+    FITSSTREAM *fs,
+    const char *fname,
+    IMAGE      *image,
+    const char *importheaderfile
+);
+
+errno_t fitsstream_write(
+    FITSSTREAM *fs,
+    const char *frames,
+    long        NBframe
+);
+
+errno_t fitsstream_close(
+    FITSSTREAM *fs
+);
+
+#endif
@@ -67,6 +67,7 @@
 #include "list_image.h"
 #include "list_variable.h"
 #include "logshmim.h"
+#include "logshmim_timing.h"
 
 #include "read_shmim.h"
 #include "read_shmim_size.h"
@@ -74,6 +75,7 @@
 
 #include "shmimlog.h"
 #include "shmimlogcmd.h"
+#include "shmimlogd.h"
 
 #include "saveall.h"
 #include "shmim_purge.h"
@@ -82,12 +84,15 @@
 #include "stream_delay.h"
 #include "stream_diff.h"
 #include "stream_halfimdiff.h"
+#include "stream_latencytrace.h"
 #include "stream_monitorlimits.h"
 #include "stream_paste.h"
 #include "stream_pixmapdecode.h"
 #include "stream_poke.h"
+#include "stream_rollstats.h"
 #include "stream_sem.h"
 #include "stream_TCP.h"
+#include "stream_TCPserve.h"
 #include "stream_updateloop.h"
 
 
@@ -124,6 +129,7 @@ static errno_t init_module_CLI()
 
     clearall_addCLIcmd();
     list_image_addCLIcmd();
+    image_ID_addCLIcmd();
 
     //KEYWORDS
     image_keyword_addCLIcmd();
@@ -179,6 +185,7 @@ static errno_t init_module_CLI()
     stream_delay_addCLIcmd();
     saveall_addCLIcmd();
     stream__TCP_addCLIcmd();
+    stream_TCPserve_addCLIcmd();
     stream_pixmapdecode_addCLIcmd();
 
     CLIADDCMD_COREMOD_memory__stream_poke();
@@ -187,13 +194,17 @@ static errno_t init_module_CLI()
     stream_paste_addCLIcmd();
     stream_halfimdiff_addCLIcmd();
     stream_ave_addCLIcmd();
+    CLIADDCMD_COREMOD_memory__stream_rollstats();
+    CLIADDCMD_COREMOD_memory__stream_latencytrace();
     stream_monitorlimits_addCLIcmd();
 
     // DATA LOGGING
     logshmim_addCLIcmd();
+    logshmim_timing_addCLIcmd();
 
     CLIADDCMD_COREMOD_memory__shmimlog();
     CLIADDCMD_COREMOD_memory__shmimlogcmd();
+    CLIADDCMD_COREMOD_memory__shmimlogd();
 
 
     // add atexit functions here
@@ -60,17 +60,21 @@
 #include "COREMOD_memory/list_image.h"
 #include "COREMOD_memory/list_variable.h"
 #include "COREMOD_memory/logshmim.h"
+#include "COREMOD_memory/logshmim_timing.h"
 #include "COREMOD_memory/read_shmim.h"
 #include "COREMOD_memory/saveall.h"
 #include "COREMOD_memory/stream_ave.h"
 #include "COREMOD_memory/stream_delay.h"
 #include "COREMOD_memory/stream_diff.h"
 #include "COREMOD_memory/stream_halfimdiff.h"
+#include "COREMOD_memory/stream_latencytrace.h"
 #include "COREMOD_memory/stream_paste.h"
 #include "COREMOD_memory/stream_pixmapdecode.h"
 #include "COREMOD_memory/stream_poke.h"
+#include "COREMOD_memory/stream_rollstats.h"
 #include "COREMOD_memory/stream_sem.h"
 #include "COREMOD_memory/stream_TCP.h"
+#include "COREMOD_memory/stream_TCPserve.h"
 #include "COREMOD_memory/stream_updateloop.h"
 #include "COREMOD_memory/variable_ID.h"
 
@@ -84,6 +84,10 @@ errno_t clearall()
         {
             data.fpsarray[fpsindex].md = NULL;
         }
+        data.fpsarray[fpsindex].pdescr = NULL;
+        data.fpsarray[fpsindex].phash = NULL;
+        data.fpsarray[fpsindex].notify = NULL;
+        data.fpsarray[fpsindex].notifydefer = 0;
     }
 
 
@@ -375,6 +375,7 @@ errno_t create_image_ID(
             NBkw,
             CBsize
         );
+        image_ID_register(ID);
     }
     else
     {
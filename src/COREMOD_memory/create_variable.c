@@ -53,6 +53,7 @@ variableID create_variable_ID(
         data.variable[ID].used = 1;
         data.variable[ID].type = 0; /** floating point double */
         strcpy(data.variable[ID].name, name);
+        variable_ID_register(ID);
         data.variable[ID].value.f = value;
 
     }
@@ -95,6 +96,7 @@ variableID create_variable_long_ID(
         data.variable[ID].used = 1;
         data.variable[ID].type = 1; /** long */
         strcpy(data.variable[ID].name, name);
+        variable_ID_register(ID);
         data.variable[ID].value.l = value;
 
     }
@@ -137,6 +139,7 @@ variableID create_variable_string_ID(
         data.variable[ID].used = 1;
         data.variable[ID].type = 2; /** string */
         strcpy(data.variable[ID].name, name);
+        variable_ID_register(ID);
         strcpy(data.variable[ID].value.s, value);
     }
 
@@ -170,6 +170,7 @@ errno_t delete_image_ID(
     }
     else
     {
+        image_ID_unregister(ID);
         data.image[ID].used = 0;
 
         if(data.image[ID].md[0].shared == 1)
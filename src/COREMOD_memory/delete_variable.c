@@ -15,6 +15,7 @@ errno_t delete_variable_ID(
     ID = variable_ID(varname);
     if(ID != -1)
     {
+        variable_ID_unregister(ID);
         data.variable[ID].used = 0;
         /*      free(data.variable[ID].name);*/
     }
@@ -10,6 +10,7 @@
 
 
 #include "CommandLineInterface/CLIcore.h"
+#include "CommandLineInterface/fps_GetParamIndex.h"
 
 
 
@@ -83,6 +84,7 @@ errno_t function_parameter_struct_create(
     int index;
     char *mapv;
     FUNCTION_PARAMETER_STRUCT fps;
+    FUNCTION_PARAMETER_STRUCT_LAYOUT layout;
 
     //  FUNCTION_PARAMETER_STRUCT_MD *funcparammd;
     //  FUNCTION_PARAMETER *funcparamarray;
@@ -103,8 +105,31 @@ errno_t function_parameter_struct_create(
     printf("Creating file %s, holding NBparamMAX = %d\n", SM_fname, NBparamMAX);
     fflush(stdout);
 
-    sharedsize = sizeof(FUNCTION_PARAMETER_STRUCT_MD);
-    sharedsize += sizeof(FUNCTION_PARAMETER) * NBparamMAX;
+    // layout version 4 : header, metadata, runtime array, name array, hash table,
+    // change notification
+    // each block starts on FUNCTION_PARAMETER_STRUCT_LAYOUT_ALIGN boundary
+    memset(&layout, 0, sizeof(FUNCTION_PARAMETER_STRUCT_LAYOUT));
+    memcpy(layout.magic, FUNCTION_PARAMETER_STRUCT_LAYOUT_MAGIC, 8);
+    layout.version = FUNCTION_PARAMETER_STRUCT_LAYOUT_VERSION;
+    layout.headersize = sizeof(FUNCTION_PARAMETER_STRUCT_LAYOUT);
+    layout.mdsize = sizeof(FUNCTION_PARAMETER_STRUCT_MD);
+    layout.paramsize = sizeof(FUNCTION_PARAMETER);
+    layout.descrsize = sizeof(FUNCTION_PARAMETER_DESCR);
+    layout.NBparamMAX = NBparamMAX;
+    layout.NBhash = functionparameter_hash_size(NBparamMAX);
+    layout.notifysize = functionparameter_notify_size(NBparamMAX);
+
+#define FPS_LAYOUT_ALIGNUP(x) ((((x) + FUNCTION_PARAMETER_STRUCT_LAYOUT_ALIGN - 1) \
+                                / FUNCTION_PARAMETER_STRUCT_LAYOUT_ALIGN) * FUNCTION_PARAMETER_STRUCT_LAYOUT_ALIGN)
+    layout.mdoffset = FPS_LAYOUT_ALIGNUP(layout.headersize);
+    layout.paramoffset = FPS_LAYOUT_ALIGNUP(layout.mdoffset + layout.mdsize);
+    layout.descroffset = FPS_LAYOUT_ALIGNUP(layout.paramoffset + layout.paramsize * NBparamMAX);
+    layout.hashoffset = FPS_LAYOUT_ALIGNUP(layout.descroffset + layout.descrsize * NBparamMAX);
+    layout.notifyoffset = FPS_LAYOUT_ALIGNUP(layout.hashoffset + sizeof(int32_t) * layout.NBhash);
+    layout.filesize = layout.notifyoffset + layout.notifysize;
+#undef FPS_LAYOUT_ALIGNUP
+
+    sharedsize = layout.filesize;
 
     SM_fd = open(SM_fname, O_RDWR | O_CREAT | O_TRUNC, (mode_t)0600);
     if(SM_fd == -1)
@@ -139,9 +164,9 @@ errno_t function_parameter_struct_create(
         exit(0);
     }
 
-    fps.md = (FUNCTION_PARAMETER_STRUCT_MD *) mmap(0, sharedsize,
-             PROT_READ | PROT_WRITE, MAP_SHARED, SM_fd, 0);
-    if(fps.md == MAP_FAILED)
+    mapv = (char *) mmap(0, sharedsize, PROT_READ | PROT_WRITE, MAP_SHARED, SM_fd,
+                         0);
+    if(mapv == MAP_FAILED)
     {
         close(SM_fd);
         perror("Error mmapping the file");
@@ -151,9 +176,16 @@ errno_t function_parameter_struct_create(
     }
     //funcparamstruct->md = funcparammd;
 
-    mapv = (char *) fps.md;
-    mapv += sizeof(FUNCTION_PARAMETER_STRUCT_MD);
-    fps.parray = (FUNCTION_PARAMETER *) mapv;
+    memcpy(mapv, &layout, sizeof(FUNCTION_PARAMETER_STRUCT_LAYOUT));
+    fps.md = (FUNCTION_PARAMETER_STRUCT_MD *)(mapv + layout.mdoffset);
+    fps.parray = (FUNCTION_PARAMETER *)(mapv + layout.paramoffset);
+    fps.pdescr = (FUNCTION_PARAMETER_DESCR *)(mapv + layout.descroffset);
+    fps.phash = (int32_t *)(mapv + layout.hashoffset);
+    fps.NBhash = layout.NBhash;
+    functionparameter_hash_init(fps.phash, fps.NBhash);
+    fps.notify = (FUNCTION_PARAMETER_STRUCT_NOTIFY *)(mapv + layout.notifyoffset);
+    functionparameter_notify_init(fps.notify, NBparamMAX);
+    fps.notifydefer = 0;
 
 
 
@@ -217,7 +249,7 @@ errno_t function_parameter_struct_create(
     fps.md->confwaitus = (uint64_t) 1000; // 1 kHz default
     fps.md->msgcnt = 0;
 
-    munmap(fps.md, sharedsize);
+    munmap(mapv, sharedsize);
 
 
     return EXIT_SUCCESS;
@@ -1,10 +1,133 @@
 /**
  * @file    image_ID.c
  * @brief   find image ID(s) from name
+ *
+ * Names are looked up in a hash index (nameindex.c), kept up to date by
+ * image_ID_register() and image_ID_unregister() where images are created,
+ * renamed and deleted.
  */
 
 
 #include "CommandLineInterface/CLIcore.h"
+#include "nameindex.h"
+
+
+
+
+// ==========================================
+// Forward declaration(s)
+// ==========================================
+
+errno_t image_ID_set_accesstime(
+    int mode
+);
+
+
+
+// ==========================================
+// Command line interface wrapper function(s)
+// ==========================================
+
+static errno_t image_ID_set_accesstime__cli()
+{
+    if(0
+            + CLI_checkarg(1, CLIARG_LONG)
+            == 0)
+    {
+        image_ID_set_accesstime(data.cmdargtoken[1].val.numl);
+        return CLICMD_SUCCESS;
+    }
+    else
+    {
+        return CLICMD_INVALID_ARG;
+    }
+}
+
+
+
+// ==========================================
+// Register CLI command(s)
+// ==========================================
+
+errno_t image_ID_addCLIcmd()
+{
+    RegisterCLIcommand(
+        "imaccesstime",
+        __FILE__,
+        image_ID_set_accesstime__cli,
+        "update image last access time on name lookup (1) or not (0)",
+        "<mode>",
+        "imaccesstime 0",
+        "errno_t image_ID_set_accesstime(int mode)");
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+static const char *image_ID_getname(
+    long ID
+)
+{
+    return (data.image[ID].used == 1) ? data.image[ID].name : NULL;
+}
+
+
+static NAMEINDEX *image_ID_nameindex()
+{
+    // (re)build if image array was resized
+    if(data.image_nameindex.NBID != data.NB_MAX_IMAGE)
+    {
+        nameindex_rebuild(&data.image_nameindex, data.NB_MAX_IMAGE, image_ID_getname);
+    }
+    return &data.image_nameindex;
+}
+
+
+
+
+/** @brief Add image to name index
+ *
+ * To be called once image is in use (used = 1) and named.
+ * Increments createcnt, invalidating IMGID handles to previous content.
+ */
+void image_ID_register(
+    imageID ID
+)
+{
+    data.image[ID].createcnt++;
+    nameindex_insert(image_ID_nameindex(), ID, image_ID_getname);
+}
+
+
+
+/** @brief Remove image from name index
+ *
+ * To be called before image is released or renamed.
+ */
+void image_ID_unregister(
+    imageID ID
+)
+{
+    nameindex_remove(image_ID_nameindex(), ID, image_ID_getname);
+    data.image[ID].createcnt++;
+}
+
+
+
+
+/** @brief Enable/disable lastaccesstime update in image_ID()
+ */
+errno_t image_ID_set_accesstime(
+    int mode
+)
+{
+    data.image_accesstime = (mode == 0) ? 0 : 1;
+
+    return RETURN_SUCCESS;
+}
+
 
 
 
@@ -15,31 +138,11 @@ imageID image_ID(
 {
     DEBUG_TRACE_FSTART();
 
-    imageID    i;
-    int        loopOK;
-    imageID    tmpID = 0;
+    imageID tmpID = nameindex_find(image_ID_nameindex(), name, image_ID_getname);
 
-    i = 0;
-    loopOK = 1;
-    while(loopOK == 1)
+    if((tmpID != -1) && (data.image_accesstime == 1))
     {
-        if(data.image[i].used == 1)
-        {
-            if((strncmp(name, data.image[i].name, strlen(name)) == 0)
-                    && (data.image[i].name[strlen(name)] == '\0'))
-            {
-                loopOK = 0;
-                tmpID = i;
-                clock_gettime(CLOCK_REALTIME, &data.image[i].md[0].lastaccesstime);
-            }
-        }
-        i++;
-
-        if(i == data.NB_MAX_IMAGE)
-        {
-            loopOK = 0;
-            tmpID = -1;
-        }
+        clock_gettime(CLOCK_REALTIME, &data.image[tmpID].md[0].lastaccesstime);
     }
 
     DEBUG_TRACEPOINT("FOUT %s -> %ld", name, tmpID);
@@ -55,31 +158,7 @@ imageID image_ID_noaccessupdate(
 {
     DEBUG_TRACE_FSTART();
 
-    imageID   i;
-    imageID   tmpID = 0;
-    int       loopOK;
-
-    i = 0;
-    loopOK = 1;
-    while(loopOK == 1)
-    {
-        if(data.image[i].used == 1)
-        {
-            if((strncmp(name, data.image[i].name, strlen(name)) == 0)
-                    && (data.image[i].name[strlen(name)] == '\0'))
-            {
-                loopOK = 0;
-                tmpID = i;
-            }
-        }
-        i++;
-
-        if(i == data.NB_MAX_IMAGE)
-        {
-            loopOK = 0;
-            tmpID = -1;
-        }
-    }
+    imageID tmpID = nameindex_find(image_ID_nameindex(), name, image_ID_getname);
 
     DEBUG_TRACE_FEXIT();
     return tmpID;
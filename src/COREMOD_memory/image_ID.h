@@ -2,6 +2,20 @@
  * @file    image_ID.h
  */
 
+errno_t image_ID_addCLIcmd();
+
+void       image_ID_register(
+    imageID ID
+);
+
+void       image_ID_unregister(
+    imageID ID
+);
+
+errno_t    image_ID_set_accesstime(
+    int mode
+);
+
 imageID    image_ID(
     const char *name
 );
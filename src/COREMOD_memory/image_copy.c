@@ -355,7 +355,9 @@ imageID chname_image_ID(
     if((image_ID(new_name) == -1) && (variable_ID(new_name) == -1))
     {
         ID = image_ID(ID_name);
+        image_ID_unregister(ID);
         strcpy(data.image[ID].name, new_name);
+        image_ID_register(ID);
         //      if ( Debug > 0 ) { printf("change image name %s -> %s\n",ID_name,new_name);}
     }
     else
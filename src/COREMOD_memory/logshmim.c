@@ -29,6 +29,7 @@
 #include "stream_sem.h"
 
 #include "shmimlog_types.h"
+#include "logshmim_timing.h"
 
 
 
@@ -74,7 +75,8 @@ errno_t COREMOD_MEMORY_sharedMem_2Dim_log(
     const char  *IDname,
     uint32_t     zsize,
     const char  *logdir,
-    const char  *IDlogdata_name
+    const char  *IDlogdata_name,
+    int          timingfmt
 );
 
 
@@ -151,6 +153,11 @@ static errno_t COREMOD_MEMORY_sharedMem_2Dim_log__cli()
         sprintf(data.cmdargtoken[4].val.string, "null");
     }
 
+    if(CLI_checkarg_noerrmsg(5, CLIARG_LONG) != 0)
+    {
+        data.cmdargtoken[5].val.numl = LOGSHMIM_TIMING_ASCII;
+    }
+
     if(0
             + CLI_checkarg(1, 3)
             + CLI_checkarg(2, CLIARG_LONG)
@@ -161,7 +168,8 @@ static errno_t COREMOD_MEMORY_sharedMem_2Dim_log__cli()
             data.cmdargtoken[1].val.string,
             data.cmdargtoken[2].val.numl,
             data.cmdargtoken[3].val.string,
-            data.cmdargtoken[4].val.string
+            data.cmdargtoken[4].val.string,
+            data.cmdargtoken[5].val.numl
         );
         return CLICMD_SUCCESS;
     }
@@ -188,9 +196,9 @@ errno_t logshmim_addCLIcmd()
         __FILE__,
         COREMOD_MEMORY_sharedMem_2Dim_log__cli,
         "logs shared memory stream (run in current directory)",
-        "<shm image> <cubesize [long]> <logdir>",
+        "<shm image> <cubesize [long]> <logdir> <logdata> <timingfmt: 0 none, 1 ASCII (default), 2 binary>",
         "shmimstreamlog wfscamim 10000 /media/data \"\"",
-        "long COREMOD_MEMORY_sharedMem_2Dim_log(const char *IDname, uint32_t zsize, const char *logdir, const char *IDlogdata_name");
+        "long COREMOD_MEMORY_sharedMem_2Dim_log(const char *IDname, uint32_t zsize, const char *logdir, const char *IDlogdata_name, int timingfmt");
 
     RegisterCLIcommand(
         "shmimslogstat",
@@ -254,18 +262,6 @@ void *save_fits_function(
     //struct savethreadmsg *tmsg; // = malloc(sizeof(struct savethreadmsg));
     STREAMSAVE_THREAD_MESSAGE *tmsg;
 
-    uint32_t     *imsizearray;
-    uint32_t      xsize, ysize;
-    uint8_t       datatype;
-
-
-    imageID       IDc;
-    long          framesize;  // in bytes
-    char         *ptr0;       // source pointer
-    char         *ptr1;       // destination pointer
-    long          k;
-    FILE         *fp;
-
 
     int RT_priority = 20;
     struct sched_param schedpar;
@@ -287,164 +283,42 @@ void *save_fits_function(
 
 
 
-    imsizearray = (uint32_t *) malloc(sizeof(uint32_t) * 3);
-    if(imsizearray == NULL)
-    {
-        PRINT_ERROR("malloc error");
-        abort();
-    }
-
     //    tmsg = (struct savethreadmsg*) ptr;
     tmsg = (STREAMSAVE_THREAD_MESSAGE *) ptr;
 
     // printf("THREAD : SAVING  %s -> %s \n", tmsg->iname, tmsg->fname);
     //fflush(stdout);
-    if(tmsg->partial == 0) // full image
-    {
-//        save_fits(tmsg->iname, tmsg->fname);
-        printf("auxFITSheader = \"%s\"\n", tmsg->fname_auxFITSheader);
-        saveFITS(tmsg->iname, tmsg->fname, 0, tmsg->fname_auxFITSheader);
-    }
-    else
-    {
-        //      printf("Saving partial image (name = %s   zsize = %ld)\n", tmsg->iname, tmsg->cubesize);
-
-        //	list_image_ID();
-
-        ID = image_ID(tmsg->iname);
-        datatype = data.image[ID].md[0].datatype;
-        xsize = data.image[ID].md[0].size[0];
-        ysize = data.image[ID].md[0].size[1];
-
-        //printf("step00\n");
-        //fflush(stdout);
 
-        imsizearray[0] = xsize;
-        imsizearray[1] = ysize;
-        imsizearray[2] = tmsg->cubesize;
+    FITSSTREAM fs;
 
-
-
-         create_image_ID("tmpsavecube", 3, imsizearray, datatype, 0, 1, 0, &IDc);
-
-        // list_image_ID();
-
-        switch(datatype)
+    ID = image_ID(tmsg->iname);
+    if(fitsstream_open(&fs, tmsg->fname, &data.image[ID],
+                       tmsg->fname_auxFITSheader) == RETURN_SUCCESS)
+    {
+        // streaming writer: frames written directly from log buffer
+        errno_t wret = fitsstream_write(&fs, (char *) data.image[ID].array.raw,
+                                        tmsg->cubesize);
+        if((fitsstream_close(&fs) != RETURN_SUCCESS) || (wret != RETURN_SUCCESS))
         {
-
-        case _DATATYPE_UINT8:
-            framesize = SIZEOF_DATATYPE_UINT8 * xsize * ysize;
-            ptr0 = (char *) data.image[ID].array.UI8; // source
-            ptr1 = (char *) data.image[IDc].array.UI8; // destination
-            break;
-        case _DATATYPE_INT8:
-            framesize = SIZEOF_DATATYPE_INT8 * xsize * ysize;
-            ptr0 = (char *) data.image[ID].array.SI8; // source
-            ptr1 = (char *) data.image[IDc].array.SI8; // destination
-            break;
-
-        case _DATATYPE_UINT16:
-            framesize = SIZEOF_DATATYPE_UINT16 * xsize * ysize;
-            ptr0 = (char *) data.image[ID].array.UI16; // source
-            ptr1 = (char *) data.image[IDc].array.UI16; // destination
-            break;
-        case _DATATYPE_INT16:
-            framesize = SIZEOF_DATATYPE_INT16 * xsize * ysize;
-            ptr0 = (char *) data.image[ID].array.SI16; // source
-            ptr1 = (char *) data.image[IDc].array.SI16; // destination
-            break;
-
-        case _DATATYPE_UINT32:
-            framesize = SIZEOF_DATATYPE_UINT32 * xsize * ysize;
-            ptr0 = (char *) data.image[ID].array.UI32; // source
-            ptr1 = (char *) data.image[IDc].array.UI32; // destination
-            break;
-        case _DATATYPE_INT32:
-            framesize = SIZEOF_DATATYPE_INT32 * xsize * ysize;
-            ptr0 = (char *) data.image[ID].array.SI32; // source
-            ptr1 = (char *) data.image[IDc].array.SI32; // destination
-            break;
-
-        case _DATATYPE_UINT64:
-            framesize = SIZEOF_DATATYPE_UINT64 * xsize * ysize;
-            ptr0 = (char *) data.image[ID].array.UI64; // source
-            ptr1 = (char *) data.image[IDc].array.UI64; // destination
-            break;
-        case _DATATYPE_INT64:
-            framesize = SIZEOF_DATATYPE_INT64 * xsize * ysize;
-            ptr0 = (char *) data.image[ID].array.SI64; // source
-            ptr1 = (char *) data.image[IDc].array.SI64; // destination
-            break;
-
-        case _DATATYPE_FLOAT:
-            framesize = SIZEOF_DATATYPE_FLOAT * xsize * ysize;
-            ptr0 = (char *) data.image[ID].array.F; // source
-            ptr1 = (char *) data.image[IDc].array.F; // destination
-            break;
-        case _DATATYPE_DOUBLE:
-            framesize = SIZEOF_DATATYPE_DOUBLE * xsize * ysize;
-            ptr0 = (char *) data.image[ID].array.D; // source
-            ptr1 = (char *) data.image[IDc].array.D; // destination
-            break;
-
-        default:
-            printf("ERROR: WRONG DATA TYPE\n");
-            free(imsizearray);
-            free(tmsg);
-            exit(0);
-            break;
+            PRINT_ERROR("streaming write failed for %s", tmsg->fname);
         }
-
-
-        memcpy((void *) ptr1, (void *) ptr0, framesize * tmsg->cubesize);
-
-        //save_fits("tmpsavecube", tmsg->fname);
-        printf("auxFITSheader = \"%s\"\n", tmsg->fname_auxFITSheader);
-        saveFITS("tmpsavecube", tmsg->fname, 0, tmsg->fname_auxFITSheader);
-
-
-        delete_image_ID("tmpsavecube", DELETE_IMAGE_ERRMODE_WARNING);
     }
-
-    if(tmsg->saveascii == 1)
+    else
     {
-        if((fp = fopen(tmsg->fnameascii, "w")) == NULL)
-        {
-            printf("ERROR: cannot create file \"%s\"\n", tmsg->fnameascii);
-            exit(0);
-        }
+        // fitsstream_open() handles every datatype the logger allocates,
+        // so a failure here is an I/O error: report it, keep timing output
+        PRINT_ERROR("cannot open %s for streaming write", tmsg->fname);
+    }
 
-        fprintf(fp, "# Telemetry stream timing data \n");
-        fprintf(fp, "# File written by function %s in file %s\n", __FUNCTION__,
-                __FILE__);
-        fprintf(fp, "# \n");
-        fprintf(fp, "# col1 : datacube frame index\n");
-        fprintf(fp, "# col2 : Main index\n");
-        fprintf(fp, "# col3 : Time since cube origin\n");
-        fprintf(fp, "# col4 : Absolute time\n");
-        fprintf(fp, "# col5 : stream cnt0 index\n");
-        fprintf(fp, "# col6 : stream cnt1 index\n");
-        fprintf(fp, "# \n");
-
-        double t0; // time reference
-        t0 = tmsg->arraytime[0];
-        for(k = 0; k < tmsg->cubesize; k++)
-        {
-            //fprintf(fp, "%6ld   %10lu  %10lu   %15.9lf\n", k, tmsg->arraycnt0[k], tmsg->arraycnt1[k], tmsg->arraytime[k]);
-
-            // entries are:
-            // - index within cube
-            // - loop index (if applicable)
-            // - time since cube start
-            // - time (absolute)
-            // - cnt0
-            // - cnt1
-
-            fprintf(fp, "%10ld  %10lu  %15.9lf   %20.9lf  %10ld   %10ld\n", k,
-                    tmsg->arrayindex[k], tmsg->arraytime[k] - t0, tmsg->arraytime[k],
-                    tmsg->arraycnt0[k], tmsg->arraycnt1[k]);
-        }
-        fclose(fp);
+    if(tmsg->saveascii == LOGSHMIM_TIMING_ASCII)
+    {
+        logshmim_timing_write_ascii(tmsg->fnameascii, tmsg->cubesize,
+                                    tmsg->arrayindex, tmsg->arraytime, tmsg->arraycnt0, tmsg->arraycnt1);
+    }
+    if(tmsg->saveascii == LOGSHMIM_TIMING_BINARY)
+    {
+        logshmim_timing_write_binary(tmsg->fnameascii, tmsg->cubesize,
+                                     tmsg->arrayindex, tmsg->arraytime, tmsg->arraycnt0, tmsg->arraycnt1);
     }
 
     //    printf(" DONE\n");
@@ -452,7 +326,6 @@ void *save_fits_function(
 
     ID = image_ID(tmsg->iname);
     tret = ID;
-    free(imsizearray);
     pthread_exit(&tret);
 
     //  free(tmsg);
@@ -697,7 +570,8 @@ errno_t __attribute__((hot)) COREMOD_MEMORY_sharedMem_2Dim_log(
     const char *IDname,
     uint32_t    zsize,
     const char *logdir,
-    const char *IDlogdata_name
+    const char *IDlogdata_name,
+    int         timingfmt
 )
 {
     // WAIT time. If no new frame during this time, save existing cube
@@ -1285,9 +1159,10 @@ errno_t __attribute__((hot)) COREMOD_MEMORY_sharedMem_2Dim_log(
                 fflush(stdout);
             }
 
-            sprintf(fnameascii, "%s/%s_%02d:%02d:%02ld.%09ld.txt", logdir, IDname,
+            sprintf(fnameascii, "%s/%s_%02d:%02d:%02ld.%09ld.%s", logdir, IDname,
                     uttimeStart->tm_hour, uttimeStart->tm_min, timenowStart.tv_sec % 60,
-                    timenowStart.tv_nsec);
+                    timenowStart.tv_nsec,
+                    (timingfmt == LOGSHMIM_TIMING_BINARY) ? "timing" : "txt");
 
 
             if(VERBOSE > 0)
@@ -1304,7 +1179,7 @@ errno_t __attribute__((hot)) COREMOD_MEMORY_sharedMem_2Dim_log(
             strcpy(tmsg->iname, iname);
             strcpy(tmsg->fname, fname);
             strcpy(tmsg->fnameascii, fnameascii);
-            tmsg->saveascii = 1;
+            tmsg->saveascii = timingfmt;
 
 
 
@@ -0,0 +1,295 @@
+/**
+ * @file    logshmim_timing.c
+ * @brief   telemetry log timing files
+ *
+ * Each saved telemetry cube has a timing file with one entry per frame.
+ * The binary format (LOGSHMIM_TIMING_HEADER followed by fixed-size
+ * LOGSHMIM_TIMING_RECORD entries) is written with a single write() per
+ * cube. The ASCII format is the historical one, and can be produced from
+ * a binary file with shmimlogtiming2ascii.
+ */
+
+
+#include <endian.h>
+#include <fcntl.h>
+
+#include "CommandLineInterface/CLIcore.h"
+#include "logshmim_timing.h"
+
+
+
+
+// ==========================================
+// Command line interface wrapper function(s)
+// ==========================================
+
+
+static errno_t logshmim_timing_bin2ascii__cli()
+{
+    if(0
+            + CLI_checkarg(1, CLIARG_STR)
+            + CLI_checkarg(2, CLIARG_STR)
+            == 0)
+    {
+        logshmim_timing_bin2ascii(
+            data.cmdargtoken[1].val.string,
+            data.cmdargtoken[2].val.string
+        );
+        return CLICMD_SUCCESS;
+    }
+    else
+    {
+        return CLICMD_INVALID_ARG;
+    }
+}
+
+
+
+// ==========================================
+// Register CLI command(s)
+// ==========================================
+
+errno_t logshmim_timing_addCLIcmd()
+{
+    RegisterCLIcommand(
+        "shmimlogtiming2ascii",
+        __FILE__,
+        logshmim_timing_bin2ascii__cli,
+        "convert binary telemetry timing file to ASCII",
+        "<binary timing file> <ASCII output file>",
+        "shmimlogtiming2ascii im1.timing im1.txt",
+        "errno_t logshmim_timing_bin2ascii(const char *fnamebin, const char *fnameascii)");
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+
+
+static inline uint64_t logshmim_timing_htole_double(
+    double val
+)
+{
+    uint64_t u;
+    memcpy(&u, &val, sizeof(u));
+    return htole64(u);
+}
+
+static inline double logshmim_timing_letoh_double(
+    uint64_t u
+)
+{
+    double val;
+    u = le64toh(u);
+    memcpy(&val, &u, sizeof(val));
+    return val;
+}
+
+
+
+/** @brief Write binary timing file, single write
+ */
+errno_t logshmim_timing_write_binary(
+    const char     *fname,
+    long            NBrecord,
+    const uint64_t *arrayindex,
+    const double   *arraytime,
+    const uint64_t *arraycnt0,
+    const uint64_t *arraycnt1
+)
+{
+    size_t bufsize = sizeof(LOGSHMIM_TIMING_HEADER)
+                     + sizeof(LOGSHMIM_TIMING_RECORD) * NBrecord;
+    char *buf = (char *) malloc(bufsize);
+    if(buf == NULL)
+    {
+        PRINT_ERROR("malloc error");
+        abort();
+    }
+
+    LOGSHMIM_TIMING_HEADER *header = (LOGSHMIM_TIMING_HEADER *) buf;
+    memcpy(header->magic, LOGSHMIM_TIMING_MAGIC, 8);
+    header->version    = htole32(LOGSHMIM_TIMING_VERSION);
+    header->recordsize = htole32(sizeof(LOGSHMIM_TIMING_RECORD));
+    header->NBrecord   = htole64(NBrecord);
+
+    LOGSHMIM_TIMING_RECORD *rec =
+        (LOGSHMIM_TIMING_RECORD *)(buf + sizeof(LOGSHMIM_TIMING_HEADER));
+    for(long k = 0; k < NBrecord; k++)
+    {
+        uint64_t utime = logshmim_timing_htole_double(arraytime[k]);
+
+        rec[k].index     = htole64(k);
+        rec[k].loopindex = htole64(arrayindex[k]);
+        memcpy(&rec[k].time, &utime, sizeof(utime));
+        rec[k].cnt0      = htole64(arraycnt0[k]);
+        rec[k].cnt1      = htole64(arraycnt1[k]);
+    }
+
+    int fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC, (mode_t) 0644);
+    if(fd == -1)
+    {
+        PRINT_ERROR("cannot create file \"%s\"", fname);
+        free(buf);
+        return RETURN_FAILURE;
+    }
+
+    errno_t ret = RETURN_SUCCESS;
+    char   *ptr = buf;
+    size_t  nleft = bufsize;
+    while(nleft > 0)
+    {
+        ssize_t rs = write(fd, ptr, nleft);
+        if(rs < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            PRINT_ERROR("write error on file \"%s\"", fname);
+            ret = RETURN_FAILURE;
+            break;
+        }
+        ptr   += rs;
+        nleft -= rs;
+    }
+    close(fd);
+    free(buf);
+
+    return ret;
+}
+
+
+
+/** @brief Write ASCII timing file
+ */
+errno_t logshmim_timing_write_ascii(
+    const char     *fname,
+    long            NBrecord,
+    const uint64_t *arrayindex,
+    const double   *arraytime,
+    const uint64_t *arraycnt0,
+    const uint64_t *arraycnt1
+)
+{
+    FILE *fp;
+
+    if((fp = fopen(fname, "w")) == NULL)
+    {
+        PRINT_ERROR("cannot create file \"%s\"", fname);
+        return RETURN_FAILURE;
+    }
+
+    fprintf(fp, "# Telemetry stream timing data \n");
+    fprintf(fp, "# File written by function %s in file %s\n", __FUNCTION__,
+            __FILE__);
+    fprintf(fp, "# \n");
+    fprintf(fp, "# col1 : datacube frame index\n");
+    fprintf(fp, "# col2 : Main index\n");
+    fprintf(fp, "# col3 : Time since cube origin\n");
+    fprintf(fp, "# col4 : Absolute time\n");
+    fprintf(fp, "# col5 : stream cnt0 index\n");
+    fprintf(fp, "# col6 : stream cnt1 index\n");
+    fprintf(fp, "# \n");
+
+    double t0 = 0.0; // time reference
+    if(NBrecord > 0)
+    {
+        t0 = arraytime[0];
+    }
+    for(long k = 0; k < NBrecord; k++)
+    {
+        // entries are:
+        // - index within cube
+        // - loop index (if applicable)
+        // - time since cube start
+        // - time (absolute)
+        // - cnt0
+        // - cnt1
+
+        fprintf(fp, "%10ld  %10lu  %15.9lf   %20.9lf  %10ld   %10ld\n", k,
+                arrayindex[k], arraytime[k] - t0, arraytime[k],
+                arraycnt0[k], arraycnt1[k]);
+    }
+    fclose(fp);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+/** @brief Convert binary timing file to ASCII timing file
+ */
+errno_t logshmim_timing_bin2ascii(
+    const char *fnamebin,
+    const char *fnameascii
+)
+{
+    FILE                  *fp;
+    LOGSHMIM_TIMING_HEADER header;
+
+    if((fp = fopen(fnamebin, "r")) == NULL)
+    {
+        PRINT_ERROR("cannot open file \"%s\"", fnamebin);
+        return RETURN_FAILURE;
+    }
+
+    if((fread(&header, sizeof(header), 1, fp) != 1)
+            || (memcmp(header.magic, LOGSHMIM_TIMING_MAGIC, 8) != 0)
+            || (le32toh(header.version) != LOGSHMIM_TIMING_VERSION)
+            || (le32toh(header.recordsize) != sizeof(LOGSHMIM_TIMING_RECORD)))
+    {
+        PRINT_ERROR("file \"%s\" is not a binary timing file", fnamebin);
+        fclose(fp);
+        return RETURN_FAILURE;
+    }
+
+    long NBrecord = le64toh(header.NBrecord);
+
+    LOGSHMIM_TIMING_RECORD *rec =
+        (LOGSHMIM_TIMING_RECORD *) malloc(sizeof(LOGSHMIM_TIMING_RECORD) * NBrecord);
+    uint64_t *arrayindex = (uint64_t *) malloc(sizeof(uint64_t) * NBrecord);
+    double   *arraytime  = (double *) malloc(sizeof(double) * NBrecord);
+    uint64_t *arraycnt0  = (uint64_t *) malloc(sizeof(uint64_t) * NBrecord);
+    uint64_t *arraycnt1  = (uint64_t *) malloc(sizeof(uint64_t) * NBrecord);
+    if((rec == NULL) || (arrayindex == NULL) || (arraytime == NULL)
+            || (arraycnt0 == NULL) || (arraycnt1 == NULL))
+    {
+        PRINT_ERROR("malloc error");
+        abort();
+    }
+
+    errno_t ret = RETURN_SUCCESS;
+    if((long) fread(rec, sizeof(LOGSHMIM_TIMING_RECORD), NBrecord, fp) != NBrecord)
+    {
+        PRINT_ERROR("file \"%s\" truncated", fnamebin);
+        ret = RETURN_FAILURE;
+    }
+    fclose(fp);
+
+    if(ret == RETURN_SUCCESS)
+    {
+        for(long k = 0; k < NBrecord; k++)
+        {
+            uint64_t utime;
+            memcpy(&utime, &rec[k].time, sizeof(utime));
+
+            arrayindex[k] = le64toh(rec[k].loopindex);
+            arraytime[k]  = logshmim_timing_letoh_double(utime);
+            arraycnt0[k]  = le64toh(rec[k].cnt0);
+            arraycnt1[k]  = le64toh(rec[k].cnt1);
+        }
+        ret = logshmim_timing_write_ascii(fnameascii, NBrecord, arrayindex, arraytime,
+                                          arraycnt0, arraycnt1);
+    }
+
+    free(rec);
+    free(arrayindex);
+    free(arraytime);
+    free(arraycnt0);
+    free(arraycnt1);
+
+    return ret;
+}
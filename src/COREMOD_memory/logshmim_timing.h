@@ -0,0 +1,68 @@
+/**
+ * @file    logshmim_timing.h
+ * @brief   telemetry log timing files
+ */
+
+#ifndef CLICORE_MEMORY_LOGSHMIM_TIMING_H
+#define CLICORE_MEMORY_LOGSHMIM_TIMING_H
+
+#include <stdint.h>
+
+
+#define LOGSHMIM_TIMING_MAGIC   "MLKTIMNG"
+#define LOGSHMIM_TIMING_VERSION 1
+
+
+/** @brief Binary timing file header
+ *
+ * All binary timing file fields are little-endian.
+ */
+typedef struct
+{
+    char     magic[8];     // LOGSHMIM_TIMING_MAGIC, not null-terminated
+    uint32_t version;
+    uint32_t recordsize;   // sizeof(LOGSHMIM_TIMING_RECORD)
+    uint64_t NBrecord;
+} LOGSHMIM_TIMING_HEADER;
+
+
+/** @brief Binary timing file record, one per frame
+ */
+typedef struct
+{
+    uint64_t index;        // frame index within cube
+    uint64_t loopindex;    // main index
+    double   time;         // absolute time [s]
+    uint64_t cnt0;         // stream cnt0
+    uint64_t cnt1;         // stream cnt1
+} LOGSHMIM_TIMING_RECORD;
+
+
+
+errno_t logshmim_timing_addCLIcmd();
+
+
+errno_t logshmim_timing_write_binary(
+    const char     *fname,
+    long            NBrecord,
+    const uint64_t *arrayindex,
+    const double   *arraytime,
+    const uint64_t *arraycnt0,
+    const uint64_t *arraycnt1
+);
+
+errno_t logshmim_timing_write_ascii(
+    const char     *fname,
+    long            NBrecord,
+    const uint64_t *arrayindex,
+    const double   *arraytime,
+    const uint64_t *arraycnt0,
+    const uint64_t *arraycnt1
+);
+
+errno_t logshmim_timing_bin2ascii(
+    const char *fnamebin,
+    const char *fnameascii
+);
+
+#endif
@@ -0,0 +1,196 @@
+/**
+ * @file    nameindex.c
+ * @brief   hash index from name to image or variable ID
+ *
+ * Open addressing, linear probing. Slots hold an ID, NAMEINDEX_EMPTY or
+ * NAMEINDEX_DELETED. Table size is a power of 2, at least twice the
+ * number of IDs, and the table is rebuilt when deleted slots accumulate.
+ *
+ * Entries are checked against the current name of the ID, so a stale
+ * entry never returns a wrong ID.
+ */
+
+
+#include "CommandLineInterface/CLIcore.h"
+#include "nameindex.h"
+
+
+#define NAMEINDEX_EMPTY   -1
+#define NAMEINDEX_DELETED -2
+
+
+
+
+// FNV-1a
+static inline uint64_t nameindex_hash(
+    const char *name
+)
+{
+    uint64_t hash = 14695981039346656037UL;
+
+    for(const char *ptr = name; *ptr != '\0'; ptr++)
+    {
+        hash ^= (uint8_t) * ptr;
+        hash *= 1099511628211UL;
+    }
+    return hash;
+}
+
+
+
+
+/** @brief Rebuild index from all IDs in use
+ *
+ * Table is (re)allocated for NBID entries.
+ */
+void nameindex_rebuild(
+    NAMEINDEX         *nindex,
+    long               NBID,
+    NAMEINDEX_GETNAME  getname
+)
+{
+    long size = 64;
+    while(size < 2 * NBID)
+    {
+        size *= 2;
+    }
+
+    if(size != nindex->size)
+    {
+        free(nindex->slot);
+        nindex->slot = (long *) malloc(sizeof(long) * size);
+        if(nindex->slot == NULL)
+        {
+            PRINT_ERROR("malloc error");
+            abort();
+        }
+        nindex->size = size;
+    }
+    nindex->NBID = NBID;
+    nindex->NBfill = 0;
+
+    for(long i = 0; i < size; i++)
+    {
+        nindex->slot[i] = NAMEINDEX_EMPTY;
+    }
+    for(long ID = 0; ID < NBID; ID++)
+    {
+        if(getname(ID) != NULL)
+        {
+            nameindex_insert(nindex, ID, getname);
+        }
+    }
+}
+
+
+
+
+/** @brief ID corresponding to name, -1 if not found
+ */
+long nameindex_find(
+    NAMEINDEX         *nindex,
+    const char        *name,
+    NAMEINDEX_GETNAME  getname
+)
+{
+    long mask = nindex->size - 1;
+    long i = (long)(nameindex_hash(name) & (uint64_t) mask);
+
+    while(nindex->slot[i] != NAMEINDEX_EMPTY)
+    {
+        long ID = nindex->slot[i];
+        if(ID >= 0)
+        {
+            const char *IDname = getname(ID);
+            if((IDname != NULL) && (strcmp(IDname, name) == 0))
+            {
+                return ID;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+
+    return -1;
+}
+
+
+
+
+/** @brief Add ID to index, under its current name
+ */
+void nameindex_insert(
+    NAMEINDEX         *nindex,
+    long               ID,
+    NAMEINDEX_GETNAME  getname
+)
+{
+    const char *name = getname(ID);
+    if(name == NULL)
+    {
+        return;
+    }
+
+    if(2 * (nindex->NBfill + 1) > nindex->size)
+    {
+        // too many deleted slots : rebuild, which inserts ID
+        nameindex_rebuild(nindex, nindex->NBID, getname);
+        return;
+    }
+
+    long mask = nindex->size - 1;
+    long i = (long)(nameindex_hash(name) & (uint64_t) mask);
+    long ifree = -1;
+
+    while(nindex->slot[i] != NAMEINDEX_EMPTY)
+    {
+        if(nindex->slot[i] == ID)
+        {
+            return;
+        }
+        if((nindex->slot[i] == NAMEINDEX_DELETED) && (ifree == -1))
+        {
+            ifree = i;
+        }
+        i = (i + 1) & mask;
+    }
+
+    if(ifree == -1)
+    {
+        ifree = i;
+        nindex->NBfill++;
+    }
+    nindex->slot[ifree] = ID;
+}
+
+
+
+
+/** @brief Remove ID from index
+ *
+ * Must be called while ID still holds the name it was inserted with.
+ */
+void nameindex_remove(
+    NAMEINDEX         *nindex,
+    long               ID,
+    NAMEINDEX_GETNAME  getname
+)
+{
+    const char *name = getname(ID);
+    if(name == NULL)
+    {
+        return;
+    }
+
+    long mask = nindex->size - 1;
+    long i = (long)(nameindex_hash(name) & (uint64_t) mask);
+
+    while(nindex->slot[i] != NAMEINDEX_EMPTY)
+    {
+        if(nindex->slot[i] == ID)
+        {
+            nindex->slot[i] = NAMEINDEX_DELETED;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+}
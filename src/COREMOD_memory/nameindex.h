@@ -0,0 +1,38 @@
+/**
+ * @file    nameindex.h
+ * @brief   hash index from name to image or variable ID
+ */
+
+#ifndef _NAMEINDEX_H
+#define _NAMEINDEX_H
+
+
+// name of entry ID, NULL if ID is not in use
+typedef const char *(*NAMEINDEX_GETNAME)(long ID);
+
+
+long nameindex_find(
+    NAMEINDEX         *nindex,
+    const char        *name,
+    NAMEINDEX_GETNAME  getname
+);
+
+void nameindex_insert(
+    NAMEINDEX         *nindex,
+    long               ID,
+    NAMEINDEX_GETNAME  getname
+);
+
+void nameindex_remove(
+    NAMEINDEX         *nindex,
+    long               ID,
+    NAMEINDEX_GETNAME  getname
+);
+
+void nameindex_rebuild(
+    NAMEINDEX         *nindex,
+    long               NBID,
+    NAMEINDEX_GETNAME  getname
+);
+
+#endif
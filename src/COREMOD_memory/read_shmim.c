@@ -69,10 +69,13 @@ imageID read_sharedmem_image(
     {
         printf("read shared mem image failed -> ID = -1\n");
         fflush(stdout);
+        data.image[IDmem].used = 0;
         ID = -1;
     }
     else
     {
+        image_ID_register(IDmem);
+
         IMGID img = makeIMGID(sname);
         //DEBUG_TRACEPOINT("resolving image");
         //ID = resolveIMGID(&img, ERRMODE_ABORT);
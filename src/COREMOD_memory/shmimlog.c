@@ -21,6 +21,7 @@
 static char *instreamname;
 static char *logdir;
 static long *logcubesize;
+static long *timingfmt;
 
 
 
@@ -42,6 +43,11 @@ static CLICMDARGDEF farg[] =
         CLIARG_STR, ".logdir", "log directory", "/media/data",
         CLIARG_VISIBLE_DEFAULT,
         (void **) &logdir
+    },
+    {
+        CLIARG_LONG, ".timingfmt", "timing file: 0 none, 1 ASCII, 2 binary", "1",
+        CLIARG_HIDDEN_DEFAULT,
+        (void **) &timingfmt
     }
 };
 
@@ -945,11 +951,11 @@ static errno_t __attribute__((hot)) shmimlog2D(
                 fflush(stdout);
             }
 
-            sprintf(fnameascii, "%s/%s.%04d%02d%02dT%02d%02d%02ld.%09ldZ.txt", logdir,
+            sprintf(fnameascii, "%s/%s.%04d%02d%02dT%02d%02d%02ld.%09ldZ.%s", logdir,
                     IDname,
                     1900 + uttimeStart->tm_year, 1 + uttimeStart->tm_mon, uttimeStart->tm_mday,
                     uttimeStart->tm_hour, uttimeStart->tm_min, timenowStart.tv_sec % 60,
-                    timenowStart.tv_nsec);
+                    timenowStart.tv_nsec, (*timingfmt == LOGSHMIM_TIMING_BINARY) ? "timing" : "txt");
 
 
             if(VERBOSE > 0)
@@ -967,7 +973,7 @@ static errno_t __attribute__((hot)) shmimlog2D(
             strcpy(tmsg->iname, iname);
             strcpy(tmsg->fname, fname);
             strcpy(tmsg->fnameascii, fnameascii);
-            tmsg->saveascii = 1;
+            tmsg->saveascii = *timingfmt;
 
 
 
@@ -8,6 +8,12 @@
 #define CLICORE_MEMORY_LOGSHMIM_TYPES_H
 
 
+// timing file format, written alongside each cube
+#define LOGSHMIM_TIMING_NONE   0
+#define LOGSHMIM_TIMING_ASCII  1 // one text line per frame
+#define LOGSHMIM_TIMING_BINARY 2 // LOGSHMIM_TIMING_RECORD per frame, see logshmim_timing.h
+
+
 typedef struct
 {
     char iname[100];
@@ -15,14 +21,11 @@ typedef struct
     int partial; // 1 if partial cube
     long cubesize; // size of the cube
 
-    int saveascii;
-    // 0 : Not saving ascii
-    // 1 : Saving ascii: arraycnt0, arraycnt1, arraytime
-    // 2 : ???
+    int saveascii; // timing file format, LOGSHMIM_TIMING_*
 
     char      fname_auxFITSheader[STRINGMAXLEN_FILENAME];
 
-    char      fnameascii[STRINGMAXLEN_FILENAME];  // name of frame to be saved
+    char      fnameascii[STRINGMAXLEN_FILENAME];  // name of timing file
     uint64_t *arrayindex;
     uint64_t *arraycnt0;
     uint64_t *arraycnt1;
@@ -48,6 +51,15 @@ typedef struct
 
     uint32_t  CBindex; // last frame grabbed
     uint64_t  CBcycle; // last frame grabbed
+
+    // cube buffer pool and writer statistics (shmimlogd)
+    uint32_t  NBbuff;       /**<  number of cube buffers */
+    uint32_t  NBbufffree;   /**<  buffers available for capture */
+    uint64_t  dropcnt;      /**<  frames dropped, no free buffer */
+    uint64_t  writeerrcnt;  /**<  cubes that could not be written */
+    uint64_t  writebytes;   /**<  total bytes written */
+    double    writetime;    /**<  total time spent writing [s] */
+    double    writeMBps;    /**<  write bandwidth, last cube [MB/s] */
 } LOGSHIM_CONF;
 
 #endif
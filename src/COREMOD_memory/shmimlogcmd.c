@@ -105,6 +105,15 @@ static errno_t logshim_cmd(
             printf(" filecnt = %lld\n", map[0].filecnt);
             printf("interval = %ld\n", map[0].interval);
             printf("logexit  = %d\n", map[0].logexit);
+            if(map[0].NBbuff > 0)
+            {
+                printf("buffers  = %u / %u free\n", map[0].NBbufffree, map[0].NBbuff);
+                printf("dropped  = %lu frames\n", map[0].dropcnt);
+                printf("wr error = %lu cubes\n", map[0].writeerrcnt);
+                printf("written  = %.3f GB in %.3f s\n", 1.0e-9 * map[0].writebytes,
+                       map[0].writetime);
+                printf("last cube write = %.1f MB/s\n", map[0].writeMBps);
+            }
         }
 
 
@@ -0,0 +1,821 @@
+/**
+ * @file    shmimlogd.c
+ * @brief   multi-stream telemetry logger daemon
+ *
+ * A single process logs any number of streams. Each stream has a capture
+ * thread copying frames into a pool of cube buffers, preallocated at
+ * startup. Full (or timed-out partial) cubes are queued to a fixed pool of
+ * writer threads, which stream them to FITS files and return the buffer to
+ * its stream pool.
+ *
+ * If a stream has no free buffer when a frame arrives, the frame is dropped
+ * and counted : capture never waits on disk I/O. Buffer pool occupancy,
+ * drop counts and write bandwidth are reported in each stream's
+ * LOGSHIM_CONF shared memory.
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "CommandLineInterface/CLIcore.h"
+#include "CommandLineInterface/timeutils.h"
+
+#include "COREMOD_iofits/COREMOD_iofits.h"
+
+#include "image_ID.h"
+#include "read_shmim.h"
+#include "stream_sem.h"
+
+#include "shmimlog_types.h"
+#include "logshmim_timing.h"
+
+
+
+// If no new frame during this time, save existing partial cube [sec]
+#define SHMIMLOGD_WAITSEC 5
+
+
+
+// Local variables pointers
+static char *instreamnames;
+static char *logdir;
+static long *logcubesize;
+static long *NBbuff;
+static long *NBwriter;
+static long *timingfmt;
+
+
+
+
+// List of arguments to function
+static CLICMDARGDEF farg[] =
+{
+    {
+        CLIARG_STR, ".in_snames", "input stream names, comma-separated", "im1,im2",
+        CLIARG_VISIBLE_DEFAULT,
+        (void **) &instreamnames
+    },
+    {
+        CLIARG_LONG, ".cubesize", "cube size", "10000",
+        CLIARG_VISIBLE_DEFAULT,
+        (void **) &logcubesize
+    },
+    {
+        CLIARG_STR, ".logdir", "log directory", "/media/data",
+        CLIARG_VISIBLE_DEFAULT,
+        (void **) &logdir
+    },
+    {
+        CLIARG_LONG, ".NBbuff", "number of cube buffers per stream", "3",
+        CLIARG_HIDDEN_DEFAULT,
+        (void **) &NBbuff
+    },
+    {
+        CLIARG_LONG, ".NBwriter", "number of writer threads", "2",
+        CLIARG_HIDDEN_DEFAULT,
+        (void **) &NBwriter
+    },
+    {
+        CLIARG_LONG, ".timingfmt", "timing file: 0 none, 1 ASCII, 2 binary", "1",
+        CLIARG_HIDDEN_DEFAULT,
+        (void **) &timingfmt
+    }
+};
+
+
+static CLICMDDATA CLIcmddata =
+{
+    "shmimlogd",
+    "log multiple shared memory streams",
+    CLICMD_FIELDS_DEFAULTS
+};
+
+
+
+
+struct SHMIMLOGD_STREAM;
+
+
+/** @brief Preallocated cube buffer
+ */
+typedef struct
+{
+    struct SHMIMLOGD_STREAM *stream;
+
+    char     *cube;
+    uint64_t *arrayloopindex; // capture loop frame index, gaps are dropped frames
+    uint64_t *arraycnt0;
+    uint64_t *arraycnt1;
+    double   *arraytime;
+    long      NBframe;
+
+    char      fname[STRINGMAXLEN_FULLFILENAME];
+    char      fnametiming[STRINGMAXLEN_FULLFILENAME];
+} SHMIMLOGD_BUFFER;
+
+
+
+typedef struct SHMIMLOGD_STREAM
+{
+    char              name[STRINGMAXLEN_IMAGE_NAME];
+    imageID           ID;
+    long              framesize;
+    long              NBslices;  // > 1 if stream is a rolling buffer
+    int               semindex;
+
+    LOGSHIM_CONF     *conf;
+
+    SHMIMLOGD_BUFFER *buff;
+    int               NBbuff;
+    int              *freelist;  // indices of free buffers, protected by daemon lock
+    int               NBfree;
+
+    pthread_t         thread_capture;
+    int               captureOK;
+
+    struct SHMIMLOGD *daemon;
+} SHMIMLOGD_STREAM;
+
+
+
+typedef struct SHMIMLOGD
+{
+    char               logdir[STRINGMAXLEN_DIRNAME];
+    long               zsize;
+    int                timingfmt;
+
+    SHMIMLOGD_STREAM  *stream;
+    int                NBstream;
+
+    // write queue, large enough to hold every buffer of every stream
+    pthread_mutex_t    lock;
+    pthread_cond_t     cond;
+    SHMIMLOGD_BUFFER **queue;
+    int                queuesize;
+    int                queuehead;
+    int                queuecnt;
+    int                writerexit;
+
+    pthread_t         *thread_writer;
+    int                NBwriter;
+} SHMIMLOGD;
+
+
+
+
+
+static errno_t shmimlogd(
+    const char *streamnames,
+    long        zsize,
+    const char *logdir,
+    int         NBbuff,
+    int         NBwriter,
+    int         timingfmt
+);
+
+
+
+static errno_t compute_function()
+{
+    shmimlogd(instreamnames, *logcubesize, logdir, *NBbuff, *NBwriter, *timingfmt);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+INSERT_STD_CLIfunction
+
+// Register function in CLI
+errno_t CLIADDCMD_COREMOD_memory__shmimlogd()
+{
+    INSERT_STD_CLIREGISTERFUNC
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+
+
+/** @brief creates logshimconf shared memory and loads it
+ */
+static LOGSHIM_CONF *shmimlogd_create_SHMconf(
+    const char *logshimname
+)
+{
+    int             SM_fd;
+    size_t          sharedsize = sizeof(LOGSHIM_CONF);
+    char            SM_fname[STRINGMAXLEN_FILENAME];
+    LOGSHIM_CONF   *map;
+
+    WRITE_FILENAME(SM_fname, "%s/%s.logshimconf.shm", data.shmdir, logshimname);
+
+    umask(0);
+    SM_fd = open(SM_fname, O_RDWR | O_CREAT | O_TRUNC, (mode_t)0666);
+    if(SM_fd == -1)
+    {
+        PRINT_ERROR("Error opening file \"%s\" for writing", SM_fname);
+        return NULL;
+    }
+
+    if(ftruncate(SM_fd, sharedsize) == -1)
+    {
+        close(SM_fd);
+        PRINT_ERROR("Error calling ftruncate() on \"%s\"", SM_fname);
+        return NULL;
+    }
+
+    map = (LOGSHIM_CONF *) mmap(0, sharedsize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                SM_fd, 0);
+    close(SM_fd);
+    if(map == MAP_FAILED)
+    {
+        perror("Error mmapping the file");
+        return NULL;
+    }
+
+    memset(map, 0, sharedsize);
+    map[0].on = 1;
+    map[0].interval = 1;
+    strcpy(map[0].fname, SM_fname);
+
+    return map;
+}
+
+
+
+
+/** @brief Return buffer to its stream pool
+ *
+ * Called with daemon lock held.
+ */
+static void shmimlogd_buffer_release(
+    SHMIMLOGD_BUFFER *buff
+)
+{
+    SHMIMLOGD_STREAM *stream = buff->stream;
+
+    stream->freelist[stream->NBfree] = (int)(buff - stream->buff);
+    stream->NBfree ++;
+    stream->conf->NBbufffree = stream->NBfree;
+}
+
+
+
+/** @brief Get free buffer from stream pool, NULL if none available
+ */
+static SHMIMLOGD_BUFFER *shmimlogd_buffer_get(
+    SHMIMLOGD_STREAM *stream
+)
+{
+    SHMIMLOGD_BUFFER *buff = NULL;
+
+    pthread_mutex_lock(&stream->daemon->lock);
+    if(stream->NBfree > 0)
+    {
+        stream->NBfree --;
+        buff = &stream->buff[stream->freelist[stream->NBfree]];
+        stream->conf->NBbufffree = stream->NBfree;
+    }
+    pthread_mutex_unlock(&stream->daemon->lock);
+
+    if(buff != NULL)
+    {
+        buff->NBframe = 0;
+    }
+
+    return buff;
+}
+
+
+
+/** @brief Queue buffer for writing
+ *
+ * Never blocks: the queue can hold all buffers.
+ */
+static void shmimlogd_buffer_queue(
+    SHMIMLOGD_BUFFER *buff
+)
+{
+    SHMIMLOGD_STREAM *stream = buff->stream;
+    SHMIMLOGD        *daemon = stream->daemon;
+
+    // file names from time of first frame in cube
+    {
+        struct timespec tstart;
+        struct tm       uttime;
+
+        tstart.tv_sec  = (time_t) buff->arraytime[0];
+        tstart.tv_nsec = (long)((buff->arraytime[0] - tstart.tv_sec) * 1.0e9);
+        gmtime_r(&tstart.tv_sec, &uttime);
+
+        WRITE_FULLFILENAME(buff->fname,
+                           "%s/%s.%04d%02d%02dT%02d%02d%02d.%09ldZ.fits",
+                           daemon->logdir, stream->name,
+                           1900 + uttime.tm_year, 1 + uttime.tm_mon, uttime.tm_mday,
+                           uttime.tm_hour, uttime.tm_min, uttime.tm_sec, tstart.tv_nsec);
+        WRITE_FULLFILENAME(buff->fnametiming,
+                           "%s/%s.%04d%02d%02dT%02d%02d%02d.%09ldZ.%s",
+                           daemon->logdir, stream->name,
+                           1900 + uttime.tm_year, 1 + uttime.tm_mon, uttime.tm_mday,
+                           uttime.tm_hour, uttime.tm_min, uttime.tm_sec, tstart.tv_nsec,
+                           (daemon->timingfmt == LOGSHMIM_TIMING_BINARY) ? "timing" : "txt");
+    }
+
+    pthread_mutex_lock(&daemon->lock);
+    daemon->queue[(daemon->queuehead + daemon->queuecnt) % daemon->queuesize] = buff;
+    daemon->queuecnt ++;
+    stream->conf->filecnt ++;
+    pthread_cond_signal(&daemon->cond);
+    pthread_mutex_unlock(&daemon->lock);
+}
+
+
+
+
+/** @brief Writer thread: write queued cubes to disk
+ */
+static void *shmimlogd_writer(
+    void *ptr
+)
+{
+    SHMIMLOGD *daemon = (SHMIMLOGD *) ptr;
+
+    pthread_mutex_lock(&daemon->lock);
+    while(1)
+    {
+        while((daemon->queuecnt == 0) && (daemon->writerexit == 0))
+        {
+            pthread_cond_wait(&daemon->cond, &daemon->lock);
+        }
+        if(daemon->queuecnt == 0)
+        {
+            // writerexit set and queue drained
+            break;
+        }
+
+        SHMIMLOGD_BUFFER *buff = daemon->queue[daemon->queuehead];
+        daemon->queuehead = (daemon->queuehead + 1) % daemon->queuesize;
+        daemon->queuecnt --;
+        pthread_mutex_unlock(&daemon->lock);
+
+
+        SHMIMLOGD_STREAM *stream = buff->stream;
+        FITSSTREAM        fs;
+        char              fname_auxFITSheader[STRINGMAXLEN_FULLFILENAME];
+        struct timespec   t0, t1;
+        errno_t           wret = RETURN_FAILURE;
+
+        WRITE_FULLFILENAME(fname_auxFITSheader, "%s/%s.auxFITSheader.shm",
+                           data.shmdir, stream->name);
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        if(fitsstream_open(&fs, buff->fname, &data.image[stream->ID],
+                           fname_auxFITSheader) == RETURN_SUCCESS)
+        {
+            wret = fitsstream_write(&fs, buff->cube, buff->NBframe);
+            if(fitsstream_close(&fs) != RETURN_SUCCESS)
+            {
+                wret = RETURN_FAILURE;
+            }
+        }
+        if(wret != RETURN_SUCCESS)
+        {
+            PRINT_ERROR("cannot write %s", buff->fname);
+        }
+
+        if(daemon->timingfmt == LOGSHMIM_TIMING_ASCII)
+        {
+            logshmim_timing_write_ascii(buff->fnametiming, buff->NBframe,
+                                        buff->arrayloopindex, buff->arraytime, buff->arraycnt0, buff->arraycnt1);
+        }
+        if(daemon->timingfmt == LOGSHMIM_TIMING_BINARY)
+        {
+            logshmim_timing_write_binary(buff->fnametiming, buff->NBframe,
+                                         buff->arrayloopindex, buff->arraytime, buff->arraycnt0, buff->arraycnt1);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+
+        pthread_mutex_lock(&daemon->lock);
+        if(wret == RETURN_SUCCESS)
+        {
+            struct timespec tdiff = timespec_diff(t0, t1);
+            double          dt = 1.0 * tdiff.tv_sec + 1.0e-9 * tdiff.tv_nsec;
+            uint64_t        nbbytes = (uint64_t) stream->framesize * buff->NBframe;
+
+            stream->conf->cnt ++;
+            stream->conf->writebytes += nbbytes;
+            stream->conf->writetime += dt;
+            if(dt > 0.0)
+            {
+                stream->conf->writeMBps = 1.0e-6 * nbbytes / dt;
+            }
+        }
+        else
+        {
+            stream->conf->writeerrcnt ++;
+        }
+        shmimlogd_buffer_release(buff);
+    }
+    pthread_mutex_unlock(&daemon->lock);
+
+    return NULL;
+}
+
+
+
+
+/** @brief Capture thread: copy stream frames into cube buffers
+ */
+static void *shmimlogd_capture(
+    void *ptr
+)
+{
+    SHMIMLOGD_STREAM *stream = (SHMIMLOGD_STREAM *) ptr;
+    SHMIMLOGD        *daemon = stream->daemon;
+    IMAGE            *image  = &data.image[stream->ID];
+    LOGSHIM_CONF     *conf   = stream->conf;
+    char             *ptr0   = (char *) image->array.raw;
+
+    SHMIMLOGD_BUFFER *buff   = NULL;
+    int               waitcnt = 0; // seconds since last frame
+    uint64_t          cnt0   = image->md[0].cnt0;
+    uint64_t          loopindex = 0; // new frames seen by capture loop
+
+    while(conf->logexit == 0)
+    {
+        struct timespec ts;
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += 1;
+
+        if(ImageStreamIO_semtimedwait(image, stream->semindex, &ts) != 0)
+        {
+            // no new frame: save partial cube on timeout
+            waitcnt ++;
+            if((waitcnt >= SHMIMLOGD_WAITSEC) && (buff != NULL) && (buff->NBframe > 0))
+            {
+                shmimlogd_buffer_queue(buff);
+                buff = NULL;
+            }
+            continue;
+        }
+        waitcnt = 0;
+
+        if((image->md[0].cnt0 == cnt0) || (conf->on == 0))
+        {
+            continue;
+        }
+        cnt0 = image->md[0].cnt0;
+        loopindex ++;
+
+        if(buff == NULL)
+        {
+            buff = shmimlogd_buffer_get(stream);
+            if(buff == NULL)
+            {
+                // pool exhausted, writers are behind
+                conf->dropcnt ++;
+                continue;
+            }
+        }
+
+        struct timespec timenow;
+        clock_gettime(CLOCK_REALTIME, &timenow);
+
+        char *ptrsrc = ptr0;
+        if(stream->NBslices > 1)
+        {
+            ptrsrc += stream->framesize * (image->md[0].cnt1 % stream->NBslices);
+        }
+        memcpy(buff->cube + stream->framesize * buff->NBframe, ptrsrc, stream->framesize);
+
+        buff->arrayloopindex[buff->NBframe] = loopindex - 1;
+        buff->arraycnt0[buff->NBframe] = image->md[0].cnt0;
+        buff->arraycnt1[buff->NBframe] = image->md[0].cnt1;
+        buff->arraytime[buff->NBframe] = timenow.tv_sec + 1.0e-9 * timenow.tv_nsec;
+        buff->NBframe ++;
+
+        if(buff->NBframe == daemon->zsize)
+        {
+            shmimlogd_buffer_queue(buff);
+            buff = NULL;
+        }
+    }
+
+    if((buff != NULL) && (buff->NBframe > 0))
+    {
+        shmimlogd_buffer_queue(buff);
+    }
+    else if(buff != NULL)
+    {
+        pthread_mutex_lock(&daemon->lock);
+        shmimlogd_buffer_release(buff);
+        pthread_mutex_unlock(&daemon->lock);
+    }
+
+    return NULL;
+}
+
+
+
+
+/** @brief Set up stream: conf shared memory and buffer pool
+ */
+static errno_t shmimlogd_stream_init(
+    SHMIMLOGD        *daemon,
+    SHMIMLOGD_STREAM *stream,
+    const char       *name,
+    int               NBbuff
+)
+{
+    strncpy(stream->name, name, STRINGMAXLEN_IMAGE_NAME - 1);
+    stream->daemon = daemon;
+
+    stream->ID = image_ID(name);
+    if(stream->ID == -1)
+    {
+        stream->ID = read_sharedmem_image(name);
+    }
+    if(stream->ID == -1)
+    {
+        PRINT_ERROR("cannot open stream %s", name);
+        return RETURN_FAILURE;
+    }
+
+    IMAGE *image = &data.image[stream->ID];
+    if(image->md[0].sem == 0)
+    {
+        COREMOD_MEMORY_image_set_createsem(name, IMAGE_NB_SEMAPHORE);
+    }
+
+    stream->NBslices = 1;
+    if(image->md[0].naxis == 3)
+    {
+        stream->NBslices = image->md[0].size[2];
+    }
+    stream->framesize = ImageStreamIO_typesize(image->md[0].datatype)
+                        * image->md[0].size[0] * image->md[0].size[1];
+    stream->semindex  = ImageStreamIO_getsemwaitindex(image, 0);
+    if(stream->semindex == -1)
+    {
+        PRINT_ERROR("stream %s: no semaphore available", name);
+        return RETURN_FAILURE;
+    }
+
+    stream->conf = shmimlogd_create_SHMconf(name);
+    if(stream->conf == NULL)
+    {
+        return RETURN_FAILURE;
+    }
+
+    // all cube memory is allocated and touched here, none in the loop
+    stream->NBbuff   = NBbuff;
+    stream->NBfree   = NBbuff;
+    stream->buff     = (SHMIMLOGD_BUFFER *) calloc(NBbuff, sizeof(SHMIMLOGD_BUFFER));
+    stream->freelist = (int *) malloc(sizeof(int) * NBbuff);
+    if((stream->buff == NULL) || (stream->freelist == NULL))
+    {
+        PRINT_ERROR("malloc error");
+        abort();
+    }
+    for(int bi = 0; bi < NBbuff; bi++)
+    {
+        SHMIMLOGD_BUFFER *buff = &stream->buff[bi];
+
+        buff->stream    = stream;
+        buff->cube      = (char *) malloc(stream->framesize * daemon->zsize);
+        buff->arrayloopindex = (uint64_t *) malloc(sizeof(uint64_t) * daemon->zsize);
+        buff->arraycnt0 = (uint64_t *) malloc(sizeof(uint64_t) * daemon->zsize);
+        buff->arraycnt1 = (uint64_t *) malloc(sizeof(uint64_t) * daemon->zsize);
+        buff->arraytime = (double *) malloc(sizeof(double) * daemon->zsize);
+        if((buff->cube == NULL) || (buff->arrayloopindex == NULL) || (buff->arraycnt0 == NULL)
+                || (buff->arraycnt1 == NULL) || (buff->arraytime == NULL))
+        {
+            PRINT_ERROR("malloc error, cannot allocate %d x %ld byte cube buffers",
+                        NBbuff, stream->framesize * daemon->zsize);
+            abort();
+        }
+        memset(buff->cube, 0, stream->framesize * daemon->zsize);
+
+        stream->freelist[bi] = bi;
+    }
+    stream->conf->NBbuff     = NBbuff;
+    stream->conf->NBbufffree = NBbuff;
+
+    printf("Logging stream %s, frame size %ld, %d x %ld frame buffers\n",
+           name, stream->framesize, NBbuff, daemon->zsize);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+static void shmimlogd_stream_free(
+    SHMIMLOGD_STREAM *stream
+)
+{
+    if(stream->buff != NULL)
+    {
+        for(int bi = 0; bi < stream->NBbuff; bi++)
+        {
+            free(stream->buff[bi].cube);
+            free(stream->buff[bi].arrayloopindex);
+            free(stream->buff[bi].arraycnt0);
+            free(stream->buff[bi].arraycnt1);
+            free(stream->buff[bi].arraytime);
+        }
+        free(stream->buff);
+    }
+    free(stream->freelist);
+
+    if(stream->conf != NULL)
+    {
+        munmap(stream->conf, sizeof(LOGSHIM_CONF));
+    }
+}
+
+
+
+
+/** @brief Log multiple streams to disk
+ *
+ * Runs until logexit is set for all streams (shmimlogcmd <stream> logexit).
+ */
+static errno_t shmimlogd(
+    const char *streamnames,
+    long        zsize,
+    const char *logdir,
+    int         NBbuff,
+    int         NBwriter,
+    int         timingfmt
+)
+{
+    SHMIMLOGD daemon;
+    char      namelist[STRINGMAXLEN_DEFAULT];
+    char     *saveptr;
+
+    if(zsize < 1)
+    {
+        PRINT_ERROR("cube size must be > 0");
+        return RETURN_FAILURE;
+    }
+    if(NBbuff < 2)
+    {
+        NBbuff = 2;
+    }
+    if(NBwriter < 1)
+    {
+        NBwriter = 1;
+    }
+
+    memset(&daemon, 0, sizeof(SHMIMLOGD));
+    strncpy(daemon.logdir, logdir, STRINGMAXLEN_DIRNAME - 1);
+    daemon.zsize     = zsize;
+    daemon.timingfmt = timingfmt;
+    pthread_mutex_init(&daemon.lock, NULL);
+    pthread_cond_init(&daemon.cond, NULL);
+
+
+    // count streams
+    strncpy(namelist, streamnames, STRINGMAXLEN_DEFAULT - 1);
+    namelist[STRINGMAXLEN_DEFAULT - 1] = '\0';
+    int NBname = 0;
+    for(char *name = strtok_r(namelist, ", ", &saveptr); name != NULL;
+            name = strtok_r(NULL, ", ", &saveptr))
+    {
+        NBname ++;
+    }
+    if(NBname == 0)
+    {
+        PRINT_ERROR("no stream to log");
+        return RETURN_FAILURE;
+    }
+
+    daemon.stream = (SHMIMLOGD_STREAM *) calloc(NBname, sizeof(SHMIMLOGD_STREAM));
+    if(daemon.stream == NULL)
+    {
+        PRINT_ERROR("malloc error");
+        abort();
+    }
+
+    strncpy(namelist, streamnames, STRINGMAXLEN_DEFAULT - 1);
+    namelist[STRINGMAXLEN_DEFAULT - 1] = '\0';
+    for(char *name = strtok_r(namelist, ", ", &saveptr); name != NULL;
+            name = strtok_r(NULL, ", ", &saveptr))
+    {
+        if(shmimlogd_stream_init(&daemon, &daemon.stream[daemon.NBstream], name,
+                                 NBbuff) == RETURN_SUCCESS)
+        {
+            daemon.queuesize += NBbuff;
+        }
+        else
+        {
+            PRINT_WARNING("stream %s will not be logged", name);
+        }
+        daemon.NBstream ++;
+    }
+
+    if(daemon.queuesize == 0)
+    {
+        PRINT_ERROR("no stream to log");
+        for(int si = 0; si < daemon.NBstream; si++)
+        {
+            shmimlogd_stream_free(&daemon.stream[si]);
+        }
+        free(daemon.stream);
+        return RETURN_FAILURE;
+    }
+
+    daemon.queue = (SHMIMLOGD_BUFFER **) malloc(sizeof(SHMIMLOGD_BUFFER *) *
+                   daemon.queuesize);
+    daemon.thread_writer = (pthread_t *) malloc(sizeof(pthread_t) * NBwriter);
+    if((daemon.queue == NULL) || (daemon.thread_writer == NULL))
+    {
+        PRINT_ERROR("malloc error");
+        abort();
+    }
+
+
+    // start writers, then capture threads
+    for(int wi = 0; wi < NBwriter; wi++)
+    {
+        if(pthread_create(&daemon.thread_writer[daemon.NBwriter], NULL,
+                          shmimlogd_writer, &daemon) == 0)
+        {
+            daemon.NBwriter ++;
+        }
+    }
+    if(daemon.NBwriter == 0)
+    {
+        PRINT_ERROR("cannot start writer thread");
+        abort();
+    }
+
+    for(int si = 0; si < daemon.NBstream; si++)
+    {
+        SHMIMLOGD_STREAM *stream = &daemon.stream[si];
+        if(stream->conf != NULL)
+        {
+            if(pthread_create(&stream->thread_capture, NULL, shmimlogd_capture,
+                              stream) == 0)
+            {
+                stream->captureOK = 1;
+            }
+            else
+            {
+                PRINT_ERROR("cannot start capture thread for %s", stream->name);
+            }
+        }
+    }
+
+
+    // capture threads exit on logexit, remaining cubes are then drained
+    for(int si = 0; si < daemon.NBstream; si++)
+    {
+        if(daemon.stream[si].captureOK == 1)
+        {
+            pthread_join(daemon.stream[si].thread_capture, NULL);
+        }
+    }
+
+    pthread_mutex_lock(&daemon.lock);
+    daemon.writerexit = 1;
+    pthread_cond_broadcast(&daemon.cond);
+    pthread_mutex_unlock(&daemon.lock);
+
+    for(int wi = 0; wi < daemon.NBwriter; wi++)
+    {
+        pthread_join(daemon.thread_writer[wi], NULL);
+    }
+
+
+    for(int si = 0; si < daemon.NBstream; si++)
+    {
+        SHMIMLOGD_STREAM *stream = &daemon.stream[si];
+        if(stream->conf != NULL)
+        {
+            printf("%-32s  %8lld files  %8lu dropped frames  %8.1f MB/s average\n",
+                   stream->name, stream->conf->cnt, stream->conf->dropcnt,
+                   (stream->conf->writetime > 0.0) ?
+                   1.0e-6 * stream->conf->writebytes / stream->conf->writetime : 0.0);
+        }
+        shmimlogd_stream_free(stream);
+    }
+    free(daemon.stream);
+    free(daemon.queue);
+    free(daemon.thread_writer);
+
+    pthread_mutex_destroy(&daemon.lock);
+    pthread_cond_destroy(&daemon.cond);
+
+    return RETURN_SUCCESS;
+}
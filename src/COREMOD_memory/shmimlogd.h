@@ -0,0 +1,6 @@
+#ifndef COREMOD_MEMORY_SHMIMLOGD_H
+#define COREMOD_MEMORY_SHMIMLOGD_H
+
+errno_t CLIADDCMD_COREMOD_memory__shmimlogd();
+
+#endif
@@ -4,10 +4,16 @@
  */
 
 
+#include <math.h>
+#include <pthread.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 #include <sched.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <linux/errqueue.h>
 
 
 #include "CommandLineInterface/CLIcore.h"
@@ -17,8 +23,18 @@
 #include "delete_image.h"
 #include "read_shmim.h"
 #include "stream_sem.h"
+#include "stream_TCP.h"
+#include "stream_TCP_codec.h"
 
 
+// zero-copy transmit, may not be defined by older libc headers
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+
 
 
 typedef struct
@@ -28,6 +44,23 @@ typedef struct
 } TCP_BUFFER_METADATA;
 
 
+// number of transmit buffers in compressed mode
+// one is filled by the compute loop while the other is sent
+#define NETWORKTRANSMIT_CODEC_NBBUFF 2
+
+typedef struct
+{
+    int      fd;
+    // each buffer: TCP_CODEC_FRAMEHEADER, payload, TCP_BUFFER_METADATA
+    char    *buff[NETWORKTRANSMIT_CODEC_NBBUFF];
+    long     buffsize[NETWORKTRANSMIT_CODEC_NBBUFF]; // bytes to send
+    sem_t    semfilled;  // posted by compute loop when buffer is ready
+    sem_t    semfree;    // posted by send thread when buffer is sent
+    int      exitflag;
+    int      errflag;    // set by send thread on send error
+} NETWORKTRANSMIT_CODECSEND;
+
+
 
 
 
@@ -158,7 +191,7 @@ errno_t stream__TCP_addCLIcmd()
         "imnetwtransmit",
         __FILE__,
         COREMOD_MEMORY_image_NETWORKtransmit__cli,
-        "transmit image over network",
+        "transmit image over network. mode flags: 1 counter sync, 2 legacy copy+send, 4 zerocopy, 8 batch, 16 compress, 32 send counters",
         "<image> <IP addr> <port [long]> <sync mode [int]>",
         "imnetwtransmit im1 127.0.0.1 0 8888 0",
         "long COREMOD_MEMORY_image_NETWORKtransmit(const char *IDname, const char *IPaddr, int port, int mode)");
@@ -167,7 +200,7 @@ errno_t stream__TCP_addCLIcmd()
         "imnetwreceive",
         __FILE__,
         COREMOD_MEMORY_image_NETWORKreceive__cli,
-        "receive image(s) over network. mode=1 uses counter instead of semaphore",
+        "receive image(s) over network. mode flags: 2 direct into next stream slot, 4 accept codec",
         "<port [long]> <mode [int]> <RT priority>",
         "imnetwreceive 8887 0 80",
         "long COREMOD_MEMORY_image_NETWORKreceive(int port, int mode, int RT_priority)");	
@@ -285,8 +318,211 @@ errno_t COREMOD_MEMORY_testfunction_semaphore(
 
 
 
+/** @brief Send all bytes described by iovec array
+ *
+ * Advances iovec array on partial send. iov content is modified.
+ * If NBcall is not NULL, it is incremented for each successful sendmsg()
+ * call : with MSG_ZEROCOPY, each call gets its own completion.
+ * Returns total number of bytes sent, or -1 on error.
+ */
+static ssize_t NETWORKtransmit_sendmsg_all(
+    int           fd,
+    struct iovec *iov,
+    int           iovcnt,
+    int           flags,
+    uint64_t     *NBcall
+)
+{
+    ssize_t totsent = 0;
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov    = iov;
+    msg.msg_iovlen = iovcnt;
+
+    while(msg.msg_iovlen > 0)
+    {
+        ssize_t rs = sendmsg(fd, &msg, flags);
+        if(rs < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if(NBcall != NULL)
+        {
+            (*NBcall) ++;
+        }
+        totsent += rs;
+
+        // skip fully sent iovec entries
+        while((msg.msg_iovlen > 0) && ((size_t) rs >= msg.msg_iov[0].iov_len))
+        {
+            rs -= msg.msg_iov[0].iov_len;
+            msg.msg_iov ++;
+            msg.msg_iovlen --;
+        }
+        if(msg.msg_iovlen > 0)
+        {
+            msg.msg_iov[0].iov_base = (char *) msg.msg_iov[0].iov_base + rs;
+            msg.msg_iov[0].iov_len -= rs;
+        }
+    }
+
+    return totsent;
+}
+
+
+/** @brief Reap MSG_ZEROCOPY completion notifications
+ *
+ * Non-blocking. Returns number of completed sendmsg() calls,
+ * and sets *copied to 1 if kernel fell back to copying.
+ */
+static long NETWORKtransmit_zerocopy_reap(
+    int  fd,
+    int *copied
+)
+{
+    long ncompleted = 0;
+    char control[128];
+
+    for(;;)
+    {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+
+        if(recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1)
+        {
+            break;
+        }
+
+        for(struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != NULL;
+                cm = CMSG_NXTHDR(&msg, cm))
+        {
+            struct sock_extended_err *serr =
+                (struct sock_extended_err *) CMSG_DATA(cm);
+            if(serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+            {
+                continue;
+            }
+            // ee_info..ee_data is the range of completed sendmsg() calls
+            ncompleted += serr->ee_data - serr->ee_info + 1;
+            if(serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+            {
+                *copied = 1;
+            }
+        }
+    }
+
+    return ncompleted;
+}
+
+
+/** @brief Wait until target MSG_ZEROCOPY sendmsg() calls have completed
+ *
+ * Completions of a TCP socket are in order, so the number of completed
+ * calls identifies the sends whose buffers can be reused.
+ * Returns 0, or -1 after 1 sec timeout.
+ */
+static int NETWORKtransmit_zerocopy_wait(
+    int       fd,
+    uint64_t *zccompleted,
+    uint64_t  target,
+    int      *copied
+)
+{
+    for(int i = 0; i < 1000; i++)
+    {
+        *zccompleted += NETWORKtransmit_zerocopy_reap(fd, copied);
+        if(*zccompleted >= target)
+        {
+            return 0;
+        }
+        // error queue is signaled by POLLERR
+        struct pollfd pfd;
+        pfd.fd      = fd;
+        pfd.events  = 0;
+        pfd.revents = 0;
+        poll(&pfd, 1, 1);
+    }
+
+    return -1;
+}
+
+
+
+/** @brief Send thread for compressed mode
+ *
+ * Sends buffers in order as they are filled, so that compression of
+ * frame N+1 overlaps with transmission of frame N.
+ */
+static void *NETWORKtransmit_codec_sendthread(
+    void *ptr
+)
+{
+    NETWORKTRANSMIT_CODECSEND *codecsend = (NETWORKTRANSMIT_CODECSEND *) ptr;
+    int bindex = 0;
+
+    for(;;)
+    {
+        sem_wait(&codecsend->semfilled);
+        if(codecsend->exitflag == 1)
+        {
+            break;
+        }
+
+        if(codecsend->errflag == 0)
+        {
+            struct iovec iov;
+            iov.iov_base = codecsend->buff[bindex];
+            iov.iov_len  = codecsend->buffsize[bindex];
+            if(NETWORKtransmit_sendmsg_all(codecsend->fd, &iov, 1,
+                                           0, NULL) != codecsend->buffsize[bindex])
+            {
+                perror("socket sendmsg error ");
+                codecsend->errflag = 1;
+            }
+        }
+
+        sem_post(&codecsend->semfree);
+        bindex = (bindex + 1) % NETWORKTRANSMIT_CODEC_NBBUFF;
+    }
+
+    return NULL;
+}
+
+
+
+
 /** continuously transmits 2D image through TCP link
- * mode = 1, force counter to be used for synchronization, ignore semaphores if they exist
+ *
+ * mode is a combination of NETWORKTRANSMIT_MODE flags :
+ * - CNTSYNC  (1) : force counter to be used for synchronization, ignore semaphores if they exist
+ * - COPYSEND (2) : legacy path, frame copied to transmit buffer before send()
+ * - ZEROCOPY (4) : sendmsg() with MSG_ZEROCOPY
+ * - BATCH    (8) : send all pending circular buffer slices in one sendmsg()
+ * - COMPRESS (16): lossless compression, receiver must use NETWORKRECEIVE_MODE_CODEC
+ *
+ * By default, frame and metadata are sent with a single sendmsg() call
+ * pointing directly to the shared memory slice. The byte stream is
+ * identical to the legacy path, so old receivers are unaffected.
+ *
+ * With ZEROCOPY, the kernel may read the slice after sendmsg() returns,
+ * so the writer must not overwrite it immediately. Zero-copy requires a
+ * circular buffer of at least NETWORKTRANSMIT_ZEROCOPY_MINSLICES slices.
+ * Frames that the writer could reach before the send completes are sent by
+ * copy, and older sends are waited for before the writer reaches their
+ * slices. Each send uses its own metadata block until completed.
+ *
+ * With COMPRESS, a TCP_CODEC_HANDSHAKE is sent after the image metadata and
+ * the codec accepted by the receiver is used. Each frame is compressed into
+ * one of NETWORKTRANSMIT_CODEC_NBBUFF buffers and sent by a separate thread.
+ * Frames that do not compress below TCP_CODEC_MAXRATIO are sent raw.
+ * COMPRESS takes precedence over COPYSEND, BATCH and ZEROCOPY.
  */
 
 
@@ -321,7 +557,32 @@ imageID COREMOD_MEMORY_image_NETWORKtransmit(
 
     TCP_BUFFER_METADATA *frame_md;
     long       framesize1; // pixel data + metadata
-    char      *buff; // transmit buffer
+    char      *buff = NULL; // transmit buffer (COPYSEND mode)
+
+    struct iovec iov[2 * NETWORKTRANSMIT_BATCHMAX];
+    int        sendflags = 0;
+    uint64_t   cnt0sent = 0;     // cnt0 of last frame sent
+    long       NBframesent = 0;
+    long       NBsendcall = 0;
+    uint64_t   zcissued = 0;     // zero-copy sendmsg() calls issued
+    uint64_t   zccompleted = 0;  // zero-copy sendmsg() calls completed
+    int        zccopied = 0;     // kernel fell back to copy
+    TCP_BUFFER_METADATA *zcmd = NULL; // per-send metadata blocks
+    uint64_t   zcmdcall[NETWORKTRANSMIT_ZEROCOPY_NBMD];  // zcissued after block send
+    uint64_t   zcmdcnt0[NETWORKTRANSMIT_ZEROCOPY_NBMD];  // cnt0 of block oldest frame
+    long       zcblock = 0;      // next metadata block
+
+    int        codecOK = 0;      // codec negotiated with receiver
+    uint32_t   codec = TCP_CODEC_RAW;
+    NETWORKTRANSMIT_CODECSEND codecsend;
+    pthread_t  thread_codecsend;
+    int        codecthreadOK = 0;
+    int        cbindex = 0;      // next compressed buffer to fill
+    long       NBframeraw = 0;   // frames sent uncompressed
+    double     NBbyteraw = 0.0;  // uncompressed size of frames sent
+    double     NBbytewire = 0.0; // bytes sent
+
+    memset(&codecsend, 0, sizeof(codecsend));
 
 
     int        semtrig = 6; // TODO - scan for available sem
@@ -398,6 +659,23 @@ imageID COREMOD_MEMORY_image_NETWORKtransmit(
         loopOK = 0;
     }
 
+    if((loopOK == 1) && (mode & NETWORKTRANSMIT_MODE_ZEROCOPY)
+            && !(mode & NETWORKTRANSMIT_MODE_COPYSEND))
+    {
+        int zcflag = 1;
+        if(setsockopt(fds_client, SOL_SOCKET, SO_ZEROCOPY, &zcflag,
+                      sizeof(zcflag)) == 0)
+        {
+            sendflags |= MSG_ZEROCOPY;
+            processinfo_WriteMessage(processinfo, "zero-copy send enabled");
+        }
+        else
+        {
+            processinfo_WriteMessage(processinfo,
+                                     "SO_ZEROCOPY not supported, using copy");
+        }
+    }
+
     if(loopOK == 1)
     {
         memset((char *) &sock_server, 0, sizeof(sock_server));
@@ -429,6 +707,55 @@ imageID COREMOD_MEMORY_image_NETWORKtransmit(
         }
     }
 
+    if((loopOK == 1) && (mode & NETWORKTRANSMIT_MODE_COMPRESS))
+    {
+        // codec negotiation
+        TCP_CODEC_HANDSHAKE hs;
+        struct timeval      tv;
+
+        hs.magic = TCP_CODEC_MAGIC;
+        hs.codec = TCP_CODEC_DELTABITPACK;
+        if(stream_TCP_codec_supported(hs.codec,
+                                      data.image[ID].md[0].datatype) == 0)
+        {
+            hs.codec = TCP_CODEC_RAW;
+        }
+
+        if(send(fds_client, (void *) &hs, sizeof(hs), 0) != sizeof(hs))
+        {
+            processinfo_error(processinfo, "ERROR: codec handshake send() failed");
+            loopOK = 0;
+        }
+
+        if(loopOK == 1)
+        {
+            tv.tv_sec  = NETWORKTRANSMIT_CODECTIMEOUT;
+            tv.tv_usec = 0;
+            setsockopt(fds_client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+            if((recv(fds_client, (void *) &hs, sizeof(hs), MSG_WAITALL) != sizeof(hs))
+                    || (hs.magic != TCP_CODEC_MAGIC)
+                    || (stream_TCP_codec_supported(hs.codec,
+                                                   data.image[ID].md[0].datatype) == 0))
+            {
+                processinfo_error(processinfo,
+                                  "ERROR: no codec reply, receiver needs CODEC mode");
+                loopOK = 0;
+            }
+            else
+            {
+                char msgstring[200];
+                codec   = hs.codec;
+                codecOK = 1;
+                sprintf(msgstring, "codec %u accepted by receiver", codec);
+                processinfo_WriteMessage(processinfo, msgstring);
+            }
+
+            tv.tv_sec = 0;
+            setsockopt(fds_client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        }
+    }
+
 
     if(loopOK == 1)
     {
@@ -440,6 +767,15 @@ imageID COREMOD_MEMORY_image_NETWORKtransmit(
             {
                 NBslices = data.image[ID].md[0].size[2];
             }
+
+        if((sendflags & MSG_ZEROCOPY)
+                && (NBslices < NETWORKTRANSMIT_ZEROCOPY_MINSLICES))
+        {
+            // writer overwrites slices being sent
+            sendflags &= ~MSG_ZEROCOPY;
+            processinfo_WriteMessage(processinfo,
+                                     "zero-copy needs circular buffer, using copy");
+        }
     }
 
     if(loopOK == 1)
@@ -547,12 +883,57 @@ imageID COREMOD_MEMORY_image_NETWORKtransmit(
 
 
 
-        frame_md = (TCP_BUFFER_METADATA *) malloc(sizeof(TCP_BUFFER_METADATA));
+        frame_md = (TCP_BUFFER_METADATA *) malloc(sizeof(TCP_BUFFER_METADATA) *
+                   NETWORKTRANSMIT_BATCHMAX);
+        if(sendflags & MSG_ZEROCOPY)
+        {
+            zcmd = (TCP_BUFFER_METADATA *) malloc(sizeof(TCP_BUFFER_METADATA) *
+                                                  NETWORKTRANSMIT_BATCHMAX * NETWORKTRANSMIT_ZEROCOPY_NBMD);
+            if(zcmd == NULL)
+            {
+                PRINT_ERROR("malloc error");
+                abort();
+            }
+            for(int b = 0; b < NETWORKTRANSMIT_ZEROCOPY_NBMD; b++)
+            {
+                zcmdcall[b] = 0;
+                zcmdcnt0[b] = 0;
+            }
+        }
         framesize1 = framesize + sizeof(TCP_BUFFER_METADATA);
-        buff = (char *) malloc(sizeof(char) * framesize1);
+        if(mode & NETWORKTRANSMIT_MODE_COPYSEND)
+        {
+            buff = (char *) malloc(sizeof(char) * framesize1);
+            printf("transfer buffer size = %ld\n", framesize1);
+            fflush(stdout);
+        }
 
-        printf("transfer buffer size = %ld\n", framesize1);
-        fflush(stdout);
+        if(codecOK == 1)
+        {
+            long payloadmax = framesize;
+            if(codec == TCP_CODEC_DELTABITPACK)
+            {
+                payloadmax = stream_TCP_codec_maxsize((long) xsize * ysize);
+            }
+            for(int b = 0; b < NETWORKTRANSMIT_CODEC_NBBUFF; b++)
+            {
+                codecsend.buff[b] = (char *) malloc(sizeof(TCP_CODEC_FRAMEHEADER)
+                                                    + payloadmax + sizeof(TCP_BUFFER_METADATA));
+            }
+            codecsend.fd = fds_client;
+            sem_init(&codecsend.semfilled, 0, 0);
+            sem_init(&codecsend.semfree, 0, NETWORKTRANSMIT_CODEC_NBBUFF);
+            if(pthread_create(&thread_codecsend, NULL, NETWORKtransmit_codec_sendthread,
+                              (void *) &codecsend) != 0)
+            {
+                processinfo_error(processinfo, "ERROR: pthread_create() failed");
+                loopOK = 0;
+            }
+            else
+            {
+                codecthreadOK = 1;
+            }
+        }
 
         oldslice = 0;
         //sockOK = 1;
@@ -560,7 +941,7 @@ imageID COREMOD_MEMORY_image_NETWORKtransmit(
         fflush(stdout);
     }
 
-    if((data.image[ID].md[0].sem == 0) || (mode == 1))
+    if((data.image[ID].md[0].sem == 0) || (mode & NETWORKTRANSMIT_MODE_CNTSYNC))
     {
         processinfo_WriteMessage(processinfo, "sync using counter");
         UseSem = 0;
@@ -647,7 +1028,66 @@ imageID COREMOD_MEMORY_image_NETWORKtransmit(
         if(processinfo_compute_status(processinfo) == 1)
         {
 
-            if(semr == 0)
+            if((semr == 0) && (codecOK == 1))
+            {
+                // compress into free buffer, send thread does the rest
+                slice = data.image[ID].md[0].cnt1;
+                if(slice > NBslices - 1)
+                {
+                    slice = 0;
+                }
+                ptr1 = ptr0 + framesize * slice;
+
+                sem_wait(&codecsend.semfree);
+
+                char *cbuff = codecsend.buff[cbindex];
+                TCP_CODEC_FRAMEHEADER *fheader = (TCP_CODEC_FRAMEHEADER *) cbuff;
+                char *payload = cbuff + sizeof(TCP_CODEC_FRAMEHEADER);
+                long  payloadsize = -1;
+
+                frame_md[0].cnt0 = data.image[ID].md[0].cnt0;
+                frame_md[0].cnt1 = slice;
+
+                fheader->codec = codec;
+                if(codec == TCP_CODEC_DELTABITPACK)
+                {
+                    payloadsize = stream_TCP_codec_compress_16((uint16_t *) ptr1,
+                                  (long) xsize * ysize, (uint8_t *) payload);
+                }
+                if((payloadsize < 0) || (payloadsize > TCP_CODEC_MAXRATIO * framesize))
+                {
+                    // not worth it: send raw
+                    fheader->codec = TCP_CODEC_RAW;
+                    payloadsize = framesize;
+                    memcpy(payload, ptr1, framesize);
+                    NBframeraw ++;
+                }
+                fheader->size = payloadsize;
+                memcpy(payload + payloadsize, frame_md, sizeof(TCP_BUFFER_METADATA));
+
+                codecsend.buffsize[cbindex] = sizeof(TCP_CODEC_FRAMEHEADER) + payloadsize
+                                              + sizeof(TCP_BUFFER_METADATA);
+                NBbyteraw  += framesize1;
+                NBbytewire += codecsend.buffsize[cbindex];
+
+                sem_post(&codecsend.semfilled);
+                cbindex = (cbindex + 1) % NETWORKTRANSMIT_CODEC_NBBUFF;
+
+                if(codecsend.errflag == 1)
+                {
+                    sprintf(errmsg, "ERROR: compressed frame send failed");
+                    printf("%s\n", errmsg);
+                    fflush(stdout);
+                    processinfo_WriteMessage(processinfo, errmsg);
+                    loopOK = 0;
+                }
+                oldslice = slice;
+                NBframesent ++;
+                NBsendcall ++;
+            }
+
+
+            if((semr == 0) && (codecOK == 0) && (mode & NETWORKTRANSMIT_MODE_COPYSEND))
             {
                 frame_md[0].cnt0 = data.image[ID].md[0].cnt0;
                 frame_md[0].cnt1 = data.image[ID].md[0].cnt1;
@@ -692,6 +1132,144 @@ imageID COREMOD_MEMORY_image_NETWORKtransmit(
                     loopOK = 0;
                 }
                 oldslice = slice;
+                NBframesent ++;
+                NBsendcall ++;
+            }
+
+
+            if((semr == 0) && (codecOK == 0) && !(mode & NETWORKTRANSMIT_MODE_COPYSEND))
+            {
+                // scatter/gather send, pixel data read directly from stream
+                uint64_t cnt0now = data.image[ID].md[0].cnt0;
+
+                slice = data.image[ID].md[0].cnt1;
+                if(slice > NBslices - 1)
+                {
+                    slice = 0;
+                }
+
+                // number of frames to send
+                // older frames are only available in a circular buffer
+                long NBframe = 1;
+                if((mode & NETWORKTRANSMIT_MODE_BATCH) && (NBslices > 1) && (cnt0sent > 0))
+                {
+                    NBframe = cnt0now - cnt0sent;
+                    if(NBframe > NBslices - 1)
+                    {
+                        NBframe = NBslices - 1;
+                    }
+                    if(NBframe > NETWORKTRANSMIT_BATCHMAX)
+                    {
+                        NBframe = NETWORKTRANSMIT_BATCHMAX;
+                    }
+                    if(NBframe < 1)
+                    {
+                        NBframe = 1;
+                    }
+                    // consume semaphore posts for the extra frames
+                    if(UseSem == 1)
+                    {
+                        for(long fr = 1; fr < NBframe; fr++)
+                        {
+                            sem_trywait(data.image[ID].semptr[semtrig]);
+                        }
+                    }
+                }
+
+                TCP_BUFFER_METADATA *md = frame_md;
+                int flags = sendflags;
+                int zcb = 0;
+                if(sendflags & MSG_ZEROCOPY)
+                {
+                    // writer next writes frame cnt0now+1 into the slot of
+                    // frame cnt0now+1-NBslices : keep a one frame margin
+                    uint64_t lagmax = NBslices - 3;
+                    uint64_t target = 0;
+
+                    zcb = zcblock % NETWORKTRANSMIT_ZEROCOPY_NBMD;
+                    md = &zcmd[zcb * NETWORKTRANSMIT_BATCHMAX];
+
+                    // metadata block must be free, and pending sends must
+                    // complete before the writer reaches their slices
+                    target = zcmdcall[zcb];
+                    for(int b = 0; b < NETWORKTRANSMIT_ZEROCOPY_NBMD; b++)
+                    {
+                        if((zcmdcall[b] > zccompleted) && (cnt0now - zcmdcnt0[b] > lagmax)
+                                && (zcmdcall[b] > target))
+                        {
+                            target = zcmdcall[b];
+                        }
+                    }
+                    if(target > zccompleted)
+                    {
+                        if(NETWORKtransmit_zerocopy_wait(fds_client, &zccompleted, target,
+                                                         &zccopied) != 0)
+                        {
+                            processinfo_WriteMessage(processinfo,
+                                                     "zero-copy completion timeout");
+                        }
+                    }
+
+                    // oldest frame of this batch too close to writer: copy
+                    if((uint64_t)(NBframe - 1) > lagmax)
+                    {
+                        flags &= ~MSG_ZEROCOPY;
+                    }
+                }
+
+                long totsize = 0;
+                for(long fr = 0; fr < NBframe; fr++)
+                {
+                    long frslice = slice - (NBframe - 1) + fr;
+                    if(frslice < 0)
+                    {
+                        frslice += NBslices;
+                    }
+                    // counters are sent as zero by default, as legacy transmit
+                    md[fr].cnt0 = 0;
+                    md[fr].cnt1 = 0;
+                    if(mode & NETWORKTRANSMIT_MODE_SENDCNT)
+                    {
+                        md[fr].cnt0 = cnt0now - (NBframe - 1) + fr;
+                        md[fr].cnt1 = frslice;
+                    }
+
+                    iov[2 * fr].iov_base     = ptr0 + framesize * frslice;
+                    iov[2 * fr].iov_len      = framesize;
+                    iov[2 * fr + 1].iov_base = &md[fr];
+                    iov[2 * fr + 1].iov_len  = sizeof(TCP_BUFFER_METADATA);
+                    totsize += framesize1;
+                }
+
+                ssize_t srs = NETWORKtransmit_sendmsg_all(fds_client, iov, 2 * NBframe,
+                              flags, (flags & MSG_ZEROCOPY) ? &zcissued : NULL);
+                if(srs != totsize)
+                {
+                    perror("socket sendmsg error ");
+                    sprintf(errmsg,
+                            "ERROR: sendmsg() sent %ld bytes, expected %ld (%ld frames)",
+                            (long) srs, totsize, NBframe);
+                    printf("%s\n", errmsg);
+                    fflush(stdout);
+                    processinfo_WriteMessage(processinfo, errmsg);
+                    loopOK = 0;
+                }
+
+                if(flags & MSG_ZEROCOPY)
+                {
+                    zcmdcall[zcb] = zcissued;
+                    zcmdcnt0[zcb] = cnt0now - (NBframe - 1);
+                    zcblock ++;
+                }
+                if(sendflags & MSG_ZEROCOPY)
+                {
+                    zccompleted += NETWORKtransmit_zerocopy_reap(fds_client, &zccopied);
+                }
+
+                cnt0sent = cnt0now;
+                oldslice = slice;
+                NBframesent += NBframe;
+                NBsendcall ++;
             }
 
 
@@ -713,6 +1291,43 @@ imageID COREMOD_MEMORY_image_NETWORKtransmit(
     // ==================================
     // ENDING LOOP
     // ==================================
+    {
+        char msgstring[200];
+        snprintf(msgstring, 200, "%ld frames sent in %ld calls%s", NBframesent,
+                 NBsendcall, zccopied ? ", zerocopy fell back to copy" : "");
+        processinfo_WriteMessage(processinfo, msgstring);
+    }
+    if(codecthreadOK == 1)
+    {
+        // wait for buffers in flight, then stop send thread
+        for(int b = 0; b < NETWORKTRANSMIT_CODEC_NBBUFF; b++)
+        {
+            sem_wait(&codecsend.semfree);
+        }
+        codecsend.exitflag = 1;
+        sem_post(&codecsend.semfilled);
+        pthread_join(thread_codecsend, NULL);
+
+        char msgstring[200];
+        snprintf(msgstring, 200, "compression ratio %.2f, %ld frames sent raw",
+                 (NBbytewire > 0.0) ? NBbyteraw / NBbytewire : 0.0, NBframeraw);
+        processinfo_WriteMessage(processinfo, msgstring);
+    }
+    if(codecsend.buff[0] != NULL)
+    {
+        sem_destroy(&codecsend.semfilled);
+        sem_destroy(&codecsend.semfree);
+        for(int b = 0; b < NETWORKTRANSMIT_CODEC_NBBUFF; b++)
+        {
+            free(codecsend.buff[b]);
+        }
+    }
+    if(zcissued > zccompleted)
+    {
+        // wait for outstanding zero-copy sends before closing
+        NETWORKtransmit_zerocopy_wait(fds_client, &zccompleted, zcissued, &zccopied);
+    }
+
     processinfo_cleanExit(processinfo);
 
 
@@ -723,6 +1338,7 @@ imageID COREMOD_MEMORY_image_NETWORKtransmit(
     fflush(stdout);
 
     free(frame_md);
+    free(zcmd);
 
 
     return ID;
@@ -734,13 +1350,30 @@ imageID COREMOD_MEMORY_image_NETWORKtransmit(
 
 
 /** continuously receives 2D image through TCP link
- * mode = 1, force counter to be used for synchronization, ignore semaphores if they exist
+ *
+ * Default mode: frame received into temporary buffer, then copied to the
+ * slice given by the sender's metadata.
+ *
+ * mode NETWORKRECEIVE_MODE_DIRECT : frame is received with a single
+ * recvmsg() directly into the next slot of the output stream. For a
+ * circular buffer stream (3D), slots are filled in order independently of
+ * the sender slice index, and cnt1 is only updated once the frame is
+ * complete, so readers never see a partially received frame. For a 2D
+ * stream, md.write is set while the frame is in flight.
+ *
+ * mode NETWORKRECEIVE_MODE_CODEC : accept codec handshake from a transmitter
+ * running with NETWORKTRANSMIT_MODE_COMPRESS. Frames are decoded directly
+ * into the destination slot (next slot if combined with DIRECT).
+ *
+ * Transfer statistics (data rate, frame drops, inter-arrival jitter) are
+ * written to the processinfo iostat entries. In codec mode, the data rate
+ * is measured on the wire (compressed).
  */
 
 
 imageID COREMOD_MEMORY_image_NETWORKreceive(
     int port,
-    __attribute__((unused)) int mode,
+    int mode,
     int RT_priority
 )
 {
@@ -782,6 +1415,25 @@ imageID COREMOD_MEMORY_image_NETWORKreceive(
     struct sched_param schedpar;
 
 
+    // transfer statistics
+    struct timespec tstat0;         // start of statistics window
+    struct timespec tframeprev;     // previous frame arrival
+    long     statframecnt   = 0;    // frames in current window
+    long     statbytecnt    = 0;    // bytes in current window
+    double   statdtsum      = 0.0;  // inter-arrival sums [us]
+    double   statdtsum2     = 0.0;
+    long     statdtcnt      = 0;
+    uint64_t framecnt       = 0;
+    uint64_t framedrop      = 0;
+    uint64_t sendercnt0prev = 0;    // sender cnt0 of last frame, 0 if unknown
+
+    // codec mode
+    uint32_t codec = TCP_CODEC_RAW; // codec accepted in handshake
+    TCP_CODEC_FRAMEHEADER fheader;
+    char    *cbuff = NULL;          // compressed payload + metadata
+    long     cbuffsize = 0;
+
+
 
 
     PROCESSINFO *processinfo;
@@ -987,8 +1639,56 @@ imageID COREMOD_MEMORY_image_NETWORKreceive(
     }
 
 
+    if(mode & NETWORKRECEIVE_MODE_CODEC)
+    {
+        // codec handshake, reply with accepted codec
+        TCP_CODEC_HANDSHAKE hs;
+
+        if((recv(fds_client, (void *) &hs, sizeof(hs), MSG_WAITALL) != sizeof(hs))
+                || (hs.magic != TCP_CODEC_MAGIC))
+        {
+            char msgstring[200];
+
+            sprintf(msgstring, "ERROR receiving codec handshake");
+            printf("%s\n", msgstring);
+
+            if(data.processinfo == 1)
+            {
+                processinfo->loopstat = 4;
+                processinfo_WriteMessage(processinfo, msgstring);
+            }
+
+            exit(0);
+        }
+
+        if(stream_TCP_codec_supported(hs.codec, imgmd[0].datatype) == 0)
+        {
+            hs.codec = TCP_CODEC_RAW;
+        }
+        codec = hs.codec;
+
+        if(send(fds_client, (void *) &hs, sizeof(hs), 0) != sizeof(hs))
+        {
+            char msgstring[200];
+
+            sprintf(msgstring, "ERROR sending codec handshake");
+            printf("%s\n", msgstring);
+
+            if(data.processinfo == 1)
+            {
+                processinfo->loopstat = 4;
+                processinfo_WriteMessage(processinfo, msgstring);
+            }
+
+            exit(0);
+        }
+        printf("codec %u\n", codec);
+    }
+    else
 	{
 		// flush socket
+		// not done in codec mode: sender waits for handshake reply,
+		// so no stale data can be pending
 		
 		size_t flushsize = 1000;
 		
@@ -1195,6 +1895,7 @@ imageID COREMOD_MEMORY_image_NETWORKreceive(
         sprintf(processinfo->description, "%s %dx%dx%ld %s", imgmd[0].name, (int) xsize,
                 (int) ysize, NBslices, typestring);
         processinfo_WriteMessage(processinfo, msgstring);
+        processinfo->iostat_dtwindow_s = NETWORKRECEIVE_STATWINDOW;
     }
 
 
@@ -1207,6 +1908,25 @@ imageID COREMOD_MEMORY_image_NETWORKreceive(
 
     frame_md = (TCP_BUFFER_METADATA *) (buff + framesize);
 
+    if(mode & NETWORKRECEIVE_MODE_DIRECT)
+    {
+        printf("Receiving directly into stream, %ld slot(s)\n", NBslices);
+    }
+
+    if(mode & NETWORKRECEIVE_MODE_CODEC)
+    {
+        long payloadmax = framesize;
+        if(codec == TCP_CODEC_DELTABITPACK)
+        {
+            payloadmax = stream_TCP_codec_maxsize((long) xsize * ysize);
+        }
+        cbuffsize = payloadmax + sizeof(TCP_BUFFER_METADATA);
+        cbuff = (char *) malloc(sizeof(char) * cbuffsize);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &tstat0);
+    tframeprev = tstat0;
+
 
 
     if(data.processinfo == 1)
@@ -1239,10 +1959,87 @@ imageID COREMOD_MEMORY_image_NETWORKreceive(
         }
 
 
-        if((recvsize = recv(fds_client, buff, framesize1, MSG_WAITALL)) < 0)
+        long slotnext = 0; // DIRECT and CODEC modes: slot being written
+        long expectsize = framesize1;
+        if(mode & NETWORKRECEIVE_MODE_CODEC)
         {
-            printf("ERROR recv()\n");
-            socketOpen = 0;
+            // frame header, then payload and metadata
+            recvsize = recv(fds_client, (void *) &fheader, sizeof(fheader), MSG_WAITALL);
+            if(recvsize < 0)
+            {
+                printf("ERROR recv()\n");
+                socketOpen = 0;
+            }
+            else if(recvsize == sizeof(fheader))
+            {
+                expectsize = sizeof(fheader) + fheader.size + sizeof(TCP_BUFFER_METADATA);
+                if((fheader.codec != codec)
+                        && !((fheader.codec == TCP_CODEC_RAW) && (fheader.size == framesize)))
+                {
+                    // frame must use codec agreed at handshake, or be sent
+                    // uncompressed (transmitter falls back to RAW when the
+                    // frame does not compress)
+                    printf("ERROR frame codec %u, expected %u\n", fheader.codec, codec);
+                    socketOpen = 0;
+                }
+                else if((long) fheader.size > cbuffsize - (long) sizeof(TCP_BUFFER_METADATA))
+                {
+                    printf("ERROR frame payload size %u exceeds buffer\n", fheader.size);
+                    socketOpen = 0;
+                }
+                else
+                {
+                    long rs = recv(fds_client, cbuff, fheader.size + sizeof(TCP_BUFFER_METADATA),
+                                   MSG_WAITALL);
+                    if(rs < 0)
+                    {
+                        printf("ERROR recv()\n");
+                        socketOpen = 0;
+                    }
+                    else
+                    {
+                        recvsize += rs;
+                    }
+                }
+            }
+        }
+        else if(mode & NETWORKRECEIVE_MODE_DIRECT)
+        {
+            struct iovec iov[2];
+            struct msghdr msg;
+
+            slotnext = 0;
+            if(NBslices > 1)
+            {
+                slotnext = (data.image[ID].md[0].cnt1 + 1) % NBslices;
+            }
+            else
+            {
+                data.image[ID].md[0].write = 1;
+            }
+
+            iov[0].iov_base = ptr0 + framesize * slotnext;
+            iov[0].iov_len  = framesize;
+            iov[1].iov_base = frame_md;
+            iov[1].iov_len  = sizeof(TCP_BUFFER_METADATA);
+
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov    = iov;
+            msg.msg_iovlen = 2;
+
+            if((recvsize = recvmsg(fds_client, &msg, MSG_WAITALL)) < 0)
+            {
+                printf("ERROR recvmsg()\n");
+                socketOpen = 0;
+            }
+        }
+        else
+        {
+            if((recvsize = recv(fds_client, buff, framesize1, MSG_WAITALL)) < 0)
+            {
+                printf("ERROR recv()\n");
+                socketOpen = 0;
+            }
         }
 
 
@@ -1260,11 +2057,127 @@ imageID COREMOD_MEMORY_image_NETWORKreceive(
             socketOpen = 0;
         }
 
+        if((socketOpen == 1) && (recvsize != expectsize))
+        {
+            // connection closed mid-frame
+            printf("ERROR recv() incomplete frame %ld / %ld bytes\n", recvsize, expectsize);
+            socketOpen = 0;
+        }
+
+        if((socketOpen == 1) && (mode & NETWORKRECEIVE_MODE_CODEC))
+        {
+            // decode into destination slot
+            frame_md = (TCP_BUFFER_METADATA *) (cbuff + fheader.size);
+
+            if(mode & NETWORKRECEIVE_MODE_DIRECT)
+            {
+                slotnext = 0;
+                if(NBslices > 1)
+                {
+                    slotnext = (data.image[ID].md[0].cnt1 + 1) % NBslices;
+                }
+            }
+            else
+            {
+                slotnext = frame_md[0].cnt1;
+                if((slotnext < 0) || (slotnext > NBslices - 1))
+                {
+                    slotnext = 0;
+                }
+            }
+            data.image[ID].md[0].write = 1;
+
+            char *ptr1 = ptr0 + framesize * slotnext;
+            if((fheader.codec == TCP_CODEC_DELTABITPACK)
+                    && (stream_TCP_codec_supported(TCP_CODEC_DELTABITPACK,
+                            data.image[ID].md[0].datatype) == 1)
+                    && (framesize == (long) sizeof(uint16_t) * xsize * ysize))
+            {
+                if(stream_TCP_codec_decompress_16((uint8_t *) cbuff, fheader.size,
+                                                  (uint16_t *) ptr1, (long) xsize * ysize) != RETURN_SUCCESS)
+                {
+                    printf("ERROR corrupted compressed frame\n");
+                    socketOpen = 0;
+                }
+            }
+            else if((fheader.codec == TCP_CODEC_RAW) && (fheader.size == framesize))
+            {
+                memcpy(ptr1, cbuff, framesize);
+            }
+            else
+            {
+                printf("ERROR unexpected codec %u, size %u\n", fheader.codec, fheader.size);
+                socketOpen = 0;
+            }
+        }
+
         if(socketOpen == 1)
         {
-            frame_md = (TCP_BUFFER_METADATA *) (buff + framesize);
+            struct timespec tframe;
+            clock_gettime(CLOCK_MONOTONIC, &tframe);
+
+            if(framecnt > 0)
+            {
+                double dtus = 1.0e6 * (tframe.tv_sec - tframeprev.tv_sec)
+                              + 1.0e-3 * (tframe.tv_nsec - tframeprev.tv_nsec);
+                statdtsum += dtus;
+                statdtsum2 += dtus * dtus;
+                statdtcnt ++;
+            }
+            tframeprev = tframe;
+            framecnt ++;
+            statframecnt ++;
+            statbytecnt += recvsize;
+
+            // sender cnt0 is 0 for legacy transmit, drops cannot be detected
+            if((frame_md[0].cnt0 > 0) && (sendercnt0prev > 0)
+                    && ((uint64_t) frame_md[0].cnt0 > sendercnt0prev + 1))
+            {
+                framedrop += frame_md[0].cnt0 - sendercnt0prev - 1;
+            }
+            sendercnt0prev = frame_md[0].cnt0;
+
+            double dtstat = 1.0 * (tframe.tv_sec - tstat0.tv_sec)
+                            + 1.0e-9 * (tframe.tv_nsec - tstat0.tv_nsec);
+            if((data.processinfo == 1) && (dtstat > NETWORKRECEIVE_STATWINDOW))
+            {
+                processinfo->iostat_bytepersec  = statbytecnt / dtstat;
+                processinfo->iostat_framepersec = statframecnt / dtstat;
+                processinfo->iostat_framecnt    = framecnt;
+                processinfo->iostat_framedrop   = framedrop;
+                if(statdtcnt > 0)
+                {
+                    double dtmean = statdtsum / statdtcnt;
+                    double dtvar  = statdtsum2 / statdtcnt - dtmean * dtmean;
+                    processinfo->iostat_dtmean_us   = dtmean;
+                    processinfo->iostat_dtjitter_us = (dtvar > 0.0) ? sqrt(dtvar) : 0.0;
+                }
+                tstat0       = tframe;
+                statframecnt = 0;
+                statbytecnt  = 0;
+                statdtsum    = 0.0;
+                statdtsum2   = 0.0;
+                statdtcnt    = 0;
+            }
+        }
 
+        if((socketOpen == 1)
+                && (mode & (NETWORKRECEIVE_MODE_DIRECT | NETWORKRECEIVE_MODE_CODEC)))
+        {
+            // frame is complete in slot: publish with single update
+            data.image[ID].md[0].cnt1 = slotnext;
+            ImageStreamIO_UpdateIm(&data.image[ID]);
+        }
 
+        if((socketOpen == 1)
+                && !(mode & (NETWORKRECEIVE_MODE_DIRECT | NETWORKRECEIVE_MODE_CODEC)))
+        {
+            frame_md = (TCP_BUFFER_METADATA *) (buff + framesize);
+
+            if((frame_md[0].cnt1 < 0) || (frame_md[0].cnt1 > NBslices - 1))
+            {
+                frame_md[0].cnt1 = 0;
+            }
             data.image[ID].md[0].cnt1 = frame_md[0].cnt1;
 
 
@@ -1385,6 +2298,7 @@ imageID COREMOD_MEMORY_image_NETWORKreceive(
 
 
     free(buff);
+    free(cbuff);
 
     close(fds_client);
 
@@ -6,6 +6,59 @@
 #define _STREAM_TCP_H
 
 
+// NETWORKtransmit mode flags (can be combined)
+
+// force counter to be used for synchronization, ignore semaphores
+#define NETWORKTRANSMIT_MODE_CNTSYNC   0x0001
+
+// legacy transmit: copy frame + metadata to buffer, then send()
+// metadata counters are sent as zero
+#define NETWORKTRANSMIT_MODE_COPYSEND  0x0002
+
+// use MSG_ZEROCOPY (kernel 4.14+), falls back to copy if not supported
+#define NETWORKTRANSMIT_MODE_ZEROCOPY  0x0004
+
+// coalesce pending circular buffer slices into a single sendmsg()
+#define NETWORKTRANSMIT_MODE_BATCH     0x0008
+
+// compress frames (lossless), codec negotiated with receiver
+// receiver must run with NETWORKRECEIVE_MODE_CODEC
+#define NETWORKTRANSMIT_MODE_COMPRESS  0x0010
+
+// send source cnt0 and slice index in frame metadata (zero otherwise)
+// older receivers write each frame to slot cnt1 : only use with
+// receivers built with this option, or single-slice streams
+// always on with NETWORKTRANSMIT_MODE_COMPRESS
+#define NETWORKTRANSMIT_MODE_SENDCNT   0x0020
+
+// max number of frames coalesced in a single sendmsg()
+#define NETWORKTRANSMIT_BATCHMAX 16
+
+// zero-copy: max number of sends in flight, each with its own metadata
+#define NETWORKTRANSMIT_ZEROCOPY_NBMD 16
+
+// zero-copy: min number of circular buffer slices, copy send otherwise
+#define NETWORKTRANSMIT_ZEROCOPY_MINSLICES 4
+
+// codec handshake reply timeout [sec]
+#define NETWORKTRANSMIT_CODECTIMEOUT 5
+
+
+
+// NETWORKreceive mode flags
+
+// receive directly into the next slot of the output stream
+// cnt1 is the index of the last complete slot
+#define NETWORKRECEIVE_MODE_DIRECT     0x0002
+
+// accept codec handshake from transmitter (NETWORKTRANSMIT_MODE_COMPRESS)
+// each frame is preceded by a TCP_CODEC_FRAMEHEADER
+#define NETWORKRECEIVE_MODE_CODEC      0x0004
+
+// transfer statistics update interval [sec]
+#define NETWORKRECEIVE_STATWINDOW 1.0
+
+
 errno_t stream__TCP_addCLIcmd();
 
 
@@ -0,0 +1,71 @@
+/**
+ * @file    stream_TCP_codec.h
+ * @brief   lossless frame codec for TCP stream transfer
+ */
+
+#ifndef _STREAM_TCP_CODEC_H
+#define _STREAM_TCP_CODEC_H
+
+#include <stdint.h>
+
+
+// codec identifiers
+#define TCP_CODEC_RAW          0 // uncompressed
+#define TCP_CODEC_DELTABITPACK 1 // pixel delta + zigzag + block bit-packing (16-bit types)
+
+// handshake magic number ("MLKC")
+#define TCP_CODEC_MAGIC 0x434b4c4d
+
+// number of pixels per bit-packing block
+#define TCP_CODEC_BLOCKSIZE 128
+
+// frames compressing to more than this fraction of raw size are sent raw
+#define TCP_CODEC_MAXRATIO 0.9
+
+
+
+/** @brief Codec handshake, sent by transmitter after IMAGE_METADATA
+ *
+ * Receiver replies with the same structure, codec set to the codec
+ * it accepts (TCP_CODEC_RAW if requested codec is not supported).
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t codec;
+} TCP_CODEC_HANDSHAKE;
+
+
+/** @brief Per-frame header, precedes payload when codec is negotiated
+ */
+typedef struct
+{
+    uint32_t codec; // codec used for this frame
+    uint32_t size;  // payload size [byte]
+} TCP_CODEC_FRAMEHEADER;
+
+
+
+int stream_TCP_codec_supported(
+    uint32_t codec,
+    uint8_t  datatype
+);
+
+long stream_TCP_codec_maxsize(
+    long nelement
+);
+
+long stream_TCP_codec_compress_16(
+    const uint16_t *in,
+    long            nelement,
+    uint8_t        *out
+);
+
+errno_t stream_TCP_codec_decompress_16(
+    const uint8_t *in,
+    long           insize,
+    uint16_t      *out,
+    long           nelement
+);
+
+#endif
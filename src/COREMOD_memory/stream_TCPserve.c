@@ -0,0 +1,1326 @@
+/**
+ * @file    stream_TCPserve.c
+ * @brief   multi-subscriber TCP stream server
+ *
+ * A single server process listens on a port and serves any number of
+ * streams to any number of clients. Each client sends one or more
+ * subscription requests (stream name + decimation factor), and receives
+ * the stream metadata followed by frames.
+ *
+ * Each new frame is read once from shared memory into a snapshot buffer,
+ * which is then referenced by the output queue of every client that
+ * should receive it. Sockets are non-blocking and driven by epoll, so a
+ * slow client only drops its own frames.
+ */
+
+
+#include <pthread.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+
+
+#include "CommandLineInterface/CLIcore.h"
+#include "image_ID.h"
+#include "create_image.h"
+#include "delete_image.h"
+#include "read_shmim.h"
+#include "stream_sem.h"
+#include "stream_TCPserve.h"
+
+
+
+// epoll event types, stored in upper 32 bits of epoll data
+#define NETWORKSERVE_EVTYPE_LISTEN 1
+#define NETWORKSERVE_EVTYPE_CLIENT 2
+#define NETWORKSERVE_EVTYPE_STREAM 3
+
+#define NETWORKSERVE_EVTAG(type, index) ((((uint64_t) (type)) << 32) | ((uint64_t) (index)))
+
+#define NETWORKSERVE_MAXEVENT 64
+
+
+
+typedef struct
+{
+    int       used;
+    char      name[STRINGMAXLEN_IMAGE_NAME];
+    imageID   ID;
+    long      framesize;
+    long      NBslices;
+    char     *ptr0;
+    uint64_t  cnt0;                    // cnt0 of last frame processed
+
+    int       semindex;
+    int       evfd;                    // eventfd written by watch thread
+    int       exitflag;
+    pthread_t thread_watch;
+
+    char     *snap[NETWORKSERVE_MAXSNAP]; // frame snapshots
+    int       snaprefcnt[NETWORKSERVE_MAXSNAP]; // client queue references
+    int       NBsnap;
+
+    uint64_t  NBframe;
+    uint64_t  NBframedrop;             // no free snapshot
+} NETWORKSERVE_STREAM;
+
+
+typedef struct
+{
+    // frame header, or subscription reply + metadata
+    char hdr[sizeof(NETWORKSERVE_REPLY) + sizeof(IMAGE_METADATA)];
+    long hdrsize;
+    int  streamindex;                  // -1 if no pixel data
+    int  snapindex;
+} NETWORKSERVE_QENTRY;
+
+
+typedef struct
+{
+    int      subindex;                 // client request index
+    int      streamindex;
+    uint32_t decimation;
+    uint32_t deccnt;
+    int      pending;                  // frame to be queued
+} NETWORKSERVE_SUB;
+
+
+typedef struct
+{
+    int      fd;                       // -1 if unused
+    int      NBrequest;
+    int      NBsub;
+    NETWORKSERVE_SUB sub[NETWORKSERVE_MAXSUB];
+
+    char     rxbuff[sizeof(NETWORKSERVE_SUBSCRIBE)];
+    long     rxsize;
+
+    NETWORKSERVE_QENTRY queue[NETWORKSERVE_QUEUESIZE];
+    int      qhead;
+    int      qlen;
+    int      qframe;                   // number of frames in queue
+    long     qoffset;                  // bytes of queue head already sent
+    int      epollout;
+    int      rxpause;                  // 1 if requests not read: queue full
+
+    uint64_t NBframesent;
+    uint64_t NBframedrop;              // queue full
+} NETWORKSERVE_CLIENT;
+
+
+typedef struct
+{
+    int                 epfd;
+    int                 NBclient;
+    int                 NBstream;
+    NETWORKSERVE_STREAM stream[NETWORKSERVE_MAXSTREAM];
+    NETWORKSERVE_CLIENT client[NETWORKSERVE_MAXCLIENT];
+} NETWORKSERVE_SERVER;
+
+
+
+
+
+// ==========================================
+// Command line interface wrapper function(s)
+// ==========================================
+
+
+static errno_t COREMOD_MEMORY_image_NETWORKserve__cli()
+{
+    if(0
+            + CLI_checkarg(1, CLIARG_LONG)
+            + CLI_checkarg(2, CLIARG_LONG)
+            == 0)
+    {
+        COREMOD_MEMORY_image_NETWORKserve(
+            data.cmdargtoken[1].val.numl,
+            data.cmdargtoken[2].val.numl
+        );
+        return CLICMD_SUCCESS;
+    }
+    else
+    {
+        return CLICMD_INVALID_ARG;
+    }
+}
+
+
+static errno_t COREMOD_MEMORY_image_NETWORKsubscribe__cli()
+{
+    if(0
+            + CLI_checkarg(1, CLIARG_STR_NOT_IMG)
+            + CLI_checkarg(2, CLIARG_LONG)
+            + CLI_checkarg(3, CLIARG_STR_NOT_IMG)
+            + CLI_checkarg(4, CLIARG_LONG)
+            == 0)
+    {
+        COREMOD_MEMORY_image_NETWORKsubscribe(
+            data.cmdargtoken[1].val.string,
+            data.cmdargtoken[2].val.numl,
+            data.cmdargtoken[3].val.string,
+            data.cmdargtoken[4].val.numl
+        );
+        return CLICMD_SUCCESS;
+    }
+    else
+    {
+        return CLICMD_INVALID_ARG;
+    }
+}
+
+
+
+
+// ==========================================
+// Register CLI command(s)
+// ==========================================
+
+errno_t stream_TCPserve_addCLIcmd()
+{
+    RegisterCLIcommand(
+        "imnetwserve",
+        __FILE__,
+        COREMOD_MEMORY_image_NETWORKserve__cli,
+        "serve streams to multiple network clients",
+        "<port [long]> <RT priority>",
+        "imnetwserve 8890 0",
+        "errno_t COREMOD_MEMORY_image_NETWORKserve(int port, int RT_priority)");
+
+    RegisterCLIcommand(
+        "imnetwsubscribe",
+        __FILE__,
+        COREMOD_MEMORY_image_NETWORKsubscribe__cli,
+        "subscribe to stream(s) from network stream server",
+        "<IP addr> <port [long]> <stream1,stream2,...> <decimation [long]>",
+        "imnetwsubscribe 127.0.0.1 8890 im1,im2 1",
+        "errno_t COREMOD_MEMORY_image_NETWORKsubscribe(const char *IPaddr, int port, const char *streamlist, int decimation)");
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+
+
+
+/** @brief Wait for stream semaphore, notify server loop through eventfd
+ */
+static void *NETWORKserve_watchthread(
+    void *ptr
+)
+{
+    NETWORKSERVE_STREAM *stream = (NETWORKSERVE_STREAM *) ptr;
+    IMAGE               *image = &data.image[stream->ID];
+    uint64_t             one = 1;
+
+    while(stream->exitflag == 0)
+    {
+        struct timespec ts;
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += 1;
+
+        if(ImageStreamIO_semtimedwait(image, stream->semindex, &ts) == 0)
+        {
+            if(write(stream->evfd, &one, sizeof(one)) < 0)
+            {
+                perror("eventfd write");
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+
+/** @brief Find or open served stream
+ *
+ * Returns stream index, -1 if stream cannot be served.
+ */
+static int NETWORKserve_stream_open(
+    NETWORKSERVE_SERVER *server,
+    const char          *name
+)
+{
+    int si;
+    int sifree = -1;
+
+    for(si = 0; si < NETWORKSERVE_MAXSTREAM; si++)
+    {
+        if(server->stream[si].used == 1)
+        {
+            if(strcmp(server->stream[si].name, name) == 0)
+            {
+                return si;
+            }
+        }
+        else if(sifree == -1)
+        {
+            sifree = si;
+        }
+    }
+    if(sifree == -1)
+    {
+        return -1;
+    }
+
+
+    imageID ID = image_ID(name);
+    if(ID == -1)
+    {
+        ID = read_sharedmem_image(name);
+    }
+    if(ID == -1)
+    {
+        return -1;
+    }
+    if(data.image[ID].md[0].sem == 0)
+    {
+        COREMOD_MEMORY_image_set_createsem(name, IMAGE_NB_SEMAPHORE);
+    }
+
+
+    NETWORKSERVE_STREAM *stream = &server->stream[sifree];
+    memset(stream, 0, sizeof(NETWORKSERVE_STREAM));
+
+    strncpy(stream->name, name, STRINGMAXLEN_IMAGE_NAME - 1);
+    stream->ID = ID;
+    stream->NBslices = 1;
+    if(data.image[ID].md[0].naxis > 2)
+        if(data.image[ID].md[0].size[2] > 1)
+        {
+            stream->NBslices = data.image[ID].md[0].size[2];
+        }
+    stream->framesize = ImageStreamIO_typesize(data.image[ID].md[0].datatype)
+                        * (data.image[ID].md[0].nelement / stream->NBslices);
+    stream->ptr0     = (char *) data.image[ID].array.raw;
+    stream->cnt0     = data.image[ID].md[0].cnt0; // do not serve stale frame
+    stream->semindex = ImageStreamIO_getsemwaitindex(&data.image[ID], -1);
+    if(stream->semindex == -1)
+    {
+        printf("ERROR: stream %s: no semaphore available\n", name);
+        return -1;
+    }
+
+    stream->evfd = eventfd(0, EFD_NONBLOCK);
+    if(stream->evfd == -1)
+    {
+        perror("eventfd");
+        return -1;
+    }
+
+    struct epoll_event ev;
+    ev.events   = EPOLLIN;
+    ev.data.u64 = NETWORKSERVE_EVTAG(NETWORKSERVE_EVTYPE_STREAM, sifree);
+    epoll_ctl(server->epfd, EPOLL_CTL_ADD, stream->evfd, &ev);
+
+    if(pthread_create(&stream->thread_watch, NULL, NETWORKserve_watchthread,
+                      (void *) stream) != 0)
+    {
+        epoll_ctl(server->epfd, EPOLL_CTL_DEL, stream->evfd, NULL);
+        close(stream->evfd);
+        return -1;
+    }
+
+    stream->used = 1;
+    server->NBstream ++;
+
+    printf("Serving stream %s, frame size %ld, sem %d\n", name, stream->framesize,
+           stream->semindex);
+
+    return sifree;
+}
+
+
+
+/** @brief Queue entry at tail of client queue
+ *
+ * At most NETWORKSERVE_QUEUELEN frames are queued, remaining entries are
+ * kept for subscription replies.
+ *
+ * Returns NULL if queue is full.
+ */
+static NETWORKSERVE_QENTRY *NETWORKserve_client_queuetail(
+    NETWORKSERVE_CLIENT *client,
+    int                  isframe
+)
+{
+    if(client->qlen == NETWORKSERVE_QUEUESIZE)
+    {
+        return NULL;
+    }
+    if((isframe == 1) && (client->qframe == NETWORKSERVE_QUEUELEN))
+    {
+        return NULL;
+    }
+
+    NETWORKSERVE_QENTRY *entry =
+        &client->queue[(client->qhead + client->qlen) % NETWORKSERVE_QUEUESIZE];
+    client->qlen ++;
+    if(isframe == 1)
+    {
+        client->qframe ++;
+    }
+
+    return entry;
+}
+
+
+
+/** @brief Close client connection and release its queued frames
+ */
+static void NETWORKserve_client_close(
+    NETWORKSERVE_SERVER *server,
+    int                  ci
+)
+{
+    NETWORKSERVE_CLIENT *client = &server->client[ci];
+
+    for(int q = 0; q < client->qlen; q++)
+    {
+        NETWORKSERVE_QENTRY *entry =
+            &client->queue[(client->qhead + q) % NETWORKSERVE_QUEUESIZE];
+        if(entry->streamindex >= 0)
+        {
+            server->stream[entry->streamindex].snaprefcnt[entry->snapindex] --;
+        }
+    }
+
+    printf("client %d closed: %lu frames sent, %lu dropped\n", ci,
+           (unsigned long) client->NBframesent, (unsigned long) client->NBframedrop);
+
+    epoll_ctl(server->epfd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+
+    memset(client, 0, sizeof(NETWORKSERVE_CLIENT));
+    client->fd = -1;
+    server->NBclient --;
+}
+
+
+
+/** @brief Process subscription request in client receive buffer
+ *
+ * Reply (and stream metadata) is queued to client.
+ */
+static errno_t NETWORKserve_client_request(
+    NETWORKSERVE_SERVER *server,
+    NETWORKSERVE_CLIENT *client
+)
+{
+    NETWORKSERVE_SUBSCRIBE *req = (NETWORKSERVE_SUBSCRIBE *) client->rxbuff;
+    NETWORKSERVE_REPLY      reply;
+    int                     si = -1;
+
+    if(req->magic != NETWORKSERVE_MAGIC)
+    {
+        return RETURN_FAILURE;
+    }
+    req->name[STRINGMAXLEN_IMAGE_NAME - 1] = '\0';
+
+    reply.magic  = NETWORKSERVE_MAGIC;
+    reply.status = -1;
+
+    if(client->NBsub < NETWORKSERVE_MAXSUB)
+    {
+        si = NETWORKserve_stream_open(server, req->name);
+    }
+    if(si >= 0)
+    {
+        NETWORKSERVE_SUB *sub = &client->sub[client->NBsub];
+        sub->subindex    = client->NBrequest;
+        sub->streamindex = si;
+        sub->decimation  = (req->decimation > 0) ? req->decimation : 1;
+        sub->deccnt      = 0;
+        sub->pending     = 0;
+        client->NBsub ++;
+        reply.status = 0;
+    }
+    client->NBrequest ++;
+
+    // caller checks queue is not full before reading request
+    NETWORKSERVE_QENTRY *entry = NETWORKserve_client_queuetail(client, 0);
+    if(entry == NULL)
+    {
+        return RETURN_FAILURE;
+    }
+    memcpy(entry->hdr, &reply, sizeof(NETWORKSERVE_REPLY));
+    entry->hdrsize     = sizeof(NETWORKSERVE_REPLY);
+    entry->streamindex = -1;
+    entry->snapindex   = -1;
+    if(si >= 0)
+    {
+        memcpy(entry->hdr + sizeof(NETWORKSERVE_REPLY),
+               data.image[server->stream[si].ID].md, sizeof(IMAGE_METADATA));
+        entry->hdrsize += sizeof(IMAGE_METADATA);
+    }
+
+    return RETURN_SUCCESS;
+}
+
+
+
+/** @brief Send queued data to client until queue is empty or socket is full
+ *
+ * Returns 0 if OK, -1 if connection should be closed.
+ */
+static int NETWORKserve_client_flush(
+    NETWORKSERVE_SERVER *server,
+    NETWORKSERVE_CLIENT *client
+)
+{
+    while(client->qlen > 0)
+    {
+        NETWORKSERVE_QENTRY *entry = &client->queue[client->qhead];
+        char         *pixdata  = NULL;
+        long          datasize = 0;
+        struct iovec  iov[2];
+        int           iovcnt = 0;
+        long          offset = client->qoffset;
+
+        if(entry->streamindex >= 0)
+        {
+            pixdata  = server->stream[entry->streamindex].snap[entry->snapindex];
+            datasize = server->stream[entry->streamindex].framesize;
+        }
+
+        if(offset < entry->hdrsize)
+        {
+            iov[iovcnt].iov_base = entry->hdr + offset;
+            iov[iovcnt].iov_len  = entry->hdrsize - offset;
+            iovcnt ++;
+            offset = 0;
+        }
+        else
+        {
+            offset -= entry->hdrsize;
+        }
+        if(datasize > 0)
+        {
+            iov[iovcnt].iov_base = pixdata + offset;
+            iov[iovcnt].iov_len  = datasize - offset;
+            iovcnt ++;
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov    = iov;
+        msg.msg_iovlen = iovcnt;
+
+        ssize_t rs = sendmsg(client->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if(rs < 0)
+        {
+            if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                return 0;
+            }
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+
+        client->qoffset += rs;
+        if(client->qoffset == entry->hdrsize + datasize)
+        {
+            // entry fully sent
+            if(entry->streamindex >= 0)
+            {
+                server->stream[entry->streamindex].snaprefcnt[entry->snapindex] --;
+                client->NBframesent ++;
+                client->qframe --;
+            }
+            client->qhead = (client->qhead + 1) % NETWORKSERVE_QUEUESIZE;
+            client->qlen --;
+            client->qoffset = 0;
+        }
+    }
+
+    return 0;
+}
+
+
+
+/** @brief Watch for writability only while client has pending output
+ *
+ * Requests are not read while queue is full, they stay in socket until
+ * queued output has been sent.
+ */
+static void NETWORKserve_client_epollout(
+    NETWORKSERVE_SERVER *server,
+    int                  ci
+)
+{
+    NETWORKSERVE_CLIENT *client = &server->client[ci];
+    int epollout = (client->qlen > 0) ? 1 : 0;
+    int rxpause  = (client->qlen == NETWORKSERVE_QUEUESIZE) ? 1 : 0;
+
+    if((epollout != client->epollout) || (rxpause != client->rxpause))
+    {
+        struct epoll_event ev;
+        ev.events   = (rxpause ? 0 : EPOLLIN) | (epollout ? EPOLLOUT : 0);
+        ev.data.u64 = NETWORKSERVE_EVTAG(NETWORKSERVE_EVTYPE_CLIENT, ci);
+        epoll_ctl(server->epfd, EPOLL_CTL_MOD, client->fd, &ev);
+        client->epollout = epollout;
+        client->rxpause  = rxpause;
+    }
+}
+
+
+
+/** @brief Dispatch new stream frame to subscribed clients
+ *
+ * Frame is copied once from shared memory to a snapshot, shared by all
+ * client queues.
+ */
+static void NETWORKserve_stream_newframe(
+    NETWORKSERVE_SERVER *server,
+    int                  si
+)
+{
+    NETWORKSERVE_STREAM *stream = &server->stream[si];
+    IMAGE               *image = &data.image[stream->ID];
+
+    uint64_t cnt0 = image->md[0].cnt0;
+    if(cnt0 == stream->cnt0)
+    {
+        return;
+    }
+    stream->cnt0 = cnt0;
+    stream->NBframe ++;
+
+    long slice = 0;
+    if(stream->NBslices > 1)
+    {
+        slice = image->md[0].cnt1;
+        if((slice < 0) || (slice > stream->NBslices - 1))
+        {
+            slice = 0;
+        }
+    }
+
+    // which subscriptions want this frame ?
+    int NBdeliver = 0;
+    for(int ci = 0; ci < NETWORKSERVE_MAXCLIENT; ci++)
+    {
+        NETWORKSERVE_CLIENT *client = &server->client[ci];
+        if(client->fd < 0)
+        {
+            continue;
+        }
+        for(int k = 0; k < client->NBsub; k++)
+        {
+            NETWORKSERVE_SUB *sub = &client->sub[k];
+            if(sub->streamindex != si)
+            {
+                continue;
+            }
+            sub->deccnt ++;
+            if(sub->deccnt >= sub->decimation)
+            {
+                sub->deccnt  = 0;
+                sub->pending = 1;
+                NBdeliver ++;
+            }
+        }
+    }
+    if(NBdeliver == 0)
+    {
+        return;
+    }
+
+
+    // get free snapshot
+    int snapindex = -1;
+    for(int sn = 0; sn < stream->NBsnap; sn++)
+    {
+        if(stream->snaprefcnt[sn] == 0)
+        {
+            snapindex = sn;
+            break;
+        }
+    }
+    if((snapindex == -1) && (stream->NBsnap < NETWORKSERVE_MAXSNAP))
+    {
+        stream->snap[stream->NBsnap] = (char *) malloc(stream->framesize);
+        if(stream->snap[stream->NBsnap] != NULL)
+        {
+            snapindex = stream->NBsnap;
+            stream->NBsnap ++;
+        }
+    }
+    if(snapindex != -1)
+    {
+        memcpy(stream->snap[snapindex], stream->ptr0 + stream->framesize * slice,
+               stream->framesize);
+    }
+    else
+    {
+        stream->NBframedrop ++;
+    }
+
+
+    // queue to clients
+    for(int ci = 0; ci < NETWORKSERVE_MAXCLIENT; ci++)
+    {
+        NETWORKSERVE_CLIENT *client = &server->client[ci];
+        if(client->fd < 0)
+        {
+            continue;
+        }
+        for(int k = 0; k < client->NBsub; k++)
+        {
+            NETWORKSERVE_SUB *sub = &client->sub[k];
+            if(sub->pending == 0)
+            {
+                continue;
+            }
+            sub->pending = 0;
+
+            NETWORKSERVE_QENTRY *entry = NULL;
+            if(snapindex != -1)
+            {
+                entry = NETWORKserve_client_queuetail(client, 1);
+            }
+            if(entry == NULL)
+            {
+                client->NBframedrop ++;
+                continue;
+            }
+
+            NETWORKSERVE_FRAMEHEADER fheader;
+            fheader.magic    = NETWORKSERVE_MAGIC;
+            fheader.subindex = sub->subindex;
+            fheader.cnt0     = cnt0;
+            fheader.cnt1     = slice;
+            fheader.size     = stream->framesize;
+            memcpy(entry->hdr, &fheader, sizeof(NETWORKSERVE_FRAMEHEADER));
+            entry->hdrsize     = sizeof(NETWORKSERVE_FRAMEHEADER);
+            entry->streamindex = si;
+            entry->snapindex   = snapindex;
+            stream->snaprefcnt[snapindex] ++;
+        }
+    }
+}
+
+
+
+
+
+/** @brief Serve streams to multiple clients
+ *
+ * Clients connect to port and send NETWORKSERVE_SUBSCRIBE requests.
+ * Use imnetwsubscribe to receive into local streams.
+ */
+errno_t COREMOD_MEMORY_image_NETWORKserve(
+    int port,
+    int RT_priority
+)
+{
+    NETWORKSERVE_SERVER *server;
+    struct sockaddr_in   sock_server;
+    int                  fds_server;
+    int                  flag = 1;
+    int                  MAXPENDING = 16;
+
+
+    // ===========================
+    // processinfo support
+    // ===========================
+    PROCESSINFO *processinfo;
+
+    char pinfoname[200];
+    sprintf(pinfoname, "ntw-serve-%d", port);
+
+    char descr[200];
+    sprintf(descr, "serve port %d", port);
+
+    char pinfomsg[200];
+    sprintf(pinfomsg, "setup");
+
+    processinfo = processinfo_setup(
+                      pinfoname,
+                      descr,    // description
+                      pinfomsg,  // message on startup
+                      __FUNCTION__, __FILE__, __LINE__
+                  );
+
+    // OPTIONAL SETTINGS
+    processinfo->MeasureTiming = 1; // Measure timing
+    processinfo->RT_priority =
+        RT_priority;  // RT_priority, 0-99. Larger number = higher priority. If <0, ignore
+
+    int loopOK = 1;
+
+
+    server = (NETWORKSERVE_SERVER *) calloc(1, sizeof(NETWORKSERVE_SERVER));
+    for(int ci = 0; ci < NETWORKSERVE_MAXCLIENT; ci++)
+    {
+        server->client[ci].fd = -1;
+    }
+
+    server->epfd = epoll_create1(0);
+    if(server->epfd == -1)
+    {
+        processinfo_error(processinfo, "ERROR: epoll_create1() failed");
+        loopOK = 0;
+    }
+
+    if((fds_server = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) == -1)
+    {
+        processinfo_error(processinfo, "ERROR creating socket");
+        loopOK = 0;
+    }
+
+    if(loopOK == 1)
+    {
+        setsockopt(fds_server, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(int));
+
+        memset((char *) &sock_server, 0, sizeof(sock_server));
+        sock_server.sin_family = AF_INET;
+        sock_server.sin_port = htons(port);
+        sock_server.sin_addr.s_addr = htonl(INADDR_ANY);
+
+        if(bind(fds_server, (struct sockaddr *)&sock_server,
+                sizeof(sock_server)) == -1)
+        {
+            char msgstring[200];
+            sprintf(msgstring, "ERROR binding socket, port %d", port);
+            processinfo_error(processinfo, msgstring);
+            loopOK = 0;
+        }
+    }
+
+    if(loopOK == 1)
+    {
+        if(listen(fds_server, MAXPENDING) < 0)
+        {
+            processinfo_error(processinfo, "ERROR listen socket");
+            loopOK = 0;
+        }
+    }
+
+    if(loopOK == 1)
+    {
+        struct epoll_event ev;
+
+        fcntl(fds_server, F_SETFL, fcntl(fds_server, F_GETFL, 0) | O_NONBLOCK);
+        ev.events   = EPOLLIN;
+        ev.data.u64 = NETWORKSERVE_EVTAG(NETWORKSERVE_EVTYPE_LISTEN, 0);
+        epoll_ctl(server->epfd, EPOLL_CTL_ADD, fds_server, &ev);
+
+        sprintf(pinfomsg, "listening on port %d", port);
+        processinfo_WriteMessage(processinfo, pinfomsg);
+    }
+
+
+    // ===========================
+    // Start loop
+    // ===========================
+    processinfo_loopstart(
+        processinfo); // Notify processinfo that we are entering loop
+
+    struct epoll_event events[NETWORKSERVE_MAXEVENT];
+    long loopcnt = 0;
+
+    while(loopOK == 1)
+    {
+        loopOK = processinfo_loopstep(processinfo);
+
+        // timeout so that processinfo control is checked
+        int NBevent = epoll_wait(server->epfd, events, NETWORKSERVE_MAXEVENT, 100);
+
+        processinfo_exec_start(processinfo);
+        if(processinfo_compute_status(processinfo) == 1)
+        {
+            for(int e = 0; e < NBevent; e++)
+            {
+                int evtype  = (int)(events[e].data.u64 >> 32);
+                int evindex = (int)(events[e].data.u64 & 0xffffffff);
+
+                switch(evtype)
+                {
+
+                    case NETWORKSERVE_EVTYPE_LISTEN:
+                        for(;;)
+                        {
+                            int fd = accept(fds_server, NULL, NULL);
+                            if(fd == -1)
+                            {
+                                break;
+                            }
+
+                            int ci;
+                            for(ci = 0; ci < NETWORKSERVE_MAXCLIENT; ci++)
+                                if(server->client[ci].fd == -1)
+                                {
+                                    break;
+                                }
+                            if(ci == NETWORKSERVE_MAXCLIENT)
+                            {
+                                processinfo_WriteMessage(processinfo, "max number of clients reached");
+                                close(fd);
+                                continue;
+                            }
+
+                            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+                            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(int));
+
+                            struct epoll_event ev;
+                            ev.events   = EPOLLIN;
+                            ev.data.u64 = NETWORKSERVE_EVTAG(NETWORKSERVE_EVTYPE_CLIENT, ci);
+                            epoll_ctl(server->epfd, EPOLL_CTL_ADD, fd, &ev);
+
+                            memset(&server->client[ci], 0, sizeof(NETWORKSERVE_CLIENT));
+                            server->client[ci].fd = fd;
+                            server->NBclient ++;
+                        }
+                        break;
+
+
+                    case NETWORKSERVE_EVTYPE_CLIENT:
+                    {
+                        NETWORKSERVE_CLIENT *client = &server->client[evindex];
+                        int closeclient = 0;
+
+                        if(client->fd == -1)
+                        {
+                            break;
+                        }
+                        if(events[e].events & (EPOLLERR | EPOLLHUP))
+                        {
+                            closeclient = 1;
+                        }
+                        if((closeclient == 0) && (events[e].events & EPOLLIN))
+                        {
+                            // subscription requests
+                            // stop reading when no queue entry is left for the reply
+                            while(client->qlen < NETWORKSERVE_QUEUESIZE)
+                            {
+                                ssize_t rs = recv(client->fd, client->rxbuff + client->rxsize,
+                                                  sizeof(NETWORKSERVE_SUBSCRIBE) - client->rxsize, MSG_DONTWAIT);
+                                if(rs == 0)
+                                {
+                                    closeclient = 1;
+                                    break;
+                                }
+                                if(rs < 0)
+                                {
+                                    if((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+                                    {
+                                        closeclient = 1;
+                                    }
+                                    break;
+                                }
+                                client->rxsize += rs;
+                                if(client->rxsize == sizeof(NETWORKSERVE_SUBSCRIBE))
+                                {
+                                    client->rxsize = 0;
+                                    if(NETWORKserve_client_request(server, client) != RETURN_SUCCESS)
+                                    {
+                                        closeclient = 1;
+                                        break;
+                                    }
+                                }
+                            }
+                        }
+                        if(closeclient == 1)
+                        {
+                            NETWORKserve_client_close(server, evindex);
+                        }
+                    }
+                    break;
+
+
+                    case NETWORKSERVE_EVTYPE_STREAM:
+                    {
+                        uint64_t evcnt;
+                        if(read(server->stream[evindex].evfd, &evcnt, sizeof(evcnt)) > 0)
+                        {
+                            NETWORKserve_stream_newframe(server, evindex);
+                        }
+                    }
+                    break;
+                }
+            }
+
+
+            // send pending output
+            for(int ci = 0; ci < NETWORKSERVE_MAXCLIENT; ci++)
+            {
+                if(server->client[ci].fd == -1)
+                {
+                    continue;
+                }
+                if(NETWORKserve_client_flush(server, &server->client[ci]) != 0)
+                {
+                    NETWORKserve_client_close(server, ci);
+                    continue;
+                }
+                NETWORKserve_client_epollout(server, ci);
+            }
+
+            if(loopcnt % 100 == 0)
+            {
+                uint64_t NBframe = 0;
+                for(int si = 0; si < NETWORKSERVE_MAXSTREAM; si++)
+                {
+                    NBframe += server->stream[si].NBframe;
+                }
+                sprintf(pinfomsg, "%d client(s) %d stream(s) %lu frames", server->NBclient,
+                        server->NBstream, (unsigned long) NBframe);
+                processinfo_WriteMessage(processinfo, pinfomsg);
+            }
+            loopcnt ++;
+        }
+        // process signals, increment loop counter
+        processinfo_exec_end(processinfo);
+
+        if((data.signal_INT == 1) || \
+                (data.signal_TERM == 1) || \
+                (data.signal_ABRT == 1) || \
+                (data.signal_BUS == 1) || \
+                (data.signal_SEGV == 1) || \
+                (data.signal_HUP == 1))
+        {
+            loopOK = 0;
+        }
+    }
+    // ==================================
+    // ENDING LOOP
+    // ==================================
+
+    for(int ci = 0; ci < NETWORKSERVE_MAXCLIENT; ci++)
+    {
+        if(server->client[ci].fd != -1)
+        {
+            NETWORKserve_client_close(server, ci);
+        }
+    }
+
+    for(int si = 0; si < NETWORKSERVE_MAXSTREAM; si++)
+    {
+        NETWORKSERVE_STREAM *stream = &server->stream[si];
+        if(stream->used == 0)
+        {
+            continue;
+        }
+        stream->exitflag = 1;
+        pthread_join(stream->thread_watch, NULL);
+        close(stream->evfd);
+        for(int sn = 0; sn < stream->NBsnap; sn++)
+        {
+            free(stream->snap[sn]);
+        }
+        printf("stream %s: %lu frames, %lu dropped\n", stream->name,
+               (unsigned long) stream->NBframe, (unsigned long) stream->NBframedrop);
+    }
+
+    processinfo_cleanExit(processinfo);
+
+    if(fds_server != -1)
+    {
+        close(fds_server);
+    }
+    if(server->epfd != -1)
+    {
+        close(server->epfd);
+    }
+    free(server);
+
+    printf("port %d closed\n", port);
+    fflush(stdout);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+
+/** @brief Get local stream matching received metadata, create it if needed
+ */
+static imageID NETWORKsubscribe_localstream(
+    IMAGE_METADATA *imgmd
+)
+{
+    imageID ID;
+    int     OKim = 1;
+
+    ID = image_ID(imgmd->name);
+    if(ID == -1)
+    {
+        ID = read_sharedmem_image(imgmd->name);
+    }
+
+    if(ID != -1)
+    {
+        if(imgmd->naxis != data.image[ID].md[0].naxis)
+        {
+            OKim = 0;
+        }
+        if(OKim == 1)
+        {
+            for(int axis = 0; axis < imgmd->naxis; axis++)
+                if(imgmd->size[axis] != data.image[ID].md[0].size[axis])
+                {
+                    OKim = 0;
+                }
+        }
+        if(imgmd->datatype != data.image[ID].md[0].datatype)
+        {
+            OKim = 0;
+        }
+        if(OKim == 0)
+        {
+            delete_image_ID(imgmd->name, DELETE_IMAGE_ERRMODE_WARNING);
+            ID = -1;
+        }
+    }
+
+    if(ID == -1)
+    {
+        create_image_ID(imgmd->name, imgmd->naxis, imgmd->size,
+                        imgmd->datatype, 1, 0, 0, &ID);
+        printf("Created image stream %s\n", imgmd->name);
+    }
+    COREMOD_MEMORY_image_set_createsem(imgmd->name, IMAGE_NB_SEMAPHORE);
+
+    return ID;
+}
+
+
+
+/** @brief Receive stream(s) from stream server into local streams
+ *
+ * streamlist is a comma-separated list of stream names.
+ * Local streams have the same name as the remote streams.
+ */
+errno_t COREMOD_MEMORY_image_NETWORKsubscribe(
+    const char *IPaddr,
+    int         port,
+    const char *streamlist,
+    int         decimation
+)
+{
+    struct sockaddr_in sock_server;
+    int                fds_client;
+    int                flag = 1;
+
+    char     names[NETWORKSERVE_MAXSUB][STRINGMAXLEN_IMAGE_NAME];
+    imageID  localID[NETWORKSERVE_MAXSUB];
+    long     framesize[NETWORKSERVE_MAXSUB];
+    long     NBslices[NETWORKSERVE_MAXSUB];
+    int      NBstream = 0;
+
+
+    // ===========================
+    // processinfo support
+    // ===========================
+    PROCESSINFO *processinfo;
+
+    char pinfoname[200];
+    snprintf(pinfoname, 200, "ntw-sub-%s", streamlist);
+
+    char descr[200];
+    snprintf(descr, 200, "%s/%d", IPaddr, port);
+
+    char pinfomsg[200];
+    sprintf(pinfomsg, "setup");
+
+    processinfo = processinfo_setup(
+                      pinfoname,
+                      descr,    // description
+                      pinfomsg,  // message on startup
+                      __FUNCTION__, __FILE__, __LINE__
+                  );
+    processinfo->MeasureTiming = 1;
+
+    int loopOK = 1;
+
+
+    {
+        char  liststr[STRINGMAXLEN_IMAGE_NAME * NETWORKSERVE_MAXSUB];
+        char *saveptr;
+
+        strncpy(liststr, streamlist, sizeof(liststr) - 1);
+        liststr[sizeof(liststr) - 1] = '\0';
+        for(char *tok = strtok_r(liststr, ",", &saveptr);
+                (tok != NULL) && (NBstream < NETWORKSERVE_MAXSUB);
+                tok = strtok_r(NULL, ",", &saveptr))
+        {
+            strncpy(names[NBstream], tok, STRINGMAXLEN_IMAGE_NAME - 1);
+            names[NBstream][STRINGMAXLEN_IMAGE_NAME - 1] = '\0';
+            localID[NBstream] = -1;
+            NBstream ++;
+        }
+    }
+
+
+    if((fds_client = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP)) < 0)
+    {
+        processinfo_error(processinfo, "ERROR creating socket");
+        loopOK = 0;
+    }
+
+    if(loopOK == 1)
+    {
+        setsockopt(fds_client, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(int));
+
+        memset((char *) &sock_server, 0, sizeof(sock_server));
+        sock_server.sin_family = AF_INET;
+        sock_server.sin_port = htons(port);
+        sock_server.sin_addr.s_addr = inet_addr(IPaddr);
+
+        if(connect(fds_client, (struct sockaddr *) &sock_server,
+                   sizeof(sock_server)) < 0)
+        {
+            perror("Error  connect() failed ");
+            processinfo_error(processinfo, "ERROR: connect() failed");
+            loopOK = 0;
+        }
+    }
+
+    for(int i = 0; (loopOK == 1) && (i < NBstream); i++)
+    {
+        NETWORKSERVE_SUBSCRIBE req;
+
+        memset(&req, 0, sizeof(req));
+        req.magic      = NETWORKSERVE_MAGIC;
+        req.decimation = (decimation > 0) ? decimation : 1;
+        strncpy(req.name, names[i], STRINGMAXLEN_IMAGE_NAME - 1);
+        if(send(fds_client, &req, sizeof(req), 0) != sizeof(req))
+        {
+            processinfo_error(processinfo, "ERROR: subscription send() failed");
+            loopOK = 0;
+        }
+    }
+
+    for(int i = 0; (loopOK == 1) && (i < NBstream); i++)
+    {
+        NETWORKSERVE_REPLY reply;
+        IMAGE_METADATA     imgmd;
+
+        if((recv(fds_client, &reply, sizeof(reply), MSG_WAITALL) != sizeof(reply))
+                || (reply.magic != NETWORKSERVE_MAGIC))
+        {
+            processinfo_error(processinfo, "ERROR: no subscription reply");
+            loopOK = 0;
+            break;
+        }
+        if(reply.status != 0)
+        {
+            printf("stream %s not available from server\n", names[i]);
+            continue;
+        }
+        if(recv(fds_client, &imgmd, sizeof(imgmd), MSG_WAITALL) != sizeof(imgmd))
+        {
+            processinfo_error(processinfo, "ERROR receiving image metadata");
+            loopOK = 0;
+            break;
+        }
+
+        localID[i] = NETWORKsubscribe_localstream(&imgmd);
+        NBslices[i] = 1;
+        if(imgmd.naxis > 2)
+            if(imgmd.size[2] > 1)
+            {
+                NBslices[i] = imgmd.size[2];
+            }
+        framesize[i] = ImageStreamIO_typesize(imgmd.datatype)
+                       * (data.image[localID[i]].md[0].nelement / NBslices[i]);
+        printf("<- %s frame size %ld\n", names[i], framesize[i]);
+    }
+
+    if(loopOK == 1)
+    {
+        snprintf(pinfomsg, 200, "subscribed to %d stream(s)", NBstream);
+        processinfo_WriteMessage(processinfo, pinfomsg);
+    }
+
+
+    // ===========================
+    // Start loop
+    // ===========================
+    processinfo_loopstart(
+        processinfo); // Notify processinfo that we are entering loop
+
+    while(loopOK == 1)
+    {
+        NETWORKSERVE_FRAMEHEADER fheader;
+
+        loopOK = processinfo_loopstep(processinfo);
+
+        if(recv(fds_client, &fheader, sizeof(fheader), MSG_WAITALL) != sizeof(fheader))
+        {
+            processinfo_WriteMessage(processinfo, "connection closed");
+            break;
+        }
+
+        processinfo_exec_start(processinfo);
+
+        int i = fheader.subindex;
+        if((fheader.magic != NETWORKSERVE_MAGIC) || (i < 0) || (i >= NBstream)
+                || (localID[i] == -1) || ((long) fheader.size != framesize[i]))
+        {
+            processinfo_error(processinfo, "ERROR: unexpected frame header");
+            loopOK = 0;
+        }
+
+        if(loopOK == 1)
+        {
+            // receive directly into slot
+            IMAGE *image = &data.image[localID[i]];
+            long   slot = 0;
+
+            if(NBslices[i] > 1)
+            {
+                slot = fheader.cnt1 % NBslices[i];
+            }
+            image->md[0].write = 1;
+            if(recv(fds_client, (char *) image->array.raw + framesize[i] * slot,
+                    framesize[i], MSG_WAITALL) != framesize[i])
+            {
+                image->md[0].write = 0;
+                processinfo_WriteMessage(processinfo, "connection closed mid-frame");
+                loopOK = 0;
+            }
+            else
+            {
+                image->md[0].cnt1 = slot;
+                ImageStreamIO_UpdateIm(image);
+            }
+        }
+
+        processinfo_exec_end(processinfo);
+
+        if((data.signal_INT == 1) || \
+                (data.signal_TERM == 1) || \
+                (data.signal_ABRT == 1) || \
+                (data.signal_BUS == 1) || \
+                (data.signal_SEGV == 1) || \
+                (data.signal_HUP == 1) || \
+                (data.signal_PIPE == 1))
+        {
+            loopOK = 0;
+        }
+    }
+
+    processinfo_cleanExit(processinfo);
+
+    if(fds_client >= 0)
+    {
+        close(fds_client);
+    }
+
+    return RETURN_SUCCESS;
+}
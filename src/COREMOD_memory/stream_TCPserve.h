@@ -0,0 +1,76 @@
+/**
+ * @file    stream_TCPserve.h
+ * @brief   multi-subscriber TCP stream server
+ */
+
+#ifndef _STREAM_TCPSERVE_H
+#define _STREAM_TCPSERVE_H
+
+#include <stdint.h>
+
+
+// protocol magic number ("MLKS")
+#define NETWORKSERVE_MAGIC 0x534b4c4d
+
+#define NETWORKSERVE_MAXCLIENT  64 // max number of connected clients
+#define NETWORKSERVE_MAXSTREAM  32 // max number of streams served
+#define NETWORKSERVE_MAXSUB     16 // max number of subscriptions per client
+#define NETWORKSERVE_MAXSNAP    64 // max number of frame snapshots per stream
+#define NETWORKSERVE_QUEUELEN    8 // max frames queued per client, older frames kept
+
+// client queue size: frames + subscription replies
+#define NETWORKSERVE_QUEUESIZE (NETWORKSERVE_QUEUELEN + NETWORKSERVE_MAXSUB)
+
+
+
+/** @brief Subscription request, client -> server
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t decimation;   // send one frame every decimation frames
+    char     name[STRINGMAXLEN_IMAGE_NAME];
+} NETWORKSERVE_SUBSCRIBE;
+
+
+/** @brief Subscription reply, server -> client
+ *
+ * Followed by stream IMAGE_METADATA if status is 0.
+ * Replies are sent in request order.
+ */
+typedef struct
+{
+    uint32_t magic;
+    int32_t  status;       // 0 if OK, -1 if stream not found
+} NETWORKSERVE_REPLY;
+
+
+/** @brief Frame header, server -> client, followed by size bytes of pixel data
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t subindex;     // subscription index, in client request order
+    uint64_t cnt0;         // source stream cnt0
+    uint64_t cnt1;         // source stream slice
+    uint64_t size;
+} NETWORKSERVE_FRAMEHEADER;
+
+
+
+errno_t stream_TCPserve_addCLIcmd();
+
+
+errno_t COREMOD_MEMORY_image_NETWORKserve(
+    int port,
+    int RT_priority
+);
+
+errno_t COREMOD_MEMORY_image_NETWORKsubscribe(
+    const char *IPaddr,
+    int         port,
+    const char *streamlist,
+    int         decimation
+);
+
+#endif
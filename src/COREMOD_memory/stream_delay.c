@@ -17,6 +17,10 @@
 
 
 
+// max number of frames in ring buffer
+#define STREAMDELAY_RINGSIZEMAX 1000000
+
+
 // ==========================================
 // Forward declaration(s)
 // ==========================================
@@ -152,7 +156,7 @@ errno_t COREMOD_MEMORY_streamDelay_FPCONF()
 
     long dtus_default[4] = { 50, 1, 200, 50 };
     long fp_dtus    = function_parameter_add_entry(&fps, ".dtus",
-                      "Loop period [us]", FPTYPE_INT64, FPFLAG, &dtus_default);
+                      "Output period [us]", FPTYPE_INT64, FPFLAG, &dtus_default);
     (void) fp_dtus; // suppresses unused parameter compiler warning
 
 
@@ -173,8 +177,17 @@ errno_t COREMOD_MEMORY_streamDelay_FPCONF()
         "Averaging time window width",
         &avedt_default);
 
+    long ringsize_default[4] = { 0, 0, STREAMDELAY_RINGSIZEMAX, 0 };
+    FPS_ADDPARAM_INT64_IN(
+        option_ringsize,
+        ".option.ringsize",
+        "Input frame buffer size, 0 for 2 x delay x input rate",
+        &ringsize_default);
+
     // status
     FPS_ADDPARAM_INT64_OUT(zsize, ".status.zsize",  "cube size");
+    FPS_ADDPARAM_INT64_OUT(nwin, ".status.nwin", "frames in averaging window");
+    FPS_ADDPARAM_INT64_OUT(overflow, ".status.overflow", "frames lost to buffer overflow");
     FPS_ADDPARAM_INT64_OUT(framelog, ".status.framelag", "lag in frame unit");
     FPS_ADDPARAM_INT64_OUT(kkin, ".status.kkin", "input cube slice index");
     FPS_ADDPARAM_INT64_OUT(kkout, ".status.kkout", "output cube slice index");
@@ -221,27 +234,84 @@ errno_t COREMOD_MEMORY_streamDelay_FPCONF()
 
 
 
+/** @brief Time elapsed since t [s]
+ */
+static inline double streamdelay_age(
+    struct timespec t,
+    struct timespec tnow
+)
+{
+    struct timespec tdiff = timespec_diff(t, tnow);
+
+    return 1.0 * tdiff.tv_sec + 1.0e-9 * tdiff.tv_nsec;
+}
+
+
+
+
+// time over which input frame rate is measured to size ring buffer [us]
+#define STREAMDELAY_RATEMEASUS 200000
+
+
+/** @brief Measure input stream frame period [us]
+ *
+ * Counts cnt0 increments over STREAMDELAY_RATEMEASUS.
+ * Returns dtus if no frame is received.
+ */
+static double streamdelay_inputperiodus(
+    imageID IDin,
+    long    dtus
+)
+{
+    uint64_t        cnt0start = data.image[IDin].md[0].cnt0;
+    struct timespec tstart;
+    struct timespec tend;
+
+    clock_gettime(CLOCK_REALTIME, &tstart);
+    usleep(STREAMDELAY_RATEMEASUS);
+    clock_gettime(CLOCK_REALTIME, &tend);
+
+    uint64_t NBframe = data.image[IDin].md[0].cnt0 - cnt0start;
+    if(NBframe == 0)
+    {
+        return 1.0 * dtus;
+    }
+
+    return 1.0e6 * streamdelay_age(tstart, tend) / NBframe;
+}
+
+
+
+
 /**
  * @brief Delay image stream by time offset
  *
  * IDout_name is a time-delayed copy of IDin_name
  *
+ * The loop wakes up on input stream semaphore, or at the next output time,
+ * whichever comes first. Each input frame is stored once in a ring buffer,
+ * with its acquisition time (md[0].atime if the writer sets it, arrival time
+ * otherwise). Outputs are written every dtus on an absolute schedule.
+ *
+ * Time averaging mode keeps the sum of frames with age within avedt of the
+ * delay : frames are added as they enter the window and subtracted as they
+ * leave it, so each output costs O(pixels) regardless of window size.
+ *
+ * Ring buffer must hold all input frames within delay (+avedt). Unless set by
+ * .option.ringsize, it is sized from input frame rate measured at startup.
+ * If ring buffer is too small, frames are lost and counted in .status.overflow.
  */
 
 errno_t COREMOD_MEMORY_streamDelay_RUN()
 {
     imageID             IDimc;
     imageID             IDin, IDout;
-    uint32_t            xsize, ysize, xysize;
-    //    long                cnt0old;
-    long                ii;
+    uint32_t            xsize, ysize;
+    uint64_t            xysize;
     struct timespec    *t0array;
     struct timespec     tnow;
-    double              tdiffv;
-    struct timespec     tdiff;
+    struct timespec     tnext;
     uint32_t           *arraytmp;
-    long                cntskip = 0;
-    long                kk;
 
 
     // ===========================
@@ -272,7 +342,11 @@ errno_t COREMOD_MEMORY_streamDelay_RUN()
                       ".option.timeavemode");
     double *avedt   = functionparameter_GetParamPtr_FLOAT64(&fps, ".option.avedt");
 
+    long ringsize = functionparameter_GetParamValue_INT64(&fps, ".option.ringsize");
+
     long *zsize    = functionparameter_GetParamPtr_INT64(&fps, ".status.zsize");
+    long *nwin     = functionparameter_GetParamPtr_INT64(&fps, ".status.nwin");
+    long *overflow = functionparameter_GetParamPtr_INT64(&fps, ".status.overflow");
     long *framelag = functionparameter_GetParamPtr_INT64(&fps, ".status.framelag");
     long *kkin     = functionparameter_GetParamPtr_INT64(&fps, ".status.kkin");
     long *kkout    = functionparameter_GetParamPtr_INT64(&fps, ".status.kkout");
@@ -340,16 +414,52 @@ errno_t COREMOD_MEMORY_streamDelay_RUN()
         processinfo_error(processinfo, msgstring);
         loopOK = 0;
     }
+    else if(data.image[IDin].md[0].datatype != _DATATYPE_FLOAT)
+    {
+        processinfo_error(processinfo, "Input stream must be float");
+        loopOK = 0;
+    }
+
+    if(loopOK == 0)
+    {
+        processinfo_cleanExit(processinfo);
+        function_parameter_RUNexit(&fps);
+        return RETURN_FAILURE;
+    }
 
 
     xsize = data.image[IDin].md[0].size[0];
     ysize = data.image[IDin].md[0].size[1];
-    *zsize = (long)(2 * delayus / dtus);
-    if(*zsize < 1)
+    xysize = (uint64_t) xsize * ysize;
+
+    // ring buffer holds input frames
+    if(ringsize > 0)
     {
-        *zsize = 1;
+        *zsize = ringsize;
+    }
+    else
+    {
+        // each input frame takes a slot
+        double framedtus = streamdelay_inputperiodus(IDin, dtus);
+        if(framedtus > dtus)
+        {
+            framedtus = dtus;
+        }
+        double windowus = delayus;
+        if(timeavemode != 0)
+        {
+            windowus += 1.0e6 * (*avedt);
+        }
+        *zsize = (long)(2.0 * windowus / framedtus);
+        if(*zsize > STREAMDELAY_RINGSIZEMAX)
+        {
+            *zsize = STREAMDELAY_RINGSIZEMAX;
+        }
+    }
+    if(*zsize < 2)
+    {
+        *zsize = 2;
     }
-    xysize = xsize * ysize;
 
     t0array = (struct timespec *) malloc(sizeof(struct timespec) * *zsize);
 
@@ -369,34 +479,36 @@ errno_t COREMOD_MEMORY_streamDelay_RUN()
     }
 
 
-    *kkin = 0;
-    *kkout = 0;
-//    cnt0old = data.image[IDin].md[0].cnt0;
+    // running sum of frames in averaging window
+    double *sumarray = (double *) calloc(xysize, sizeof(double));
 
-    float *arraytmpf;
-    arraytmpf = (float *) malloc(sizeof(float) * xsize * ysize);
+    // frame counters, slot index is counter modulo zsize
+    uint64_t cntin    = 0; // frames stored
+    uint64_t cntenter = 0; // next frame to enter averaging window
+    uint64_t cntleave = 0; // oldest frame in averaging window
+    uint64_t cntout   = 0; // frames that have reached delay (no averaging)
 
-    clock_gettime(CLOCK_REALTIME, &tnow);
-    for(kk = 0; kk < *zsize; kk++)
-    {
-        t0array[kk] = tnow;
-    }
+    uint64_t        cnt0old = data.image[IDin].md[0].cnt0;
+    struct timespec tacqold = data.image[IDin].md[0].atime;
 
+    *kkin = 0;
+    *kkout = 0;
+    *nwin = 0;
+    *overflow = 0;
+    int overflowwarn = 0; // 1 after overflow message written
+
+    float *ringF = data.image[IDimc].array.F;
+    float *inF   = data.image[IDin].array.F;
 
     DEBUG_TRACEPOINT(" ");
 
 
     // Specify input stream trigger
-
+    // timeout is set before each wait to reach next output time
     processinfo_waitoninputstream_init(processinfo, IDin,
-                                       PROCESSINFO_TRIGGERMODE_DELAY, -1);
-    processinfo->triggerdelay.tv_sec = 0;
-    processinfo->triggerdelay.tv_nsec = (long)(dtus * 1000);
-    while(processinfo->triggerdelay.tv_nsec > 1000000000)
-    {
-        processinfo->triggerdelay.tv_nsec -= 1000000000;
-        processinfo->triggerdelay.tv_sec += 1;
-    }
+                                       PROCESSINFO_TRIGGERMODE_SEMAPHORE, -1);
+
+    clock_gettime(CLOCK_REALTIME, &tnext);
 
 
     // ===========================
@@ -410,15 +522,20 @@ errno_t COREMOD_MEMORY_streamDelay_RUN()
 
     while(loopOK == 1)
     {
-        int kkinscan;
-        float normframes = 0.0;
-
         DEBUG_TRACEPOINT(" ");
         loopOK = processinfo_loopstep(processinfo);
 
-
+        clock_gettime(CLOCK_REALTIME, &tnow);
+        if(streamdelay_age(tnow, tnext) > 0.0)
+        {
+            processinfo->triggertimeout = timespec_diff(tnow, tnext);
+        }
+        else
+        {
+            processinfo->triggertimeout.tv_sec = 0;
+            processinfo->triggertimeout.tv_nsec = 0;
+        }
         processinfo_waitoninputstream(processinfo);
-        //usleep(dtus); // main loop wait
 
         processinfo_exec_start(processinfo);
 
@@ -426,132 +543,161 @@ errno_t COREMOD_MEMORY_streamDelay_RUN()
         {
             DEBUG_TRACEPOINT(" ");
 
-            // has new frame arrived ?
-//            cnt0 = data.image[IDin].md[0].cnt0;
-
-//            if(cnt0 != cnt0old) { // new frame
-            clock_gettime(CLOCK_REALTIME, &t0array[*kkin]);  // record time of input frame
-
-            DEBUG_TRACEPOINT(" ");
-            for(ii = 0; ii < xysize; ii++)
+            uint64_t cnt0 = data.image[IDin].md[0].cnt0;
+            if(cnt0 != cnt0old)
             {
-                data.image[IDimc].array.F[(*kkin) * xysize + ii] = data.image[IDin].array.F[ii];
-            }
-            (*kkin) ++;
-            DEBUG_TRACEPOINT(" ");
-
-            if((*kkin) == (*zsize))
-            {
-                (*kkin) = 0;
-            }
+                // new frame
+                uint64_t slot = cntin % *zsize;
 
+                cnt0old = cnt0;
 
+                if(timeavemode == 0)
+                {
+                    if(cntin - cntout >= (uint64_t) *zsize)
+                    {
+                        // buffer full: oldest frames are overwritten before output
+                        uint64_t cntskip = cntin + 1 - *zsize - cntout;
+                        cntout += cntskip;
+                        (*overflow) += cntskip;
+                    }
+                }
+                else if(cntin - cntleave >= (uint64_t) *zsize)
+                {
+                    // buffer full: oldest frame leaves averaging window early
+                    if(cntleave < cntenter)
+                    {
+                        float *ptr = ringF + slot * xysize;
+                        for(uint64_t ii = 0; ii < xysize; ii++)
+                        {
+                            sumarray[ii] -= ptr[ii];
+                        }
+                    }
+                    else
+                    {
+                        cntenter++;
+                    }
+                    cntleave++;
+                    (*overflow)++;
+                }
 
-            clock_gettime(CLOCK_REALTIME, &tnow);
-            DEBUG_TRACEPOINT(" ");
+                if((*overflow > 0) && (overflowwarn == 0))
+                {
+                    processinfo_WriteMessage(processinfo,
+                                             "ring too small: delay limited, increase .option.ringsize");
+                    overflowwarn = 1;
+                }
 
+                struct timespec tacq = data.image[IDin].md[0].atime;
+                if((tacq.tv_sec != tacqold.tv_sec) || (tacq.tv_nsec != tacqold.tv_nsec))
+                {
+                    t0array[slot] = tacq;
+                    tacqold = tacq;
+                }
+                else
+                {
+                    clock_gettime(CLOCK_REALTIME, &t0array[slot]);
+                }
 
-            cntskip = 0;
-            tdiff = timespec_diff(t0array[*kkout], tnow);
-            tdiffv = 1.0 * tdiff.tv_sec + 1.0e-9 * tdiff.tv_nsec;
+                memcpy(ringF + slot * xysize, inF, SIZEOF_DATATYPE_FLOAT * xysize);
+                cntin++;
+            }
 
-            DEBUG_TRACEPOINT(" ");
 
+            clock_gettime(CLOCK_REALTIME, &tnow);
 
-            while((tdiffv > 1.0e-6 * delayus) && (cntskip < *zsize))
+            if(streamdelay_age(tnext, tnow) >= 0.0)
             {
-                cntskip++;  // advance index until time condition is satisfied
-                (*kkout) ++;
-                if(*kkout == *zsize)
+                // output time reached, schedule next
+                while(streamdelay_age(tnext, tnow) >= 0.0)
                 {
-                    *kkout = 0;
+                    tnext.tv_nsec += dtus * 1000;
+                    while(tnext.tv_nsec >= 1000000000)
+                    {
+                        tnext.tv_nsec -= 1000000000;
+                        tnext.tv_sec++;
+                    }
                 }
-                tdiff = timespec_diff(t0array[*kkout], tnow);
-                tdiffv = 1.0 * tdiff.tv_sec + 1.0e-9 * tdiff.tv_nsec;
-            }
 
-            DEBUG_TRACEPOINT(" ");
+                double delay = 1.0e-6 * delayus;
 
-            *framelag = *kkin - *kkout;
-            if(*framelag < 0)
-            {
-                *framelag += *zsize;
-            }
-
-
-            DEBUG_TRACEPOINT(" ");
-
-
-            switch(timeavemode)
-            {
+                switch(timeavemode)
+                {
 
                 case 0: // no time averaging - pick more recent frame that matches requirement
                     DEBUG_TRACEPOINT(" ");
-                    if(cntskip > 0)
                     {
-                        char *ptr; // pointer address
-
-                        data.image[IDout].md[0].write = 1;
-
-                        ptr = (char *) data.image[IDimc].array.F;
-                        ptr += SIZEOF_DATATYPE_FLOAT * xysize * *kkout;
-
-                        memcpy(data.image[IDout].array.F, ptr,
-                               SIZEOF_DATATYPE_FLOAT * xysize);  // copy time-delayed input to output
-
-                        COREMOD_MEMORY_image_set_sempost_byID(IDout, -1);
-                        data.image[IDout].md[0].cnt0++;
-                        data.image[IDout].md[0].write = 0;
+                        uint64_t cntout0 = cntout;
+                        while((cntout < cntin)
+                                && (streamdelay_age(t0array[cntout % *zsize], tnow) >= delay))
+                        {
+                            cntout++;
+                        }
+                        if(cntout > cntout0)
+                        {
+                            data.image[IDout].md[0].write = 1;
+                            memcpy(data.image[IDout].array.F,
+                                   ringF + ((cntout - 1) % *zsize) * xysize,
+                                   SIZEOF_DATATYPE_FLOAT * xysize);  // copy time-delayed input to output
+                            processinfo_update_output_stream(processinfo, IDout);
+                        }
+                        *kkout = (cntout > 0) ? (long)((cntout - 1) % *zsize) : 0;
+                        *framelag = cntin - cntout;
                     }
                     break;
 
                 default : // strict time window (note: other modes will be coded in the future)
-                    normframes = 0.0;
                     DEBUG_TRACEPOINT(" ");
 
-                    for(ii = 0; ii < xysize; ii++)
+                    // frames enter window at age delay-avedt
+                    while((cntenter < cntin)
+                            && (streamdelay_age(t0array[cntenter % *zsize], tnow) > delay - *avedt))
                     {
-                        arraytmpf[ii] = 0.0;
+                        float *ptr = ringF + (cntenter % *zsize) * xysize;
+                        for(uint64_t ii = 0; ii < xysize; ii++)
+                        {
+                            sumarray[ii] += ptr[ii];
+                        }
+                        cntenter++;
                     }
 
-                    for(kkinscan = 0; kkinscan < *zsize; kkinscan++)
+                    // frames leave window at age delay+avedt
+                    while((cntleave < cntenter)
+                            && (streamdelay_age(t0array[cntleave % *zsize], tnow) >= delay + *avedt))
                     {
-                        tdiff = timespec_diff(t0array[kkinscan], tnow);
-                        tdiffv = 1.0 * tdiff.tv_sec + 1.0e-9 * tdiff.tv_nsec;
-
-                        if((tdiffv > 0) && (fabs(tdiffv - 1.0e-6 * delayus) < *avedt))
+                        float *ptr = ringF + (cntleave % *zsize) * xysize;
+                        for(uint64_t ii = 0; ii < xysize; ii++)
                         {
-                            float coeff = 1.0;
-                            for(ii = 0; ii < xysize; ii++)
-                            {
-                                arraytmpf[ii] += coeff * data.image[IDimc].array.F[kkinscan * xysize + ii];
-                            }
-                            normframes += coeff;
+                            sumarray[ii] -= ptr[ii];
                         }
+                        cntleave++;
                     }
-                    if(normframes < 0.0001)
-                    {
-                        normframes = 0.0001;    // avoid division by zero
-                    }
+
+                    *nwin = (long)(cntenter - cntleave);
 
                     data.image[IDout].md[0].write = 1;
-                    for(ii = 0; ii < xysize; ii++)
+                    if(*nwin == 0)
                     {
-                        data.image[IDout].array.F[ii] = arraytmpf[ii] / normframes;
+                        // reset accumulated rounding error
+                        memset(sumarray, 0, sizeof(double) * xysize);
+                        memset(data.image[IDout].array.F, 0, SIZEOF_DATATYPE_FLOAT * xysize);
+                    }
+                    else
+                    {
+                        double normframes = 1.0 / *nwin;
+                        for(uint64_t ii = 0; ii < xysize; ii++)
+                        {
+                            data.image[IDout].array.F[ii] = sumarray[ii] * normframes;
+                        }
                     }
-
                     processinfo_update_output_stream(processinfo, IDout);
-                    /*
-                    COREMOD_MEMORY_image_set_sempost_byID(IDout, -1);
-                    data.image[IDout].md[0].cnt0++;
-                    data.image[IDout].md[0].write = 0;
-                    */
+
+                    *kkout = (long)(cntleave % *zsize);
+                    *framelag = cntin - cntleave;
                     break;
+                }
+                *kkin = (long)(cntin % *zsize);
             }
             DEBUG_TRACEPOINT(" ");
-
-
-
         }
         // process signals, increment loop counter
         processinfo_exec_end(processinfo);
@@ -572,7 +718,7 @@ errno_t COREMOD_MEMORY_streamDelay_RUN()
     delete_image_ID("_tmpc", DELETE_IMAGE_ERRMODE_WARNING);
 
     free(t0array);
-    free(arraytmpf);
+    free(sumarray);
 
     return IDout;
 }
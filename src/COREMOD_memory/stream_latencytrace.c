@@ -0,0 +1,539 @@
+/**
+ * @file    stream_latencytrace.c
+ * @brief   end-to-end pipeline latency from stream process traces
+ *
+ * Each processinfo-enabled stage writing a stream through
+ * processinfo_update_output_stream() prepends its own entry to the
+ * streamproctrace array copied from its trigger stream. The trace of the
+ * last stream of a pipeline therefore describes the path of each frame
+ * through all stages (trigger inode, cnt0, process start and stream update
+ * times).
+ *
+ * This tool records the trace of the pipeline output stream for NBframe
+ * frames, then reports per-stage latency distributions :
+ * - wait   : upstream stream update to stage process start
+ * - exec   : stage process start to stage stream update
+ * - cumul  : first stage process start to stage stream update
+ * and writes the recorded traces to file, either as Chrome trace JSON
+ * (chrome://tracing, Perfetto) or as compact binary.
+ *
+ * Runs as a standard processinfo loop : trigger on stream semaphore with
+ * ..triggermode 3 and ..triggerstreamname <in_sname>.
+ */
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "CommandLineInterface/CLIcore.h"
+#include "COREMOD_tools/COREMOD_tools.h"
+
+
+
+// variables local to this translation unit
+static char *inimname;
+static long *NBframe;
+static char *outfname;
+static long *outformat;
+
+
+
+static CLICMDARGDEF farg[] =
+{
+    {
+        CLIARG_IMG,  ".in_sname", "pipeline output stream", "ims1",
+        CLIARG_VISIBLE_DEFAULT,
+        (void **) &inimname
+    },
+    {
+        CLIARG_LONG, ".NBframe", "number of frames to trace", "10000",
+        CLIARG_VISIBLE_DEFAULT,
+        (void **) &NBframe
+    },
+    {
+        CLIARG_STR, ".outfname", "output file name", "sptrace.json",
+        CLIARG_VISIBLE_DEFAULT,
+        (void **) &outfname
+    },
+    {
+        CLIARG_LONG, ".format", "output format 0:Chrome trace JSON 1:binary", "0",
+        CLIARG_HIDDEN_DEFAULT,
+        (void **) &outformat
+    }
+};
+
+static CLICMDDATA CLIcmddata =
+{
+    "streamlatencytrace",
+    "trace pipeline latency from stream process traces",
+    CLICMD_FIELDS_DEFAULTS
+};
+
+
+// detailed help
+static errno_t help_function()
+{
+    printf(
+        "Record streamproctrace of pipeline output stream for NBframe frames\n"
+        "and print per-stage latency distributions [us]:\n"
+        "    wait   upstream stream update -> stage process start\n"
+        "    exec   stage process start -> stage stream update\n"
+        "    cumul  first stage process start -> stage stream update\n"
+        "Traces are written to outfname:\n"
+        "    format 0 : Chrome trace JSON, open in chrome://tracing or Perfetto\n"
+        "    format 1 : binary, SPTRACE_FILEHEADER followed for each frame by\n"
+        "               SPTRACE_FRAME and NBproctrace STREAM_PROC_TRACE entries\n"
+        "To trigger on stream semaphore:\n"
+        "    streamlatencytrace ..procinfo 1\n"
+        "    streamlatencytrace ..triggermode 3\n"
+        "    streamlatencytrace ..triggerstreamname <in_sname>\n"
+        "    streamlatencytrace ..loopcntMax -1\n"
+    );
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+#define SPTRACE_MAGIC "SPTRACE1"
+
+typedef struct
+{
+    char     magic[8];
+    uint32_t NBproctrace;
+    uint32_t tracesize;      // sizeof(STREAM_PROC_TRACE)
+    uint64_t NBframe;
+} SPTRACE_FILEHEADER;
+
+typedef struct
+{
+    struct timespec trecv;   // time frame received by tracer
+    uint64_t        cnt0;    // output stream cnt0
+} SPTRACE_FRAME;
+
+
+
+
+static inline long sptrace_dtns(
+    struct timespec t0,
+    struct timespec t1
+)
+{
+    return (long)(t1.tv_sec - t0.tv_sec) * 1000000000L + (t1.tv_nsec - t0.tv_nsec);
+}
+
+
+// number of valid consecutive entries, starting from most recent stage
+static int sptrace_NBhop(
+    const STREAM_PROC_TRACE *spt,
+    int                      NBspt
+)
+{
+    int NBhop = 0;
+    while((NBhop < NBspt) && (spt[NBhop].procwrite_PID != 0))
+    {
+        NBhop++;
+    }
+    return NBhop;
+}
+
+
+
+
+/** @brief Stream name from inode, scanning shared memory directory
+ */
+static void sptrace_inode_name(
+    ino_t  inode,
+    char  *sname
+)
+{
+    DIR *d = opendir(data.shmdir);
+
+    snprintf(sname, STRINGMAXLEN_IMAGE_NAME, "inode %lu", (unsigned long) inode);
+    if(d == NULL)
+    {
+        return;
+    }
+
+    struct dirent *dir;
+    while((dir = readdir(d)) != NULL)
+    {
+        char *pch = strstr(dir->d_name, ".im.shm");
+        if(pch != NULL)
+        {
+            char fname[STRINGMAXLEN_FULLFILENAME];
+            struct stat buf;
+
+            WRITE_FULLFILENAME(fname, "%s/%s", data.shmdir, dir->d_name);
+            if((stat(fname, &buf) == 0) && (buf.st_ino == inode))
+            {
+                int len = (int)(pch - dir->d_name);
+                if(len > STRINGMAXLEN_IMAGE_NAME - 1)
+                {
+                    len = STRINGMAXLEN_IMAGE_NAME - 1;
+                }
+                strncpy(sname, dir->d_name, len);
+                sname[len] = '\0';
+                break;
+            }
+        }
+    }
+    closedir(d);
+}
+
+
+
+
+static void sptrace_printstat(
+    const char *label,
+    long       *array,
+    long        n
+)
+{
+    if(n == 0)
+    {
+        printf("  %5s %8s %8s %8s", label, "-", "-", "-");
+        return;
+    }
+    quick_sort_long(array, n);
+    printf("  %5s %8.1f %8.1f %8.1f", label,
+           0.001 * array[n / 2],
+           0.001 * array[(long)(0.99 * (n - 1))],
+           0.001 * array[n - 1]);
+}
+
+
+
+/** @brief Per-stage latency distributions
+ *
+ * Stage k is streamproctrace entry k, k=0 is the stage writing in_sname.
+ */
+static errno_t sptrace_analyze(
+    const SPTRACE_FRAME     *frame,
+    const STREAM_PROC_TRACE *trace,
+    long                     NBf,
+    int                      NBspt,
+    char                     stagename[][STRINGMAXLEN_IMAGE_NAME]
+)
+{
+    long *waitarray = (long *) malloc(sizeof(long) * NBf * NBspt);
+    long *execarray = (long *) malloc(sizeof(long) * NBf * NBspt);
+    long *cumularray = (long *) malloc(sizeof(long) * NBf * (NBspt + 1));
+    long *nwait = (long *) calloc(NBspt, sizeof(long));
+    long *nexec = (long *) calloc(NBspt + 1, sizeof(long));
+
+    if((waitarray == NULL) || (execarray == NULL) || (cumularray == NULL)
+            || (nwait == NULL) || (nexec == NULL))
+    {
+        PRINT_ERROR("malloc error");
+        abort();
+    }
+
+    int NBhopmax = 0;
+    for(long f = 0; f < NBf; f++)
+    {
+        const STREAM_PROC_TRACE *spt = trace + f * NBspt;
+        int NBhop = sptrace_NBhop(spt, NBspt);
+        if(NBhop == 0)
+        {
+            continue;
+        }
+        if(NBhop > NBhopmax)
+        {
+            NBhopmax = NBhop;
+        }
+
+        struct timespec torigin = spt[NBhop - 1].ts_procstart;
+        for(int k = 0; k < NBhop; k++)
+        {
+            execarray[k * NBf + nexec[k]] = sptrace_dtns(spt[k].ts_procstart,
+                                            spt[k].ts_streamupdate);
+            cumularray[k * NBf + nexec[k]] = sptrace_dtns(torigin, spt[k].ts_streamupdate);
+            nexec[k]++;
+            if(k < NBhop - 1)
+            {
+                waitarray[k * NBf + nwait[k]] = sptrace_dtns(spt[k + 1].ts_streamupdate,
+                                                spt[k].ts_procstart);
+                nwait[k]++;
+            }
+        }
+        // tracer receive, last row
+        cumularray[NBspt * NBf + nexec[NBspt]] = sptrace_dtns(torigin, frame[f].trecv);
+        nexec[NBspt]++;
+    }
+
+    printf("\n%ld frames, %d stages traced\n", NBf, NBhopmax);
+    printf("%2s %-24s %8s", "", "stage output stream", "PID");
+    for(int i = 0; i < 3; i++)
+    {
+        printf("  %5s %8s %8s %8s", "", "p50", "p99", "max");
+    }
+    printf("  [us]\n");
+    for(int k = NBhopmax - 1; k >= 0; k--)
+    {
+        printf("%2d %-24s %8d", k, stagename[k], (int) trace[k].procwrite_PID);
+        sptrace_printstat("wait", waitarray + k * NBf, nwait[k]);
+        sptrace_printstat("exec", execarray + k * NBf, nexec[k]);
+        sptrace_printstat("cumul", cumularray + k * NBf, nexec[k]);
+        printf("\n");
+    }
+    printf("%2s %-24s %8s", "", "tracer receive", "");
+    printf("%*s", 2 * 34, "");
+    sptrace_printstat("cumul", cumularray + NBspt * NBf, nexec[NBspt]);
+    printf("\n\n");
+
+    free(waitarray);
+    free(execarray);
+    free(cumularray);
+    free(nwait);
+    free(nexec);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+static errno_t sptrace_write_binary(
+    const char              *fname,
+    const SPTRACE_FRAME     *frame,
+    const STREAM_PROC_TRACE *trace,
+    long                     NBf,
+    int                      NBspt
+)
+{
+    FILE *fp = fopen(fname, "wb");
+    if(fp == NULL)
+    {
+        PRINT_ERROR("cannot create file %s", fname);
+        return RETURN_FAILURE;
+    }
+
+    SPTRACE_FILEHEADER hdr;
+    memcpy(hdr.magic, SPTRACE_MAGIC, 8);
+    hdr.NBproctrace = NBspt;
+    hdr.tracesize = sizeof(STREAM_PROC_TRACE);
+    hdr.NBframe = NBf;
+    fwrite(&hdr, sizeof(SPTRACE_FILEHEADER), 1, fp);
+
+    for(long f = 0; f < NBf; f++)
+    {
+        fwrite(&frame[f], sizeof(SPTRACE_FRAME), 1, fp);
+        fwrite(trace + f * NBspt, sizeof(STREAM_PROC_TRACE), NBspt, fp);
+    }
+    fclose(fp);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+/** @brief Write traces as Chrome trace events
+ *
+ * One complete event (ph X) per stage and frame for exec, one for wait.
+ * pid is the stage process PID, tid the stage index.
+ * Stage entries shared with previous frame (same stream update) are
+ * written once.
+ */
+static errno_t sptrace_write_chrometrace(
+    const char              *fname,
+    const SPTRACE_FRAME     *frame,
+    const STREAM_PROC_TRACE *trace,
+    long                     NBf,
+    int                      NBspt,
+    char                     stagename[][STRINGMAXLEN_IMAGE_NAME]
+)
+{
+    FILE *fp = fopen(fname, "w");
+    if(fp == NULL)
+    {
+        PRINT_ERROR("cannot create file %s", fname);
+        return RETURN_FAILURE;
+    }
+
+    // time reference, us timestamps relative to first frame
+    struct timespec tref = frame[0].trecv;
+    for(int k = 0; k < sptrace_NBhop(trace, NBspt); k++)
+    {
+        if(sptrace_dtns(tref, trace[k].ts_procstart) < 0)
+        {
+            tref = trace[k].ts_procstart;
+        }
+    }
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"stream\":\"%s\",\"tref\":\"%ld.%09ld\"},\n",
+            inimname, (long) tref.tv_sec, tref.tv_nsec);
+    fprintf(fp, "\"traceEvents\":[\n");
+
+    int first = 1;
+    for(int k = 0; k < NBspt; k++)
+    {
+        if(trace[k].procwrite_PID != 0)
+        {
+            fprintf(fp, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",\n", (int) trace[k].procwrite_PID, stagename[k]);
+            first = 0;
+        }
+    }
+
+    for(long f = 0; f < NBf; f++)
+    {
+        const STREAM_PROC_TRACE *spt = trace + f * NBspt;
+        int NBhop = sptrace_NBhop(spt, NBspt);
+
+        for(int k = 0; k < NBhop; k++)
+        {
+            if((f > 0)
+                    && (spt[k].ts_streamupdate.tv_sec == spt[k - NBspt].ts_streamupdate.tv_sec)
+                    && (spt[k].ts_streamupdate.tv_nsec == spt[k - NBspt].ts_streamupdate.tv_nsec))
+            {
+                continue;
+            }
+
+            fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"exec\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                    "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"cnt0\":%lu}}",
+                    first ? "" : ",\n",
+                    stagename[k], (int) spt[k].procwrite_PID, k,
+                    0.001 * sptrace_dtns(tref, spt[k].ts_procstart),
+                    0.001 * sptrace_dtns(spt[k].ts_procstart, spt[k].ts_streamupdate),
+                    spt[k].cnt0);
+            first = 0;
+
+            if(k < NBhop - 1)
+            {
+                fprintf(fp, ",\n{\"name\":\"wait\",\"cat\":\"wait\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                        "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"cnt0\":%lu}}",
+                        (int) spt[k].procwrite_PID, k,
+                        0.001 * sptrace_dtns(tref, spt[k + 1].ts_streamupdate),
+                        0.001 * sptrace_dtns(spt[k + 1].ts_streamupdate, spt[k].ts_procstart),
+                        spt[k].cnt0);
+            }
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+// Wrapper function, used by all CLI calls
+static errno_t compute_function()
+{
+    IMGID img = makeIMGID(inimname);
+    resolveIMGID(&img, ERRMODE_ABORT);
+
+    int NBspt = img.md->NBproctrace;
+    if((NBspt < 1) || (img.im->streamproctrace == NULL))
+    {
+        PRINT_ERROR("stream %s has no process trace", inimname);
+        return RETURN_FAILURE;
+    }
+    if(*NBframe < 1)
+    {
+        PRINT_ERROR("NBframe = %ld, must be >= 1", *NBframe);
+        return RETURN_FAILURE;
+    }
+
+    SPTRACE_FRAME *frame = (SPTRACE_FRAME *) malloc(sizeof(SPTRACE_FRAME) * (*NBframe));
+    STREAM_PROC_TRACE *trace = (STREAM_PROC_TRACE *) malloc(sizeof(STREAM_PROC_TRACE) *
+                               (*NBframe) * NBspt);
+    if((frame == NULL) || (trace == NULL))
+    {
+        PRINT_ERROR("malloc error");
+        abort();
+    }
+
+    long     NBf = 0;
+    long     NBtorn = 0;   // trace written while copied
+    uint64_t cnt0prev = img.md->cnt0;
+
+    INSERT_STD_PROCINFO_COMPUTEFUNC_START
+
+    uint64_t cnt0 = img.md->cnt0;
+    if(cnt0 != cnt0prev)
+    {
+        clock_gettime(CLOCK_REALTIME, &frame[NBf].trecv);
+
+        // trace entry is written while md->write is set, before cnt0 increments
+        int writebefore = __atomic_load_n(&img.md->write, __ATOMIC_ACQUIRE);
+        memcpy(trace + NBf * NBspt, img.im->streamproctrace,
+               sizeof(STREAM_PROC_TRACE) * NBspt);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        int writeafter = __atomic_load_n(&img.md->write, __ATOMIC_RELAXED);
+
+        // keep only if stream was not being written or updated during copy
+        if((writebefore == 0) && (writeafter == 0) && (img.md->cnt0 == cnt0))
+        {
+            frame[NBf].cnt0 = cnt0;
+            NBf++;
+        }
+        else
+        {
+            NBtorn++;
+        }
+        cnt0prev = cnt0;
+
+        if(NBf == *NBframe)
+        {
+            processloopOK = 0;
+        }
+    }
+
+    INSERT_STD_PROCINFO_COMPUTEFUNC_END
+
+    printf("Traced %ld frames (%ld discarded, written during copy)\n", NBf, NBtorn);
+
+    if(NBf > 0)
+    {
+        // stage k writes stream read by stage k-1
+        char (*stagename)[STRINGMAXLEN_IMAGE_NAME] =
+            malloc(sizeof(char) * STRINGMAXLEN_IMAGE_NAME * NBspt);
+        if(stagename == NULL)
+        {
+            PRINT_ERROR("malloc error");
+            abort();
+        }
+        strncpy(stagename[0], inimname, STRINGMAXLEN_IMAGE_NAME - 1);
+        stagename[0][STRINGMAXLEN_IMAGE_NAME - 1] = '\0';
+        for(int k = 1; k < NBspt; k++)
+        {
+            sptrace_inode_name(trace[k - 1].trigger_inode, stagename[k]);
+        }
+
+        sptrace_analyze(frame, trace, NBf, NBspt, stagename);
+
+        if(*outformat == 1)
+        {
+            sptrace_write_binary(outfname, frame, trace, NBf, NBspt);
+        }
+        else
+        {
+            sptrace_write_chrometrace(outfname, frame, trace, NBf, NBspt, stagename);
+        }
+        printf("Traces written to %s\n", outfname);
+
+        free(stagename);
+    }
+
+    free(frame);
+    free(trace);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+INSERT_STD_FPSCLIfunctions
+
+// Register function in CLI
+errno_t CLIADDCMD_COREMOD_memory__stream_latencytrace()
+{
+    INSERT_STD_CLIREGISTERFUNC
+
+    return RETURN_SUCCESS;
+}
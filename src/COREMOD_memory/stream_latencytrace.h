@@ -0,0 +1,10 @@
+/**
+ * @file    stream_latencytrace.h
+ */
+
+#ifndef MILK_COREMOD_MEMORY_STREAM_LATENCYTRACE_H
+#define MILK_COREMOD_MEMORY_STREAM_LATENCYTRACE_H
+
+errno_t CLIADDCMD_COREMOD_memory__stream_latencytrace();
+
+#endif
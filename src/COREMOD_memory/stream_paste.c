@@ -88,10 +88,14 @@ errno_t stream_paste_addCLIcmd()
 
 
 
-//
-// compute difference between two 2D streams
-// triggers alternatively on stream0 and stream1
-//
+/**
+ * @brief Paste two 2D streams side by side into output stream
+ *
+ * Waits on both input streams at once (processinfo trigger set, ANY mode),
+ * so that a frame from either input is pasted as soon as it arrives.
+ * Output semaphores are posted and cnt0 incremented when master input is
+ * updated. Output cnt1 holds index of last input pasted.
+ */
 imageID COREMOD_MEMORY_streamPaste(
     const char *IDstream0_name,
     const char *IDstream1_name,
@@ -101,24 +105,20 @@ imageID COREMOD_MEMORY_streamPaste(
     int         master
 )
 {
-    imageID     ID0;
-    imageID     ID1;
+    imageID     IDin[2];
     imageID     IDout;
-    imageID     IDin;
-    long        Xoffset;
     uint32_t    xsize;
     uint32_t    ysize;
     uint32_t   *arraysize;
-    unsigned long long   cnt;
     uint8_t     datatype;
-    int         FrameIndex;
+    int         semindex[2];
 
-    ID0 = image_ID(IDstream0_name);
-    ID1 = image_ID(IDstream1_name);
+    IDin[0] = image_ID(IDstream0_name);
+    IDin[1] = image_ID(IDstream1_name);
 
-    xsize = data.image[ID0].md[0].size[0];
-    ysize = data.image[ID0].md[0].size[1];
-    datatype = data.image[ID0].md[0].datatype;
+    xsize = data.image[IDin[0]].md[0].size[0];
+    ysize = data.image[IDin[0]].md[0].size[1];
+    datatype = data.image[IDin[0]].md[0].datatype;
 
     arraysize = (uint32_t *) malloc(sizeof(uint32_t) * 2);
     if(arraysize == NULL)
@@ -137,187 +137,88 @@ imageID COREMOD_MEMORY_streamPaste(
     }
     free(arraysize);
 
+    // row size [byte]
+    size_t rowsize = (size_t) xsize * ImageStreamIO_typesize(datatype);
 
-    FrameIndex = 0;
 
-    while(1)
-    {
-        if(FrameIndex == 0)
-        {
-            // has new frame 0 arrived ?
-            if(data.image[ID0].md[0].sem == 0)
-            {
-                while(cnt == data.image[ID0].md[0].cnt0) // test if new frame exists
-                {
-                    usleep(5);
-                }
-                cnt = data.image[ID0].md[0].cnt0;
-            }
-            else
-            {
-                sem_wait(data.image[ID0].semptr[semtrig0]);
-            }
-            Xoffset = 0;
-            IDin = 0;
-        }
-        else
-        {
-            // has new frame 1 arrived ?
-            if(data.image[ID1].md[0].sem == 0)
-            {
-                while(cnt == data.image[ID1].md[0].cnt0) // test if new frame exists
-                {
-                    usleep(5);
-                }
-                cnt = data.image[ID1].md[0].cnt0;
-            }
-            else
-            {
-                sem_wait(data.image[ID1].semptr[semtrig1]);
-            }
-            Xoffset = xsize;
-            IDin = 1;
-        }
+    PROCESSINFO *processinfo;
 
+    char pinfoname[200];
+    sprintf(pinfoname, "streampaste-%s", IDstreamout_name);
+    char pinfodescr[200];
+    sprintf(pinfodescr, "%s+%s", IDstream0_name, IDstream1_name);
+    char msgstring[200];
+    sprintf(msgstring, "%s,%s->%s", IDstream0_name, IDstream1_name,
+            IDstreamout_name);
 
-        data.image[IDout].md[0].write = 1;
+    processinfo = processinfo_setup(
+                      pinfoname,
+                      pinfodescr,
+                      msgstring,
+                      __FUNCTION__, __FILE__, __LINE__
+                  );
+    processinfo->MeasureTiming = 1;
 
-        switch(datatype)
-        {
-            case _DATATYPE_UINT8 :
-                for(uint32_t ii = 0; ii < xsize; ii++)
-                    for(uint32_t jj = 0; jj < ysize; jj++)
-                    {
-                        data.image[IDout].array.UI8[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.UI8[jj * xsize + ii];
-                    }
-                break;
-
-            case _DATATYPE_UINT16 :
-                for(uint32_t ii = 0; ii < xsize; ii++)
-                    for(uint32_t jj = 0; jj < ysize; jj++)
-                    {
-                        data.image[IDout].array.UI16[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.UI16[jj * xsize + ii];
-                    }
-                break;
-
-            case _DATATYPE_UINT32 :
-                for(uint32_t ii = 0; ii < xsize; ii++)
-                    for(uint32_t jj = 0; jj < ysize; jj++)
-                    {
-                        data.image[IDout].array.UI32[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.UI32[jj * xsize + ii];
-                    }
-                break;
+    semindex[0] = (int) semtrig0;
+    semindex[1] = (int) semtrig1;
+    if(processinfo_triggerset_init(processinfo, 2, IDin, semindex,
+                                   PROCESSINFO_TRIGGERMODE_ANY, 0) != RETURN_SUCCESS)
+    {
+        processinfo_error(processinfo, "cannot set up input triggers");
+        processinfo_cleanExit(processinfo);
+        return IDout;
+    }
 
-            case _DATATYPE_UINT64 :
-                for(uint32_t ii = 0; ii < xsize; ii++)
-                    for(uint32_t jj = 0; jj < ysize; jj++)
-                    {
-                        data.image[IDout].array.UI64[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.UI64[jj * xsize + ii];
-                    }
-                break;
+    processinfo_WriteMessage(processinfo, "Starting loop");
 
-            case _DATATYPE_INT8 :
-                for(uint32_t ii = 0; ii < xsize; ii++)
-                    for(uint32_t jj = 0; jj < ysize; jj++)
-                    {
-                        data.image[IDout].array.SI8[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.SI8[jj * xsize + ii];
-                    }
-                break;
+    processinfo_loopstart(processinfo);
 
-            case _DATATYPE_INT16 :
-                for(uint32_t ii = 0; ii < xsize; ii++)
-                    for(uint32_t jj = 0; jj < ysize; jj++)
-                    {
-                        data.image[IDout].array.SI16[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.SI16[jj * xsize + ii];
-                    }
-                break;
+    int loopOK = 1;
+    while(loopOK == 1)
+    {
+        loopOK = processinfo_loopstep(processinfo);
 
-            case _DATATYPE_INT32 :
-                for(uint32_t ii = 0; ii < xsize; ii++)
-                    for(uint32_t jj = 0; jj < ysize; jj++)
-                    {
-                        data.image[IDout].array.SI32[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.SI32[jj * xsize + ii];
-                    }
-                break;
+        processinfo_waitoninputstream(processinfo);
 
-            case _DATATYPE_INT64 :
-                for(uint32_t ii = 0; ii < xsize; ii++)
-                    for(uint32_t jj = 0; jj < ysize; jj++)
-                    {
-                        data.image[IDout].array.SI64[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.SI64[jj * xsize + ii];
-                    }
-                break;
+        processinfo_exec_start(processinfo);
 
-            case _DATATYPE_FLOAT :
-                for(uint32_t ii = 0; ii < xsize; ii++)
-                    for(uint32_t jj = 0; jj < ysize; jj++)
-                    {
-                        data.image[IDout].array.F[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.F[jj * xsize + ii];
-                    }
-                break;
+        if((processinfo_compute_status(processinfo) == 1)
+                && (processinfo->triggerstatus == PROCESSINFO_TRIGGERSTATUS_RECEIVED))
+        {
+            data.image[IDout].md[0].write = 1;
 
-            case _DATATYPE_DOUBLE :
-                for(uint32_t ii = 0; ii < xsize; ii++)
-                    for(uint32_t jj = 0; jj < ysize; jj++)
-                    {
-                        data.image[IDout].array.D[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.D[jj * xsize + ii];
-                    }
-                break;
+            int postout = 0;
+            for(int k = 0; k < 2; k++)
+            {
+                if(processinfo->trigsetreadymask & (1U << k))
+                {
+                    char *ptrin = (char *) data.image[IDin[k]].array.raw;
+                    char *ptrout = (char *) data.image[IDout].array.raw + k * rowsize;
 
-            case _DATATYPE_COMPLEX_FLOAT :
-                for(uint32_t ii = 0; ii < xsize; ii++)
                     for(uint32_t jj = 0; jj < ysize; jj++)
                     {
-                        data.image[IDout].array.CF[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.CF[jj * xsize + ii];
+                        memcpy(ptrout + jj * 2 * rowsize, ptrin + jj * rowsize, rowsize);
                     }
-                break;
-
-            case _DATATYPE_COMPLEX_DOUBLE :
-                for(uint32_t ii = 0; ii < xsize; ii++)
-                    for(uint32_t jj = 0; jj < ysize; jj++)
+                    data.image[IDout].md[0].cnt1 = k;
+                    if(k == master)
                     {
-                        data.image[IDout].array.CD[jj * 2 * xsize + ii + Xoffset] =
-                            data.image[IDin].array.CD[jj * xsize + ii];
+                        postout = 1;
                     }
-                break;
+                }
+            }
 
-            default :
-                printf("Unknown data type\n");
-                exit(0);
-                break;
-        }
-        if(FrameIndex == master)
-        {
-            COREMOD_MEMORY_image_set_sempost_byID(IDout, -1);;
-            data.image[IDout].md[0].cnt0++;
+            if(postout == 1)
+            {
+                COREMOD_MEMORY_image_set_sempost_byID(IDout, -1);
+                data.image[IDout].md[0].cnt0++;
+            }
+            data.image[IDout].md[0].write = 0;
         }
-        data.image[IDout].md[0].cnt1 = FrameIndex;
-        data.image[IDout].md[0].write = 0;
 
-        if(FrameIndex == 0)
-        {
-            FrameIndex = 1;
-        }
-        else
-        {
-            FrameIndex = 0;
-        }
+        processinfo_exec_end(processinfo);
     }
 
+    processinfo_cleanExit(processinfo);
+
     return IDout;
 }
-
-
-
-
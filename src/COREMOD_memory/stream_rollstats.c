@@ -0,0 +1,503 @@
+/**
+ * @file    stream_rollstats.c
+ * @brief   rolling statistics of stream over sliding window
+ *
+ * Maintains per-pixel mean, RMS, min and max over the last NBframe frames,
+ * and optionally an exponential moving average (EMA).
+ *
+ * Each new frame updates the statistics in O(pixels) :
+ * - mean and variance use Welford's update, extended to a sliding window
+ *   by removing the oldest frame as the new one is added
+ * - min/max are rescanned over the window for a pixel only when the value
+ *   leaving the window was the current extremum
+ *
+ * Outputs are float streams <outprefix>_mean, _rms, _min, _max and _ema.
+ * Runs as a standard processinfo loop : trigger on input stream semaphore
+ * with ..triggermode 3 and ..triggerstreamname <in_sname>.
+ */
+
+#include <math.h>
+
+#include "CommandLineInterface/CLIcore.h"
+
+#include "image_ID.h"
+#include "create_image.h"
+#include "delete_image.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#define OMP_NELEMENT_LIMIT 1000000
+#endif
+
+
+
+// variables local to this translation unit
+static char   *inimname;
+static long   *NBframe;
+static char   *outprefix;
+static long   *minmaxmode;
+static double *emacoeff;
+
+
+
+static CLICMDARGDEF farg[] =
+{
+    {
+        CLIARG_IMG,  ".in_sname", "input stream", "ims1",
+        CLIARG_VISIBLE_DEFAULT,
+        (void **) &inimname
+    },
+    {
+        CLIARG_LONG, ".NBframe", "sliding window size [frame]", "100",
+        CLIARG_VISIBLE_DEFAULT,
+        (void **) &NBframe
+    },
+    {
+        CLIARG_STR, ".outprefix", "output streams prefix", "rstat",
+        CLIARG_VISIBLE_DEFAULT,
+        (void **) &outprefix
+    },
+    {
+        CLIARG_LONG, ".minmax", "compute min/max (0/1)", "1",
+        CLIARG_HIDDEN_DEFAULT,
+        (void **) &minmaxmode
+    },
+    {
+        CLIARG_FLOAT, ".emacoeff", "EMA coefficient, 0 to disable", "0.0",
+        CLIARG_HIDDEN_DEFAULT,
+        (void **) &emacoeff
+    }
+};
+
+static CLICMDDATA CLIcmddata =
+{
+    "streamrollstats",
+    "rolling mean/RMS/min/max of stream",
+    CLICMD_FIELDS_DEFAULTS
+};
+
+
+// detailed help
+static errno_t help_function()
+{
+    printf(
+        "Per-pixel statistics of input stream over the last NBframe frames\n"
+        "Output streams (float, shared memory):\n"
+        "    <outprefix>_mean   running mean\n"
+        "    <outprefix>_rms    running standard deviation\n"
+        "    <outprefix>_min    running min (if minmax=1)\n"
+        "    <outprefix>_max    running max (if minmax=1)\n"
+        "    <outprefix>_ema    exponential moving average (if emacoeff>0)\n"
+        "Statistics cover fewer frames until NBframe frames have been received.\n"
+        "To trigger on input stream semaphore:\n"
+        "    streamrollstats ..triggermode 3\n"
+        "    streamrollstats ..triggerstreamname <in_sname>\n"
+    );
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+typedef struct
+{
+    uint64_t nelement;
+    long     NBframe;
+    long     cnt;       // number of frames received
+    long     slot;      // ring slot for next frame
+
+    float   *ring;      // NBframe x nelement, last frames
+    double  *mean;
+    double  *M2;        // sum of squared deviations from mean
+    float   *min;
+    float   *max;
+    double  *ema;
+
+    int      minmax;
+    double   emacoeff;
+} ROLLSTATS;
+
+
+
+
+static errno_t rollstats_init(
+    ROLLSTATS *rs,
+    uint64_t   nelement,
+    long       NBframe,
+    int        minmax,
+    double     emacoeff
+)
+{
+    rs->nelement = nelement;
+    rs->NBframe = NBframe;
+    rs->cnt = 0;
+    rs->slot = 0;
+    rs->minmax = minmax;
+    rs->emacoeff = emacoeff;
+
+    rs->ring = (float *) calloc(nelement * NBframe, sizeof(float));
+    rs->mean = (double *) calloc(nelement, sizeof(double));
+    rs->M2 = (double *) calloc(nelement, sizeof(double));
+    rs->min = NULL;
+    rs->max = NULL;
+    rs->ema = NULL;
+    if(minmax == 1)
+    {
+        rs->min = (float *) malloc(sizeof(float) * nelement);
+        rs->max = (float *) malloc(sizeof(float) * nelement);
+    }
+    if(emacoeff > 0.0)
+    {
+        rs->ema = (double *) malloc(sizeof(double) * nelement);
+    }
+
+    if((rs->ring == NULL) || (rs->mean == NULL) || (rs->M2 == NULL)
+            || ((minmax == 1) && ((rs->min == NULL) || (rs->max == NULL)))
+            || ((emacoeff > 0.0) && (rs->ema == NULL)))
+    {
+        PRINT_ERROR("malloc error");
+        return RETURN_FAILURE;
+    }
+
+    return RETURN_SUCCESS;
+}
+
+
+
+static void rollstats_free(
+    ROLLSTATS *rs
+)
+{
+    free(rs->ring);
+    free(rs->mean);
+    free(rs->M2);
+    free(rs->min);
+    free(rs->max);
+    free(rs->ema);
+}
+
+
+
+
+/** @brief Rescan min and max of pixel ii over window
+ */
+static void rollstats_rescan(
+    ROLLSTATS *rs,
+    uint64_t   ii,
+    long       NBf
+)
+{
+    float vmin = rs->ring[ii];
+    float vmax = rs->ring[ii];
+
+    for(long k = 1; k < NBf; k++)
+    {
+        float v = rs->ring[k * rs->nelement + ii];
+        vmin = (v < vmin) ? v : vmin;
+        vmax = (v > vmax) ? v : vmax;
+    }
+    rs->min[ii] = vmin;
+    rs->max[ii] = vmax;
+}
+
+
+
+
+/**
+ * Add frame to rolling statistics, input pixel type T
+ *
+ * Window not full (n frames after this one):
+ *   mean += (x - mean) / n ; M2 += (x - mean_old) * (x - mean_new)
+ * Window full, x replaces xold:
+ *   mean += (x - xold) / N ; M2 += (x - xold) * (x - mean_new + xold - mean_old)
+ */
+#define ROLLSTATS_UPDATEDEF(name, T)                                         \
+    static void name(ROLLSTATS *rs, const T *restrict in)                    \
+    {                                                                        \
+        uint64_t nelement = rs->nelement;                                    \
+        long     N = rs->NBframe;                                            \
+        int      full = (rs->cnt >= N);                                      \
+        long     n = full ? N : rs->cnt + 1;                                 \
+        double   invn = 1.0 / n;                                             \
+        float   *ringslot = rs->ring + rs->slot * nelement;                  \
+                                                                             \
+        OMP_ROLLSTATS_FOR                                                    \
+        for(uint64_t ii = 0; ii < nelement; ii++)                            \
+        {                                                                    \
+            float  x = (float) in[ii];                                       \
+            double m0 = rs->mean[ii];                                        \
+            double m1;                                                       \
+            float  xold = ringslot[ii];                                      \
+                                                                             \
+            ringslot[ii] = x;                                                \
+            if(full)                                                         \
+            {                                                                \
+                m1 = m0 + ((double) x - xold) * invn;                        \
+                rs->M2[ii] += ((double) x - xold) * ((x - m1) + (xold - m0)); \
+            }                                                                \
+            else                                                             \
+            {                                                                \
+                m1 = m0 + (x - m0) * invn;                                   \
+                rs->M2[ii] += (x - m0) * (x - m1);                           \
+            }                                                                \
+            rs->mean[ii] = m1;                                               \
+                                                                             \
+            if(rs->min != NULL)                                              \
+            {                                                                \
+                if(n == 1)                                                   \
+                {                                                            \
+                    rs->min[ii] = x;                                         \
+                    rs->max[ii] = x;                                         \
+                }                                                            \
+                else if(full && ((xold == rs->min[ii]) || (xold == rs->max[ii]))) \
+                {                                                            \
+                    rollstats_rescan(rs, ii, N);                             \
+                }                                                            \
+                else                                                         \
+                {                                                            \
+                    rs->min[ii] = (x < rs->min[ii]) ? x : rs->min[ii];       \
+                    rs->max[ii] = (x > rs->max[ii]) ? x : rs->max[ii];       \
+                }                                                            \
+            }                                                                \
+                                                                             \
+            if(rs->ema != NULL)                                              \
+            {                                                                \
+                if(rs->cnt == 0)                                             \
+                {                                                            \
+                    rs->ema[ii] = x;                                         \
+                }                                                            \
+                else                                                         \
+                {                                                            \
+                    rs->ema[ii] += rs->emacoeff * (x - rs->ema[ii]);         \
+                }                                                            \
+            }                                                                \
+        }                                                                    \
+    }
+
+#ifdef _OPENMP
+#define OMP_ROLLSTATS_FOR _Pragma("omp parallel for if (nelement > OMP_NELEMENT_LIMIT)")
+#else
+#define OMP_ROLLSTATS_FOR
+#endif
+
+ROLLSTATS_UPDATEDEF(rollstats_update_UI8,  uint8_t)
+ROLLSTATS_UPDATEDEF(rollstats_update_SI8,  int8_t)
+ROLLSTATS_UPDATEDEF(rollstats_update_UI16, uint16_t)
+ROLLSTATS_UPDATEDEF(rollstats_update_SI16, int16_t)
+ROLLSTATS_UPDATEDEF(rollstats_update_UI32, uint32_t)
+ROLLSTATS_UPDATEDEF(rollstats_update_SI32, int32_t)
+ROLLSTATS_UPDATEDEF(rollstats_update_UI64, uint64_t)
+ROLLSTATS_UPDATEDEF(rollstats_update_SI64, int64_t)
+ROLLSTATS_UPDATEDEF(rollstats_update_F,    float)
+ROLLSTATS_UPDATEDEF(rollstats_update_D,    double)
+
+
+
+
+static errno_t rollstats_update(
+    ROLLSTATS *rs,
+    IMGID      inimg
+)
+{
+    switch(inimg.md->datatype)
+    {
+    case _DATATYPE_UINT8 :
+        rollstats_update_UI8(rs, inimg.im->array.UI8);
+        break;
+    case _DATATYPE_INT8 :
+        rollstats_update_SI8(rs, inimg.im->array.SI8);
+        break;
+    case _DATATYPE_UINT16 :
+        rollstats_update_UI16(rs, inimg.im->array.UI16);
+        break;
+    case _DATATYPE_INT16 :
+        rollstats_update_SI16(rs, inimg.im->array.SI16);
+        break;
+    case _DATATYPE_UINT32 :
+        rollstats_update_UI32(rs, inimg.im->array.UI32);
+        break;
+    case _DATATYPE_INT32 :
+        rollstats_update_SI32(rs, inimg.im->array.SI32);
+        break;
+    case _DATATYPE_UINT64 :
+        rollstats_update_UI64(rs, inimg.im->array.UI64);
+        break;
+    case _DATATYPE_INT64 :
+        rollstats_update_SI64(rs, inimg.im->array.SI64);
+        break;
+    case _DATATYPE_FLOAT :
+        rollstats_update_F(rs, inimg.im->array.F);
+        break;
+    case _DATATYPE_DOUBLE :
+        rollstats_update_D(rs, inimg.im->array.D);
+        break;
+    default :
+        PRINT_ERROR("data type not supported");
+        return RETURN_FAILURE;
+    }
+
+    rs->cnt++;
+    rs->slot++;
+    if(rs->slot == rs->NBframe)
+    {
+        rs->slot = 0;
+    }
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+/** @brief Connect to or create output stream <outprefix>_<suffix>
+ *
+ * Existing stream is re-created if type or size does not match input.
+ */
+static IMGID rollstats_outstream(
+    IMGID       inimg,
+    const char *suffix
+)
+{
+    char name[STRINGMAXLEN_IMAGE_NAME];
+    WRITE_IMAGENAME(name, "%s_%s", outprefix, suffix);
+
+    IMGID img = makeIMGID(name);
+    img.datatype = _DATATYPE_FLOAT;
+    img.shared = 1;
+    img.naxis = inimg.md->naxis;
+    for(int k = 0; k < 3; k++)
+    {
+        img.size[k] = (k < img.naxis) ? inimg.md->size[k] : 1;
+    }
+
+    resolveIMGID(&img, ERRMODE_NULL);
+    if(img.ID != -1)
+    {
+        int OK = (img.md->datatype == _DATATYPE_FLOAT)
+                 && (img.md->nelement == inimg.md->nelement);
+        if(OK == 0)
+        {
+            delete_image_ID(img.name, DELETE_IMAGE_ERRMODE_WARNING);
+            img.ID = -1;
+        }
+    }
+    imcreateIMGID(&img);
+
+    return img;
+}
+
+
+
+static void rollstats_publish(
+    PROCESSINFO *processinfo,
+    IMGID        img,
+    const double *srcD,
+    const float  *srcF,
+    int          rms,
+    long         n
+)
+{
+    uint64_t nelement = img.md->nelement;
+    float   *dst = img.im->array.F;
+
+    img.md->write = 1;
+    if(srcF != NULL)
+    {
+        memcpy(dst, srcF, sizeof(float) * nelement);
+    }
+    else if(rms == 1)
+    {
+        double invn = 1.0 / n;
+        for(uint64_t ii = 0; ii < nelement; ii++)
+        {
+            double v = srcD[ii] * invn;
+            dst[ii] = (v > 0.0) ? (float) sqrt(v) : 0.0f;
+        }
+    }
+    else
+    {
+        for(uint64_t ii = 0; ii < nelement; ii++)
+        {
+            dst[ii] = (float) srcD[ii];
+        }
+    }
+    processinfo_update_output_stream(processinfo, img.ID);
+}
+
+
+
+
+// Wrapper function, used by all CLI calls
+static errno_t compute_function()
+{
+    IMGID inimg = makeIMGID(inimname);
+    resolveIMGID(&inimg, ERRMODE_ABORT);
+
+    if(*NBframe < 1)
+    {
+        PRINT_ERROR("NBframe = %ld, must be >= 1", *NBframe);
+        return RETURN_FAILURE;
+    }
+
+    ROLLSTATS rs;
+    if(rollstats_init(&rs, inimg.md->nelement, *NBframe, (*minmaxmode == 1) ? 1 : 0,
+                      *emacoeff) != RETURN_SUCCESS)
+    {
+        rollstats_free(&rs);
+        return RETURN_FAILURE;
+    }
+
+    IMGID imgmean = rollstats_outstream(inimg, "mean");
+    IMGID imgrms = rollstats_outstream(inimg, "rms");
+    IMGID imgmin = imgmean;
+    IMGID imgmax = imgmean;
+    IMGID imgema = imgmean;
+    if(rs.minmax == 1)
+    {
+        imgmin = rollstats_outstream(inimg, "min");
+        imgmax = rollstats_outstream(inimg, "max");
+    }
+    if(rs.ema != NULL)
+    {
+        imgema = rollstats_outstream(inimg, "ema");
+    }
+
+    INSERT_STD_PROCINFO_COMPUTEFUNC_START
+
+    if(rollstats_update(&rs, inimg) == RETURN_SUCCESS)
+    {
+        long n = (rs.cnt < rs.NBframe) ? rs.cnt : rs.NBframe;
+
+        rollstats_publish(processinfo, imgmean, rs.mean, NULL, 0, n);
+        rollstats_publish(processinfo, imgrms, rs.M2, NULL, 1, n);
+        if(rs.minmax == 1)
+        {
+            rollstats_publish(processinfo, imgmin, NULL, rs.min, 0, n);
+            rollstats_publish(processinfo, imgmax, NULL, rs.max, 0, n);
+        }
+        if(rs.ema != NULL)
+        {
+            rollstats_publish(processinfo, imgema, rs.ema, NULL, 0, n);
+        }
+    }
+
+    INSERT_STD_PROCINFO_COMPUTEFUNC_END
+
+    rollstats_free(&rs);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+INSERT_STD_FPSCLIfunctions
+
+// Register function in CLI
+errno_t CLIADDCMD_COREMOD_memory__stream_rollstats()
+{
+    INSERT_STD_CLIREGISTERFUNC
+
+    return RETURN_SUCCESS;
+}
@@ -0,0 +1,10 @@
+/**
+ * @file    stream_rollstats.h
+ */
+
+#ifndef MILK_COREMOD_MEMORY_STREAM_ROLLSTATS_H
+#define MILK_COREMOD_MEMORY_STREAM_ROLLSTATS_H
+
+errno_t CLIADDCMD_COREMOD_memory__stream_rollstats();
+
+#endif
@@ -5,43 +5,60 @@
 
 
 #include "CommandLineInterface/CLIcore.h"
+#include "nameindex.h"
 
 
 
 
-
-/* ID number corresponding to a name */
-variableID variable_ID(
-    const char *name
+static const char *variable_ID_getname(
+    long ID
 )
 {
-    variableID i;
-    variableID tmpID;
-    int        loopOK;
+    return (data.variable[ID].used == 1) ? data.variable[ID].name : NULL;
+}
 
-    i = 0;
-    loopOK = 1;
-    while(loopOK == 1)
-    {
-        if(data.variable[i].used == 1)
-        {
-            if((strncmp(name, data.variable[i].name, strlen(name)) == 0)
-                    && (data.variable[i].name[strlen(name)] == '\0'))
-            {
-                loopOK = 0;
-                tmpID = i;
-            }
-        }
 
-        i++;
-        if(i == data.NB_MAX_VARIABLE)
-        {
-            loopOK = 0;
-            tmpID = -1;
-        }
+static NAMEINDEX *variable_ID_nameindex()
+{
+    // (re)build if variable array was resized
+    if(data.variable_nameindex.NBID != data.NB_MAX_VARIABLE)
+    {
+        nameindex_rebuild(&data.variable_nameindex, data.NB_MAX_VARIABLE,
+                          variable_ID_getname);
     }
+    return &data.variable_nameindex;
+}
+
+
+
+/** @brief Add variable to name index, once in use and named
+ */
+void variable_ID_register(
+    variableID ID
+)
+{
+    nameindex_insert(variable_ID_nameindex(), ID, variable_ID_getname);
+}
+
+
+/** @brief Remove variable from name index, before it is released
+ */
+void variable_ID_unregister(
+    variableID ID
+)
+{
+    nameindex_remove(variable_ID_nameindex(), ID, variable_ID_getname);
+}
+
+
 
-    return tmpID;
+
+/* ID number corresponding to a name */
+variableID variable_ID(
+    const char *name
+)
+{
+    return nameindex_find(variable_ID_nameindex(), name, variable_ID_getname);
 }
 
 
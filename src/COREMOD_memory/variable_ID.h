@@ -4,6 +4,14 @@
 
 
 
+void       variable_ID_register(
+    variableID ID
+);
+
+void       variable_ID_unregister(
+    variableID ID
+);
+
 variableID variable_ID(
     const char *name
 );
@@ -360,6 +360,28 @@ errno_t streamCTRL_CTRLscreen__cli()
 }
 
 
+errno_t streamCTRL_headless__cli()
+{
+    return(streamCTRL_headless());
+}
+
+
+errno_t processinfo_lathist_dump_PID__cli()
+{
+    if(CLI_checkarg(1, CLIARG_STR) + CLI_checkarg(2, CLIARG_LONG) == 0)
+    {
+        processinfo_lathist_dump_PID(
+            data.cmdargtoken[1].val.string,
+            data.cmdargtoken[2].val.numl);
+        return CLICMD_SUCCESS;
+    }
+    else
+    {
+        return CLICMD_INVALID_ARG;
+    }
+}
+
+
 
 
 
@@ -1176,6 +1198,15 @@ void runCLI_cmd_init()
         "procCTRL",
         "processinfo_CTRLscreen()");
 
+    RegisterCLIcommand(
+        "procinfolatdump",
+        __FILE__,
+        processinfo_lathist_dump_PID__cli,
+        "print loop latency histograms of process",
+        "<process name> <PID>",
+        "procinfolatdump streamDelay-00 12345",
+        "errno_t processinfo_lathist_dump_PID(const char *pname, long PID)");
+
 
 
 
@@ -1190,6 +1221,15 @@ void runCLI_cmd_init()
         "streamCTRL",
         "streamCTRL_CTRLscreen()");
 
+    RegisterCLIcommand(
+        "streamCTRLd",
+        __FILE__,
+        streamCTRL_headless__cli,
+        "headless stream scan, publish update rates to shared memory",
+        "no argument",
+        "streamCTRLd",
+        "streamCTRL_headless()");
+
 
 
     // FPS
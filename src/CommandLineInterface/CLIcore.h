@@ -358,6 +358,15 @@ typedef struct
 // number of entries stored in testpoint trace array
 #define CODETESTPOINTARRAY_NBCNT  100000
 
+// hash index from name to image or variable ID, see COREMOD_memory/nameindex.c
+typedef struct
+{
+    long  NBID;    // number of IDs indexed, table rebuilt if changed
+    long  size;    // number of slots, power of 2
+    long  NBfill;  // slots in use or deleted
+    long *slot;
+} NAMEINDEX;
+
 // THIS IS WHERE EVERYTHING THAT NEEDS TO BE WIDELY ACCESSIBLE GETS STORED
 typedef struct
 {
@@ -549,6 +558,8 @@ typedef struct
 #else
     IMAGE         *image;
 #endif
+    NAMEINDEX      image_nameindex;
+    int            image_accesstime; // 1 if image_ID() updates lastaccesstime
     int            MEM_MONITOR; // memory monitor enabled ?
 
     // shared memory default
@@ -569,6 +580,7 @@ typedef struct
 #else
     VARIABLE      *variable;
 #endif
+    NAMEINDEX      variable_nameindex;
 
 
 
@@ -111,9 +111,13 @@ typedef struct
     char triggerstreamname[STRINGMAXLEN_IMAGE_NAME];
     struct timespec triggerdelay;
     struct timespec triggertimeout;
+    long triggerspin_ns;  // busy-poll budget for SPINSEM mode
+    long triggertolerance_ns; // ALL mode input alignment tolerance, 0 if unused
 
     int RT_priority;    // -1 if unused. 0-99 for higher priority
     cpu_set_t CPUmask;
+    int procinfo_memlock;
+    int procinfo_NUMAbind;
 
     int procinfo_MeasureTiming;
 
@@ -69,6 +69,16 @@ void CLI_data_init()
         data.image[i].createcnt = 0;
     }
 
+    // name index built on first lookup
+    data.image_nameindex.NBID = 0;
+    data.image_nameindex.size = 0;
+    data.image_nameindex.slot = NULL;
+    data.variable_nameindex.NBID = 0;
+    data.variable_nameindex.size = 0;
+    data.variable_nameindex.slot = NULL;
+
+    data.image_accesstime = 1;
+
 
 
 
@@ -121,6 +131,14 @@ void CLI_data_init()
         data.fpsarray[fpsindex].SMfd = -1;
         data.fpsarray[fpsindex].md = NULL;
         data.fpsarray[fpsindex].parray = NULL;
+        data.fpsarray[fpsindex].pdescr = NULL;
+        data.fpsarray[fpsindex].phash = NULL;
+        data.fpsarray[fpsindex].NBhash = 0;
+        data.fpsarray[fpsindex].notify = NULL;
+        data.fpsarray[fpsindex].notifydefer = 0;
+        data.fpsarray[fpsindex].shmaddr = NULL;
+        data.fpsarray[fpsindex].shmsize = 0;
+        data.fpsarray[fpsindex].layoutversion = 0;
     }
 
 
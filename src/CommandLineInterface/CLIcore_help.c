@@ -577,6 +577,18 @@ errno_t help_command(
                     case PROCESSINFO_TRIGGERMODE_DELAY:
                         printf("DELAY");
                         break;
+                    case PROCESSINFO_TRIGGERMODE_SPINWAIT:
+                        printf("SPINWAIT");
+                        break;
+                    case PROCESSINFO_TRIGGERMODE_SPINSEM:
+                        printf("SPINSEM");
+                        break;
+                    case PROCESSINFO_TRIGGERMODE_ANY:
+                        printf("ANY");
+                        break;
+                    case PROCESSINFO_TRIGGERMODE_ALL:
+                        printf("ALL");
+                        break;
                     default:
                         printf("unknown");
                         break;
@@ -594,6 +606,12 @@ errno_t help_command(
                            (long long)data.cmd[cmdi].cmdsettings.triggertimeout.tv_sec,
                            data.cmd[cmdi].cmdsettings.triggertimeout.tv_nsec);
 
+                    printf("        triggerspinns      : %ld\n",
+                           data.cmd[cmdi].cmdsettings.triggerspin_ns);
+
+                    printf("        triggertolerance   : %.3f us\n",
+                           0.001 * data.cmd[cmdi].cmdsettings.triggertolerance_ns);
+
                     printf("      Resources:\n");
                     printf("        RT_priority        : %d\n",
 
@@ -607,6 +625,10 @@ errno_t help_command(
                         printf(" %d", CPU_ISSET(cpu, &data.cmd[cmdi].cmdsettings.CPUmask));
                     }
                     printf("\n");
+                    printf("        memlock            : %d\n",
+                           data.cmd[cmdi].cmdsettings.procinfo_memlock);
+                    printf("        NUMAbind           : %d\n",
+                           data.cmd[cmdi].cmdsettings.procinfo_NUMAbind);
                     printf("        MeasureTiming      : %d\n",
                            data.cmd[cmdi].cmdsettings.procinfo_MeasureTiming);
                 }
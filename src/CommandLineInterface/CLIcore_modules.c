@@ -528,6 +528,7 @@ uint32_t RegisterCLIcmd(
 
     data.cmd[data.NBcmd].cmdsettings.procinfo_loopcntMax = 1;
     data.cmd[data.NBcmd].cmdsettings.procinfo_MeasureTiming = 1;
+    data.cmd[data.NBcmd].cmdsettings.triggerspin_ns = PROCESSINFO_TRIGGERSPIN_NS_DEFAULT;
 
     data.NBcmd++;
 
@@ -165,11 +165,15 @@ if( CLIcmddata.cmdsettings->flags & CLICMDFLAG_PROCINFO)\
     strcpy(processinfo->triggerstreamname, CLIcmddata.cmdsettings->triggerstreamname);\
     processinfo->triggerdelay = CLIcmddata.cmdsettings->triggerdelay;\
     processinfo->triggertimeout = CLIcmddata.cmdsettings->triggertimeout;\
+    processinfo->triggerspin_ns = CLIcmddata.cmdsettings->triggerspin_ns;\
+    processinfo->trigsettolerance_ns = CLIcmddata.cmdsettings->triggertolerance_ns;\
     processinfo->triggerstreamID = image_ID(processinfo->triggerstreamname); \
     processinfo_waitoninputstream_init(processinfo, processinfo->triggerstreamID, \
         CLIcmddata.cmdsettings->triggermode, -1); \
     processinfo->RT_priority = CLIcmddata.cmdsettings->RT_priority;\
     processinfo->CPUmask = CLIcmddata.cmdsettings->CPUmask;\
+    processinfo->memlock = CLIcmddata.cmdsettings->procinfo_memlock;\
+    processinfo->NUMAbind = CLIcmddata.cmdsettings->procinfo_NUMAbind;\
  \
     processinfo->MeasureTiming =  CLIcmddata.cmdsettings->procinfo_MeasureTiming;\
 \
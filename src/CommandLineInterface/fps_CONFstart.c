@@ -34,6 +34,7 @@ errno_t functionparameter_CONFstart(
 
     // notify GUI loop to update
     fps->md->signal |= FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE;
+    functionparameter_notify_change(fps->notify, -1);
 
     return RETURN_SUCCESS;
 }
@@ -18,6 +18,7 @@ errno_t functionparameter_CONFstop(
 {
 	// send conf stop signal
 	fps->md->signal &= ~FUNCTION_PARAMETER_STRUCT_SIGNAL_CONFRUN;
+    functionparameter_notify_change(fps->notify, -1);
 
     return RETURN_SUCCESS;
 }
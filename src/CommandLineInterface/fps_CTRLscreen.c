@@ -483,6 +483,7 @@ errno_t functionparameter_CTRLscreen(
     fpsCTRLvar.directorynodeSelected = 0;
     fpsCTRLvar.currentlevel          = 0;
     fpsCTRLvar.direction             = 1;
+    fpsCTRLvar.setvalbatch           = 0;
     strcpy(fpsCTRLvar.fpsnamemask, fpsnamemask);
     strcpy(fpsCTRLvar.fpsCTRLfifoname, fpsCTRLfifoname);
 
@@ -554,6 +555,7 @@ errno_t functionparameter_CTRLscreen(
     {
         fpsctrltasklist[cmdindex].status = 0;
         fpsctrltasklist[cmdindex].queue = 0;
+        fpsctrltasklist[cmdindex].nextindex = -1;
     }
 
     // Set up task queue list
@@ -569,6 +571,8 @@ errno_t functionparameter_CTRLscreen(
     for(int queueindex = 0; queueindex < NB_FPSCTRL_TASKQUEUE_MAX; queueindex++)
     {
         fpsctrlqueuelist[queueindex].priority = 1; // 0 = not active
+        fpsctrlqueuelist[queueindex].taskhead = -1;
+        fpsctrlqueuelist[queueindex].tasktail = -1;
     }
 
 
@@ -1276,7 +1280,7 @@ errno_t functionparameter_CTRLscreen(
                                     screenprint_setreverse();
                                 }
 
-                                TUI_printfw(" %-20s", data.fpsarray[fpsindex].parray[pindex].keyword[level - 1]);
+                                TUI_printfw(" %-20s", data.fpsarray[fpsindex].pdescr[pindex].keyword[level - 1]);
 
                                 if(GUIline == fpsCTRLvar.GUIlineSelected[fpsCTRLvar.currentlevel])
                                 {
@@ -1748,7 +1752,7 @@ errno_t functionparameter_CTRLscreen(
                                     }
                                 }
 
-                                TUI_printfw("    %s", data.fpsarray[fpsindex].parray[pindex].description);
+                                TUI_printfw("    %s", data.fpsarray[fpsindex].pdescr[pindex].description);
 
 
 
@@ -1826,7 +1830,7 @@ errno_t functionparameter_CTRLscreen(
                     {
                         pindex = data.fpsarray[fpsCTRLvar.fpsindexSelected].md->msgpindex[msgi];
                         TUI_printfw("%-40s %s",
-                                    data.fpsarray[fpsCTRLvar.fpsindexSelected].parray[pindex].keywordfull,
+                                    data.fpsarray[fpsCTRLvar.fpsindexSelected].pdescr[pindex].keywordfull,
                                     data.fpsarray[fpsCTRLvar.fpsindexSelected].md->message[msgi]);
                         TUI_newline();
                     }
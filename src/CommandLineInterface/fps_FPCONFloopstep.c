@@ -16,6 +16,8 @@ uint16_t function_parameter_FPCONFloopstep(
     uint16_t updateFLAG = 0;
 
     static uint32_t prev_status;
+    static uint32_t notifyseq = 0;
+    static struct timespec tnotify = {0, 0};
     //static uint32_t statuschanged = 0;
 
 
@@ -74,7 +76,58 @@ uint16_t function_parameter_FPCONFloopstep(
             fps->md->signal &=
                 ~FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE; // disable update (should be moved to conf process)
         }
-        usleep(fps->md->confwaitus);
+
+        // wait for parameter change
+        // without change notification, sleep confwaitus as before
+        // with change notification, wake up on change, and at least every
+        // FPS_NOTIFY_CONFWAIT_MAXUS to test process status.
+        // Only changes of user-writable parameters (FPFLAG_WRITECONF or
+        // FPFLAG_WRITERUN) request an update : RUN process outputs and
+        // status parameters do not. Consecutive change-triggered updates
+        // are at least confwaitus apart, so that a CONF process writing its
+        // own parameters does not loop faster than without notification.
+        long waitus = fps->md->confwaitus;
+        if((fps->notify != NULL) && (waitus < FPS_NOTIFY_CONFWAIT_MAXUS))
+        {
+            waitus = FPS_NOTIFY_CONFWAIT_MAXUS;
+        }
+        if(functionparameter_notify_wait(fps, &notifyseq, waitus) == 1)
+        {
+            long NBdirtyword = fps->notify->NBdirtyword;
+            uint64_t dirty[NBdirtyword];
+            int userchange = 0;
+
+            if(functionparameter_notify_fetchdirty(fps, FPS_NOTIFY_CONF, dirty,
+                                                   NBdirtyword) > 0)
+            {
+                for(long pindex = 0; pindex < fps->md->NBparamMAX; pindex++)
+                {
+                    if((dirty[pindex / 64] & (1UL << (pindex % 64)))
+                            && (fps->parray[pindex].fpflag & (FPFLAG_WRITECONF | FPFLAG_WRITERUN)))
+                    {
+                        userchange = 1;
+                        break;
+                    }
+                }
+            }
+
+            if(userchange == 1)
+            {
+                struct timespec tnow;
+                clock_gettime(CLOCK_MONOTONIC, &tnow);
+                long dtus = (tnow.tv_sec - tnotify.tv_sec) * 1000000L
+                            + (tnow.tv_nsec - tnotify.tv_nsec) / 1000L;
+                if((dtus >= 0) && (dtus < (long) fps->md->confwaitus))
+                {
+                    usleep(fps->md->confwaitus - dtus);
+                    clock_gettime(CLOCK_MONOTONIC, &tnow);
+                }
+                tnotify = tnow;
+
+                // processed at next loop step
+                fps->md->signal |= FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE;
+            }
+        }
     }
     else
     {
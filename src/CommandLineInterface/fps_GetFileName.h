@@ -10,7 +10,7 @@
 
 int functionparameter_GetFileName(
     FUNCTION_PARAMETER_STRUCT *fps,
-    FUNCTION_PARAMETER *fparam,
+    FUNCTION_PARAMETER_DESCR *fparam,
     char *outfname,
     char *tagname
 );
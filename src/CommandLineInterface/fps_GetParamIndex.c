@@ -1,50 +1,205 @@
 /**
- * @file    fps_GetParamIndex.h
+ * @file    fps_GetParamIndex.c
  * @brief   Get index of parameter
+ *
+ * Parameters are looked up by exact full keyword match, through the
+ * keywordfull hash table stored in FPS shared memory (layout version 3+).
+ * Older FPS files have no hash table and are scanned linearly.
  */
 
 
 #include "CommandLineInterface/CLIcore.h"
 
+#include "fps_GetParamIndex.h"
 
 
 
-int functionparameter_GetParamIndex(
+#define FPS_HASH_EMPTY -1
+
+
+
+/** @brief FNV-1a hash of full keyword
+ */
+static uint32_t functionparameter_keywordhash(
+    const char *keyword
+)
+{
+    uint32_t hash = 2166136261U;
+
+    while(*keyword != '\0')
+    {
+        hash ^= (uint8_t)(*keyword);
+        hash *= 16777619U;
+        keyword++;
+    }
+
+    return hash;
+}
+
+
+
+/** @brief Hash table size for NBparamMAX entries
+ *
+ * Power of 2, at least twice the number of entries.
+ */
+long functionparameter_hash_size(
+    long NBparamMAX
+)
+{
+    long NBhash = 16;
+
+    while(NBhash < 2 * NBparamMAX)
+    {
+        NBhash *= 2;
+    }
+
+    return NBhash;
+}
+
+
+
+/** @brief Initialize empty hash table
+ */
+errno_t functionparameter_hash_init(
+    int32_t *phash,
+    long     NBhash
+)
+{
+    for(long hindex = 0; hindex < NBhash; hindex++)
+    {
+        phash[hindex] = FPS_HASH_EMPTY;
+    }
+
+    return RETURN_SUCCESS;
+}
+
+
+
+/** @brief Add parameter pindex to hash table
+ *
+ * Called once keywordfull has been written.
+ * Entries are never removed: lookup checks keyword and FPFLAG_ACTIVE.
+ */
+errno_t functionparameter_hash_insert(
     FUNCTION_PARAMETER_STRUCT *fps,
-    const char                *paramname
+    long                       pindex
 )
 {
-    long index = -1;
-    long pindex = 0;
+    if(fps->phash == NULL)
+    {
+        return RETURN_SUCCESS;
+    }
 
+    uint32_t mask = (uint32_t)(fps->NBhash - 1);
+    uint32_t hindex = functionparameter_keywordhash(
+                          fps->pdescr[pindex].keywordfull) & mask;
 
-    long NBparamMAX = fps->md->NBparamMAX;
+    for(long probe = 0; probe < fps->NBhash; probe++)
+    {
+        int32_t slot = fps->phash[hindex];
 
-    int found = 0;
-    for(pindex = 0; pindex < NBparamMAX; pindex++)
+        if(slot == (int32_t) pindex)
+        {
+            return RETURN_SUCCESS;
+        }
+        if(slot == FPS_HASH_EMPTY)
+        {
+            fps->phash[hindex] = (int32_t) pindex;
+            return RETURN_SUCCESS;
+        }
+        hindex = (hindex + 1) & mask;
+    }
+
+    PRINT_ERROR("FPS %s keyword hash table full", fps->md->name);
+    return RETURN_FAILURE;
+}
+
+
+
+// index of active parameter with full keyword, -1 if not found
+static long functionparameter_GetParamIndex_full(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *keywordfull
+)
+{
+    if(fps->phash == NULL)
     {
-        if(found == 0)
+        long NBparamMAX = fps->md->NBparamMAX;
+        for(long pindex = 0; pindex < NBparamMAX; pindex++)
         {
-            if(fps->parray[pindex].fpflag & FPFLAG_ACTIVE)
+            if((fps->parray[pindex].fpflag & FPFLAG_ACTIVE)
+                    && (strcmp(fps->pdescr[pindex].keywordfull, keywordfull) == 0))
             {
-                if(strstr(fps->parray[pindex].keywordfull, paramname) != NULL)
-                {
-                    index = pindex;
-                    found = 1;
-                }
+                return pindex;
             }
         }
+        return -1;
+    }
+
+    uint32_t mask = (uint32_t)(fps->NBhash - 1);
+    uint32_t hindex = functionparameter_keywordhash(keywordfull) & mask;
+
+    for(long probe = 0; probe < fps->NBhash; probe++)
+    {
+        int32_t slot = fps->phash[hindex];
+
+        if(slot == FPS_HASH_EMPTY)
+        {
+            break;
+        }
+        if((fps->parray[slot].fpflag & FPFLAG_ACTIVE)
+                && (strcmp(fps->pdescr[slot].keywordfull, keywordfull) == 0))
+        {
+            return slot;
+        }
+        hindex = (hindex + 1) & mask;
+    }
+
+    return -1;
+}
+
+
+
+/** @brief Get index of parameter
+ *
+ * paramname is matched exactly against full keywords. It can be :
+ * - full keyword     : fpsname.conf.gain
+ * - relative keyword : .conf.gain or conf.gain, fps name is prepended
+ *
+ * @return parameter index, -1 if not found
+ */
+int functionparameter_GetParamIndex(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname
+)
+{
+    char keywordfull[FUNCTION_PARAMETER_KEYWORD_STRMAXLEN *
+                     FUNCTION_PARAMETER_KEYWORD_MAXLEVEL];
+    long index = -1;
+
+    if(paramname[0] != '.')
+    {
+        index = functionparameter_GetParamIndex_full(fps, paramname);
     }
 
-    /*
     if(index == -1)
     {
-        printf("ERROR: cannot find parameter \"%s\" in structure\n", paramname);
-        printf("STEP %s %d\n", __FILE__, __LINE__);
-        fflush(stdout);
-        exit(0);
+        int slen;
+        if(paramname[0] == '.')
+        {
+            slen = snprintf(keywordfull, sizeof(keywordfull), "%s%s", fps->md->name,
+                            paramname);
+        }
+        else
+        {
+            slen = snprintf(keywordfull, sizeof(keywordfull), "%s.%s", fps->md->name,
+                            paramname);
+        }
+        if((slen > 0) && (slen < (int) sizeof(keywordfull)))
+        {
+            index = functionparameter_GetParamIndex_full(fps, keywordfull);
+        }
     }
-    */
 
     return index;
 }
@@ -8,9 +8,23 @@
 
 #include "function_parameters.h"
 
+long functionparameter_hash_size(
+    long NBparamMAX
+);
+
+errno_t functionparameter_hash_init(
+    int32_t *phash,
+    long     NBhash
+);
+
+errno_t functionparameter_hash_insert(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    long                       pindex
+);
+
 int functionparameter_GetParamIndex(
     FUNCTION_PARAMETER_STRUCT *fps,
     const char                *paramname
 );
 
-#endif
\ No newline at end of file
+#endif
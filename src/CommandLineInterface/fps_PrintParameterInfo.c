@@ -23,7 +23,7 @@ errno_t functionparameter_PrintParameterInfo(
     int pindex
 )
 {
-    printf("%s\n", fpsentry->parray[pindex].description);
+    printf("%s\n", fpsentry->pdescr[pindex].description);
     printf("\n");
 
 
@@ -64,7 +64,7 @@ errno_t functionparameter_PrintParameterInfo(
 
     printf("------------- FUNCTION PARAMETER \n");
     printf("[%d] Parameter name : %s\n", pindex,
-           fpsentry->parray[pindex].keywordfull);
+           fpsentry->pdescr[pindex].keywordfull);
 
     char typestring[100];
     functionparameter_GetTypeString(fpsentry->parray[pindex].type, typestring);
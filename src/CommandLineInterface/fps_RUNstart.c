@@ -83,6 +83,7 @@ errno_t functionparameter_RUNstart(
         fps->md->status |= FUNCTION_PARAMETER_STRUCT_STATUS_CMDRUN;
         fps->md->signal |=
             FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE; // notify GUI loop to update
+        functionparameter_notify_change(fps->notify, -1);
     }
     return RETURN_SUCCESS;
 }
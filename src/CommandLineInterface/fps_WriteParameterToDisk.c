@@ -61,7 +61,7 @@ int functionparameter_WriteParameterToDisk(
 
     if(strcmp(tagname, "setval") == 0)   // VALUE
     {
-        functionparameter_GetFileName(fpsentry, &(fpsentry->parray[pindex]), fname,
+        functionparameter_GetFileName(fpsentry, &(fpsentry->pdescr[pindex]), fname,
                                       tagname);
         fp = fopen(fname, "w");
         switch(fpsentry->parray[pindex].type)
@@ -139,7 +139,7 @@ int functionparameter_WriteParameterToDisk(
 
     if(strcmp(tagname, "minval") == 0)   // MIN VALUE
     {
-        functionparameter_GetFileName(fpsentry, &(fpsentry->parray[pindex]), fname,
+        functionparameter_GetFileName(fpsentry, &(fpsentry->pdescr[pindex]), fname,
                                       tagname);
 
         switch(fpsentry->parray[pindex].type)
@@ -168,7 +168,7 @@ int functionparameter_WriteParameterToDisk(
 
     if(strcmp(tagname, "maxval") == 0)   // MAX VALUE
     {
-        functionparameter_GetFileName(fpsentry, &(fpsentry->parray[pindex]), fname,
+        functionparameter_GetFileName(fpsentry, &(fpsentry->pdescr[pindex]), fname,
                                       tagname);
 
         switch(fpsentry->parray[pindex].type)
@@ -197,7 +197,7 @@ int functionparameter_WriteParameterToDisk(
 
     if(strcmp(tagname, "currval") == 0)   // CURRENT VALUE
     {
-        functionparameter_GetFileName(fpsentry, &(fpsentry->parray[pindex]), fname,
+        functionparameter_GetFileName(fpsentry, &(fpsentry->pdescr[pindex]), fname,
                                       tagname);
 
         switch(fpsentry->parray[pindex].type)
@@ -228,7 +228,7 @@ int functionparameter_WriteParameterToDisk(
 
     if(strcmp(tagname, "fpsname") == 0)   // FPS name
     {
-        functionparameter_GetFileName(fpsentry, &(fpsentry->parray[pindex]), fname,
+        functionparameter_GetFileName(fpsentry, &(fpsentry->pdescr[pindex]), fname,
                                       tagname);
         fp = fopen(fname, "w");
         fprintf(fp, "%10s    # %s\n", fpsentry->md->name, timestring);
@@ -237,7 +237,7 @@ int functionparameter_WriteParameterToDisk(
 
     if(strcmp(tagname, "fpsdir") == 0)   // FPS name
     {
-        functionparameter_GetFileName(fpsentry, &(fpsentry->parray[pindex]), fname,
+        functionparameter_GetFileName(fpsentry, &(fpsentry->pdescr[pindex]), fname,
                                       tagname);
         fp = fopen(fname, "w");
         fprintf(fp, "%10s    # %s\n", fpsentry->md->workdir, timestring);
@@ -246,7 +246,7 @@ int functionparameter_WriteParameterToDisk(
 
     if(strcmp(tagname, "status") == 0)   // FPS name
     {
-        functionparameter_GetFileName(fpsentry, &(fpsentry->parray[pindex]), fname,
+        functionparameter_GetFileName(fpsentry, &(fpsentry->pdescr[pindex]), fname,
                                       tagname);
         fp = fopen(fname, "w");
         fprintf(fp, "%10ld    # %s\n", fpsentry->parray[pindex].fpflag, timestring);
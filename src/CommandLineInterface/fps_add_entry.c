@@ -7,6 +7,7 @@
 
 #include "CommandLineInterface/CLIcore.h"
 
+#include "fps_GetParamIndex.h"
 
 
 /** @brief Add parameter to database with default settings
@@ -28,8 +29,15 @@ int function_parameter_add_entry(
     char *pch;
     char tmpstring[FUNCTION_PARAMETER_KEYWORD_STRMAXLEN * FUNCTION_PARAMETER_KEYWORD_MAXLEVEL];
     FUNCTION_PARAMETER *funcparamarray;
+    FUNCTION_PARAMETER_DESCR *funcparamdescr;
+
+    if(functionparameter_CheckWritable(fps) == 0)
+    {
+        return -1;
+    }
 
     funcparamarray = fps->parray;
+    funcparamdescr = fps->pdescr;
 
     long NBparamMAX = -1;
 
@@ -60,7 +68,7 @@ int function_parameter_add_entry(
     long pindexscan;
     for(pindexscan = 0; pindexscan < NBparamMAX; pindexscan++)
     {
-        if(strcmp(keywordstringC, funcparamarray[pindexscan].keywordfull) == 0)
+        if(strcmp(keywordstringC, funcparamdescr[pindexscan].keywordfull) == 0)
         {
             pindex = pindexscan;
             scanOK = 1;
@@ -97,23 +105,24 @@ int function_parameter_add_entry(
 
 
         // break full keyword into keywords
-        strncpy(funcparamarray[pindex].keywordfull, keywordstringC,
+        strncpy(funcparamdescr[pindex].keywordfull, keywordstringC,
                 FUNCTION_PARAMETER_KEYWORD_STRMAXLEN * FUNCTION_PARAMETER_KEYWORD_MAXLEVEL -1);
         strncpy(tmpstring, keywordstringC,
                 FUNCTION_PARAMETER_KEYWORD_STRMAXLEN * FUNCTION_PARAMETER_KEYWORD_MAXLEVEL - 1);
-        funcparamarray[pindex].keywordlevel = 0;
+        funcparamdescr[pindex].keywordlevel = 0;
         pch = strtok(tmpstring, ".");
         while(pch != NULL)
         {
-            strncpy(funcparamarray[pindex].keyword[funcparamarray[pindex].keywordlevel],
+            strncpy(funcparamdescr[pindex].keyword[funcparamdescr[pindex].keywordlevel],
                     pch, FUNCTION_PARAMETER_KEYWORD_STRMAXLEN-1);
-            funcparamarray[pindex].keywordlevel++;
+            funcparamdescr[pindex].keywordlevel++;
             pch = strtok(NULL, ".");
         }
+        functionparameter_hash_insert(fps, pindex);
 
 
         // Write description
-        strncpy(funcparamarray[pindex].description, descriptionstring,
+        strncpy(funcparamdescr[pindex].description, descriptionstring,
                 FUNCTION_PARAMETER_DESCR_STRMAXLEN-1);
 
         // type
@@ -399,15 +408,15 @@ int function_parameter_add_entry(
             switch(index)
             {
                 case 0 :
-                    functionparameter_GetFileName(fps, &funcparamarray[pindex], fname, "setval");
+                    functionparameter_GetFileName(fps, &funcparamdescr[pindex], fname, "setval");
                     break;
 
                 case 1 :
-                    functionparameter_GetFileName(fps, &funcparamarray[pindex], fname, "minval");
+                    functionparameter_GetFileName(fps, &funcparamdescr[pindex], fname, "minval");
                     break;
 
                 case 2 :
-                    functionparameter_GetFileName(fps, &funcparamarray[pindex], fname, "maxval");
+                    functionparameter_GetFileName(fps, &funcparamdescr[pindex], fname, "maxval");
                     break;
 
             }
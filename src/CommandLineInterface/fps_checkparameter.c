@@ -35,7 +35,7 @@ int functionparameter_CheckParameter(
     {
         char msg[STRINGMAXLEN_FPS_LOGMSG];
         SNPRINTF_CHECK(msg, STRINGMAXLEN_FPS_LOGMSG, "%s",
-                       fpsentry->parray[pindex].keywordfull);
+                       fpsentry->pdescr[pindex].keywordfull);
         functionparameter_outlog("CHECKPARAM", "%s", msg);
     }
 
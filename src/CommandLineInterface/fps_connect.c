@@ -18,6 +18,126 @@
 
 
 
+/** @brief Set md, parray and pdescr pointers from file mapping
+ *
+ * Layout version 2+ arrays are used in place. Version 2 files have no
+ * keyword hash table, parameter lookup then scans parray. Version 2 and 3
+ * files have no change notification block.
+ *
+ * Layout version 1 files (runtime and name fields interleaved) are
+ * converted into process-local arrays : md remains shared, but parameter
+ * values are a read-only snapshot. Setters refuse to write them, see
+ * functionparameter_CheckWritable().
+ */
+static errno_t function_parameter_struct_maplayout(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char *SM_fname
+)
+{
+    char *shmaddr = (char *) fps->shmaddr;
+    FUNCTION_PARAMETER_STRUCT_LAYOUT *layout =
+        (FUNCTION_PARAMETER_STRUCT_LAYOUT *) shmaddr;
+
+    if((fps->shmsize >= sizeof(FUNCTION_PARAMETER_STRUCT_LAYOUT))
+            && (memcmp(layout->magic, FUNCTION_PARAMETER_STRUCT_LAYOUT_MAGIC, 8) == 0))
+    {
+        if((layout->version < 2)
+                || (layout->version > FUNCTION_PARAMETER_STRUCT_LAYOUT_VERSION)
+                || (layout->mdsize != sizeof(FUNCTION_PARAMETER_STRUCT_MD))
+                || (layout->paramsize != sizeof(FUNCTION_PARAMETER))
+                || (layout->descrsize != sizeof(FUNCTION_PARAMETER_DESCR))
+                || (layout->filesize > fps->shmsize))
+        {
+            PRINT_ERROR("%s: incompatible FPS layout version %u (expected %d)",
+                        SM_fname, layout->version, FUNCTION_PARAMETER_STRUCT_LAYOUT_VERSION);
+            return RETURN_FAILURE;
+        }
+
+        fps->md = (FUNCTION_PARAMETER_STRUCT_MD *)(shmaddr + layout->mdoffset);
+        fps->parray = (FUNCTION_PARAMETER *)(shmaddr + layout->paramoffset);
+        fps->pdescr = (FUNCTION_PARAMETER_DESCR *)(shmaddr + layout->descroffset);
+        fps->layoutversion = layout->version;
+        fps->phash = NULL;
+        fps->NBhash = 0;
+        if((layout->version >= 3)
+                && (layout->headersize >= sizeof(FUNCTION_PARAMETER_STRUCT_LAYOUT))
+                && (layout->hashoffset + sizeof(int32_t) * layout->NBhash <= fps->shmsize))
+        {
+            fps->phash = (int32_t *)(shmaddr + layout->hashoffset);
+            fps->NBhash = layout->NBhash;
+        }
+        fps->notifydefer = 0;
+        fps->notify = NULL;
+        if((layout->version >= 4)
+                && (layout->notifyoffset + layout->notifysize <= fps->shmsize))
+        {
+            fps->notify = (FUNCTION_PARAMETER_STRUCT_NOTIFY *)(shmaddr + layout->notifyoffset);
+        }
+
+        return RETURN_SUCCESS;
+    }
+
+
+    // layout version 1
+    fps->md = (FUNCTION_PARAMETER_STRUCT_MD *) shmaddr;
+    if((fps->shmsize < sizeof(FUNCTION_PARAMETER_STRUCT_MD))
+            || (fps->md->NBparamMAX < 0)
+            || (sizeof(FUNCTION_PARAMETER_STRUCT_MD)
+                + sizeof(FUNCTION_PARAMETER_V1) * fps->md->NBparamMAX > fps->shmsize))
+    {
+        PRINT_ERROR("%s: unknown FPS layout", SM_fname);
+        return RETURN_FAILURE;
+    }
+
+    PRINT_WARNING("%s: FPS layout version 1, parameters loaded as read-only snapshot",
+                  SM_fname);
+
+    long NBparamMAX = fps->md->NBparamMAX;
+    FUNCTION_PARAMETER_V1 *parrayV1 =
+        (FUNCTION_PARAMETER_V1 *)(shmaddr + sizeof(FUNCTION_PARAMETER_STRUCT_MD));
+
+    fps->parray = (FUNCTION_PARAMETER *) calloc(NBparamMAX,
+                  sizeof(FUNCTION_PARAMETER));
+    fps->pdescr = (FUNCTION_PARAMETER_DESCR *) calloc(NBparamMAX,
+                  sizeof(FUNCTION_PARAMETER_DESCR));
+    if((NBparamMAX > 0) && ((fps->parray == NULL) || (fps->pdescr == NULL)))
+    {
+        PRINT_ERROR("calloc error");
+        abort();
+    }
+
+    for(long pindex = 0; pindex < NBparamMAX; pindex++)
+    {
+        FUNCTION_PARAMETER       *fparam = &fps->parray[pindex];
+        FUNCTION_PARAMETER_DESCR *fdescr = &fps->pdescr[pindex];
+
+        fparam->fpflag = parrayV1[pindex].fpflag;
+        fparam->type = parrayV1[pindex].type;
+        memcpy(&fparam->val, &parrayV1[pindex].val, sizeof(fparam->val));
+        memcpy(&fparam->info, &parrayV1[pindex].info, sizeof(fparam->info));
+        fparam->cnt0 = parrayV1[pindex].cnt0;
+
+        memcpy(fdescr->keywordfull, parrayV1[pindex].keywordfull,
+               sizeof(fdescr->keywordfull));
+        memcpy(fdescr->keyword, parrayV1[pindex].keyword, sizeof(fdescr->keyword));
+        fdescr->keywordlevel = parrayV1[pindex].keywordlevel;
+        memcpy(fdescr->keywordfrom, parrayV1[pindex].keywordfrom,
+               sizeof(fdescr->keywordfrom));
+        memcpy(fdescr->description, parrayV1[pindex].description,
+               sizeof(fdescr->description));
+    }
+    fps->layoutversion = 1;
+    fps->phash = NULL;
+    fps->NBhash = 0;
+    fps->notify = NULL;
+    fps->notifydefer = 0;
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
 /** @brief Connect to function parameter structure
  *
  *
@@ -41,7 +161,6 @@ long function_parameter_struct_connect(
     int   SM_fd; // shared memory file descriptor
     long  NBparamMAX;
     //    long NBparamActive;
-    char *mapv;
 
     char shmdname[stringmaxlen];
 
@@ -79,9 +198,9 @@ long function_parameter_struct_connect(
     fstat(SM_fd, &file_stat);
 
 
-    fps->md = (FUNCTION_PARAMETER_STRUCT_MD *) mmap(0, file_stat.st_size,
-              PROT_READ | PROT_WRITE, MAP_SHARED, SM_fd, 0);
-    if(fps->md == MAP_FAILED)
+    char *shmaddr = (char *) mmap(0, file_stat.st_size,
+                                  PROT_READ | PROT_WRITE, MAP_SHARED, SM_fd, 0);
+    if(shmaddr == MAP_FAILED)
     {
         close(SM_fd);
         perror("Error mmapping the file");
@@ -89,6 +208,30 @@ long function_parameter_struct_connect(
         fflush(stdout);
         exit(EXIT_FAILURE);
     }
+    fps->shmaddr = shmaddr;
+    fps->shmsize = file_stat.st_size;
+
+    if(function_parameter_struct_maplayout(fps, SM_fname) != RETURN_SUCCESS)
+    {
+        munmap(fps->shmaddr, fps->shmsize);
+        close(SM_fd);
+        fps->SMfd = -1;
+        fps->md = NULL;
+        fps->parray = NULL;
+        fps->pdescr = NULL;
+        fps->phash = NULL;
+        fps->notify = NULL;
+        return(-1);
+    }
+
+    if((fps->layoutversion == 1) && (fpsconnectmode != FPSCONNECT_SIMPLE))
+    {
+        PRINT_ERROR("%s: FPS layout version 1 can only be read, re-create FPS",
+                    SM_fname);
+        function_parameter_struct_disconnect(fps);
+        fps->md = NULL;
+        return(-1);
+    }
 
     if(fpsconnectmode == FPSCONNECT_CONF)
     {
@@ -104,10 +247,6 @@ long function_parameter_struct_connect(
 
 
 
-    mapv = (char *) fps->md;
-    mapv += sizeof(FUNCTION_PARAMETER_STRUCT_MD);
-    fps->parray = (FUNCTION_PARAMETER *) mapv;
-
     //	NBparam = (int) (file_stat.st_size / sizeof(FUNCTION_PARAMETER));
     NBparamMAX = fps->md->NBparamMAX;
     printf("    Connected to %s, %ld entries\n", SM_fname,
@@ -168,7 +307,7 @@ long function_parameter_struct_connect(
 
 
 
-    //function_parameter_printlist(fps->parray, NBparamMAX);
+    //function_parameter_printlist(fps->parray, fps->pdescr, NBparamMAX);
 
 
     if((fpsconnectmode == FPSCONNECT_CONF) || (fpsconnectmode == FPSCONNECT_RUN))
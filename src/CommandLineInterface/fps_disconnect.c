@@ -15,15 +15,21 @@ int function_parameter_struct_disconnect(
     FUNCTION_PARAMETER_STRUCT *funcparamstruct
 )
 {
-    int NBparamMAX;
-
-    NBparamMAX = funcparamstruct->md->NBparamMAX;
-    //funcparamstruct->md->NBparam = 0;
+    if(funcparamstruct->layoutversion == 1)
+    {
+        // local copies of layout version 1 parameters
+        free(funcparamstruct->parray);
+        free(funcparamstruct->pdescr);
+    }
     funcparamstruct->parray = NULL;
-    
-    munmap(funcparamstruct->md,
-           sizeof(FUNCTION_PARAMETER_STRUCT_MD) + sizeof(FUNCTION_PARAMETER)*NBparamMAX);
-    
+    funcparamstruct->pdescr = NULL;
+    funcparamstruct->phash = NULL;
+    funcparamstruct->notify = NULL;
+
+    munmap(funcparamstruct->shmaddr, funcparamstruct->shmsize);
+    funcparamstruct->shmaddr = NULL;
+    funcparamstruct->shmsize = 0;
+
     close(funcparamstruct->SMfd);
     
     funcparamstruct->SMfd = -1;
@@ -140,6 +140,61 @@ errno_t function_parameter_getFPSargs_from_CLIfunc(
             return RETURN_SUCCESS;
         }
 
+        if(strcmp(data.cmdargtoken[1].val.string, "..triggerspinns") == 0)
+        {
+            printf("Command %ld: updating triggerspinns to value %ld\n", data.cmdindex,
+                   data.cmdargtoken[2].val.numl);
+            data.cmd[data.cmdindex].cmdsettings.triggerspin_ns =
+                data.cmdargtoken[2].val.numl;
+            data.FPS_CMDCODE = FPSCMDCODE_IGNORE;
+            return RETURN_SUCCESS;
+        }
+
+        if(strcmp(data.cmdargtoken[1].val.string, "..triggertolerance") == 0)
+        {
+            printf("Command %ld: updating triggertolerance to value %f us\n", data.cmdindex,
+                   data.cmdargtoken[2].val.numf);
+            data.cmd[data.cmdindex].cmdsettings.triggertolerance_ns =
+                (long)(1000.0 * data.cmdargtoken[2].val.numf);
+            data.FPS_CMDCODE = FPSCMDCODE_IGNORE;
+            return RETURN_SUCCESS;
+        }
+
+        if(strcmp(data.cmdargtoken[1].val.string, "..taskset") == 0)
+        {
+            printf("Command %ld: updating taskset to %s\n", data.cmdindex,
+                   data.cmdargtoken[2].val.string);
+            if(processinfo_parse_cpulist(data.cmdargtoken[2].val.string,
+                                         &data.cmd[data.cmdindex].cmdsettings.CPUmask) < 0)
+            {
+                PRINT_WARNING("cannot parse CPU list \"%s\"",
+                              data.cmdargtoken[2].val.string);
+                CPU_ZERO(&data.cmd[data.cmdindex].cmdsettings.CPUmask);
+            }
+            data.FPS_CMDCODE = FPSCMDCODE_IGNORE;
+            return RETURN_SUCCESS;
+        }
+
+        if(strcmp(data.cmdargtoken[1].val.string, "..memlock") == 0)
+        {
+            printf("Command %ld: updating memlock to value %ld\n", data.cmdindex,
+                   data.cmdargtoken[2].val.numl);
+            data.cmd[data.cmdindex].cmdsettings.procinfo_memlock =
+                data.cmdargtoken[2].val.numl;
+            data.FPS_CMDCODE = FPSCMDCODE_IGNORE;
+            return RETURN_SUCCESS;
+        }
+
+        if(strcmp(data.cmdargtoken[1].val.string, "..NUMAbind") == 0)
+        {
+            printf("Command %ld: updating NUMAbind to value %ld\n", data.cmdindex,
+                   data.cmdargtoken[2].val.numl);
+            data.cmd[data.cmdindex].cmdsettings.procinfo_NUMAbind =
+                data.cmdargtoken[2].val.numl;
+            data.FPS_CMDCODE = FPSCMDCODE_IGNORE;
+            return RETURN_SUCCESS;
+        }
+
         // TODO: add other function attributes
 
 
@@ -20,7 +20,7 @@ imageID functionparameter_LoadStream(
 
 
     printf("====================== Loading stream \"%s\" = %s\n",
-           fps->parray[pindex].keywordfull, fps->parray[pindex].val.string[0]);
+           fps->pdescr[pindex].keywordfull, fps->parray[pindex].val.string[0]);
     ID = COREMOD_IOFITS_LoadMemStream(fps->parray[pindex].val.string[0],
                                       &(fps->parray[pindex].fpflag), &imLOC);
 
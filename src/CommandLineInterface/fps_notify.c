@@ -0,0 +1,276 @@
+/**
+ * @file    fps_notify.c
+ * @brief   FPS parameter change notification
+ *
+ * Parameter setters post a change : the parameter index bit is set in the
+ * dirty bitmap of each consumer (CONF, RUN), and the changeseq counter is
+ * incremented. Processes can cheaply test changeseq against the last value
+ * they have seen, or block on it (futex) until a change is posted.
+ *
+ * Requires FPS layout version 4+. On older FPS files, functions below
+ * do nothing (post) or fall back to sleeping (wait).
+ */
+
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef __MACH__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "CommandLineInterface/CLIcore.h"
+
+#include "fps_notify.h"
+
+
+
+
+/** @brief Size of notification block for NBparamMAX parameters [byte]
+ */
+uint64_t functionparameter_notify_size(
+    long NBparamMAX
+)
+{
+    uint64_t NBdirtyword = (NBparamMAX + 63) / 64;
+
+    return sizeof(FUNCTION_PARAMETER_STRUCT_NOTIFY)
+           + sizeof(uint64_t) * NBdirtyword * FPS_NOTIFY_NBCONSUMER;
+}
+
+
+
+errno_t functionparameter_notify_init(
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify,
+    long                              NBparamMAX
+)
+{
+    notify->changeseq = 0;
+    notify->NBwaiter = 0;
+    notify->NBdirtyword = (NBparamMAX + 63) / 64;
+    memset(notify->dirty, 0,
+           sizeof(uint64_t) * notify->NBdirtyword * FPS_NOTIFY_NBCONSUMER);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+/** @brief Mark parameter dirty for all consumers, without posting change
+ */
+void functionparameter_notify_mark(
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify,
+    long                              pindex
+)
+{
+    if(notify == NULL)
+    {
+        return;
+    }
+
+    if((pindex >= 0) && ((uint64_t) pindex < 64 * notify->NBdirtyword))
+    {
+        uint64_t bit = 1UL << (pindex % 64);
+        for(int consumer = 0; consumer < FPS_NOTIFY_NBCONSUMER; consumer++)
+        {
+            __atomic_fetch_or(&notify->dirty[consumer * notify->NBdirtyword + pindex / 64],
+                              bit, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+
+
+/** @brief Post parameter change
+ *
+ * pindex < 0 posts a change without marking any parameter dirty, for
+ * example on FPS status change.
+ */
+void functionparameter_notify_change(
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify,
+    long                              pindex
+)
+{
+    if(notify == NULL)
+    {
+        return;
+    }
+
+    functionparameter_notify_mark(notify, pindex);
+
+    // seq_cst ordering with waiter registration in functionparameter_notify_wait():
+    // either waiter is seen here, or waiter sees new changeseq
+    __atomic_fetch_add(&notify->changeseq, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&notify->NBwaiter, __ATOMIC_SEQ_CST) > 0)
+    {
+#ifndef __MACH__
+        syscall(SYS_futex, &notify->changeseq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+    }
+}
+
+
+
+
+/** @brief Post change of parameter set through FPS
+ *
+ * If fps->notifydefer is set, the parameter is only marked dirty: the caller
+ * posts a single change once all parameters are set.
+ */
+void functionparameter_notify_param(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    long                       pindex
+)
+{
+    if(fps->notifydefer == 1)
+    {
+        functionparameter_notify_mark(fps->notify, pindex);
+    }
+    else
+    {
+        functionparameter_notify_change(fps->notify, pindex);
+    }
+}
+
+
+
+
+/** @brief Current change sequence number, 0 if no notification
+ */
+uint32_t functionparameter_notify_seq(
+    FUNCTION_PARAMETER_STRUCT *fps
+)
+{
+    if(fps->notify == NULL)
+    {
+        return 0;
+    }
+    return __atomic_load_n(&fps->notify->changeseq, __ATOMIC_ACQUIRE);
+}
+
+
+
+/** @brief Test if change was posted since seq
+ *
+ * Updates seq to current sequence number.
+ *
+ * @return 1 if changed, 0 otherwise
+ */
+int functionparameter_notify_test(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    uint32_t                  *seq
+)
+{
+    uint32_t seqnow = functionparameter_notify_seq(fps);
+
+    if(seqnow != *seq)
+    {
+        *seq = seqnow;
+        return 1;
+    }
+    return 0;
+}
+
+
+
+/** @brief Wait for change posted since seq
+ *
+ * Blocks until a change is posted or timeout_us expires (timeout_us < 0
+ * waits forever). Without notification block, sleeps timeout_us.
+ * Updates seq to current sequence number.
+ *
+ * @return 1 if changed, 0 on timeout
+ */
+int functionparameter_notify_wait(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    uint32_t                  *seq,
+    long                       timeout_us
+)
+{
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify = fps->notify;
+
+    if(functionparameter_notify_test(fps, seq) == 1)
+    {
+        return 1;
+    }
+
+    if(notify == NULL)
+    {
+        if(timeout_us > 0)
+        {
+            usleep(timeout_us);
+        }
+        return 0;
+    }
+
+    struct timespec  ts;
+    struct timespec *tsptr = NULL;
+    if(timeout_us >= 0)
+    {
+        ts.tv_sec = timeout_us / 1000000;
+        ts.tv_nsec = (timeout_us % 1000000) * 1000;
+        tsptr = &ts;
+    }
+
+    __atomic_fetch_add(&notify->NBwaiter, 1, __ATOMIC_SEQ_CST);
+#ifndef __MACH__
+    // returns immediately if changeseq != *seq
+    syscall(SYS_futex, &notify->changeseq, FUTEX_WAIT, *seq, tsptr, NULL, 0);
+#else
+    // no futex: poll
+    {
+        long waitus = 0;
+        while((__atomic_load_n(&notify->changeseq, __ATOMIC_ACQUIRE) == *seq)
+                && ((tsptr == NULL) || (waitus < timeout_us)))
+        {
+            usleep(100);
+            waitus += 100;
+        }
+    }
+#endif
+    __atomic_fetch_sub(&notify->NBwaiter, 1, __ATOMIC_SEQ_CST);
+
+    return functionparameter_notify_test(fps, seq);
+}
+
+
+
+
+/** @brief Fetch and clear consumer dirty bitmap
+ *
+ * Bit pindex%64 of dirty[pindex/64] is set if parameter pindex changed
+ * since previous fetch by same consumer.
+ *
+ * @return number of changed parameters, -1 if no notification
+ */
+long functionparameter_notify_fetchdirty(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    int                        consumer,
+    uint64_t                  *dirty,
+    long                       NBdirtyword
+)
+{
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify = fps->notify;
+    long NBchanged = 0;
+
+    if((notify == NULL) || (consumer < 0) || (consumer >= FPS_NOTIFY_NBCONSUMER))
+    {
+        return -1;
+    }
+
+    for(long w = 0; w < NBdirtyword; w++)
+    {
+        dirty[w] = 0;
+        if((uint64_t) w < notify->NBdirtyword)
+        {
+            dirty[w] = __atomic_exchange_n(
+                           &notify->dirty[consumer * notify->NBdirtyword + w], 0,
+                           __ATOMIC_ACQ_REL);
+            NBchanged += __builtin_popcountll(dirty[w]);
+        }
+    }
+
+    return NBchanged;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file    fps_notify.h
+ * @brief   FPS parameter change notification
+ */
+
+#ifndef FPS_NOTIFY_H
+#define FPS_NOTIFY_H
+
+#include "function_parameters.h"
+
+
+// Longest CONF loop wait when change notification is available [us]
+// Bounds the delay to detect CONF/RUN process status changes
+#define FPS_NOTIFY_CONFWAIT_MAXUS  100000
+
+
+uint64_t functionparameter_notify_size(
+    long NBparamMAX
+);
+
+errno_t functionparameter_notify_init(
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify,
+    long                              NBparamMAX
+);
+
+void functionparameter_notify_mark(
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify,
+    long                              pindex
+);
+
+void functionparameter_notify_change(
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify,
+    long                              pindex
+);
+
+void functionparameter_notify_param(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    long                       pindex
+);
+
+uint32_t functionparameter_notify_seq(
+    FUNCTION_PARAMETER_STRUCT *fps
+);
+
+int functionparameter_notify_test(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    uint32_t                  *seq
+);
+
+int functionparameter_notify_wait(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    uint32_t                  *seq,
+    long                       timeout_us
+);
+
+long functionparameter_notify_fetchdirty(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    int                        consumer,
+    uint64_t                  *dirty,
+    long                       NBdirtyword
+);
+
+#endif
@@ -1,10 +1,29 @@
 /**
  * @file    fps_outlog.c
  * @brief   output log functions for FPS
+ *
+ * functionparameter_outlog() does not write to the log file. Messages are
+ * timestamped and copied into a per-process ring buffer, and a drain thread
+ * formats and writes them in batches with a single flush per batch.
+ *
+ * The ring is lock-free with multiple producers (any thread calling
+ * functionparameter_outlog) and a single consumer (drain thread). If the ring
+ * is full, the message is dropped and counted: logging never blocks the
+ * caller. The number of dropped messages is written to the log by the drain
+ * thread (keyword LOGDROP).
+ *
+ * The drain thread does not inherit the scheduling policy and CPU affinity
+ * of the caller, which may be a RT loop : it runs as SCHED_OTHER on the
+ * non-isolated CPUs.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 
 #include <stdarg.h>
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h> // access()
 
 #include "CommandLineInterface/CLIcore.h"
@@ -35,6 +54,65 @@ errno_t getFPSlogfname(char *logfname)
 
 
 
+// number of messages in ring buffer, must be power of 2
+#define FPS_OUTLOG_RINGSIZE 512
+
+// drain thread polling interval when ring is empty [us]
+#define FPS_OUTLOG_DRAINUS 10000
+
+#define FPS_OUTLOG_KEYWMAXLEN 16
+
+
+typedef struct
+{
+    uint64_t        seq;  // slot sequence number, see fpsoutlog_push()
+    struct timespec tlog;
+    char            keyw[FPS_OUTLOG_KEYWMAXLEN];
+    char            msgstring[STRINGMAXLEN_FPS_LOGMSG];
+} FPS_OUTLOG_MSG;
+
+
+static FPS_OUTLOG_MSG outlogring[FPS_OUTLOG_RINGSIZE];
+static uint64_t       outloghead = 0; // next slot to be written by producers
+static uint64_t       outlogtail = 0; // next slot to be read by drain thread
+static uint64_t       outlogdropcnt = 0;
+
+static int       outlogrunning = 0; // 1 if drain thread is running
+static int       outlogstop = 0;    // request drain thread to exit
+static pthread_t outlogthread;
+static char      outlogfname[STRINGMAXLEN_FULLFILENAME];
+
+static pthread_mutex_t outlogmutex = PTHREAD_MUTEX_INITIALIZER; // start/stop only
+
+
+
+
+static void fpsoutlog_timestring(
+    struct timespec tnow,
+    char           *timestring
+)
+{
+    struct tm uttime;
+    time_t    now = tnow.tv_sec;
+
+    gmtime_r(&now, &uttime);
+
+    sprintf(
+        timestring,
+        "%04d%02d%02dT%02d%02d%02d.%09ld",
+        1900 + uttime.tm_year,
+        1 + uttime.tm_mon,
+        uttime.tm_mday,
+        uttime.tm_hour,
+        uttime.tm_min,
+        uttime.tm_sec,
+        tnow.tv_nsec);
+}
+
+
+
+
+
 errno_t functionparameter_outlog_file(
     char *keyw,
     char *msgstring,
@@ -43,24 +121,11 @@ errno_t functionparameter_outlog_file(
 {
     // Get GMT time
     struct timespec tnow;
-    time_t now;
 
     clock_gettime(CLOCK_REALTIME, &tnow);
-    now = tnow.tv_sec;
-    struct tm *uttime;
-    uttime = gmtime(&now);
 
     char timestring[30];
-    sprintf(
-        timestring,
-        "%04d%02d%02dT%02d%02d%02d.%09ld",
-        1900 + uttime->tm_year,
-        1 + uttime->tm_mon,
-        uttime->tm_mday,
-        uttime->tm_hour,
-        uttime->tm_min,
-        uttime->tm_sec,
-        tnow.tv_nsec);
+    fpsoutlog_timestring(tnow, timestring);
 
     fprintf(fpout, "%s %-12s %s\n", timestring, keyw, msgstring);
     fflush(fpout);
@@ -71,83 +136,371 @@ errno_t functionparameter_outlog_file(
 
 
 
+/** @brief Reserve ring slot
+ *
+ * Slot i holds seq = i when free for position i, seq = i+1 when written.
+ * Consumer sets seq = i + FPS_OUTLOG_RINGSIZE when done reading.
+ *
+ * @return slot pointer, NULL if ring is full
+ */
+static FPS_OUTLOG_MSG *fpsoutlog_reserve(
+    uint64_t *pos
+)
+{
+    uint64_t head = __atomic_load_n(&outloghead, __ATOMIC_RELAXED);
 
+    for(;;)
+    {
+        FPS_OUTLOG_MSG *slot = &outlogring[head & (FPS_OUTLOG_RINGSIZE - 1)];
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int64_t  diff = (int64_t) seq - (int64_t) head;
+
+        if(diff == 0)
+        {
+            if(__atomic_compare_exchange_n(&outloghead, &head, head + 1, 1,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                *pos = head;
+                return slot;
+            }
+            // head updated by failed CAS, retry
+        }
+        else if(diff < 0)
+        {
+            // slot not yet read by drain thread: ring full
+            return NULL;
+        }
+        else
+        {
+            head = __atomic_load_n(&outloghead, __ATOMIC_RELAXED);
+        }
+    }
+}
 
 
 
 
-errno_t functionparameter_outlog(
-    char *keyw,
-    const char *fmt, ...
+/** @brief Write pending messages to log file
+ *
+ * @return number of messages written
+ */
+static long fpsoutlog_drain(
+    FILE **fpout
 )
 {
-    // identify logfile and open file
+    long NBmsg = 0;
 
-    static int LogOutOpen = 0;
-    static FILE *fpout;
+    for(;;)
+    {
+        FPS_OUTLOG_MSG *slot = &outlogring[outlogtail & (FPS_OUTLOG_RINGSIZE - 1)];
+        if(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != outlogtail + 1)
+        {
+            break;
+        }
 
-    if(LogOutOpen == 0)   // file not open
+        if(*fpout == NULL)
+        {
+            *fpout = fopen(outlogfname, "a");
+            if(*fpout == NULL)
+            {
+                PRINT_ERROR("cannot open file %s", outlogfname);
+            }
+        }
+
+        if(*fpout != NULL)
+        {
+            char timestring[30];
+            fpsoutlog_timestring(slot->tlog, timestring);
+            fprintf(*fpout, "%s %-12s %s\n", timestring, slot->keyw, slot->msgstring);
+        }
+        else
+        {
+            __atomic_fetch_add(&outlogdropcnt, 1, __ATOMIC_RELAXED);
+        }
+
+        __atomic_store_n(&slot->seq, outlogtail + FPS_OUTLOG_RINGSIZE,
+                         __ATOMIC_RELEASE);
+        outlogtail++;
+        NBmsg++;
+    }
+
+    // report dropped messages
+    if((*fpout != NULL)
+            && (__atomic_load_n(&outlogdropcnt, __ATOMIC_RELAXED) > 0))
     {
-        char logfname[STRINGMAXLEN_FULLFILENAME];
-        getFPSlogfname(logfname);
+        uint64_t dropcnt = __atomic_exchange_n(&outlogdropcnt, 0, __ATOMIC_ACQ_REL);
+        struct timespec tnow;
+        char timestring[30];
+
+        clock_gettime(CLOCK_REALTIME, &tnow);
+        fpsoutlog_timestring(tnow, timestring);
+        fprintf(*fpout, "%s %-12s %lu messages dropped\n", timestring, "LOGDROP",
+                (unsigned long) dropcnt);
+        NBmsg++;
+    }
 
-        fpout = fopen(logfname, "a");
-        if(fpout == NULL)
+    if((NBmsg > 0) && (*fpout != NULL))
+    {
+        fflush(*fpout);
+    }
+
+    return NBmsg;
+}
+
+
+
+
+static void *fpsoutlog_drainthread(
+    __attribute__((unused)) void *ptr
+)
+{
+    FILE *fpout = NULL;
+
+    while(__atomic_load_n(&outlogstop, __ATOMIC_ACQUIRE) == 0)
+    {
+        if(fpsoutlog_drain(&fpout) == 0)
         {
-            printf("ERROR: cannot open file\n");
-            exit(EXIT_FAILURE);
+            usleep(FPS_OUTLOG_DRAINUS);
         }
-        LogOutOpen = 1;
     }
+    // messages posted before stop request
+    fpsoutlog_drain(&fpout);
 
+    if(fpout != NULL)
+    {
+        fclose(fpout);
+    }
 
-    // Get GMT time and create timestring
+    return NULL;
+}
 
-    struct timespec tnow;
-    time_t now;
 
-    clock_gettime(CLOCK_REALTIME, &tnow);
-    now = tnow.tv_sec;
-    struct tm *uttime;
-    uttime = gmtime(&now);
 
-    char timestring[30];
-    sprintf(
-        timestring,
-        "%04d%02d%02dT%02d%02d%02d.%09ld",
-        1900 + uttime->tm_year,
-        1 + uttime->tm_mon,
-        uttime->tm_mday,
-        uttime->tm_hour,
-        uttime->tm_min,
-        uttime->tm_sec,
-        tnow.tv_nsec);
 
+/** @brief Stop drain thread, write pending messages and close log file
+ *
+ * Next call to functionparameter_outlog() reopens the log file.
+ */
+errno_t functionparameter_outlog_close()
+{
+    pthread_mutex_lock(&outlogmutex);
+    if(__atomic_load_n(&outlogrunning, __ATOMIC_ACQUIRE) == 1)
+    {
+        __atomic_store_n(&outlogstop, 1, __ATOMIC_RELEASE);
+        pthread_join(outlogthread, NULL);
+        __atomic_store_n(&outlogrunning, 0, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&outlogmutex);
 
+    return RETURN_SUCCESS;
+}
 
-    fprintf(fpout, "%s %-12s ", timestring, keyw);
 
-    va_list args;
-    va_start(args, fmt);
+static void fpsoutlog_atexit()
+{
+    functionparameter_outlog_close();
+}
 
-    vfprintf(fpout, fmt, args);
 
-    fprintf(fpout, "\n");
+// drain thread is not inherited by child process: restart on next message
+// parent messages are not written by child, and slots reserved by other
+// parent threads would never be published: reset ring
+static void fpsoutlog_atfork_child()
+{
+    pthread_mutex_init(&outlogmutex, NULL);
+    outlogrunning = 0;
 
-    fflush(fpout);
+    for(uint64_t i = 0; i < FPS_OUTLOG_RINGSIZE; i++)
+    {
+        outlogring[i].seq = i;
+    }
+    outloghead = 0;
+    outlogtail = 0;
+    outlogdropcnt = 0;
+}
 
-    va_end(args);
 
 
-    if(strcmp(keyw, "LOGFILECLOSE") == 0)
+
+/** @brief Drain thread CPU set
+ *
+ * Online CPUs, excluding CPUs isolated from the kernel scheduler
+ * (isolcpus), and excluding the calling thread's CPUs if it runs with a
+ * RT policy. Falls back to all online CPUs if the result is empty.
+ */
+static void fpsoutlog_cpuset(
+    cpu_set_t *cpuset
+)
+{
+    long NBcpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+    CPU_ZERO(cpuset);
+    for(long cpu = 0; (cpu < NBcpu) && (cpu < CPU_SETSIZE); cpu++)
+    {
+        CPU_SET(cpu, cpuset);
+    }
+
+    cpu_set_t excludeset;
+    CPU_ZERO(&excludeset);
+
+    FILE *fp = fopen("/sys/devices/system/cpu/isolated", "r");
+    if(fp != NULL)
+    {
+        char line[200];
+        if(fgets(line, sizeof(line), fp) != NULL)
+        {
+            line[strcspn(line, "\n")] = '\0';
+            cpu_set_t isolset;
+            if(processinfo_parse_cpulist(line, &isolset) > 0)
+            {
+                CPU_OR(&excludeset, &excludeset, &isolset);
+            }
+        }
+        fclose(fp);
+    }
+
+    int policy;
+    struct sched_param schedpar;
+    if((pthread_getschedparam(pthread_self(), &policy, &schedpar) == 0)
+            && ((policy == SCHED_FIFO) || (policy == SCHED_RR)))
+    {
+        cpu_set_t callerset;
+        if(pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &callerset) == 0)
+        {
+            CPU_OR(&excludeset, &excludeset, &callerset);
+        }
+    }
+
+    // drainset = cpuset minus excludeset
+    cpu_set_t drainset;
+    CPU_XOR(&drainset, cpuset, &excludeset);
+    CPU_AND(&drainset, &drainset, cpuset);
+    if(CPU_COUNT(&drainset) > 0)
+    {
+        CPU_AND(cpuset, cpuset, &drainset);
+    }
+}
+
+
+
+
+static errno_t fpsoutlog_start()
+{
+    static int atexitset = 0;
+
+    pthread_mutex_lock(&outlogmutex);
+    if(__atomic_load_n(&outlogrunning, __ATOMIC_ACQUIRE) == 0)
+    {
+        static int ringinit = 0;
+        if(ringinit == 0)
+        {
+            for(uint64_t i = 0; i < FPS_OUTLOG_RINGSIZE; i++)
+            {
+                outlogring[i].seq = i;
+            }
+            ringinit = 1;
+        }
+
+        getFPSlogfname(outlogfname);
+
+        // explicit attributes: do not inherit RT policy and affinity of caller
+        pthread_attr_t attr;
+        struct sched_param schedpar;
+        cpu_set_t cpuset;
+
+        pthread_attr_init(&attr);
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+        schedpar.sched_priority = 0;
+        pthread_attr_setschedparam(&attr, &schedpar);
+        fpsoutlog_cpuset(&cpuset);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);
+
+        outlogstop = 0;
+        int ret = pthread_create(&outlogthread, &attr, fpsoutlog_drainthread, NULL);
+        pthread_attr_destroy(&attr);
+        if(ret != 0)
+        {
+            pthread_mutex_unlock(&outlogmutex);
+            PRINT_ERROR("pthread_create error");
+            return RETURN_FAILURE;
+        }
+
+        if(atexitset == 0)
+        {
+            atexit(fpsoutlog_atexit);
+            pthread_atfork(NULL, NULL, fpsoutlog_atfork_child);
+            atexitset = 1;
+        }
+        __atomic_store_n(&outlogrunning, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&outlogmutex);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+/** @brief Number of messages dropped since last report to log file
+ */
+uint64_t functionparameter_outlog_dropcount()
+{
+    return __atomic_load_n(&outlogdropcnt, __ATOMIC_RELAXED);
+}
+
+
+
+
+/** @brief Log message
+ *
+ * Non-blocking: message is queued for the drain thread, or dropped if
+ * queue is full. Keyword LOGFILECLOSE waits for pending messages to be
+ * written and closes the log file.
+ */
+errno_t functionparameter_outlog(
+    char *keyw,
+    const char *fmt, ...
+)
+{
+    if(__atomic_load_n(&outlogrunning, __ATOMIC_ACQUIRE) == 0)
     {
-        if(LogOutOpen == 1)
+        if(fpsoutlog_start() != RETURN_SUCCESS)
         {
-            fclose(fpout);
-            LogOutOpen = 0;
+            return RETURN_FAILURE;
         }
     }
 
+
+    uint64_t pos;
+    FPS_OUTLOG_MSG *slot = fpsoutlog_reserve(&pos);
+
+    if(slot == NULL)
+    {
+        __atomic_fetch_add(&outlogdropcnt, 1, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        clock_gettime(CLOCK_REALTIME, &slot->tlog);
+
+        strncpy(slot->keyw, keyw, FPS_OUTLOG_KEYWMAXLEN - 1);
+        slot->keyw[FPS_OUTLOG_KEYWMAXLEN - 1] = '\0';
+
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(slot->msgstring, STRINGMAXLEN_FPS_LOGMSG, fmt, args);
+        va_end(args);
+
+        // publish to drain thread
+        __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    }
+
+
+    if(strcmp(keyw, "LOGFILECLOSE") == 0)
+    {
+        functionparameter_outlog_close();
+    }
+
     return RETURN_SUCCESS;
 }
 
@@ -12,6 +12,10 @@ errno_t functionparameter_outlog_file(char *keyw, char *msgstring, FILE *fpout);
 
 errno_t functionparameter_outlog(char *keyw, const char *fmt, ...);
 
+errno_t functionparameter_outlog_close();
+
+uint64_t functionparameter_outlog_dropcount();
+
 errno_t functionparameter_outlog_namelink();
 
 #endif
\ No newline at end of file
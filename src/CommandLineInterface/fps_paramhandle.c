@@ -0,0 +1,120 @@
+/**
+ * @file    fps_paramhandle.c
+ * @brief   pre-resolved parameter handles
+ */
+
+
+
+#include "CommandLineInterface/CLIcore.h"
+
+#include "fps_GetParamIndex.h"
+#include "fps_paramhandle.h"
+
+
+
+
+/** @brief Resolve parameter by name
+ *
+ * Parameter type must match one of the bits in typemask.
+ *
+ * @param[out] fparam  parameter entry, NULL if not found or wrong type
+ * @param[out] pindex  parameter index, -1 if not found or wrong type
+ */
+errno_t functionparameter_GetParamHandle(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    uint32_t                   typemask,
+    FUNCTION_PARAMETER       **fparam,
+    long                      *pindex
+)
+{
+    *fparam = NULL;
+    *pindex = -1;
+
+    // handle would point to a local copy
+    if(functionparameter_CheckWritable(fps) == 0)
+    {
+        return RETURN_FAILURE;
+    }
+
+    int index = functionparameter_GetParamIndex(fps, paramname);
+    if(index < 0)
+    {
+        PRINT_ERROR("FPS %s: parameter %s not found", fps->md->name, paramname);
+        return RETURN_FAILURE;
+    }
+
+    if((fps->parray[index].type & typemask) == 0)
+    {
+        PRINT_ERROR("FPS %s: parameter %s type 0x%08x does not match 0x%08x",
+                    fps->md->name, paramname, fps->parray[index].type, typemask);
+        return RETURN_FAILURE;
+    }
+
+    *fparam = &fps->parray[index];
+    *pindex = index;
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+errno_t functionparameter_GetParamHandle_INT64(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    FPS_PARAMHANDLE_INT64     *handle
+)
+{
+    handle->notify = fps->notify;
+    return functionparameter_GetParamHandle(fps, paramname, FPTYPE_MASK_INT,
+                                            &handle->fparam, &handle->pindex);
+}
+
+
+errno_t functionparameter_GetParamHandle_FLOAT64(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    FPS_PARAMHANDLE_FLOAT64   *handle
+)
+{
+    handle->notify = fps->notify;
+    return functionparameter_GetParamHandle(fps, paramname, FPTYPE_FLOAT64,
+                                            &handle->fparam, &handle->pindex);
+}
+
+
+errno_t functionparameter_GetParamHandle_FLOAT32(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    FPS_PARAMHANDLE_FLOAT32   *handle
+)
+{
+    handle->notify = fps->notify;
+    return functionparameter_GetParamHandle(fps, paramname, FPTYPE_FLOAT32,
+                                            &handle->fparam, &handle->pindex);
+}
+
+
+errno_t functionparameter_GetParamHandle_ONOFF(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    FPS_PARAMHANDLE_ONOFF     *handle
+)
+{
+    handle->notify = fps->notify;
+    return functionparameter_GetParamHandle(fps, paramname, FPTYPE_ONOFF,
+                                            &handle->fparam, &handle->pindex);
+}
+
+
+errno_t functionparameter_GetParamHandle_STRING(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    FPS_PARAMHANDLE_STRING    *handle
+)
+{
+    handle->notify = fps->notify;
+    return functionparameter_GetParamHandle(fps, paramname, FPTYPE_MASK_STRING,
+                                            &handle->fparam, &handle->pindex);
+}
@@ -0,0 +1,218 @@
+/**
+ * @file    fps_paramhandle.h
+ * @brief   pre-resolved parameter handles
+ *
+ * A handle points directly to the parameter entry in FPS shared memory.
+ * It is resolved once by name after connecting to the FPS, then read and
+ * written without name lookup, for example inside a processing loop :
+ *
+ *     FPS_PARAMHANDLE_FLOAT64 hgain;
+ *     functionparameter_GetParamHandle_FLOAT64(&fps, ".gain", &hgain);
+ *     ...
+ *     double gain = fps_paramhandle_get_FLOAT64(hgain);
+ *
+ * Handles are valid until function_parameter_struct_disconnect().
+ * Set accessors post a change notification (see fps_notify.h).
+ */
+
+#ifndef FPS_PARAMHANDLE_H
+#define FPS_PARAMHANDLE_H
+
+#include "function_parameters.h"
+#include "fps_notify.h"
+
+
+// parameter types stored in val.i64
+#define FPTYPE_MASK_INT     (FPTYPE_INT32 | FPTYPE_UINT32 | FPTYPE_INT64 | FPTYPE_UINT64)
+
+// parameter types stored in val.string
+#define FPTYPE_MASK_STRING  (FPTYPE_FILENAME | FPTYPE_FITSFILENAME | FPTYPE_EXECFILENAME \
+                             | FPTYPE_DIRNAME | FPTYPE_STREAMNAME | FPTYPE_STRING \
+                             | FPTYPE_PROCESS | FPTYPE_FPSNAME)
+
+
+typedef struct
+{
+    FUNCTION_PARAMETER               *fparam;
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify;
+    long                              pindex;
+} FPS_PARAMHANDLE_INT64;
+
+typedef struct
+{
+    FUNCTION_PARAMETER               *fparam;
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify;
+    long                              pindex;
+} FPS_PARAMHANDLE_FLOAT64;
+
+typedef struct
+{
+    FUNCTION_PARAMETER               *fparam;
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify;
+    long                              pindex;
+} FPS_PARAMHANDLE_FLOAT32;
+
+typedef struct
+{
+    FUNCTION_PARAMETER               *fparam;
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify;
+    long                              pindex;
+} FPS_PARAMHANDLE_ONOFF;
+
+typedef struct
+{
+    FUNCTION_PARAMETER               *fparam;
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify;
+    long                              pindex;
+} FPS_PARAMHANDLE_STRING;
+
+
+
+errno_t functionparameter_GetParamHandle(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    uint32_t                   typemask,
+    FUNCTION_PARAMETER       **fparam,
+    long                      *pindex
+);
+
+errno_t functionparameter_GetParamHandle_INT64(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    FPS_PARAMHANDLE_INT64     *handle
+);
+
+errno_t functionparameter_GetParamHandle_FLOAT64(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    FPS_PARAMHANDLE_FLOAT64   *handle
+);
+
+errno_t functionparameter_GetParamHandle_FLOAT32(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    FPS_PARAMHANDLE_FLOAT32   *handle
+);
+
+errno_t functionparameter_GetParamHandle_ONOFF(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    FPS_PARAMHANDLE_ONOFF     *handle
+);
+
+errno_t functionparameter_GetParamHandle_STRING(
+    FUNCTION_PARAMETER_STRUCT *fps,
+    const char                *paramname,
+    FPS_PARAMHANDLE_STRING    *handle
+);
+
+
+
+
+// =====================================================================
+// Accessors
+// Set functions increment parameter cnt0 and post change notification
+// =====================================================================
+
+static inline int64_t fps_paramhandle_get_INT64(
+    FPS_PARAMHANDLE_INT64 handle
+)
+{
+    return handle.fparam->val.i64[0];
+}
+
+static inline void fps_paramhandle_set_INT64(
+    FPS_PARAMHANDLE_INT64 handle,
+    int64_t               value
+)
+{
+    handle.fparam->val.i64[0] = value;
+    handle.fparam->cnt0++;
+    functionparameter_notify_change(handle.notify, handle.pindex);
+}
+
+
+static inline double fps_paramhandle_get_FLOAT64(
+    FPS_PARAMHANDLE_FLOAT64 handle
+)
+{
+    return handle.fparam->val.f64[0];
+}
+
+static inline void fps_paramhandle_set_FLOAT64(
+    FPS_PARAMHANDLE_FLOAT64 handle,
+    double                  value
+)
+{
+    handle.fparam->val.f64[0] = value;
+    handle.fparam->cnt0++;
+    functionparameter_notify_change(handle.notify, handle.pindex);
+}
+
+
+static inline float fps_paramhandle_get_FLOAT32(
+    FPS_PARAMHANDLE_FLOAT32 handle
+)
+{
+    return handle.fparam->val.f32[0];
+}
+
+static inline void fps_paramhandle_set_FLOAT32(
+    FPS_PARAMHANDLE_FLOAT32 handle,
+    float                   value
+)
+{
+    handle.fparam->val.f32[0] = value;
+    handle.fparam->cnt0++;
+    functionparameter_notify_change(handle.notify, handle.pindex);
+}
+
+
+static inline int fps_paramhandle_get_ONOFF(
+    FPS_PARAMHANDLE_ONOFF handle
+)
+{
+    return (handle.fparam->fpflag & FPFLAG_ONOFF) ? 1 : 0;
+}
+
+static inline void fps_paramhandle_set_ONOFF(
+    FPS_PARAMHANDLE_ONOFF handle,
+    int                   ONOFFvalue
+)
+{
+    if(ONOFFvalue == 1)
+    {
+        handle.fparam->fpflag |= FPFLAG_ONOFF;
+        handle.fparam->val.i64[0] = 1;
+    }
+    else
+    {
+        handle.fparam->fpflag &= ~FPFLAG_ONOFF;
+        handle.fparam->val.i64[0] = 0;
+    }
+    handle.fparam->cnt0++;
+    functionparameter_notify_change(handle.notify, handle.pindex);
+}
+
+
+static inline const char *fps_paramhandle_get_STRING(
+    FPS_PARAMHANDLE_STRING handle
+)
+{
+    return handle.fparam->val.string[0];
+}
+
+static inline void fps_paramhandle_set_STRING(
+    FPS_PARAMHANDLE_STRING handle,
+    const char            *stringvalue
+)
+{
+    strncpy(handle.fparam->val.string[0], stringvalue,
+            FUNCTION_PARAMETER_STRMAXLEN - 1);
+    handle.fparam->val.string[0][FUNCTION_PARAMETER_STRMAXLEN - 1] = '\0';
+    handle.fparam->cnt0++;
+    functionparameter_notify_change(handle.notify, handle.pindex);
+}
+
+
+#endif
@@ -12,10 +12,31 @@
 #include "fps_disconnect.h"
 #include "fps_paramvalue.h"
 #include "fps_GetParamIndex.h"
+#include "fps_notify.h"
 
 
 
 
+/** @brief Check that FPS parameters can be written
+ *
+ * Layout version 1 parameters are process-local copies (see
+ * function_parameter_struct_connect) : a write would not reach the FPS.
+ *
+ * Returns 1 if writable, 0 otherwise.
+ */
+int functionparameter_CheckWritable(
+    FUNCTION_PARAMETER_STRUCT *fps
+)
+{
+    if(fps->layoutversion == 1)
+    {
+        PRINT_ERROR("FPS %s: layout version 1 is read-only", fps->md->name);
+        return 0;
+    }
+    return 1;
+}
+
+
 
 
 long functionparameter_GetParamValue_INT64(
@@ -26,6 +47,10 @@ long functionparameter_GetParamValue_INT64(
     long value;
 
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return 0;
+    }
     value = fps->parray[fpsi].val.i64[0];
     fps->parray[fpsi].val.i64[3] = value;
 
@@ -39,9 +64,19 @@ int functionparameter_SetParamValue_INT64(
     long value
 )
 {
+    if(functionparameter_CheckWritable(fps) == 0)
+    {
+        return EXIT_FAILURE;
+    }
+
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return EXIT_FAILURE;
+    }
     fps->parray[fpsi].val.i64[0] = value;
     fps->parray[fpsi].cnt0++;
+    functionparameter_notify_param(fps, fpsi);
 
     return EXIT_SUCCESS;
 }
@@ -78,12 +113,20 @@ int function_parameter_SetValue_int64(
         pch = strtok(NULL, ".");
     }
 
-    function_parameter_struct_connect(keyword[9], &fps, FPSCONNECT_SIMPLE);
+    if(function_parameter_struct_connect(keyword[9], &fps, FPSCONNECT_SIMPLE) == -1)
+    {
+        return RETURN_FAILURE;
+    }
 
     int pindex = functionparameter_GetParamIndex(&fps, keywordfull);
 
 
-    fps.parray[pindex].val.i64[0] = val;
+    if((pindex > -1) && (functionparameter_CheckWritable(&fps) == 1))
+    {
+        fps.parray[pindex].val.i64[0] = val;
+        fps.parray[pindex].cnt0++;
+        functionparameter_notify_change(fps.notify, pindex);
+    }
 
     function_parameter_struct_disconnect(&fps);
 
@@ -107,6 +150,10 @@ long *functionparameter_GetParamPtr_INT64(
     long *ptr;
 
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return NULL;
+    }
     ptr = &fps->parray[fpsi].val.i64[0];
 
     return ptr;
@@ -124,6 +171,10 @@ double functionparameter_GetParamValue_FLOAT64(
     double value;
 
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return 0;
+    }
     value = fps->parray[fpsi].val.f64[0];
     fps->parray[fpsi].val.f64[3] = value;
 
@@ -136,9 +187,19 @@ int functionparameter_SetParamValue_FLOAT64(
     double value
 )
 {
+    if(functionparameter_CheckWritable(fps) == 0)
+    {
+        return EXIT_FAILURE;
+    }
+
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return EXIT_FAILURE;
+    }
     fps->parray[fpsi].val.f64[0] = value;
     fps->parray[fpsi].cnt0++;
+    functionparameter_notify_param(fps, fpsi);
 
     return EXIT_SUCCESS;
 }
@@ -163,6 +224,10 @@ double *functionparameter_GetParamPtr_FLOAT64(
     double *ptr;
 
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return NULL;
+    }
     ptr = &fps->parray[fpsi].val.f64[0];
 
     return ptr;
@@ -177,6 +242,10 @@ float functionparameter_GetParamValue_FLOAT32(
     float value;
 
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return 0;
+    }
     value = fps->parray[fpsi].val.f32[0];
     fps->parray[fpsi].val.f32[3] = value;
 
@@ -189,9 +258,19 @@ int functionparameter_SetParamValue_FLOAT32(
     float value
 )
 {
+    if(functionparameter_CheckWritable(fps) == 0)
+    {
+        return EXIT_FAILURE;
+    }
+
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return EXIT_FAILURE;
+    }
     fps->parray[fpsi].val.f32[0] = value;
     fps->parray[fpsi].cnt0++;
+    functionparameter_notify_param(fps, fpsi);
 
     return EXIT_SUCCESS;
 }
@@ -204,6 +283,10 @@ float *functionparameter_GetParamPtr_FLOAT32(
     float *ptr;
 
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return NULL;
+    }
     ptr = &fps->parray[fpsi].val.f32[0];
 
     return ptr;
@@ -217,6 +300,10 @@ char *functionparameter_GetParamPtr_STRING(
 )
 {
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return NULL;
+    }
     return fps->parray[fpsi].val.string[0];
 }
 
@@ -226,11 +313,21 @@ int functionparameter_SetParamValue_STRING(
     const char *stringvalue
 )
 {
+    if(functionparameter_CheckWritable(fps) == 0)
+    {
+        return EXIT_FAILURE;
+    }
+
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return EXIT_FAILURE;
+    }
 
     strncpy(fps->parray[fpsi].val.string[0], stringvalue,
             FUNCTION_PARAMETER_STRMAXLEN-1);
     fps->parray[fpsi].cnt0++;
+    functionparameter_notify_param(fps, fpsi);
 
     return EXIT_SUCCESS;
 }
@@ -244,6 +341,10 @@ int functionparameter_GetParamValue_ONOFF(
 )
 {
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return 0;
+    }
 
     if(fps->parray[fpsi].fpflag & FPFLAG_ONOFF)
     {
@@ -263,7 +364,16 @@ int functionparameter_SetParamValue_ONOFF(
     int ONOFFvalue
 )
 {
+    if(functionparameter_CheckWritable(fps) == 0)
+    {
+        return EXIT_FAILURE;
+    }
+
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return EXIT_FAILURE;
+    }
 
     if(ONOFFvalue == 1)
     {
@@ -277,6 +387,7 @@ int functionparameter_SetParamValue_ONOFF(
     }
 
     fps->parray[fpsi].cnt0++;
+    functionparameter_notify_param(fps, fpsi);
 
     return EXIT_SUCCESS;
 }
@@ -291,6 +402,10 @@ uint64_t *functionparameter_GetParamPtr_fpflag(
     uint64_t *ptr;
 
     int fpsi = functionparameter_GetParamIndex(fps, paramname);
+    if(fpsi < 0)
+    {
+        return NULL;
+    }
     ptr = &fps->parray[fpsi].fpflag;
 
     return ptr;
@@ -8,6 +8,12 @@
 
 
 
+int functionparameter_CheckWritable(
+    FUNCTION_PARAMETER_STRUCT *fps
+);
+
+
+
 // =====================================================================
 // INT32
 // =====================================================================
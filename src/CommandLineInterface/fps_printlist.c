@@ -12,6 +12,7 @@
 
 int function_parameter_printlist(
     FUNCTION_PARAMETER  *funcparamarray,
+    FUNCTION_PARAMETER_DESCR *funcparamdescr,
     long NBparamMAX
 )
 {
@@ -23,11 +24,11 @@ int function_parameter_printlist(
     {
         if(funcparamarray[pindex].fpflag & FPFLAG_ACTIVE)
         {
-            printf("Parameter %4ld : %s\n", pindex, funcparamarray[pindex].keywordfull);
-            /*for(int kl=0; kl< funcparamarray[pindex].keywordlevel; kl++)
-            	printf("  %s", funcparamarray[pindex].keyword[kl]);
+            printf("Parameter %4ld : %s\n", pindex, funcparamdescr[pindex].keywordfull);
+            /*for(int kl=0; kl< funcparamdescr[pindex].keywordlevel; kl++)
+            	printf("  %s", funcparamdescr[pindex].keyword[kl]);
             printf("\n");*/
-            printf("    %s\n", funcparamarray[pindex].description);
+            printf("    %s\n", funcparamdescr[pindex].description);
 
             // STATUS FLAGS
             printf("    STATUS FLAGS (0x%02hhx) :", (int) funcparamarray[pindex].fpflag);
@@ -9,6 +9,7 @@
 
 errno_t functionparameter_PrintParameter_ValueString(
     FUNCTION_PARAMETER *fpsentry,
+    FUNCTION_PARAMETER_DESCR *fpsdescr,
     char *outstring,
     int stringmaxlen
 )
@@ -23,7 +24,7 @@ errno_t functionparameter_PrintParameter_ValueString(
             outstring,
             stringmaxlen,
             "%-40s INT64      %ld %ld %ld %ld",
-            fpsentry->keywordfull,
+            fpsdescr->keywordfull,
             fpsentry->val.i64[0],
             fpsentry->val.i64[1],
             fpsentry->val.i64[2],
@@ -36,7 +37,7 @@ errno_t functionparameter_PrintParameter_ValueString(
             outstring,
             stringmaxlen,
             "%-40s FLOAT64    %f %f %f %f",
-            fpsentry->keywordfull,
+            fpsdescr->keywordfull,
             fpsentry->val.f64[0],
             fpsentry->val.f64[1],
             fpsentry->val.f64[2],
@@ -49,7 +50,7 @@ errno_t functionparameter_PrintParameter_ValueString(
             outstring,
             stringmaxlen,
             "%-40s FLOAT32    %f %f %f %f",
-            fpsentry->keywordfull,
+            fpsdescr->keywordfull,
             fpsentry->val.f32[0],
             fpsentry->val.f32[1],
             fpsentry->val.f32[2],
@@ -62,7 +63,7 @@ errno_t functionparameter_PrintParameter_ValueString(
             outstring,
             stringmaxlen,
             "%-40s PID        %ld",
-            fpsentry->keywordfull,
+            fpsdescr->keywordfull,
             fpsentry->val.i64[0]);
         cmdOK = 1;
         break;
@@ -76,7 +77,7 @@ errno_t functionparameter_PrintParameter_ValueString(
             outstring,
             stringmaxlen,
             "%-40s FILENAME   %s",
-            fpsentry->keywordfull,
+            fpsdescr->keywordfull,
             fpsentry->val.string[0]);
         cmdOK = 1;
         break;
@@ -86,7 +87,7 @@ errno_t functionparameter_PrintParameter_ValueString(
             outstring,
             stringmaxlen,
             "%-40s FITSFILENAME   %s",
-            fpsentry->keywordfull,
+            fpsdescr->keywordfull,
             fpsentry->val.string[0]);
         cmdOK = 1;
         break;
@@ -96,7 +97,7 @@ errno_t functionparameter_PrintParameter_ValueString(
             outstring,
             stringmaxlen,
             "%-40s EXECFILENAME   %s",
-            fpsentry->keywordfull,
+            fpsdescr->keywordfull,
             fpsentry->val.string[0]);
         cmdOK = 1;
         break;
@@ -106,7 +107,7 @@ errno_t functionparameter_PrintParameter_ValueString(
             outstring,
             stringmaxlen,
             "%-40s DIRNAME    %s",
-            fpsentry->keywordfull,
+            fpsdescr->keywordfull,
             fpsentry->val.string[0]);
         cmdOK = 1;
         break;
@@ -116,7 +117,7 @@ errno_t functionparameter_PrintParameter_ValueString(
             outstring,
             stringmaxlen,
             "%-40s STREAMNAME %s",
-            fpsentry->keywordfull,
+            fpsdescr->keywordfull,
             fpsentry->val.string[0]);
         cmdOK = 1;
         break;
@@ -126,7 +127,7 @@ errno_t functionparameter_PrintParameter_ValueString(
             outstring,
             stringmaxlen,
             "%-40s STRING     %s",
-            fpsentry->keywordfull,
+            fpsdescr->keywordfull,
             fpsentry->val.string[0]);
         cmdOK = 1;
         break;
@@ -135,12 +136,12 @@ errno_t functionparameter_PrintParameter_ValueString(
         if(fpsentry->fpflag & FPFLAG_ONOFF)
         {
             SNPRINTF_CHECK(outstring, stringmaxlen, "%-40s ONOFF      ON",
-                           fpsentry->keywordfull);
+                           fpsdescr->keywordfull);
         }
         else
         {
             SNPRINTF_CHECK(outstring, stringmaxlen, "%-40s ONOFF      OFF",
-                           fpsentry->keywordfull);
+                           fpsdescr->keywordfull);
         }
         cmdOK = 1;
         break;
@@ -148,7 +149,7 @@ errno_t functionparameter_PrintParameter_ValueString(
 
     case FPTYPE_FPSNAME:
         SNPRINTF_CHECK(outstring, stringmaxlen, "%-40s FPSNAME   %s",
-                       fpsentry->keywordfull, fpsentry->val.string[0]);
+                       fpsdescr->keywordfull, fpsentry->val.string[0]);
         cmdOK = 1;
         break;
 
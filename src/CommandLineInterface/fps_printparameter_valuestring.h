@@ -10,6 +10,7 @@
 
 errno_t functionparameter_PrintParameter_ValueString(
     FUNCTION_PARAMETER *fpsentry,
+    FUNCTION_PARAMETER_DESCR *fpsdescr,
     char *outstring,
     int stringmaxlen
 );
@@ -7,10 +7,100 @@
 #include "CommandLineInterface/CLIcore.h"
 
 
+#include "fps_notify.h"
 #include "fps_processcmdline.h"
 
 
 
+
+/** @brief Mark task completed and remove it from its queue
+ *
+ * Task must be at the head of its queue.
+ */
+static void fpsCMDarray_taskcomplete(
+    FPSCTRL_TASK_ENTRY *fpsctrltasklist,
+    FPSCTRL_TASK_QUEUE *fpsctrlqueuelist,
+    int                 cmdindex
+)
+{
+    FPSCTRL_TASK_QUEUE *queue = &fpsctrlqueuelist[fpsctrltasklist[cmdindex].queue];
+
+    // update status - no longer running
+    fpsctrltasklist[cmdindex].status &= ~FPSTASK_STATUS_RUNNING;
+    fpsctrltasklist[cmdindex].status |= FPSTASK_STATUS_COMPLETED;
+
+    //no longer active, remove it from list
+    fpsctrltasklist[cmdindex].status &= ~FPSTASK_STATUS_ACTIVE;
+
+    //   fpsctrltasklist[cmdindex].status &= ~FPSTASK_STATUS_SHOW; // and stop displaying
+
+    clock_gettime(CLOCK_REALTIME, &fpsctrltasklist[cmdindex].completiontime);
+
+    queue->taskhead = fpsctrltasklist[cmdindex].nextindex;
+    if(queue->taskhead == -1)
+    {
+        queue->tasktail = -1;
+    }
+    fpsctrltasklist[cmdindex].nextindex = -1;
+}
+
+
+
+
+/** @brief Can task be run as part of a setval batch ?
+ *
+ * setval tasks not waiting on RUN or CONF complete immediately.
+ */
+static int fpsCMDarray_taskbatchable(
+    FPSCTRL_TASK_ENTRY *task
+)
+{
+    if(task->flag & (FPSTASK_FLAG_WAITONRUN | FPSTASK_FLAG_WAITONCONF))
+    {
+        return 0;
+    }
+
+    if((strncmp(task->cmdstring, "setval", strlen("setval")) == 0)
+            && ((task->cmdstring[6] == ' ') || (task->cmdstring[6] == '\t')))
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+
+
+
+/** @brief Run task
+ */
+static void fpsCMDarray_taskrun(
+    FPSCTRL_TASK_ENTRY         *fpsctrltasklist,
+    FPSCTRL_TASK_QUEUE         *fpsctrlqueuelist,
+    KEYWORD_TREE_NODE          *keywnode,
+    FPSCTRL_PROCESS_VARS       *fpsCTRLvar,
+    FUNCTION_PARAMETER_STRUCT  *fps,
+    int                         cmdindexExec
+)
+{
+    uint64_t taskstatus = 0;
+
+    fpsctrltasklist[cmdindexExec].fpsindex =
+        functionparameter_FPSprocess_cmdline(fpsctrltasklist[cmdindexExec].cmdstring,
+                fpsctrlqueuelist, keywnode, fpsCTRLvar, fps, &taskstatus);
+
+    // update status form cmdline interpreter
+    fpsctrltasklist[cmdindexExec].status |= taskstatus;
+
+    clock_gettime(CLOCK_REALTIME, &fpsctrltasklist[cmdindexExec].activationtime);
+
+    // update status to running
+    fpsctrltasklist[cmdindexExec].status |= FPSTASK_STATUS_RUNNING;
+    fpsctrltasklist[cmdindexExec].status &= ~FPSTASK_STATUS_WAITING;
+}
+
+
+
 /** @brief Find the next task to execute
  *
  * Tasks are arranged in execution queues.
@@ -29,6 +119,15 @@
  * - A running task waiting to be completed cannot block tasks in other queues
  * - If two tasks are ready with the same priority, the one in the lower queue will be launched
  *
+ * Active tasks of each queue are linked in submission order (taskhead, nextindex), so the
+ * next task of a queue is its head.
+ *
+ * SETVAL BATCH :
+ * Consecutive setval tasks at the head of the selected queue (up to NB_FPSCTRL_TASK_BATCHMAX)
+ * are applied in a single call. FPS update is signaled once per FPS at the end of the batch,
+ * so that the CONF process checks the new configuration once instead of once per value.
+ * Tasks flagged WAITONRUN or WAITONCONF are not batched.
+ *
  * CONVENTIONS AND GUIDELINES :
  * - queue #0 is the main queue
  * - Keep queue 0 priority at 10
@@ -78,33 +177,12 @@ int function_parameter_process_fpsCMDarray(
 
         while ( queue_nexttask[qi] == QUEUE_SCANREADY )
         {
-            // find next command to execute
-            uint64_t inputindexmin = UINT_MAX;
-            int cmdindexExec;
-            int cmdOK = 0;
-
+            // next command to execute is at head of queue
+            int cmdindexExec = fpsctrlqueuelist[qi].taskhead;
 
             queue_nexttask[qi] = QUEUE_NOTASK;
-            //
-            // Find task with smallest inputindex within this queue
-            // This is the one to be executed
-            //
-            for( int cmdindex = 0; cmdindex < NB_FPSCTRL_TASK_MAX; cmdindex++ )
-            {
-                if((fpsctrltasklist[cmdindex].status & FPSTASK_STATUS_ACTIVE)
-                        && (fpsctrltasklist[cmdindex].queue == qi))
-                {
-                    if(fpsctrltasklist[cmdindex].inputindex < inputindexmin)
-                    {
-                        inputindexmin = fpsctrltasklist[cmdindex].inputindex;
-                        cmdindexExec = cmdindex;
-                        cmdOK = 1;
-                    }
-                }
-            }
-
 
-            if(cmdOK == 1) // A potential task to be executed has been found
+            if(cmdindexExec != -1) // A potential task to be executed has been found
             {
                 if(!(fpsctrltasklist[cmdindexExec].status &
                         FPSTASK_STATUS_RUNNING))     // if task not running, launch it
@@ -141,20 +219,11 @@ int function_parameter_process_fpsCMDarray(
 
                     if(task_completed == 1)
                     {
-                        // update status - no longer running
-                        fpsctrltasklist[cmdindexExec].status &= ~FPSTASK_STATUS_RUNNING;
-                        fpsctrltasklist[cmdindexExec].status |= FPSTASK_STATUS_COMPLETED;
-
-                        //no longer active, remove it from list
-                        fpsctrltasklist[cmdindexExec].status &= ~FPSTASK_STATUS_ACTIVE;
-
-                        //   fpsctrltasklist[cmdindexExec].status &= ~FPSTASK_STATUS_SHOW; // and stop displaying
-
-                        clock_gettime(CLOCK_REALTIME, &fpsctrltasklist[cmdindexExec].completiontime);
+                        fpsCMDarray_taskcomplete(fpsctrltasklist, fpsctrlqueuelist, cmdindexExec);
                         queue_nexttask[qi] = QUEUE_SCANREADY;
                     }
                 }
-            } // end if(cmdOK==1)
+            } // end if(cmdindexExec != -1)
         } // end while QUEUE_SCANREADY
 
 
@@ -233,29 +302,63 @@ int function_parameter_process_fpsCMDarray(
     if( nexttask_cmdindex != -1 )
     {
         if(nexttask_priority > 0 )
-        {   // execute task
+        {
             int cmdindexExec = nexttask_cmdindex;
 
-            uint64_t taskstatus = 0;
-
-            fpsctrltasklist[cmdindexExec].fpsindex =
-                functionparameter_FPSprocess_cmdline(fpsctrltasklist[cmdindexExec].cmdstring,
-                        fpsctrlqueuelist, keywnode, fpsCTRLvar, fps, &taskstatus);
-            NBtaskLaunched++;
+            if(fpsCMDarray_taskbatchable(&fpsctrltasklist[cmdindexExec]) == 0)
+            {
+                // execute task
+                fpsCMDarray_taskrun(fpsctrltasklist, fpsctrlqueuelist, keywnode,
+                                    fpsCTRLvar, fps, cmdindexExec);
+                NBtaskLaunched++;
+            }
+            else
+            {
+                // execute setval batch
+                int batchfps[NB_FPSCTRL_TASK_BATCHMAX];
+                int NBbatchfps = 0;
+
+                fpsCTRLvar->setvalbatch = 1;
+                while((cmdindexExec != -1)
+                        && (NBtaskLaunched < NB_FPSCTRL_TASK_BATCHMAX)
+                        && (fpsCMDarray_taskbatchable(&fpsctrltasklist[cmdindexExec]) == 1))
+                {
+                    fpsCMDarray_taskrun(fpsctrltasklist, fpsctrlqueuelist, keywnode,
+                                        fpsCTRLvar, fps, cmdindexExec);
+                    NBtaskLaunched++;
 
-            // update status form cmdline interpreter
-            fpsctrltasklist[cmdindexExec].status |= taskstatus;
+                    if(fpsctrltasklist[cmdindexExec].status & FPSTASK_STATUS_CMDOK)
+                    {
+                        int fpsindex = fpsctrltasklist[cmdindexExec].fpsindex;
+                        int i = 0;
+                        while((i < NBbatchfps) && (batchfps[i] != fpsindex))
+                        {
+                            i++;
+                        }
+                        if(i == NBbatchfps)
+                        {
+                            batchfps[NBbatchfps] = fpsindex;
+                            NBbatchfps++;
+                        }
+                    }
 
-            clock_gettime(CLOCK_REALTIME, &fpsctrltasklist[cmdindexExec].activationtime);
+                    // setval does not wait: complete task and move to next in queue
+                    int qi = fpsctrltasklist[cmdindexExec].queue;
+                    fpsCMDarray_taskcomplete(fpsctrltasklist, fpsctrlqueuelist, cmdindexExec);
+                    cmdindexExec = fpsctrlqueuelist[qi].taskhead;
+                }
+                fpsCTRLvar->setvalbatch = 0;
 
-            // update status to running
-            fpsctrltasklist[cmdindexExec].status |= FPSTASK_STATUS_RUNNING;
-            fpsctrltasklist[cmdindexExec].status &= ~FPSTASK_STATUS_WAITING;
+                // notify fpsCTRL that parameters have been updated
+                for(int i = 0; i < NBbatchfps; i++)
+                {
+                    fps[batchfps[i]].md->signal |= FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE;
+                    functionparameter_notify_change(fps[batchfps[i]].notify, -1);
+                }
+            }
         }
     }
 
 
     return NBtaskLaunched;
 }
-
-
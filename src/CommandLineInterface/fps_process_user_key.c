@@ -258,6 +258,7 @@ int fpsCTRLscreen_process_user_key(
                 fps[fpsindex].parray[pindex].cnt0 ++;
                 fps[fpsindex].md->signal |=
                     FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE; // notify GUI loop to update
+                functionparameter_notify_change(fps[fpsindex].notify, pindex);
             }
         }
 
@@ -274,6 +275,7 @@ int fpsCTRLscreen_process_user_key(
         fpsindex = keywnode[fpsCTRLvar->nodeSelected].fpsindex;
         fps[fpsindex].md->signal |=
             FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE; // notify GUI loop to update
+        functionparameter_notify_change(fps[fpsindex].notify, -1);
         if(snprintf(msg, stringmaxlen, "UPDATE %s", fps[fpsindex].md->name) < 0)
         {
             PRINT_ERROR("snprintf error");
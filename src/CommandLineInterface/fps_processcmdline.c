@@ -47,6 +47,9 @@
  *
  * - queueprio   : change queue priority
  *
+ * If fpsCTRLvar->setvalbatch is set, setval does not signal FPS update nor
+ * post change notification (parameter is only marked dirty).
+ * The caller is then responsible for signaling update once all values are set.
  *
  */
 
@@ -452,6 +455,7 @@ int functionparameter_FPSprocess_cmdline(
                     FUNCTION_PARAMETER_STRUCT_SIGNAL_CHECKED; // update status: check waiting to be done
                 fps[fpsindex].md->signal |=
                     FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE; // request an update
+                functionparameter_notify_change(fps[fpsindex].notify, -1);
 
                 functionparameter_outlog("CONFUPDATE", "update CONF process %d %s",
                                fpsindex, fps[fpsindex].md->name);
@@ -493,6 +497,7 @@ int functionparameter_FPSprocess_cmdline(
                         FUNCTION_PARAMETER_STRUCT_SIGNAL_CHECKED; // update status: check waiting to be done
                     fps[fpsindex].md->signal |=
                         FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE; // request an update
+                    functionparameter_notify_change(fps[fpsindex].notify, -1);
 
                     while(((fps[fpsindex].md->signal & FUNCTION_PARAMETER_STRUCT_SIGNAL_CHECKED))
                             && (timercnt < timercntmax))
@@ -691,6 +696,9 @@ int functionparameter_FPSprocess_cmdline(
             {
                 int updated = 0;
 
+                // in batch mode, change is posted once at end of batch
+                fps[fpsindex].notifydefer = fpsCTRLvar->setvalbatch;
+
                 switch(fps[fpsindex].parray[pindex].type)
                 {
 
@@ -834,13 +842,19 @@ int functionparameter_FPSprocess_cmdline(
 
                 }
 
+                fps[fpsindex].notifydefer = 0;
+
                 // notify fpsCTRL that parameter has been updated
                 if(updated == 1)
                 {
                     cmdOK = 1;
                     functionparameter_WriteParameterToDisk(&fps[fpsindex], pindex, "setval",
                                                            "InputCommandFile");
-                    fps[fpsindex].md->signal |= FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE;
+                    // in batch mode, update is signaled once at end of batch
+                    if(fpsCTRLvar->setvalbatch == 0)
+                    {
+                        fps[fpsindex].md->signal |= FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE;
+                    }
                 }
                 else
                 {
@@ -872,7 +886,7 @@ int functionparameter_FPSprocess_cmdline(
             else
             {
 				errno_t ret;
-				ret = functionparameter_PrintParameter_ValueString(&fps[fpsindex].parray[pindex], msgstring, STRINGMAXLEN_FPS_LOGMSG);
+				ret = functionparameter_PrintParameter_ValueString(&fps[fpsindex].parray[pindex], &fps[fpsindex].pdescr[pindex], msgstring, STRINGMAXLEN_FPS_LOGMSG);
 				
 				if(ret == RETURN_SUCCESS)
 					cmdOK = 1;
@@ -8,6 +8,7 @@
 
 
 #include "fps_GetParamIndex.h"
+#include "fps_processinfo_entries.h"
 
 
 /** @brief Add parameters to FPS for real-time process settings
@@ -39,7 +40,17 @@ errno_t fps_add_processinfo_entries(FUNCTION_PARAMETER_STRUCT *fps)
 
     // taskset
     function_parameter_add_entry(fps, ".conf.taskset", "CPUs mask",
-                                 FPTYPE_STRING, FPFLAG, "0-127");
+                                 FPTYPE_STRING, FPFLAG, FPS_TASKSET_DEFAULT);
+
+    // lock memory and pre-fault stack and streams at loop start
+    long memlock_default[4] = { 0, 0, 1, 0 };
+    function_parameter_add_entry(fps, ".conf.procinfo.memlock", "lock memory",
+                                 FPTYPE_INT64, FPFLAG, &memlock_default);
+
+    // bind memory to NUMA node(s) of taskset CPUs
+    long NUMAbind_default[4] = { 0, 0, 1, 0 };
+    function_parameter_add_entry(fps, ".conf.procinfo.NUMAbind", "NUMA memory bind",
+                                 FPTYPE_INT64, FPFLAG, &NUMAbind_default);
 
     // run time string
     function_parameter_add_entry(fps, ".conf.timestring", "runstart time string",
@@ -96,5 +107,39 @@ errno_t fps_to_processinfo(FUNCTION_PARAMETER_STRUCT *fps,
         procinfo->RT_priority = RTprio;
     }
 
+    // CPU affinity
+    // default value does not override external pinning (taskset, cset)
+    pindex = functionparameter_GetParamIndex(fps, ".conf.taskset");
+    if((pindex > -1)
+            && (strcmp(functionparameter_GetParamPtr_STRING(fps, ".conf.taskset"),
+                       FPS_TASKSET_DEFAULT) != 0))
+    {
+        cpu_set_t mask;
+        if(processinfo_parse_cpulist(
+                    functionparameter_GetParamPtr_STRING(fps, ".conf.taskset"),
+                    &mask) > 0)
+        {
+            procinfo->CPUmask = mask;
+        }
+        else
+        {
+            PRINT_WARNING("cannot parse taskset string, CPU affinity unchanged");
+        }
+    }
+
+    pindex = functionparameter_GetParamIndex(fps, ".conf.procinfo.memlock");
+    if(pindex > -1)
+    {
+        procinfo->memlock = functionparameter_GetParamValue_INT64(fps,
+                            ".conf.procinfo.memlock");
+    }
+
+    pindex = functionparameter_GetParamIndex(fps, ".conf.procinfo.NUMAbind");
+    if(pindex > -1)
+    {
+        procinfo->NUMAbind = functionparameter_GetParamValue_INT64(fps,
+                             ".conf.procinfo.NUMAbind");
+    }
+
     return RETURN_SUCCESS;
 }
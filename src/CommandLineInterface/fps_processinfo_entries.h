@@ -9,6 +9,9 @@
 #include "processinfo.h"
 #include "function_parameters.h"
 
+// .conf.taskset default value : CPU affinity left unchanged
+#define FPS_TASKSET_DEFAULT "0-127"
+
 errno_t fps_add_processinfo_entries(FUNCTION_PARAMETER_STRUCT *fps);
 
 errno_t fps_to_processinfo(FUNCTION_PARAMETER_STRUCT *fps, PROCESSINFO *procinfo);
@@ -6,237 +6,326 @@
 #include "CommandLineInterface/CLIcore.h"
 
 
-// fill up task list from fifo submissions
+// fifo read buffer size, must hold at least one command line
+#define FPSCMD_FIFO_BUFFSIZE 16384
 
-int functionparameter_read_fpsCMD_fifo(
-    int fpsCTRLfifofd,
+
+
+
+/** @brief Find free entry in task list
+ *
+ * Search starts from entry following last allocated entry.
+ *
+ * @return task index, -1 if task list is full
+ */
+static int fpsCMD_fifo_freetask(
+    FPSCTRL_TASK_ENTRY *fpsctrltasklist
+)
+{
+    static int cmdindexlast = NB_FPSCTRL_TASK_MAX - 1;
+
+    for(int i = 1; i <= NB_FPSCTRL_TASK_MAX; i++)
+    {
+        int cmdindex = (cmdindexlast + i) % NB_FPSCTRL_TASK_MAX;
+        if(fpsctrltasklist[cmdindex].status == 0)
+        {
+            cmdindexlast = cmdindex;
+            return cmdindex;
+        }
+    }
+
+    return -1;
+}
+
+
+
+
+/** @brief Process one command line read from fifo
+ *
+ * Queue configuration commands are applied, other commands are appended
+ * to the tail of the current queue.
+ *
+ * @return 1 if task added, 0 otherwise
+ */
+static int fpsCMD_fifo_processline(
+    char               *FPScmdline,
+    int                 cmdindex,
     FPSCTRL_TASK_ENTRY *fpsctrltasklist,
     FPSCTRL_TASK_QUEUE *fpsctrlqueuelist
 )
 {
-    int cmdcnt = 0;
-    char *FPScmdline = NULL;
-    char buff[200];
-    int total_bytes = 0;
-    int bytes;
-    char buf0[1];
-
     // toggles
     static uint32_t queue = 0;
     static int waitonrun = 0;
     static int waitonconf = 0;
 
+    static uint16_t	cmdinputcnt = 0;
 
 
-    static uint16_t	cmdinputcnt = 0;
+    // Some commands affect how the task list is configured instead of being inserted as entries
+    int cmdFOUND = 0;
 
-    int lineOK = 1; // keep reading
 
+    if((FPScmdline[0] == '#') || (FPScmdline[0] == ' ') || (FPScmdline[0] == '\0'))       // disregard line
+    {
+        cmdFOUND = 1;
+    }
 
-    DEBUG_TRACEPOINT(" ");
+    // set wait on run ON
+    if((cmdFOUND == 0)
+            && (strncmp(FPScmdline, "taskcntzero", strlen("taskcntzero")) == 0))
+    {
+        cmdFOUND = 1;
+        cmdinputcnt = 0;
+    }
 
-    while(lineOK == 1)
+    // Set queue index
+    // entries will now be placed in queue specified by this command
+    if((cmdFOUND == 0)
+            && (strncmp(FPScmdline, "setqindex", strlen("setqindex")) == 0))
     {
-        total_bytes = 0;
-        lineOK = 0;
-        for(;;)
+        cmdFOUND = 1;
+        int queue_index;
+        if(sscanf(FPScmdline, "%*s %d", &queue_index) == 1)
         {
-            bytes = read(fpsCTRLfifofd, buf0, 1);  // read one char at a time
-            DEBUG_TRACEPOINT("ERRROR: BUFFER OVERFLOW %d %d\n", bytes, total_bytes);
-            if(bytes > 0)
+            if((queue_index > -1) && (queue_index < NB_FPSCTRL_TASKQUEUE_MAX))
             {
-                buff[total_bytes] = buf0[0];
-                total_bytes += (size_t)bytes;
-
+                queue = queue_index;
             }
-            else
+        }
+    }
+
+    // Set queue priority
+    if((cmdFOUND == 0)
+            && (strncmp(FPScmdline, "setqprio", strlen("setqprio")) == 0))
+    {
+        cmdFOUND = 1;
+        int queue_priority;
+        if(sscanf(FPScmdline, "%*s %d", &queue_priority) == 1)
+        {
+            if(queue_priority < 0)
             {
-                if(errno == EWOULDBLOCK)
-                {
-                    break;
-                }
-                else     // read 0 byte
-                {
-                    //perror("read 0 byte");
-                    return cmdcnt;
-                }
+                queue_priority = 0;
             }
 
+            fpsctrlqueuelist[queue].priority = queue_priority;
+        }
+    }
 
-            DEBUG_TRACEPOINT(" ");
 
 
-            if(buf0[0] == '\n')
-            {
-                // reached end of line
-                // -> process command
-                //
+    // set wait on run ON
+    if((cmdFOUND == 0)
+            && (strncmp(FPScmdline, "waitonrunON", strlen("waitonrunON")) == 0))
+    {
+        cmdFOUND = 1;
+        waitonrun = 1;
+    }
 
-                buff[total_bytes - 1] = '\0';
-                FPScmdline = buff;
+    // set wait on run OFF
+    if((cmdFOUND == 0)
+            && (strncmp(FPScmdline, "waitonrunOFF", strlen("waitonrunOFF")) == 0))
+    {
+        cmdFOUND = 1;
+        waitonrun = 0;
+    }
 
+    // set wait on conf ON
+    if((cmdFOUND == 0)
+            && (strncmp(FPScmdline, "waitonconfON", strlen("waitonconfON")) == 0))
+    {
+        cmdFOUND = 1;
+        waitonconf = 1;
+    }
 
+    // set wait on conf OFF
+    if((cmdFOUND == 0)
+            && (strncmp(FPScmdline, "waitonconfOFF", strlen("waitonconfOFF")) == 0))
+    {
+        cmdFOUND = 1;
+        waitonconf = 0;
+    }
 
-                // find next index
-                int cmdindex = 0;
-                int cmdindexOK = 0;
-                while((cmdindexOK == 0) && (cmdindex < NB_FPSCTRL_TASK_MAX))
-                {
-                    if(fpsctrltasklist[cmdindex].status == 0)
-                    {
-                        cmdindexOK = 1;
-                    }
-                    else
-                    {
-                        cmdindex ++;
-                    }
-                }
 
+    if(cmdFOUND == 1)
+    {
+        return 0;
+    }
 
-                if(cmdindex == NB_FPSCTRL_TASK_MAX)
-                {
-                    printf("ERROR: fpscmdarray is full\n");
-                    exit(0);
-                }
 
+    DEBUG_TRACEPOINT(" ");
 
-                DEBUG_TRACEPOINT(" ");
+    // for all other commands, put in task list
+    strncpy(fpsctrltasklist[cmdindex].cmdstring, FPScmdline,
+            STRINGMAXLEN_FPS_CMDLINE - 1);
+    fpsctrltasklist[cmdindex].cmdstring[STRINGMAXLEN_FPS_CMDLINE - 1] = '\0';
 
-                // Some commands affect how the task list is configured instead of being inserted as entries
-                int cmdFOUND = 0;
+    fpsctrltasklist[cmdindex].status = FPSTASK_STATUS_ACTIVE | FPSTASK_STATUS_SHOW;
+    fpsctrltasklist[cmdindex].inputindex = cmdinputcnt;
+    fpsctrltasklist[cmdindex].queue = queue;
+    clock_gettime(CLOCK_REALTIME, &fpsctrltasklist[cmdindex].creationtime);
 
+    // waiting to be processed
+    fpsctrltasklist[cmdindex].status |= FPSTASK_STATUS_WAITING;
 
-                if((FPScmdline[0] == '#') || (FPScmdline[0] == ' ') || (total_bytes<2))       // disregard line
-                {
-                    cmdFOUND = 1;
-                }
 
-                // set wait on run ON
-                if((cmdFOUND == 0)
-                        && (strncmp(FPScmdline, "taskcntzero", strlen("taskcntzero")) == 0))
-                {
-                    cmdFOUND = 1;
-                    cmdinputcnt = 0;
-                }
+    if(waitonrun == 1)
+    {
+        fpsctrltasklist[cmdindex].flag |= FPSTASK_FLAG_WAITONRUN;
+    }
+    else
+    {
+        fpsctrltasklist[cmdindex].flag &= ~FPSTASK_FLAG_WAITONRUN;
+    }
 
-                // Set queue index
-                // entries will now be placed in queue specified by this command
-                if((cmdFOUND == 0)
-                        && (strncmp(FPScmdline, "setqindex", strlen("setqindex")) == 0))
-                {
-                    cmdFOUND = 1;
-                    char stringtmp[200];
-                    int queue_index;
-                    sscanf(FPScmdline, "%s %d", stringtmp, &queue_index);
-
-                    if((queue_index > -1) && (queue_index < NB_FPSCTRL_TASKQUEUE_MAX))
-                    {
-                        queue = queue_index;
-                    }
-                }
+    if(waitonconf == 1)
+    {
+        fpsctrltasklist[cmdindex].flag |= FPSTASK_FLAG_WAITONCONF;
+    }
+    else
+    {
+        fpsctrltasklist[cmdindex].flag &= ~FPSTASK_FLAG_WAITONCONF;
+    }
 
-                // Set queue priority
-                if((cmdFOUND == 0)
-                        && (strncmp(FPScmdline, "setqprio", strlen("setqprio")) == 0))
-                {
-                    cmdFOUND = 1;
-                    char stringtmp[200];
-                    int queue_priority;
-                    sscanf(FPScmdline, "%s %d", stringtmp, &queue_priority);
+    // append to queue
+    fpsctrltasklist[cmdindex].nextindex = -1;
+    if(fpsctrlqueuelist[queue].tasktail == -1)
+    {
+        fpsctrlqueuelist[queue].taskhead = cmdindex;
+    }
+    else
+    {
+        fpsctrltasklist[fpsctrlqueuelist[queue].tasktail].nextindex = cmdindex;
+    }
+    fpsctrlqueuelist[queue].tasktail = cmdindex;
 
-                    if(queue_priority < 0)
-                    {
-                        queue_priority = 0;
-                    }
+    cmdinputcnt++;
 
-                    fpsctrlqueuelist[queue].priority = queue_priority;
-                }
+    return 1;
+}
 
 
 
-                // set wait on run ON
-                if((cmdFOUND == 0)
-                        && (strncmp(FPScmdline, "waitonrunON", strlen("waitonrunON")) == 0))
-                {
-                    cmdFOUND = 1;
-                    waitonrun = 1;
-                }
 
-                // set wait on run OFF
-                if((cmdFOUND == 0)
-                        && (strncmp(FPScmdline, "waitonrunOFF", strlen("waitonrunOFF")) == 0))
-                {
-                    cmdFOUND = 1;
-                    waitonrun = 0;
-                }
+/** @brief Fill up task list from fifo submissions
+ *
+ * fifo is read in blocks into a static buffer, and complete lines are
+ * processed. Incomplete lines are kept for next call.
+ * Lines longer than STRINGMAXLEN_FPS_CMDLINE are discarded.
+ *
+ * If the task list is full, reading stops and remaining lines stay in
+ * the buffer or fifo until tasks are purged.
+ *
+ * @return number of tasks added
+ */
+int functionparameter_read_fpsCMD_fifo(
+    int fpsCTRLfifofd,
+    FPSCTRL_TASK_ENTRY *fpsctrltasklist,
+    FPSCTRL_TASK_QUEUE *fpsctrlqueuelist
+)
+{
+    static char   buff[FPSCMD_FIFO_BUFFSIZE];
+    static size_t buffsize = 0;  // bytes in buff
+    static int    discardline = 0; // 1 if skipping remainder of over-long line
 
-                // set wait on conf ON
-                if((cmdFOUND == 0)
-                        && (strncmp(FPScmdline, "waitonconfON", strlen("waitonconfON")) == 0))
-                {
-                    cmdFOUND = 1;
-                    waitonconf = 1;
-                }
+    int cmdcnt = 0;
+
+
+    DEBUG_TRACEPOINT(" ");
 
-                // set wait on conf OFF
-                if((cmdFOUND == 0)
-                        && (strncmp(FPScmdline, "waitonconfOFF", strlen("waitonconfOFF")) == 0))
+    for(;;)
+    {
+        // process complete lines in buffer
+        size_t linestart = 0;
+        char  *eol;
+
+        while((eol = memchr(buff + linestart, '\n',
+                            buffsize - linestart)) != NULL)
+        {
+            size_t linelen = eol - (buff + linestart);
+
+            if(discardline == 1)
+            {
+                discardline = 0;
+            }
+            else if(linelen > STRINGMAXLEN_FPS_CMDLINE - 1)
+            {
+                PRINT_WARNING("fifo command line too long (%zu char), discarded",
+                              linelen);
+            }
+            else
+            {
+                int cmdindex = fpsCMD_fifo_freetask(fpsctrltasklist);
+                if(cmdindex == -1)
                 {
-                    cmdFOUND = 1;
-                    waitonconf = 0;
+                    // task list full, resume on next call
+                    break;
                 }
 
+                *eol = '\0';
+                cmdcnt += fpsCMD_fifo_processline(buff + linestart, cmdindex,
+                                                  fpsctrltasklist, fpsctrlqueuelist);
+            }
+            linestart += linelen + 1;
+        }
+
+        // shift remaining bytes to start of buffer
+        if(linestart > 0)
+        {
+            memmove(buff, buff + linestart, buffsize - linestart);
+            buffsize -= linestart;
+        }
+
+        if(eol != NULL)
+        {
+            // stopped on full task list
+            break;
+        }
+
+        // incomplete line exceeding max length: drop it and skip to next newline
+        if(buffsize > STRINGMAXLEN_FPS_CMDLINE - 1)
+        {
+            PRINT_WARNING("fifo command line too long, discarded");
+            buffsize = 0;
+            discardline = 1;
+        }
 
-                // set wait point for arbitrary FPS run to have finished
 
-                DEBUG_TRACEPOINT(" ");
+        ssize_t bytes = read(fpsCTRLfifofd, buff + buffsize,
+                             FPSCMD_FIFO_BUFFSIZE - buffsize);
 
-                // for all other commands, put in task list
-                if(cmdFOUND == 0)
+        if(bytes > 0)
+        {
+            buffsize += bytes;
+            if(discardline == 1)
+            {
+                char *nl = memchr(buff, '\n', buffsize);
+                if(nl == NULL)
                 {
-                    strncpy(fpsctrltasklist[cmdindex].cmdstring, FPScmdline,
-                            STRINGMAXLEN_FPS_CMDLINE-1);
-
-                    fpsctrltasklist[cmdindex].status = FPSTASK_STATUS_ACTIVE | FPSTASK_STATUS_SHOW;
-                    fpsctrltasklist[cmdindex].inputindex = cmdinputcnt;
-                    fpsctrltasklist[cmdindex].queue = queue;
-                    clock_gettime(CLOCK_REALTIME, &fpsctrltasklist[cmdindex].creationtime);
-
-                    // waiting to be processed
-                    fpsctrltasklist[cmdindex].status |= FPSTASK_STATUS_WAITING;
-
-
-                    if(waitonrun == 1)
-                    {
-                        fpsctrltasklist[cmdindex].flag |= FPSTASK_FLAG_WAITONRUN;
-                    }
-                    else
-                    {
-                        fpsctrltasklist[cmdindex].flag &= ~FPSTASK_FLAG_WAITONRUN;
-                    }
-
-                    if(waitonconf == 1)
-                    {
-                        fpsctrltasklist[cmdindex].flag |= FPSTASK_FLAG_WAITONCONF;
-                    }
-                    else
-                    {
-                        fpsctrltasklist[cmdindex].flag &= ~FPSTASK_FLAG_WAITONCONF;
-                    }
-
-                    cmdinputcnt++;
-
-                    cmdcnt ++;
+                    buffsize = 0;
+                }
+                else
+                {
+                    // keep newline, ends discarded line
+                    size_t skip = nl - buff;
+                    memmove(buff, nl, buffsize - skip);
+                    buffsize -= skip;
                 }
-                lineOK = 1;
-                break;
             }
         }
-
+        else
+        {
+            // no more data (EWOULDBLOCK), writer closed, or error
+            if((bytes < 0) && (errno != EWOULDBLOCK) && (errno != EAGAIN)
+                    && (errno != EINTR))
+            {
+                PRINT_WARNING("fifo read error");
+            }
+            break;
+        }
     }
 
     DEBUG_TRACEPOINT(" ");
 
     return cmdcnt;
 }
-
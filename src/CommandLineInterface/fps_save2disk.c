@@ -86,7 +86,7 @@ int functionparameter_SaveFPS2disk_dir(
 
     for ( int pindex = 0; pindex < fpsentry->md->NBparamMAX; pindex++)
     {
-        errno_t ret = functionparameter_PrintParameter_ValueString(&fpsentry->parray[pindex], outfpstring, stringmaxlen);
+        errno_t ret = functionparameter_PrintParameter_ValueString(&fpsentry->parray[pindex], &fpsentry->pdescr[pindex], outfpstring, stringmaxlen);
         if(ret == RETURN_SUCCESS)
             fprintf(fpoutval, "%s\n", outfpstring);
 
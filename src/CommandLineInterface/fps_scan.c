@@ -300,7 +300,7 @@ errno_t functionparameter_scan_fps(
                     {
                         // find or allocate keyword node
                         int level;
-                        for(level = 1; level < fps[fpsindex].parray[pindex0].keywordlevel + 1; level++)
+                        for(level = 1; level < fps[fpsindex].pdescr[pindex0].keywordlevel + 1; level++)
                         {
 
                             // does node already exist ?
@@ -313,12 +313,12 @@ errno_t functionparameter_scan_fps(
                                     int match = 1;
                                     for(l = 0; l < level; l++)   // keywords at all levels need to match
                                     {
-                                        if(strcmp(fps[fpsindex].parray[pindex0].keyword[l],
+                                        if(strcmp(fps[fpsindex].pdescr[pindex0].keyword[l],
                                                   keywnode[kwnindex].keyword[l]) != 0)
                                         {
                                             match = 0;
                                         }
-                                        //                        printf("TEST MATCH : %16s %16s  %d\n", fps[fpsindex].parray[i].keyword[l], keywnode[kwnindex].keyword[l], match);
+                                        //                        printf("TEST MATCH : %16s %16s  %d\n", fps[fpsindex].pdescr[i].keyword[l], keywnode[kwnindex].keyword[l], match);
                                     }
                                     if(match == 1)   // we have a match
                                     {
@@ -347,7 +347,7 @@ errno_t functionparameter_scan_fps(
 
                                         for(l = 0; l < level - 1; l++)   // keywords at all levels need to match
                                         {
-                                            if(strcmp(fps[fpsindex].parray[pindex0].keyword[l],
+                                            if(strcmp(fps[fpsindex].pdescr[pindex0].keyword[l],
                                                       keywnode[kwnindexp].keyword[l]) != 0)
                                             {
                                                 match = 0;
@@ -379,7 +379,7 @@ errno_t functionparameter_scan_fps(
                                 for(l = 0; l < level; l++)
                                 {
                                     char tmpstring[200];
-                                    strcpy(keywnode[kwnindex].keyword[l], fps[fpsindex].parray[pindex0].keyword[l]);
+                                    strcpy(keywnode[kwnindex].keyword[l], fps[fpsindex].pdescr[pindex0].keyword[l]);
                                     printf(" %s", keywnode[kwnindex].keyword[l]);
                                     if(l == 0)
                                     {
@@ -394,13 +394,13 @@ errno_t functionparameter_scan_fps(
                                 if(verbose > 0)
                                 {
                                     printf("   %d %d\n", keywnode[kwnindex].keywordlevel,
-                                           fps[fpsindex].parray[pindex0].keywordlevel);
+                                           fps[fpsindex].pdescr[pindex0].keywordlevel);
                                 }
 
                                 if(keywnode[kwnindex].keywordlevel ==
-                                        fps[fpsindex].parray[pindex0].keywordlevel)
+                                        fps[fpsindex].pdescr[pindex0].keywordlevel)
                                 {
-                                    //									strcpy(keywnode[kwnindex].keywordfull, fps[fpsindex].parray[i].keywordfull);
+                                    //									strcpy(keywnode[kwnindex].keywordfull, fps[fpsindex].pdescr[i].keywordfull);
 
                                     keywnode[kwnindex].leaf = 1;
                                     keywnode[kwnindex].fpsindex = fpsindex;
@@ -36,7 +36,8 @@ int functionparameter_UserInputSetParamValue(
     functionparameter_PrintParameterInfo(fpsentry, pindex);
 
 
-    if(fpsentry->parray[pindex].fpflag & FPFLAG_WRITESTATUS)
+    if((fpsentry->parray[pindex].fpflag & FPFLAG_WRITESTATUS)
+            && (fpsentry->layoutversion != 1))
     {
         inputOK = 0;
         fflush(stdout);
@@ -257,6 +258,7 @@ int functionparameter_UserInputSetParamValue(
 
             // notify GUI
             fpsentry->md->signal |= FUNCTION_PARAMETER_STRUCT_SIGNAL_UPDATE;
+            functionparameter_notify_change(fpsentry->notify, pindex);
 
 
             // Save to disk
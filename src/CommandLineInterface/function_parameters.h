@@ -301,22 +301,17 @@ typedef struct
 
 
 
+/** @brief Function parameter, runtime fields
+ *
+ * Fields accessed by processes at runtime (flags, type, value, min/max,
+ * update counter). Entries are stored in a contiguous array, separate from
+ * the larger name and description block (FUNCTION_PARAMETER_DESCR), so
+ * that polling a few parameters touches few cache lines and pages.
+ */
 typedef struct
 {
     uint64_t fpflag;// 64 binary flags, see FUNCTION_PARAMETER_MASK_XXXX
 
-    // Parameter name
-    char keywordfull[FUNCTION_PARAMETER_KEYWORD_STRMAXLEN *
-                                                          FUNCTION_PARAMETER_KEYWORD_MAXLEVEL];
-    char keyword[FUNCTION_PARAMETER_KEYWORD_MAXLEVEL][FUNCTION_PARAMETER_KEYWORD_STRMAXLEN];
-    int keywordlevel; // number of levels in keyword
-
-    // if this parameter value imported from another parameter, source is:
-    char keywordfrom[FUNCTION_PARAMETER_KEYWORD_STRMAXLEN *
-                                                          FUNCTION_PARAMETER_KEYWORD_MAXLEVEL];
-
-    char description[FUNCTION_PARAMETER_DESCR_STRMAXLEN];
-
     // one of FUNCTION_PARAMETER_TYPE_XXXX
     uint32_t type;
 
@@ -355,6 +350,64 @@ typedef struct
 
 
 
+/** @brief Function parameter, name and description
+ *
+ * Same index as FUNCTION_PARAMETER entry.
+ * Written when parameter is added, read by user interfaces and name lookup.
+ */
+typedef struct
+{
+    // Parameter name
+    char keywordfull[FUNCTION_PARAMETER_KEYWORD_STRMAXLEN *
+                                                          FUNCTION_PARAMETER_KEYWORD_MAXLEVEL];
+    char keyword[FUNCTION_PARAMETER_KEYWORD_MAXLEVEL][FUNCTION_PARAMETER_KEYWORD_STRMAXLEN];
+    int keywordlevel; // number of levels in keyword
+
+    // if this parameter value imported from another parameter, source is:
+    char keywordfrom[FUNCTION_PARAMETER_KEYWORD_STRMAXLEN *
+                                                          FUNCTION_PARAMETER_KEYWORD_MAXLEVEL];
+
+    char description[FUNCTION_PARAMETER_DESCR_STRMAXLEN];
+
+} FUNCTION_PARAMETER_DESCR;
+
+
+
+/** @brief Function parameter, layout version 1
+ *
+ * Single array of parameters, runtime and name fields interleaved.
+ * Only used to read FPS files written before layout version 2.
+ */
+typedef struct
+{
+    uint64_t fpflag;
+    char keywordfull[FUNCTION_PARAMETER_KEYWORD_STRMAXLEN *
+                                                          FUNCTION_PARAMETER_KEYWORD_MAXLEVEL];
+    char keyword[FUNCTION_PARAMETER_KEYWORD_MAXLEVEL][FUNCTION_PARAMETER_KEYWORD_STRMAXLEN];
+    int keywordlevel;
+    char keywordfrom[FUNCTION_PARAMETER_KEYWORD_STRMAXLEN *
+                                                          FUNCTION_PARAMETER_KEYWORD_MAXLEVEL];
+    char description[FUNCTION_PARAMETER_DESCR_STRMAXLEN];
+    uint32_t type;
+    union
+    {
+        int64_t i64[4];
+        double f64[4];
+        float  f32[4];
+        pid_t pid[2];
+        struct timespec ts[2];
+        char string[2][FUNCTION_PARAMETER_STRMAXLEN];
+    } val;
+    union
+    {
+        FUNCTION_PARAMETER_SUBINFO_STREAM stream;
+        FUNCTION_PARAMETER_SUBINFO_FPS    fps;
+    } info;
+    long cnt0;
+} FUNCTION_PARAMETER_V1;
+
+
+
 
 #define STRINGMAXLEN_FPS_NAME      100
 
@@ -421,6 +474,71 @@ typedef struct
 #define FPS_MODULE_STRMAXLEN 200
 
 
+// FPS shared memory file layout
+//
+// version 1 : [MD][FUNCTION_PARAMETER_V1 x NBparamMAX]
+// version 2 : [LAYOUT][MD][FUNCTION_PARAMETER x NBparamMAX][FUNCTION_PARAMETER_DESCR x NBparamMAX]
+// version 3 : version 2 followed by keyword hash table [int32_t x NBhash]
+// version 4 : version 3 followed by change notification block [NOTIFY]
+//
+// Version 1 files start with MD name, version 2+ files with layout magic.
+// Magic first byte is 0, which cannot start a valid FPS name.
+//
+#define FUNCTION_PARAMETER_STRUCT_LAYOUT_MAGIC    "\0FPSLYT"
+#define FUNCTION_PARAMETER_STRUCT_LAYOUT_VERSION  4
+#define FUNCTION_PARAMETER_STRUCT_LAYOUT_ALIGN    64
+
+typedef struct
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t headersize;  // sizeof(FUNCTION_PARAMETER_STRUCT_LAYOUT)
+
+    // byte offsets from start of file
+    uint64_t mdoffset;
+    uint64_t paramoffset;
+    uint64_t descroffset;
+
+    // entry sizes, checked at connect time
+    uint64_t mdsize;
+    uint64_t paramsize;
+    uint64_t descrsize;
+
+    uint64_t NBparamMAX;
+    uint64_t filesize;
+
+    // version 3+
+    uint64_t hashoffset;
+    uint64_t NBhash;      // hash table size, power of 2
+
+    // version 4+
+    uint64_t notifyoffset;
+    uint64_t notifysize;
+} FUNCTION_PARAMETER_STRUCT_LAYOUT;
+
+
+
+// change notification consumers, each has its own dirty bitmap
+#define FPS_NOTIFY_CONF         0
+#define FPS_NOTIFY_RUN          1
+#define FPS_NOTIFY_NBCONSUMER   2
+
+/** @brief Parameter change notification
+ *
+ * Setters set parameter index bit in each consumer dirty bitmap, then
+ * increment changeseq and wake processes waiting on it (futex).
+ * dirty holds FPS_NOTIFY_NBCONSUMER bitmaps of NBdirtyword words.
+ */
+typedef struct
+{
+    uint32_t changeseq;     // futex word
+    uint32_t NBwaiter;      // number of processes waiting on changeseq
+    uint64_t NBdirtyword;
+    uint64_t dirty[];
+} FUNCTION_PARAMETER_STRUCT_NOTIFY;
+
+
+
 // metadata
 typedef struct
 {
@@ -511,11 +629,19 @@ typedef struct
 
 typedef struct
 {
-    // these two structures are shared
+    // these structures are shared
     FUNCTION_PARAMETER_STRUCT_MD *md;
     FUNCTION_PARAMETER           *parray;   // array of function parameters
+    FUNCTION_PARAMETER_DESCR     *pdescr;   // parameter names, same index as parray
+    int32_t                      *phash;    // keywordfull hash table, NULL if none
+    FUNCTION_PARAMETER_STRUCT_NOTIFY *notify; // change notification, NULL if none
 
     // these variables are local to each process
+    void     *shmaddr;       // file mapping
+    size_t    shmsize;
+    int       layoutversion; // 1: parray and pdescr are local copies
+    long      NBhash;        // size of phash
+    int       notifydefer;   // 1: setters mark parameters dirty, caller posts change
     uint16_t  localstatus;   // 1 if conf loop should be active
     int       SMfd;
     uint32_t  CMDmode;
@@ -541,6 +667,9 @@ typedef struct
 #define NB_FPSCTRL_TASK_MAX             500
 #define NB_FPSCTRL_TASK_PURGESIZE        50
 
+// max number of consecutive setval tasks applied in a single scheduler pass
+#define NB_FPSCTRL_TASK_BATCHMAX        100
+
 // flags
 #define FPSTASK_STATUS_ACTIVE    0x0000000000000001   // is the task entry in the array used ?
 #define FPSTASK_STATUS_SHOW      0x0000000000000002
@@ -569,6 +698,11 @@ typedef struct
     // high number = high priority
     // 0 = queue not active
 
+    // active tasks in submission order, linked by FPSCTRL_TASK_ENTRY.nextindex
+    // -1 if queue is empty
+    int taskhead;
+    int tasktail;
+
 } FPSCTRL_TASK_QUEUE;
 
 
@@ -586,6 +720,8 @@ typedef struct
     uint32_t queue;
     // Default queue is 0
 
+    int nextindex; // next active task in same queue, -1 if last
+
     uint64_t status;
     uint64_t flag;
 
@@ -623,6 +759,7 @@ typedef struct
     char     fpsCTRLfifoname[200];
     int      fpsCTRLfifofd;
     int      direction;
+    int      setvalbatch;         // 1 : setval does not signal update
 } FPSCTRL_PROCESS_VARS;
 
 
@@ -679,6 +816,8 @@ typedef struct
 #include "fps_load.h"
 #include "fps_outlog.h"
 #include "fps_paramvalue.h"
+#include "fps_notify.h"
+#include "fps_paramhandle.h"
 #include "fps_processinfo_entries.h"
 #include "fps_RUNexit.h"
 #include "fps_save2disk.h"
@@ -23,8 +23,39 @@
 // timing info for real-time loop processes
 #define PROCESSINFO_NBtimer 100
 
+// trigger wake-up latency histogram, log2 bins of nanosec
+// bin k holds latencies in [2^k, 2^(k+1)) ns, last bin is overflow
+#define PROCESSINFO_WAKELAT_NBBIN 32
+
+// max number of input streams in trigger set
+#define PROCESSINFO_TRIGGERSET_MAXNB 8
+
+// loop latency histograms, log-linear (HDR) bins of nanosec
+// values below 2^SUBBITS ns are binned exactly, above each power of 2
+// is split in 2^SUBBITS sub-bins (6% resolution)
+// values above 2^MAXBITS ns (~18 mn) go to last bin
+#define PROCESSINFO_LATHIST_SUBBITS 4
+#define PROCESSINFO_LATHIST_MAXBITS 40
+#define PROCESSINFO_LATHIST_NBBIN \
+    ((PROCESSINFO_LATHIST_MAXBITS - PROCESSINFO_LATHIST_SUBBITS + 1) << PROCESSINFO_LATHIST_SUBBITS)
+
 #include "CLIcore.h"
 
+
+/**
+ * Latency histogram
+ *
+ * Written by loop process only, read lock-free by other processes
+ */
+typedef struct
+{
+    uint64_t cnt;
+    uint64_t max_ns;
+    uint64_t bin[PROCESSINFO_LATHIST_NBBIN];
+} PROCESSINFO_LATHIST;
+
+
+
 /**
  *
  * This structure hold process information and hooks required for basic
@@ -97,10 +128,43 @@ typedef struct
     uint64_t  triggermissedframe_cumul;      // cumulative missed frames
     int       triggerstatus;   // see TRIGGERSTATUS codes
 
+    // busy-poll budget for SPINSEM trigger mode [nanosec]
+    // can be tuned live (procCTRL trigger screen)
+    long      triggerspin_ns;
+    uint64_t  triggerspinhitcnt;              // trigger received while spinning
+    uint64_t  triggerspinblockcnt;            // spin budget exhausted, blocked on semaphore
+
+    // wake-up latency: time from input stream write to trigger received
+    uint64_t  triggerwakelat_hist[PROCESSINFO_WAKELAT_NBBIN];
+    uint64_t  triggerwakelat_cnt;
+    long      triggerwakelat_max_ns;
+
+    // OPTIONAL MULTI-INPUT TRIGGER SET
+    // Used with triggermode ANY or ALL, set up by processinfo_triggerset_init()
+    // Input 0 is also the triggerstream (streamproctrace)
+    int       trigsetNB;                                      // number of inputs, 0 if unused
+    long      trigsettolerance_ns;                            // ALL: max spread of input arrival times, 0 to disable
+    imageID   trigsetstreamID[PROCESSINFO_TRIGGERSET_MAXNB];
+    ino_t     trigsetinode[PROCESSINFO_TRIGGERSET_MAXNB];
+    int       trigsetsem[PROCESSINFO_TRIGGERSET_MAXNB];       // semaphore index, -1: cnt0 polled
+    uint64_t  trigsetrecvcnt[PROCESSINFO_TRIGGERSET_MAXNB];   // frames received
+    uint64_t  trigsetmissedframe_cumul[PROCESSINFO_TRIGGERSET_MAXNB];
+    uint32_t  trigsetreadymask;                               // inputs updated at last trigger
+    uint64_t  trigsetmisaligncnt;                             // ALL: frames dropped, outside tolerance
+    void     *trigsetctx;                                     // waiter threads, local to process
+
 
 
     int RT_priority;    // -1 if unused. 0-99 for higher priority
-    cpu_set_t CPUmask;
+    cpu_set_t CPUmask;  // CPU affinity, applied by loopstart if not empty
+    int memlock;        // 1 if memory locked and pre-faulted by loopstart
+    int NUMAbind;       // 1 if memory bound to NUMA node(s) of CPUmask
+
+    // placement outcome, written by loopstart
+    int      placement_flags;        // PROCESSINFO_PLACEMENT_* bits applied
+    int      placement_cpu;          // CPU at loop start, -1 if unknown
+    int      placement_node;         // NUMA node at loop start, -1 if unknown
+    uint64_t placement_lockedbytes;  // locked memory (VmLck) [byte]
 
 
     // OPTIONAL TIMING MEASUREMENT
@@ -119,6 +183,16 @@ typedef struct
     long dtmedian_iter_ns;  // median time offset between iterations [nanosec]
     long dtmedian_exec_ns;  // median compute/busy time [nanosec]
 
+    // latency histograms since last reset, CLOCK_MONOTONIC
+    // to reset, set lathist_resetreq = 1 : loop process clears histograms
+    PROCESSINFO_LATHIST lathist_iter;   // iteration period, start to start
+    PROCESSINFO_LATHIST lathist_exec;   // execution time, start to end
+    PROCESSINFO_LATHIST lathist_wait;   // trigger wait, end to next start
+    struct timespec lathist_tstart;     // last exec start (0 if none)
+    struct timespec lathist_tend;       // last exec end (0 if none)
+    struct timespec lathist_resettime;  // CLOCK_REALTIME of last reset
+    int             lathist_resetreq;
+
     // If enabled=1, pause process if dtiter larger than limit
     int dtiter_limit_enable;
     long dtiter_limit_value;
@@ -132,6 +206,18 @@ typedef struct
 
     char description[STRINGMAXLEN_PROCESSINFO_DESCRIPTION];
 
+
+    // OPTIONAL DATA TRANSFER STATISTICS
+    // Used by processes moving frames between streams and network links
+    // Rates are measured over iostat_dtwindow_s
+    double    iostat_dtwindow_s;   // averaging window [sec]
+    double    iostat_bytepersec;   // data rate
+    double    iostat_framepersec;  // frame rate
+    uint64_t  iostat_framecnt;     // cumulative frames transferred
+    uint64_t  iostat_framedrop;    // cumulative frames dropped upstream
+    double    iostat_dtmean_us;    // mean frame inter-arrival time [us]
+    double    iostat_dtjitter_us;  // RMS frame inter-arrival jitter [us]
+
 } PROCESSINFO;
 
 
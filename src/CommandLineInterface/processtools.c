@@ -303,6 +303,19 @@ PROCESSINFO *processinfo_setup(
 
     processinfo->MeasureTiming =  0;  // default: do not measure timing
     processinfo->RT_priority   = -1;  // default: do not assign RT priority
+    CPU_ZERO(&processinfo->CPUmask);  // default: do not set CPU affinity
+    processinfo->memlock       = 0;   // default: do not lock memory
+    processinfo->NUMAbind      = 0;   // default: no NUMA memory binding
+    processinfo->placement_flags = 0;
+    processinfo->placement_cpu   = -1;
+    processinfo->placement_node  = -1;
+    processinfo->placement_lockedbytes = 0;
+
+    processinfo->triggerspin_ns = PROCESSINFO_TRIGGERSPIN_NS_DEFAULT;
+
+    processinfo->trigsetNB           = 0;  // default: single trigger input
+    processinfo->trigsettolerance_ns = 0;
+    processinfo->trigsetctx          = NULL;
 
     DEBUG_TRACEPOINT(" ");
 
@@ -359,6 +372,8 @@ errno_t processinfo_loopstart(
 #endif
     }
 
+    // CPU affinity, NUMA binding, memory locking
+    processinfo_placement_apply(processinfo);
 
     return RETURN_SUCCESS;
 }
@@ -694,6 +709,9 @@ PROCESSINFO *processinfo_shm_create(
     pinfo->dtiter_limit_enable = 0;
     pinfo->dtexec_limit_enable = 0;
 
+    // latency histograms are cleared on first exec_start
+    pinfo->lathist_resetreq = 1;
+
     data.pinfo = pinfo;
     pinfo->PID = PID;
 
@@ -811,6 +829,11 @@ int processinfo_cleanExit(PROCESSINFO *processinfo)
         processinfo->loopstat = 3; // clean exit
     }
 
+    if(processinfo->trigsetctx != NULL)
+    {
+        processinfo_triggerset_free(processinfo);
+    }
+
     return 0;
 }
 
@@ -1156,6 +1179,11 @@ errno_t processinfo_update_output_stream(
             IDin = processinfo->triggerstreamID;
             DEBUG_TRACEPOINT("trigger IDin = %ld", IDin);
 
+            // trace readers discard copies taken while write is set
+            // cleared by ImageStreamIO_UpdateIm()
+            data.image[outstreamID].md[0].write = 1;
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+
             if(IDin > -1)
             {
                 int sptisize = data.image[IDin].md[0].NBproctrace - 1;
@@ -1232,6 +1260,7 @@ int processinfo_exec_start(
 
         clock_gettime(CLOCK_REALTIME,
                       &processinfo->texecstart[processinfo->timerindex]);
+        processinfo_lathist_execstart(processinfo);
 
         if(processinfo->dtiter_limit_enable != 0)
         {
@@ -1307,6 +1336,7 @@ int processinfo_exec_end(
     if(processinfo->MeasureTiming == 1)
     {
         clock_gettime(CLOCK_REALTIME, &processinfo->texecend[processinfo->timerindex]);
+        processinfo_lathist_execend(processinfo);
 
         if(processinfo->dtexec_limit_enable != 0)
         {
@@ -2761,6 +2791,21 @@ void processinfo_CTRLscreen_handle_winch(int __attribute__((unused)) sig)
 
 
 
+// print p50 / p99 / p99.9 / max of latency histogram [us]
+static void procCTRL_print_lathist(
+    const char                *label,
+    const PROCESSINFO_LATHIST *lathist
+)
+{
+    TUI_printfw(" %s %7.1f %7.1f %7.1f %8.1f us |", label,
+                0.001 * processinfo_lathist_percentile(lathist, 0.5),
+                0.001 * processinfo_lathist_percentile(lathist, 0.99),
+                0.001 * processinfo_lathist_percentile(lathist, 0.999),
+                0.001 * lathist->max_ns);
+}
+
+
+
 /**
  * ## Purpose
  *
@@ -3617,6 +3662,59 @@ errno_t processinfo_CTRLscreen()
             break;;
 
 
+        case 'b' : // decrease trigger spin budget
+            pindex = pindexSelected;
+            procinfoproc.pinfoarray[pindex]->triggerspin_ns /= 2;
+            if(procinfoproc.pinfoarray[pindex]->triggerspin_ns < 1000)
+            {
+                procinfoproc.pinfoarray[pindex]->triggerspin_ns = 0;
+            }
+            break;
+
+        case 'B' : // increase trigger spin budget
+            pindex = pindexSelected;
+            procinfoproc.pinfoarray[pindex]->triggerspin_ns *= 2;
+            if(procinfoproc.pinfoarray[pindex]->triggerspin_ns < 1000)
+            {
+                procinfoproc.pinfoarray[pindex]->triggerspin_ns = 1000;
+            }
+            if(procinfoproc.pinfoarray[pindex]->triggerspin_ns > 10000000)
+            {
+                procinfoproc.pinfoarray[pindex]->triggerspin_ns = 10000000;
+            }
+            break;
+
+        case 'H' : // reset trigger wake-up latency histogram
+            pindex = pindexSelected;
+            processinfo_trigger_wakelat_reset(procinfoproc.pinfoarray[pindex]);
+            procinfoproc.pinfoarray[pindex]->triggerspinhitcnt = 0;
+            procinfoproc.pinfoarray[pindex]->triggerspinblockcnt = 0;
+            break;
+
+        case 'l' : // reset latency histograms
+            pindex = pindexSelected;
+            procinfoproc.pinfoarray[pindex]->lathist_resetreq = 1;
+            break;
+
+        case 'D' : // dump latency histograms to file
+            pindex = pindexSelected;
+            if(pinfolist->active[pindex] == 1)
+            {
+                char procdname[STRINGMAXLEN_FULLFILENAME];
+                char fname[STRINGMAXLEN_FULLFILENAME];
+                processinfo_procdirname(procdname);
+                WRITE_FULLFILENAME(fname, "%s/proc.%s.%06d.lathist.txt", procdname,
+                                   procinfoproc.pinfoarray[pindex]->name,
+                                   (int) procinfoproc.pinfoarray[pindex]->PID);
+                FILE *fp = fopen(fname, "w");
+                if(fp != NULL)
+                {
+                    processinfo_lathist_dump(procinfoproc.pinfoarray[pindex], fp);
+                    fclose(fp);
+                }
+            }
+            break;
+
         case 'm' : // message
             pindex = pindexSelected;
             if(pinfolist->active[pindex] == 1)
@@ -3976,6 +4074,42 @@ errno_t processinfo_CTRLscreen()
                 TUI_printfw("    Enable execution time limit");
                 TUI_newline();
 
+                attron(attrval);
+                TUI_printfw("    l");
+                attroff(attrval);
+                TUI_printfw("    Reset latency histograms");
+                TUI_newline();
+
+                attron(attrval);
+                TUI_printfw("    D");
+                attroff(attrval);
+                TUI_printfw("    Dump latency histograms to <procdir>/proc.<name>.<PID>.lathist.txt");
+                TUI_newline();
+
+
+
+                TUI_newline();
+                TUI_printfw("============ TRIGGER");
+                TUI_newline();
+
+                attron(attrval);
+                TUI_printfw("    b");
+                attroff(attrval);
+                TUI_printfw("    Decrease trigger spin budget (x0.5)");
+                TUI_newline();
+
+                attron(attrval);
+                TUI_printfw("    B");
+                attroff(attrval);
+                TUI_printfw("    Increase trigger spin budget (x2)");
+                TUI_newline();
+
+                attron(attrval);
+                TUI_printfw("    H");
+                attroff(attrval);
+                TUI_printfw("    Reset trigger wake-up latency histogram");
+                TUI_newline();
+
 
 
                 TUI_newline();
@@ -4393,7 +4527,7 @@ errno_t processinfo_CTRLscreen()
                     DEBUG_TRACEPOINT(" ");
                     TUI_newline();
                     TUI_newline();
-                    TUI_printfw("%*.*s %*.*s %-*.*s %*.*s %*.*s mode sem %*.*s  %*.*s  %*.*s",
+                    TUI_printfw("%*.*s %*.*s %-*.*s %*.*s %*.*s mode sem %*.*s  %*.*s  %*.*s  spin[us] hit%%  wake p50/p99/max [us]",
                                 pstrlen_status,   pstrlen_status,   "STATUS",
                                 pstrlen_pid,      pstrlen_pid,      "PID",
                                 pstrlen_pname,    pstrlen_pname,    "pname",
@@ -4902,6 +5036,20 @@ errno_t processinfo_CTRLscreen()
                                         attroff(COLOR_PAIR(memColor));
 #endif
 
+                                        // placement at loop start : cpu, NUMA node, locked memory
+                                        // flags : A = affinity, M = memlock, N = NUMA bind
+                                        if((spindex == 0) && (procinfoproc.pinfoarray[pindex] != NULL))
+                                        {
+                                            PROCESSINFO *pinfo = procinfoproc.pinfoarray[pindex];
+                                            TUI_printfw(" c%02d n%d %5ldM %c%c%c",
+                                                        pinfo->placement_cpu,
+                                                        pinfo->placement_node,
+                                                        (long)(pinfo->placement_lockedbytes / 1048576),
+                                                        (pinfo->placement_flags & PROCESSINFO_PLACEMENT_AFFINITY) ? 'A' : '-',
+                                                        (pinfo->placement_flags & PROCESSINFO_PLACEMENT_MEMLOCK) ? 'M' : '-',
+                                                        (pinfo->placement_flags & PROCESSINFO_PLACEMENT_NUMABIND) ? 'N' : '-');
+                                        }
+
                                         if(pindex == pindexSelected)
                                         {
                                             attroff(A_REVERSE);
@@ -4962,6 +5110,28 @@ errno_t processinfo_CTRLscreen()
                                     TUI_printfw(" DELA   ");
                                     break;
 
+                                case PROCESSINFO_TRIGGERMODE_SPINWAIT :
+                                    TUI_printfw(" SPIN   ");
+                                    break;
+
+                                case PROCESSINFO_TRIGGERMODE_SPINSEM :
+                                    TUI_printfw(" SPSE %2d",
+                                                procinfoproc.pinfoarray[pindex]->triggersem
+                                               );
+                                    break;
+
+                                case PROCESSINFO_TRIGGERMODE_ANY :
+                                    TUI_printfw(" ANY  %2d",
+                                                procinfoproc.pinfoarray[pindex]->trigsetNB
+                                               );
+                                    break;
+
+                                case PROCESSINFO_TRIGGERMODE_ALL :
+                                    TUI_printfw(" ALL  %2d",
+                                                procinfoproc.pinfoarray[pindex]->trigsetNB
+                                               );
+                                    break;
+
                                 default :
                                     TUI_printfw(" %04d   ",  procinfoproc.pinfoarray[pindex]->triggermode);
                                 }
@@ -4972,6 +5142,29 @@ errno_t processinfo_CTRLscreen()
                                             procinfoproc.pinfoarray[pindex]->triggermissedframe_cumul);
                                 TUI_printfw("  %*llu ", pstrlen_tocnt,
                                             procinfoproc.pinfoarray[pindex]->trigggertimeoutcnt);
+
+                                {
+                                    PROCESSINFO *pinfo = procinfoproc.pinfoarray[pindex];
+                                    uint64_t spincnt = pinfo->triggerspinhitcnt + pinfo->triggerspinblockcnt;
+
+                                    TUI_printfw(" %8.1f ", 0.001 * pinfo->triggerspin_ns);
+                                    if(spincnt > 0)
+                                    {
+                                        TUI_printfw("%5.1f ", 100.0 * pinfo->triggerspinhitcnt / spincnt);
+                                    }
+                                    else
+                                    {
+                                        TUI_printfw("    - ");
+                                    }
+
+                                    if(pinfo->triggerwakelat_cnt > 0)
+                                    {
+                                        TUI_printfw(" %8.1f %8.1f %8.1f",
+                                                    0.001 * processinfo_trigger_wakelat_percentile(pinfo, 0.5),
+                                                    0.001 * processinfo_trigger_wakelat_percentile(pinfo, 0.99),
+                                                    0.001 * pinfo->triggerwakelat_max_ns);
+                                    }
+                                }
                             }
 
 
@@ -5178,6 +5371,22 @@ errno_t processinfo_CTRLscreen()
                                     free(dtiter_array);
                                     free(dtexec_array);
 
+                                    // latency histograms since reset, selected process only
+                                    if(pindex == pindexSelected)
+                                    {
+                                        PROCESSINFO *pinfo = procinfoproc.pinfoarray[pindex];
+                                        struct timespec tnow;
+                                        clock_gettime(CLOCK_REALTIME, &tnow);
+
+                                        TUI_newline();
+                                        TUI_printfw("     HDR %9lu iter  %6lds ",
+                                                    pinfo->lathist_iter.cnt,
+                                                    (long)(tnow.tv_sec - pinfo->lathist_resettime.tv_sec));
+                                        procCTRL_print_lathist("ITER", &pinfo->lathist_iter);
+                                        procCTRL_print_lathist("EXEC", &pinfo->lathist_exec);
+                                        procCTRL_print_lathist("WAIT", &pinfo->lathist_wait);
+                                    }
+
                                 }
                             }
 
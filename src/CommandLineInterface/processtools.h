@@ -28,6 +28,8 @@
 
 #include "processinfo.h"
 #include "processtools_trigger.h"
+#include "processtools_placement.h"
+#include "processtools_latency.h"
 
 
 
@@ -205,6 +207,7 @@ extern "C" {
 #endif
 
 
+errno_t processinfo_procdirname(char *procdname);
 
 PROCESSINFO *processinfo_setup(
     char *pinfoname,
@@ -0,0 +1,355 @@
+/**
+ * @file processtools_latency.c
+ *
+ * Loop latency histograms
+ *
+ * Iteration period, execution time and trigger wait time are accumulated
+ * in log-linear (HDR) histograms in the processinfo shared memory, so that
+ * tail latency can be monitored over long periods.
+ *
+ * The loop process is the only writer. Other processes read the histograms
+ * without locking, and request a reset by setting lathist_resetreq.
+ *
+ */
+
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+
+#include "CLIcore.h"
+
+#include "processinfo.h"
+#include "processtools_latency.h"
+
+
+
+
+/** @brief Histogram bin index of a latency value
+ */
+int processinfo_lathist_binindex(
+    uint64_t val_ns
+)
+{
+    if(val_ns < (1UL << PROCESSINFO_LATHIST_SUBBITS))
+    {
+        return (int) val_ns;
+    }
+
+    int msb = 63 - __builtin_clzll(val_ns);
+    if(msb >= PROCESSINFO_LATHIST_MAXBITS)
+    {
+        return PROCESSINFO_LATHIST_NBBIN - 1;
+    }
+
+    int shift = msb - PROCESSINFO_LATHIST_SUBBITS;
+
+    return ((shift + 1) << PROCESSINFO_LATHIST_SUBBITS)
+           + (int)((val_ns >> shift) - (1UL << PROCESSINFO_LATHIST_SUBBITS));
+}
+
+
+
+static uint64_t processinfo_lathist_binmin(
+    int bin
+)
+{
+    if(bin < (1 << PROCESSINFO_LATHIST_SUBBITS))
+    {
+        return (uint64_t) bin;
+    }
+
+    int      shift = (bin >> PROCESSINFO_LATHIST_SUBBITS) - 1;
+    uint64_t sub = (bin & ((1 << PROCESSINFO_LATHIST_SUBBITS) - 1))
+                   | (1UL << PROCESSINFO_LATHIST_SUBBITS);
+
+    return sub << shift;
+}
+
+
+
+/** @brief Largest latency value falling in bin
+ */
+uint64_t processinfo_lathist_binmax(
+    int bin
+)
+{
+    if(bin < (1 << PROCESSINFO_LATHIST_SUBBITS))
+    {
+        return (uint64_t) bin;
+    }
+
+    int shift = (bin >> PROCESSINFO_LATHIST_SUBBITS) - 1;
+
+    return processinfo_lathist_binmin(bin) + (1UL << shift) - 1;
+}
+
+
+
+
+/** @brief Latency percentile [ns]
+ *
+ * Returns upper bound of bin holding the requested fraction, capped to
+ * maximum recorded value. Returns 0 if histogram is empty.
+ */
+uint64_t processinfo_lathist_percentile(
+    const PROCESSINFO_LATHIST *lathist,
+    double                     fraction
+)
+{
+    uint64_t cnt = 0;
+
+    // count from bins: may be read while loop process writes
+    for(int bin = 0; bin < PROCESSINFO_LATHIST_NBBIN; bin++)
+    {
+        cnt += lathist->bin[bin];
+    }
+    if(cnt == 0)
+    {
+        return 0;
+    }
+
+    uint64_t cntlim = (uint64_t)(fraction * cnt + 0.5);
+    if(cntlim < 1)
+    {
+        cntlim = 1;
+    }
+
+    uint64_t cntcumul = 0;
+    for(int bin = 0; bin < PROCESSINFO_LATHIST_NBBIN; bin++)
+    {
+        cntcumul += lathist->bin[bin];
+        if(cntcumul >= cntlim)
+        {
+            uint64_t val = processinfo_lathist_binmax(bin);
+            if(val > lathist->max_ns)
+            {
+                val = lathist->max_ns;
+            }
+            return val;
+        }
+    }
+
+    return lathist->max_ns;
+}
+
+
+
+
+static inline void processinfo_lathist_add(
+    PROCESSINFO_LATHIST *lathist,
+    struct timespec      t0,
+    struct timespec      t1
+)
+{
+    int64_t dt = (int64_t)(t1.tv_sec - t0.tv_sec) * 1000000000L
+                 + (t1.tv_nsec - t0.tv_nsec);
+    if(dt < 0)
+    {
+        dt = 0;
+    }
+
+    lathist->bin[processinfo_lathist_binindex((uint64_t) dt)] ++;
+    lathist->cnt ++;
+    if((uint64_t) dt > lathist->max_ns)
+    {
+        lathist->max_ns = (uint64_t) dt;
+    }
+}
+
+
+static inline int processinfo_lathist_tset(
+    struct timespec t
+)
+{
+    return (t.tv_sec != 0) || (t.tv_nsec != 0);
+}
+
+
+
+
+/** @brief Update histograms at execution start
+ *
+ * Called by processinfo_exec_start()
+ */
+void processinfo_lathist_execstart(
+    PROCESSINFO *processinfo
+)
+{
+    struct timespec tnow;
+
+    clock_gettime(CLOCK_MONOTONIC, &tnow);
+
+    if(processinfo->lathist_resetreq != 0)
+    {
+        memset(&processinfo->lathist_iter, 0, sizeof(PROCESSINFO_LATHIST));
+        memset(&processinfo->lathist_exec, 0, sizeof(PROCESSINFO_LATHIST));
+        memset(&processinfo->lathist_wait, 0, sizeof(PROCESSINFO_LATHIST));
+        processinfo->lathist_tstart.tv_sec = 0;
+        processinfo->lathist_tstart.tv_nsec = 0;
+        processinfo->lathist_tend.tv_sec = 0;
+        processinfo->lathist_tend.tv_nsec = 0;
+        clock_gettime(CLOCK_REALTIME, &processinfo->lathist_resettime);
+        processinfo->lathist_resetreq = 0;
+    }
+
+    if(processinfo_lathist_tset(processinfo->lathist_tstart))
+    {
+        processinfo_lathist_add(&processinfo->lathist_iter,
+                                processinfo->lathist_tstart, tnow);
+
+        // only if previous iteration reached exec_end
+        if((processinfo->lathist_tend.tv_sec > processinfo->lathist_tstart.tv_sec)
+                || ((processinfo->lathist_tend.tv_sec == processinfo->lathist_tstart.tv_sec)
+                    && (processinfo->lathist_tend.tv_nsec >= processinfo->lathist_tstart.tv_nsec)))
+        {
+            processinfo_lathist_add(&processinfo->lathist_wait,
+                                    processinfo->lathist_tend, tnow);
+        }
+    }
+
+    processinfo->lathist_tstart = tnow;
+}
+
+
+
+/** @brief Update histograms at execution end
+ *
+ * Called by processinfo_exec_end()
+ */
+void processinfo_lathist_execend(
+    PROCESSINFO *processinfo
+)
+{
+    struct timespec tnow;
+
+    clock_gettime(CLOCK_MONOTONIC, &tnow);
+
+    if(processinfo_lathist_tset(processinfo->lathist_tstart))
+    {
+        processinfo_lathist_add(&processinfo->lathist_exec,
+                                processinfo->lathist_tstart, tnow);
+    }
+
+    processinfo->lathist_tend = tnow;
+}
+
+
+
+
+static void processinfo_lathist_dump1(
+    FILE                      *fp,
+    const char                *label,
+    const PROCESSINFO_LATHIST *lathist
+)
+{
+    uint64_t cnt = 0;
+
+    for(int bin = 0; bin < PROCESSINFO_LATHIST_NBBIN; bin++)
+    {
+        cnt += lathist->bin[bin];
+    }
+
+    fprintf(fp, "# %s  cnt %lu  p50 %lu  p90 %lu  p99 %lu  p99.9 %lu  p99.99 %lu  max %lu [ns]\n",
+            label,
+            cnt,
+            processinfo_lathist_percentile(lathist, 0.5),
+            processinfo_lathist_percentile(lathist, 0.9),
+            processinfo_lathist_percentile(lathist, 0.99),
+            processinfo_lathist_percentile(lathist, 0.999),
+            processinfo_lathist_percentile(lathist, 0.9999),
+            lathist->max_ns);
+
+    uint64_t cntcumul = 0;
+    for(int bin = 0; bin < PROCESSINFO_LATHIST_NBBIN; bin++)
+    {
+        if(lathist->bin[bin] > 0)
+        {
+            cntcumul += lathist->bin[bin];
+            fprintf(fp, "%-4s %12lu %12lu %12lu  %.6f\n",
+                    label,
+                    processinfo_lathist_binmin(bin),
+                    processinfo_lathist_binmax(bin),
+                    lathist->bin[bin],
+                    1.0 * cntcumul / cnt);
+        }
+    }
+}
+
+
+
+/** @brief Write latency histograms to file stream
+ *
+ * One line per non-empty bin :
+ * label  binmin[ns]  binmax[ns]  count  cumulative fraction
+ */
+errno_t processinfo_lathist_dump(
+    PROCESSINFO *processinfo,
+    FILE        *fp
+)
+{
+    fprintf(fp, "# process %s  PID %d\n", processinfo->name, (int) processinfo->PID);
+    fprintf(fp, "# reset time %ld.%09ld\n",
+            (long) processinfo->lathist_resettime.tv_sec,
+            processinfo->lathist_resettime.tv_nsec);
+    fprintf(fp, "# ITER: iteration period, EXEC: execution time, WAIT: end to next start\n");
+
+    processinfo_lathist_dump1(fp, "ITER", &processinfo->lathist_iter);
+    processinfo_lathist_dump1(fp, "EXEC", &processinfo->lathist_exec);
+    processinfo_lathist_dump1(fp, "WAIT", &processinfo->lathist_wait);
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+/** @brief Print latency histograms of a running process
+ *
+ * Connects to processinfo shared memory of process pname/PID
+ */
+errno_t processinfo_lathist_dump_PID(
+    const char *pname,
+    long        PID
+)
+{
+    char procdname[STRINGMAXLEN_FULLFILENAME];
+    char SM_fname[STRINGMAXLEN_FULLFILENAME];
+    int  SM_fd;
+
+    processinfo_procdirname(procdname);
+    WRITE_FULLFILENAME(SM_fname, "%s/proc.%s.%06d.shm", procdname, pname,
+                       (int) PID);
+
+    if(access(SM_fname, R_OK | W_OK) != 0)
+    {
+        PRINT_ERROR("cannot access %s", SM_fname);
+        return RETURN_FAILURE;
+    }
+
+    // stale entry may be truncated
+    struct stat file_stat;
+    if((stat(SM_fname, &file_stat) != 0)
+            || (file_stat.st_size < (off_t) sizeof(PROCESSINFO)))
+    {
+        PRINT_ERROR("%s is not a processinfo file", SM_fname);
+        return RETURN_FAILURE;
+    }
+
+    PROCESSINFO *pinfo = processinfo_shm_link(SM_fname, &SM_fd);
+    if((pinfo == NULL) || (pinfo == MAP_FAILED))
+    {
+        PRINT_ERROR("cannot map %s", SM_fname);
+        return RETURN_FAILURE;
+    }
+    processinfo_lathist_dump(pinfo, stdout);
+    processinfo_shm_close(pinfo, SM_fd);
+
+    return RETURN_SUCCESS;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file    processtools_latency.h
+ *
+ * @brief   Loop latency histograms
+ *
+ *
+ */
+
+
+#ifndef _PROCESSTOOLS_LATENCY_H
+#define _PROCESSTOOLS_LATENCY_H
+
+
+#include "CLIcore.h"
+
+#include "processinfo.h"
+
+
+
+int processinfo_lathist_binindex(
+    uint64_t val_ns
+);
+
+uint64_t processinfo_lathist_binmax(
+    int bin
+);
+
+uint64_t processinfo_lathist_percentile(
+    const PROCESSINFO_LATHIST *lathist,
+    double                     fraction
+);
+
+void processinfo_lathist_execstart(
+    PROCESSINFO *processinfo
+);
+
+void processinfo_lathist_execend(
+    PROCESSINFO *processinfo
+);
+
+errno_t processinfo_lathist_dump(
+    PROCESSINFO *processinfo,
+    FILE        *fp
+);
+
+errno_t processinfo_lathist_dump_PID(
+    const char *pname,
+    long        PID
+);
+
+#endif
@@ -0,0 +1,280 @@
+/**
+ * @file processtools_placement.c
+ *
+ * CPU affinity, memory locking and NUMA placement, applied by
+ * processinfo_loopstart() before entering the loop.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+
+#ifdef USE_HWLOC
+#include <hwloc.h>
+#endif
+
+
+#include "CLIcore.h"
+
+#include "processinfo.h"
+#include "processtools_placement.h"
+
+
+
+
+/** @brief Parse CPU list string into CPU mask
+ *
+ * Format is the same as taskset -c, for example "0-3,8,10-11"
+ *
+ * @return number of CPUs in mask, -1 if string cannot be parsed
+ */
+int processinfo_parse_cpulist(
+    const char *cpulist,
+    cpu_set_t  *mask
+)
+{
+    const char *ptr = cpulist;
+    int NBcpu = 0;
+
+    CPU_ZERO(mask);
+
+    while(*ptr != '\0')
+    {
+        char *endptr;
+        long cpu0 = strtol(ptr, &endptr, 10);
+        long cpu1;
+
+        if(endptr == ptr)
+        {
+            return -1;
+        }
+        ptr = endptr;
+        cpu1 = cpu0;
+
+        if(*ptr == '-')
+        {
+            ptr++;
+            cpu1 = strtol(ptr, &endptr, 10);
+            if(endptr == ptr)
+            {
+                return -1;
+            }
+            ptr = endptr;
+        }
+
+        if((cpu0 < 0) || (cpu1 < cpu0) || (cpu1 >= CPU_SETSIZE))
+        {
+            return -1;
+        }
+        for(long cpu = cpu0; cpu <= cpu1; cpu++)
+        {
+            if(!CPU_ISSET(cpu, mask))
+            {
+                CPU_SET(cpu, mask);
+                NBcpu++;
+            }
+        }
+
+        if(*ptr == ',')
+        {
+            ptr++;
+        }
+        else if(*ptr != '\0')
+        {
+            return -1;
+        }
+    }
+
+    return NBcpu;
+}
+
+
+
+
+// touch stack pages so that the loop does not page-fault on stack growth
+static void __attribute__((noinline)) processinfo_prefault_stack()
+{
+    volatile char stack[PROCESSINFO_PREFAULT_STACKSIZE];
+    long pagesize = sysconf(_SC_PAGESIZE);
+
+    for(long i = 0; i < PROCESSINFO_PREFAULT_STACKSIZE; i += pagesize)
+    {
+        stack[i] = 0;
+    }
+    (void) stack;
+}
+
+
+
+// touch every page of mapped shared memory streams
+static uint64_t processinfo_prefault_streams()
+{
+    long     pagesize = sysconf(_SC_PAGESIZE);
+    uint64_t NBpage = 0;
+
+    for(imageID ID = 0; ID < data.NB_MAX_IMAGE; ID++)
+    {
+        if((data.image[ID].used == 1) && (data.image[ID].md != NULL)
+                && (data.image[ID].md[0].shared == 1))
+        {
+            volatile char *ptr = (volatile char *) data.image[ID].md;
+            char sum = 0;
+
+            for(uint64_t offset = 0; offset < data.image[ID].memsize; offset += pagesize)
+            {
+                sum += ptr[offset];
+                NBpage++;
+            }
+            (void) sum;
+        }
+    }
+
+    return NBpage;
+}
+
+
+
+
+/** @brief Record current CPU, NUMA node and locked memory in processinfo
+ */
+errno_t processinfo_placement_update(
+    PROCESSINFO *processinfo
+)
+{
+    unsigned int cpu;
+    unsigned int node;
+
+    if(syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+    {
+        processinfo->placement_cpu = (int) cpu;
+        processinfo->placement_node = (int) node;
+    }
+    else
+    {
+        processinfo->placement_cpu = -1;
+        processinfo->placement_node = -1;
+    }
+
+    processinfo->placement_lockedbytes = 0;
+    FILE *fp = fopen("/proc/self/status", "r");
+    if(fp != NULL)
+    {
+        char line[200];
+        while(fgets(line, sizeof(line), fp) != NULL)
+        {
+            long kB;
+            if(sscanf(line, "VmLck: %ld kB", &kB) == 1)
+            {
+                processinfo->placement_lockedbytes = (uint64_t) kB * 1024;
+                break;
+            }
+        }
+        fclose(fp);
+    }
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+/** @brief Apply CPU affinity, NUMA binding and memory locking
+ *
+ * Settings are read from processinfo :
+ * - CPUmask  : applied to calling thread if not empty
+ * - NUMAbind : if 1, bind memory allocations to NUMA node(s) of CPUs
+ *              the thread runs on (requires hwloc)
+ * - memlock  : if 1, lock process memory (mlockall), pre-fault stack and
+ *              mapped streams
+ *
+ * Outcome is written to processinfo placement_ fields.
+ */
+errno_t processinfo_placement_apply(
+    PROCESSINFO *processinfo
+)
+{
+    processinfo->placement_flags = 0;
+
+    // CPU affinity
+    if(CPU_COUNT(&processinfo->CPUmask) > 0)
+    {
+        if(sched_setaffinity(0, sizeof(cpu_set_t), &processinfo->CPUmask) == 0)
+        {
+            processinfo->placement_flags |= PROCESSINFO_PLACEMENT_AFFINITY;
+        }
+        else
+        {
+            PRINT_WARNING("sched_setaffinity error: %s", strerror(errno));
+        }
+    }
+
+
+    // NUMA binding
+    if(processinfo->NUMAbind == 1)
+    {
+#ifdef USE_HWLOC
+        hwloc_topology_t topology;
+        hwloc_bitmap_t   cpuset = hwloc_bitmap_alloc();
+
+        hwloc_topology_init(&topology);
+        hwloc_topology_load(topology);
+
+        if((hwloc_get_cpubind(topology, cpuset, HWLOC_CPUBIND_THREAD) == 0)
+                && (hwloc_set_membind(topology, cpuset, HWLOC_MEMBIND_BIND,
+                                      HWLOC_MEMBIND_THREAD) == 0))
+        {
+            processinfo->placement_flags |= PROCESSINFO_PLACEMENT_NUMABIND;
+        }
+        else
+        {
+            PRINT_WARNING("NUMA memory binding failed");
+        }
+
+        hwloc_bitmap_free(cpuset);
+        hwloc_topology_destroy(topology);
+#else
+        PRINT_WARNING("NUMA memory binding requires hwloc, ignored");
+#endif
+    }
+
+
+    // memory locking
+    if(processinfo->memlock == 1)
+    {
+#ifndef __MACH__
+        if(seteuid(data.euid) != 0)     //This goes up to maximum privileges
+        {
+            PRINT_ERROR("seteuid error");
+        }
+        if(mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+        {
+            processinfo->placement_flags |= PROCESSINFO_PLACEMENT_MEMLOCK;
+        }
+        else
+        {
+            PRINT_WARNING("mlockall error: %s", strerror(errno));
+        }
+        if(seteuid(data.ruid) != 0)     //Go back to normal privileges
+        {
+            PRINT_ERROR("seteuid error");
+        }
+#endif
+        processinfo_prefault_stack();
+        processinfo_prefault_streams();
+    }
+
+    processinfo_placement_update(processinfo);
+
+    return RETURN_SUCCESS;
+}
@@ -0,0 +1,37 @@
+/**
+ * @file    processtools_placement.h
+ *
+ * @brief   CPU affinity, memory locking and NUMA placement of loop processes
+ *
+ *
+ */
+
+
+#ifndef _PROCESSTOOLS_PLACEMENT_H
+#define _PROCESSTOOLS_PLACEMENT_H
+
+
+// processinfo->placement_flags bits, set if applied successfully
+#define PROCESSINFO_PLACEMENT_AFFINITY  0x0001  // CPUmask applied
+#define PROCESSINFO_PLACEMENT_MEMLOCK   0x0002  // mlockall succeeded
+#define PROCESSINFO_PLACEMENT_NUMABIND  0x0004  // memory bound to local NUMA node(s)
+
+// stack pre-fault size [byte]
+#define PROCESSINFO_PREFAULT_STACKSIZE  (256 * 1024)
+
+
+
+int processinfo_parse_cpulist(
+    const char *cpulist,
+    cpu_set_t  *mask
+);
+
+errno_t processinfo_placement_apply(
+    PROCESSINFO *processinfo
+);
+
+errno_t processinfo_placement_update(
+    PROCESSINFO *processinfo
+);
+
+#endif
@@ -9,7 +9,17 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // _mm_pause()
+#endif
 
 
 #include "CLIcore.h"
@@ -21,6 +31,523 @@
 
 
 
+// spin-wait hint to the CPU
+static inline void processinfo_cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+
+// nanosec elapsed since t0 (CLOCK_MONOTONIC)
+static inline long processinfo_elapsed_ns(
+    struct timespec *t0
+)
+{
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) * 1000000000L + (t1.tv_nsec - t0->tv_nsec);
+}
+
+
+/** @brief Add wake-up latency sample to histogram
+ *
+ * Latency is measured from the input stream writetime to now.
+ * Only called when the process was actually waiting (no missed frame).
+ */
+static void processinfo_trigger_wakelat_update(
+    PROCESSINFO *processinfo
+)
+{
+    struct timespec twrite =
+        data.image[processinfo->triggerstreamID].md[0].writetime;
+
+    if(twrite.tv_sec == 0)
+    {
+        // writer does not set writetime
+        return;
+    }
+
+    struct timespec tnow;
+    clock_gettime(CLOCK_REALTIME, &tnow);
+
+    long dt_ns = (tnow.tv_sec - twrite.tv_sec) * 1000000000L
+                 + (tnow.tv_nsec - twrite.tv_nsec);
+    if(dt_ns < 0)
+    {
+        return;
+    }
+
+    int bin = 0;
+    if(dt_ns > 0)
+    {
+        bin = 63 - __builtin_clzl((unsigned long) dt_ns);
+    }
+    if(bin > PROCESSINFO_WAKELAT_NBBIN - 1)
+    {
+        bin = PROCESSINFO_WAKELAT_NBBIN - 1;
+    }
+
+    processinfo->triggerwakelat_hist[bin] ++;
+    processinfo->triggerwakelat_cnt ++;
+    if(dt_ns > processinfo->triggerwakelat_max_ns)
+    {
+        processinfo->triggerwakelat_max_ns = dt_ns;
+    }
+}
+
+
+
+
+/** @brief Wait on trigger semaphore, with timeout
+ *
+ * Flushes semaphore first. If semaphore was already posted, returns
+ * immediately and updates triggermissedframe.
+ * Returns trigger status (RECEIVED or TIMEDOUT)
+ */
+static int processinfo_trigger_semtimedwait(
+    PROCESSINFO *processinfo,
+    sem_t       *semptr
+)
+{
+    int semr;
+    int tmpstatus = PROCESSINFO_TRIGGERSTATUS_RECEIVED;
+
+    // get current time
+    struct timespec ts;
+    if(clock_gettime(CLOCK_REALTIME, &ts) == -1)
+    {
+        perror("clock_gettime");
+        exit(EXIT_FAILURE);
+    }
+
+    // is semaphore at zero ?
+    DEBUG_TRACEPOINT("test sem status");
+    semr = 0;
+    while(semr == 0)
+    {
+        // this should only run once, returning semr = -1 with errno = EAGAIN
+        // otherwise, we're potentially missing frames
+        DEBUG_TRACEPOINT("sem_trywait %ld", processinfo->triggerstreamID);
+        semr = sem_trywait(semptr);
+        if(semr == 0)
+        {
+            processinfo->triggermissedframe ++;
+        }
+    }
+
+    // expected state: NBmissedframe = 0, semr = -1, errno = EAGAIN
+    // missed frame state: NBmissedframe>0, semr = -1, errno = EAGAIN
+    DEBUG_TRACEPOINT("triggermissedframe = %d", processinfo->triggermissedframe);
+    if(processinfo->triggermissedframe == 0)
+    {
+        DEBUG_TRACEPOINT("timedwait");
+        // add timeout
+        ts.tv_sec += processinfo->triggertimeout.tv_sec;
+        ts.tv_nsec += processinfo->triggertimeout.tv_nsec;
+        while(ts.tv_nsec >= 1000000000)
+        {
+            ts.tv_nsec -= 1000000000;
+            ts.tv_sec ++;
+        }
+
+        semr = sem_timedwait(semptr, &ts);
+        if(semr == -1)
+        {
+            if(errno == ETIMEDOUT)
+            {
+                // timeout condition
+                processinfo->trigggertimeoutcnt ++;
+                tmpstatus = PROCESSINFO_TRIGGERSTATUS_TIMEDOUT;
+            }
+        }
+        else
+        {
+            processinfo_trigger_wakelat_update(processinfo);
+        }
+    }
+
+    return tmpstatus;
+}
+
+
+
+
+/**
+ * Trigger set context, local to the process
+ *
+ * One waiter thread per input blocks on the input semaphore, counts the
+ * received frame and posts semready, on which the loop thread waits.
+ * This lets the loop thread block on several semaphores at once.
+ * Inputs without semaphores are polled on cnt0 by their waiter thread.
+ *
+ * Waiter threads are created by the loop thread on its first wait, after
+ * processinfo_loopstart(), so that they inherit its RT scheduling policy,
+ * priority and CPU affinity.
+ */
+typedef struct
+{
+    void    *ctx;
+    int      index;
+    sem_t   *semptr;       // NULL if input has no semaphore: poll cnt0
+    IMAGE   *img;
+    uint64_t cnt0last;     // last cnt0 seen, for inputs polled on cnt0
+    uint64_t pending;      // frames received, not yet consumed (atomic)
+    int64_t  tarrival_ns;  // CLOCK_REALTIME arrival of last frame (atomic)
+    pthread_t thread;
+} PROCESSINFO_TRIGSET_INPUT;
+
+typedef struct
+{
+    int      NBin;
+    int      mode;
+    int      started;      // 1 once waiter threads are created
+    sem_t    semready;
+    uint32_t readymask;    // ALL mode: inputs received since last trigger
+    PROCESSINFO_TRIGSET_INPUT input[PROCESSINFO_TRIGGERSET_MAXNB];
+} PROCESSINFO_TRIGSET_CTX;
+
+
+
+static void *processinfo_triggerset_waiter(
+    void *ptr
+)
+{
+    PROCESSINFO_TRIGSET_INPUT *in = (PROCESSINFO_TRIGSET_INPUT *) ptr;
+    PROCESSINFO_TRIGSET_CTX *ctx = (PROCESSINFO_TRIGSET_CTX *) in->ctx;
+
+    while(1)
+    {
+        uint64_t NBframe = 0;
+
+        if(in->semptr == NULL)
+        {
+            // usleep is a cancellation point
+            uint64_t cnt0 = __atomic_load_n(&in->img->md[0].cnt0, __ATOMIC_ACQUIRE);
+            if(cnt0 == in->cnt0last)
+            {
+                usleep(5);
+            }
+            else
+            {
+                NBframe = cnt0 - in->cnt0last;
+                in->cnt0last = cnt0;
+            }
+        }
+        else
+        {
+            // sem_wait is a cancellation point
+            if(sem_wait(in->semptr) == 0)
+            {
+                NBframe = 1;
+            }
+        }
+
+        if(NBframe > 0)
+        {
+            struct timespec t;
+            clock_gettime(CLOCK_REALTIME, &t);
+            __atomic_store_n(&in->tarrival_ns,
+                             (int64_t) t.tv_sec * 1000000000L + t.tv_nsec, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&in->pending, NBframe, __ATOMIC_RELEASE);
+            sem_post(&ctx->semready);
+        }
+    }
+
+    return NULL;
+}
+
+
+
+
+/** @brief Set up multi-input trigger set
+ *
+ * triggermode PROCESSINFO_TRIGGERMODE_ANY : trigger when any input is updated
+ * triggermode PROCESSINFO_TRIGGERMODE_ALL : trigger when all inputs have been
+ * updated. If tolerance_ns > 0, inputs must also have arrived within
+ * tolerance_ns of the most recent one, otherwise their frame is dropped and
+ * the next one awaited.
+ *
+ * semindexrequested may be NULL for automatic semaphore selection.
+ * Inputs without semaphores (md[0].sem = 0) are polled on cnt0.
+ * After processinfo_waitoninputstream(), processinfo->trigsetreadymask
+ * holds the inputs updated (bit k for input k).
+ */
+errno_t processinfo_triggerset_init(
+    PROCESSINFO   *processinfo,
+    int            NBin,
+    const imageID *trigID,
+    const int     *semindexrequested,
+    int            triggermode,
+    long           tolerance_ns
+)
+{
+    if((NBin < 1) || (NBin > PROCESSINFO_TRIGGERSET_MAXNB))
+    {
+        PRINT_ERROR("number of inputs %d, must be 1 to %d", NBin,
+                    PROCESSINFO_TRIGGERSET_MAXNB);
+        return RETURN_FAILURE;
+    }
+    if((triggermode != PROCESSINFO_TRIGGERMODE_ANY)
+            && (triggermode != PROCESSINFO_TRIGGERMODE_ALL))
+    {
+        PRINT_ERROR("invalid trigger set mode %d", triggermode);
+        return RETURN_FAILURE;
+    }
+    for(int k = 0; k < NBin; k++)
+    {
+        if(trigID[k] < 0)
+        {
+            PRINT_ERROR("trigger set input %d does not exist", k);
+            return RETURN_FAILURE;
+        }
+    }
+
+    processinfo_triggerset_free(processinfo);
+
+    PROCESSINFO_TRIGSET_CTX *ctx = (PROCESSINFO_TRIGSET_CTX *) calloc(1,
+                                   sizeof(PROCESSINFO_TRIGSET_CTX));
+    if(ctx == NULL)
+    {
+        PRINT_ERROR("malloc error");
+        abort();
+    }
+    ctx->NBin = NBin;
+    ctx->mode = triggermode;
+    sem_init(&ctx->semready, 0, 0);
+
+    // input 0 is reported as trigger stream
+    processinfo->triggerstreamID    = trigID[0];
+    processinfo->triggerstreaminode = data.image[trigID[0]].md[0].inode;
+    strncpy(processinfo->triggerstreamname, data.image[trigID[0]].md[0].name,
+            STRINGMAXLEN_IMAGE_NAME - 1);
+
+    processinfo->triggermode              = triggermode;
+    processinfo->triggermissedframe_cumul = 0;
+    processinfo->trigggertimeoutcnt       = 0;
+    processinfo->triggerstatus            = 0;
+    processinfo->triggersem               = -1;
+
+    processinfo->trigsetNB           = NBin;
+    processinfo->trigsettolerance_ns = tolerance_ns;
+    processinfo->trigsetreadymask    = 0;
+    processinfo->trigsetmisaligncnt  = 0;
+
+    for(int k = 0; k < NBin; k++)
+    {
+        ctx->input[k].ctx    = ctx;
+        ctx->input[k].index  = k;
+        ctx->input[k].img    = &data.image[trigID[k]];
+        ctx->input[k].semptr = NULL;
+        ctx->input[k].cnt0last = data.image[trigID[k]].md[0].cnt0;
+
+        processinfo->trigsetstreamID[k]          = trigID[k];
+        processinfo->trigsetinode[k]             = data.image[trigID[k]].md[0].inode;
+        processinfo->trigsetsem[k]               = -1;
+        processinfo->trigsetrecvcnt[k]           = 0;
+        processinfo->trigsetmissedframe_cumul[k] = 0;
+
+        if(data.image[trigID[k]].md[0].sem == 0)
+        {
+            PRINT_WARNING("input %d (%s) has no semaphore, polling cnt0", k,
+                          data.image[trigID[k]].md[0].name);
+            continue;
+        }
+
+        int semreq = (semindexrequested == NULL) ? -1 : semindexrequested[k];
+        int sem = ImageStreamIO_getsemwaitindex(&data.image[trigID[k]], semreq);
+        if(sem == -1)
+        {
+            PRINT_ERROR("no semaphore available for input %d (%s)", k,
+                        data.image[trigID[k]].md[0].name);
+            processinfo->trigsetctx = ctx;
+            processinfo_triggerset_free(processinfo);
+            return RETURN_FAILURE;
+        }
+        data.image[trigID[k]].semReadPID[sem] = getpid();
+
+        processinfo->trigsetsem[k] = sem;
+        ctx->input[k].semptr = data.image[trigID[k]].semptr[sem];
+
+        // flush semaphore
+        while(sem_trywait(ctx->input[k].semptr) == 0) {}
+    }
+
+    // waiter threads are started by processinfo_triggerset_wait()
+    processinfo->trigsetctx = ctx;
+
+    // set default timeout to 2 sec
+    processinfo->triggertimeout.tv_sec = 2;
+    processinfo->triggertimeout.tv_nsec = 0;
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+/** @brief Stop trigger set waiter threads
+ */
+errno_t processinfo_triggerset_free(
+    PROCESSINFO *processinfo
+)
+{
+    PROCESSINFO_TRIGSET_CTX *ctx = (PROCESSINFO_TRIGSET_CTX *) processinfo->trigsetctx;
+
+    if(ctx == NULL)
+    {
+        return RETURN_SUCCESS;
+    }
+
+    for(int k = 0; k < ctx->NBin; k++)
+    {
+        if(ctx->input[k].thread != 0)
+        {
+            pthread_cancel(ctx->input[k].thread);
+            pthread_join(ctx->input[k].thread, NULL);
+        }
+    }
+    sem_destroy(&ctx->semready);
+    free(ctx);
+
+    processinfo->trigsetctx = NULL;
+    processinfo->trigsetNB = 0;
+
+    return RETURN_SUCCESS;
+}
+
+
+
+
+/** @brief Wait on trigger set
+ */
+static errno_t processinfo_triggerset_wait(
+    PROCESSINFO *processinfo
+)
+{
+    PROCESSINFO_TRIGSET_CTX *ctx = (PROCESSINFO_TRIGSET_CTX *) processinfo->trigsetctx;
+    uint32_t allmask = (1U << ctx->NBin) - 1;
+    int      tmpstatus = PROCESSINFO_TRIGGERSTATUS_RECEIVED;
+
+    if(ctx->started == 0)
+    {
+        // created from loop thread: inherit scheduling policy, priority and
+        // CPU affinity set by processinfo_loopstart()
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+        for(int k = 0; k < ctx->NBin; k++)
+        {
+            if(pthread_create(&ctx->input[k].thread, &attr,
+                              processinfo_triggerset_waiter, &ctx->input[k]) != 0)
+            {
+                PRINT_ERROR("cannot create trigger set waiter thread %d", k);
+                ctx->input[k].thread = 0;
+            }
+        }
+        pthread_attr_destroy(&attr);
+        ctx->started = 1;
+    }
+
+    processinfo->triggerstatus = PROCESSINFO_TRIGGERSTATUS_WAITING;
+
+    if(ctx->mode == PROCESSINFO_TRIGGERMODE_ANY)
+    {
+        ctx->readymask = 0;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += processinfo->triggertimeout.tv_sec;
+    ts.tv_nsec += processinfo->triggertimeout.tv_nsec;
+    while(ts.tv_nsec >= 1000000000)
+    {
+        ts.tv_nsec -= 1000000000;
+        ts.tv_sec ++;
+    }
+
+    while(1)
+    {
+        // collect frames received by waiter threads
+        // more than one frame per input : missed frames
+        for(int k = 0; k < ctx->NBin; k++)
+        {
+            uint64_t cnt = __atomic_exchange_n(&ctx->input[k].pending, 0, __ATOMIC_ACQ_REL);
+            if(cnt > 0)
+            {
+                ctx->readymask |= (1U << k);
+                processinfo->trigsetrecvcnt[k] += cnt;
+                processinfo->trigsetmissedframe_cumul[k] += cnt - 1;
+                processinfo->triggermissedframe += (int)(cnt - 1);
+            }
+        }
+
+        if((ctx->mode == PROCESSINFO_TRIGGERMODE_ANY) && (ctx->readymask != 0))
+        {
+            break;
+        }
+
+        if((ctx->mode == PROCESSINFO_TRIGGERMODE_ALL) && (ctx->readymask == allmask))
+        {
+            if(processinfo->trigsettolerance_ns <= 0)
+            {
+                break;
+            }
+
+            // drop inputs that arrived too early relative to most recent
+            int64_t tmax = 0;
+            for(int k = 0; k < ctx->NBin; k++)
+            {
+                int64_t t = __atomic_load_n(&ctx->input[k].tarrival_ns, __ATOMIC_RELAXED);
+                tmax = (t > tmax) ? t : tmax;
+            }
+            for(int k = 0; k < ctx->NBin; k++)
+            {
+                int64_t t = __atomic_load_n(&ctx->input[k].tarrival_ns, __ATOMIC_RELAXED);
+                if(tmax - t > processinfo->trigsettolerance_ns)
+                {
+                    ctx->readymask &= ~(1U << k);
+                    processinfo->trigsetmisaligncnt ++;
+                }
+            }
+            if(ctx->readymask == allmask)
+            {
+                break;
+            }
+        }
+
+        // semready may hold extra posts from frames already collected :
+        // spurious wake-ups are handled by re-checking
+        if(sem_timedwait(&ctx->semready, &ts) == -1)
+        {
+            if(errno == ETIMEDOUT)
+            {
+                processinfo->trigggertimeoutcnt ++;
+                tmpstatus = PROCESSINFO_TRIGGERSTATUS_TIMEDOUT;
+                break;
+            }
+        }
+    }
+
+    processinfo->trigsetreadymask = ctx->readymask;
+    if(tmpstatus == PROCESSINFO_TRIGGERSTATUS_RECEIVED)
+    {
+        ctx->readymask = 0;
+    }
+
+    processinfo->triggerstreamcnt = data.image[processinfo->triggerstreamID].md[0].cnt0;
+    processinfo->triggermissedframe_cumul += processinfo->triggermissedframe;
+    processinfo->triggerstatus = tmpstatus;
+
+    return RETURN_SUCCESS;
+}
+
+
 
 
 /** @brief Set up input wait stream
@@ -43,6 +570,47 @@ errno_t processinfo_waitoninputstream_init(
 {
 
     printf("======================= processinfo_waitoninputstream_init ====================\n");//test
+
+    if((triggermode == PROCESSINFO_TRIGGERMODE_ANY)
+            || (triggermode == PROCESSINFO_TRIGGERMODE_ALL))
+    {
+        // trigger stream name is comma-separated list of inputs
+        imageID IDarray[PROCESSINFO_TRIGGERSET_MAXNB];
+        int     NBin = 0;
+        char    namelist[STRINGMAXLEN_IMAGE_NAME];
+        char   *saveptr;
+
+        strncpy(namelist, processinfo->triggerstreamname, STRINGMAXLEN_IMAGE_NAME - 1);
+        namelist[STRINGMAXLEN_IMAGE_NAME - 1] = '\0';
+        for(char *tok = strtok_r(namelist, ",", &saveptr);
+                (tok != NULL) && (NBin < PROCESSINFO_TRIGGERSET_MAXNB);
+                tok = strtok_r(NULL, ",", &saveptr))
+        {
+            IDarray[NBin] = image_ID(tok);
+            NBin++;
+        }
+
+        if(processinfo_triggerset_init(processinfo, NBin, IDarray, NULL, triggermode,
+                                       processinfo->trigsettolerance_ns) == RETURN_SUCCESS)
+        {
+            return RETURN_SUCCESS;
+        }
+        // fall back to first input that exists
+        trigID = -1;
+        for(int k = 0; (k < NBin) && (trigID == -1); k++)
+        {
+            trigID = IDarray[k];
+        }
+        if(trigID < 0)
+        {
+            PRINT_ERROR("trigger set init failed, no input stream found");
+            return RETURN_FAILURE;
+        }
+        PRINT_WARNING("trigger set init failed, using single input %s",
+                      data.image[trigID].md[0].name);
+        triggermode = PROCESSINFO_TRIGGERMODE_SEMAPHORE;
+    }
+
     processinfo->triggerstreamID    = trigID;
 
 
@@ -62,6 +630,9 @@ errno_t processinfo_waitoninputstream_init(
     processinfo->triggermissedframe_cumul = 0;
     processinfo->trigggertimeoutcnt       = 0;
     processinfo->triggerstatus            = 0;
+    processinfo->triggerspinhitcnt        = 0;
+    processinfo->triggerspinblockcnt      = 0;
+    processinfo_trigger_wakelat_reset(processinfo);
 
     // default
     processinfo->triggermode = PROCESSINFO_TRIGGERMODE_SEMAPHORE;
@@ -96,6 +667,24 @@ errno_t processinfo_waitoninputstream_init(
     }
 
 
+    if(triggermode == PROCESSINFO_TRIGGERMODE_SPINWAIT)
+    {
+        // busy-poll on cnt0
+        processinfo->triggermode = PROCESSINFO_TRIGGERMODE_SPINWAIT;
+        processinfo->triggerstreamcnt =
+            data.image[processinfo->triggerstreamID].md[0].cnt0;
+    }
+
+
+    if(triggermode == PROCESSINFO_TRIGGERMODE_SPINSEM)
+    {
+        // busy-poll on cnt0, then semaphore
+        processinfo->triggermode = PROCESSINFO_TRIGGERMODE_SPINSEM;
+        processinfo->triggerstreamcnt =
+            data.image[processinfo->triggerstreamID].md[0].cnt0;
+    }
+
+
     if(triggermode == PROCESSINFO_TRIGGERMODE_DELAY)
     {
         // time wait
@@ -108,15 +697,24 @@ errno_t processinfo_waitoninputstream_init(
 
 
     // checking if semaphore trigger mode OK
-    if(processinfo->triggermode == PROCESSINFO_TRIGGERMODE_SEMAPHORE)
+    if((processinfo->triggermode == PROCESSINFO_TRIGGERMODE_SEMAPHORE)
+            || (processinfo->triggermode == PROCESSINFO_TRIGGERMODE_SPINSEM))
     {
         processinfo->triggersem = ImageStreamIO_getsemwaitindex(&data.image[trigID],
                                   semindexrequested);
         if(processinfo->triggersem == -1)
         {
             // could not find available semaphore
-            // fall back to CNT0 trigger mode
-            processinfo->triggermode = PROCESSINFO_TRIGGERMODE_CNT0;
+            // fall back to CNT0 trigger mode, or pure spin if spinning requested
+            if(processinfo->triggermode == PROCESSINFO_TRIGGERMODE_SPINSEM)
+            {
+                processinfo->triggermode = PROCESSINFO_TRIGGERMODE_SPINWAIT;
+            }
+            else
+            {
+                processinfo->triggermode = PROCESSINFO_TRIGGERMODE_CNT0;
+            }
+            processinfo->triggerstreamcnt = data.image[trigID].md[0].cnt0;
         }
         else
         {
@@ -147,6 +745,12 @@ errno_t processinfo_waitoninputstream(
 {
     processinfo->triggermissedframe = 0;
 
+    if((processinfo->triggermode == PROCESSINFO_TRIGGERMODE_ANY)
+            || (processinfo->triggermode == PROCESSINFO_TRIGGERMODE_ALL))
+    {
+        return processinfo_triggerset_wait(processinfo);
+    }
+
     if(processinfo->triggermode == PROCESSINFO_TRIGGERMODE_IMMEDIATE)
     {
         processinfo->triggerstatus = PROCESSINFO_TRIGGERSTATUS_RECEIVED;
@@ -170,6 +774,10 @@ errno_t processinfo_waitoninputstream(
         processinfo->triggermissedframe =
             data.image[processinfo->triggerstreamID].md[0].cnt0 -
             processinfo->triggerstreamcnt - 1;
+        if(processinfo->triggermissedframe == 0)
+        {
+            processinfo_trigger_wakelat_update(processinfo);
+        }
         // update trigger counter
         processinfo->triggerstreamcnt =
             data.image[processinfo->triggerstreamID].md[0].cnt0;
@@ -197,6 +805,10 @@ errno_t processinfo_waitoninputstream(
         processinfo->triggermissedframe =
             data.image[processinfo->triggerstreamID].md[0].cnt1 -
             processinfo->triggerstreamcnt - 1;
+        if(processinfo->triggermissedframe == 0)
+        {
+            processinfo_trigger_wakelat_update(processinfo);
+        }
         // update trigger counter
         processinfo->triggerstreamcnt =
             data.image[processinfo->triggerstreamID].md[0].cnt1;
@@ -229,76 +841,175 @@ errno_t processinfo_waitoninputstream(
 
 
 
-    if(processinfo->triggermode == PROCESSINFO_TRIGGERMODE_SEMAPHORE)
+    if(processinfo->triggermode == PROCESSINFO_TRIGGERMODE_SPINWAIT)
     {
-        int semr;
+        // busy-poll cnt0, no sleep
+        // timeout is tested periodically so that the loop can respond to
+        // control and signals if the input stream stops
+        uint64_t *cntptr = &data.image[processinfo->triggerstreamID].md[0].cnt0;
         int tmpstatus = PROCESSINFO_TRIGGERSTATUS_RECEIVED;
-
-        DEBUG_TRACEPOINT("wait on semaphore");
+        long timeout_ns = processinfo->triggertimeout.tv_sec * 1000000000L
+                          + processinfo->triggertimeout.tv_nsec;
 
         processinfo->triggerstatus = PROCESSINFO_TRIGGERSTATUS_WAITING;
 
-        // get current time
-        struct timespec ts;
-        if(clock_gettime(CLOCK_REALTIME, &ts) == -1)
+        struct timespec tspin0;
+        clock_gettime(CLOCK_MONOTONIC, &tspin0);
+
+        uint64_t cnt = __atomic_load_n(cntptr, __ATOMIC_ACQUIRE);
+        long spincnt = 0;
+        while(cnt == processinfo->triggerstreamcnt)
         {
-            perror("clock_gettime");
-            exit(EXIT_FAILURE);
+            processinfo_cpu_relax();
+            spincnt ++;
+            if((spincnt & 0x3FF) == 0)
+            {
+                if(processinfo_elapsed_ns(&tspin0) > timeout_ns)
+                {
+                    processinfo->trigggertimeoutcnt ++;
+                    tmpstatus = PROCESSINFO_TRIGGERSTATUS_TIMEDOUT;
+                    break;
+                }
+            }
+            cnt = __atomic_load_n(cntptr, __ATOMIC_ACQUIRE);
         }
 
-        // is semaphore at zero ?
-        DEBUG_TRACEPOINT("test sem status");
-        semr = 0;
-        while(semr == 0)
+        if(tmpstatus == PROCESSINFO_TRIGGERSTATUS_RECEIVED)
         {
-            // this should only run once, returning semr = -1 with errno = EAGAIN
-            // otherwise, we're potentially missing frames
-            DEBUG_TRACEPOINT("sem_trywait %ld", processinfo->triggerstreamID);
-            semr = sem_trywait(
-                       data.image[processinfo->triggerstreamID].semptr[processinfo->triggersem]);
-            if(semr == 0)
+            processinfo->triggermissedframe =
+                cnt - processinfo->triggerstreamcnt - 1;
+            if(processinfo->triggermissedframe == 0)
             {
-                processinfo->triggermissedframe ++;
+                processinfo_trigger_wakelat_update(processinfo);
             }
+            processinfo->triggerstreamcnt = cnt;
+            processinfo->triggermissedframe_cumul += processinfo->triggermissedframe;
+        }
+
+        processinfo->triggerstatus = tmpstatus;
+
+        return RETURN_SUCCESS;
+    }
+
+
+
+
+    if(processinfo->triggermode == PROCESSINFO_TRIGGERMODE_SEMAPHORE)
+    {
+        DEBUG_TRACEPOINT("wait on semaphore");
+
+        processinfo->triggerstatus = PROCESSINFO_TRIGGERSTATUS_WAITING;
+
+        int tmpstatus = processinfo_trigger_semtimedwait(processinfo,
+                        data.image[processinfo->triggerstreamID].semptr[processinfo->triggersem]);
+
+        processinfo->triggermissedframe_cumul += processinfo->triggermissedframe;
+
+        processinfo->triggerstatus = tmpstatus;
+
+        return RETURN_SUCCESS;
+    }
+
+
+
+
+    if(processinfo->triggermode == PROCESSINFO_TRIGGERMODE_SPINSEM)
+    {
+        // busy-poll cnt0 for up to triggerspin_ns, then block on semaphore
+        //
+        // The semaphore is always consumed, so the semaphore count stays
+        // consistent with SEMAPHORE mode. On a spin hit, only the post for
+        // the detected frame is consumed; further posts are missed frames.
+        IMAGE *trigimg = &data.image[processinfo->triggerstreamID];
+        sem_t *semptr  = trigimg->semptr[processinfo->triggersem];
+        int tmpstatus  = PROCESSINFO_TRIGGERSTATUS_RECEIVED;
+
+        processinfo->triggerstatus = PROCESSINFO_TRIGGERSTATUS_WAITING;
+
+        // reference counter value must be read before flushing semaphore
+        uint64_t cntref = __atomic_load_n(&trigimg->md[0].cnt0, __ATOMIC_ACQUIRE);
+
+        while(sem_trywait(semptr) == 0)
+        {
+            processinfo->triggermissedframe ++;
         }
 
-        // expected state: NBmissedframe = 0, semr = -1, errno = EAGAIN
-        // missed frame state: NBmissedframe>0, semr = -1, errno = EAGAIN
-        DEBUG_TRACEPOINT("triggermissedframe = %d", processinfo->triggermissedframe);
         if(processinfo->triggermissedframe == 0)
         {
-            DEBUG_TRACEPOINT("timedwait");
-            // add timeout
-            ts.tv_sec += processinfo->triggertimeout.tv_sec;
-            ts.tv_nsec += processinfo->triggertimeout.tv_nsec;
-            while(ts.tv_nsec > 1000000000)
+            long spin_ns = processinfo->triggerspin_ns;
+            int  spinOK  = (spin_ns > 0);
+            long spincnt = 0;
+
+            struct timespec tspin0;
+            clock_gettime(CLOCK_MONOTONIC, &tspin0);
+
+            while(spinOK == 1)
             {
-                ts.tv_nsec -= 1000000000;
-                ts.tv_sec ++;
+                processinfo_cpu_relax();
+                if(__atomic_load_n(&trigimg->md[0].cnt0, __ATOMIC_ACQUIRE) != cntref)
+                {
+                    break;
+                }
+                spincnt ++;
+                if((spincnt & 0x3F) == 0)
+                {
+                    if(processinfo_elapsed_ns(&tspin0) > spin_ns)
+                    {
+                        spinOK = 0;
+                    }
+                }
             }
 
-            semr = sem_timedwait(
-                       data.image[processinfo->triggerstreamID].semptr[processinfo->triggersem], &ts);
-            if(semr == -1)
+            if(spinOK == 1)
             {
-                if(errno == ETIMEDOUT)
+                // frame detected while spinning
+                processinfo->triggerspinhitcnt ++;
+                processinfo_trigger_wakelat_update(processinfo);
+
+                // consume the post for the detected frame
+                // the writer may not have posted yet: wait for it
+                int semOK = 1;
+                if(sem_trywait(semptr) == -1)
                 {
-                    // timeout condition
-                    processinfo->trigggertimeoutcnt ++;
-                    tmpstatus = PROCESSINFO_TRIGGERSTATUS_TIMEDOUT;
+                    struct timespec ts;
+                    clock_gettime(CLOCK_REALTIME, &ts);
+                    ts.tv_sec += processinfo->triggertimeout.tv_sec;
+                    ts.tv_nsec += processinfo->triggertimeout.tv_nsec;
+                    while(ts.tv_nsec >= 1000000000)
+                    {
+                        ts.tv_nsec -= 1000000000;
+                        ts.tv_sec ++;
+                    }
+                    int semr;
+                    while(((semr = sem_timedwait(semptr, &ts)) == -1) && (errno == EINTR))
+                    {
+                    }
+                    if(semr == -1)
+                    {
+                        // post for the detected frame not consumed:
+                        // skip drain, any post left is not a missed frame
+                        semOK = 0;
+                        processinfo->trigggertimeoutcnt ++;
+                    }
                 }
-            }
 
-            // measure time spent waiting for input
-            // get current time
-            struct timespec ts1;
-            if(clock_gettime(CLOCK_REALTIME, &ts1) == -1)
+                // any remaining post is a frame that arrived since
+                if(semOK == 1)
+                {
+                    while(sem_trywait(semptr) == 0)
+                    {
+                        processinfo->triggermissedframe ++;
+                    }
+                }
+            }
+            else
             {
-                perror("clock_gettime");
-                exit(EXIT_FAILURE);
+                processinfo->triggerspinblockcnt ++;
+                tmpstatus = processinfo_trigger_semtimedwait(processinfo, semptr);
             }
         }
 
+        processinfo->triggerstreamcnt = trigimg->md[0].cnt0;
         processinfo->triggermissedframe_cumul += processinfo->triggermissedframe;
 
         processinfo->triggerstatus = tmpstatus;
@@ -311,3 +1022,56 @@ errno_t processinfo_waitoninputstream(
 }
 
 
+
+
+
+
+/** @brief Wake-up latency percentile from histogram
+ *
+ * Returns upper edge of histogram bin containing the requested fraction
+ * (0.5 for median) [ns], or -1 if no sample.
+ */
+long processinfo_trigger_wakelat_percentile(
+    PROCESSINFO *processinfo,
+    double       fraction
+)
+{
+    uint64_t cnt = 0;
+    for(int bin = 0; bin < PROCESSINFO_WAKELAT_NBBIN; bin++)
+    {
+        cnt += processinfo->triggerwakelat_hist[bin];
+    }
+    if(cnt == 0)
+    {
+        return -1;
+    }
+
+    uint64_t cntlim = (uint64_t)(fraction * cnt);
+    uint64_t cntcumul = 0;
+    for(int bin = 0; bin < PROCESSINFO_WAKELAT_NBBIN - 1; bin++)
+    {
+        cntcumul += processinfo->triggerwakelat_hist[bin];
+        if(cntcumul > cntlim)
+        {
+            return (1L << (bin + 1));
+        }
+    }
+
+    return processinfo->triggerwakelat_max_ns;
+}
+
+
+
+errno_t processinfo_trigger_wakelat_reset(
+    PROCESSINFO *processinfo
+)
+{
+    for(int bin = 0; bin < PROCESSINFO_WAKELAT_NBBIN; bin++)
+    {
+        processinfo->triggerwakelat_hist[bin] = 0;
+    }
+    processinfo->triggerwakelat_cnt    = 0;
+    processinfo->triggerwakelat_max_ns = 0;
+
+    return RETURN_SUCCESS;
+}
@@ -29,6 +29,22 @@
 // trigger after a time delay
 #define PROCESSINFO_TRIGGERMODE_DELAY          4
 
+// trigger when cnt0 increments, busy-polling (no sleep)
+#define PROCESSINFO_TRIGGERMODE_SPINWAIT       5
+
+// busy-poll cnt0 for triggerspin_ns, then block on semaphore
+#define PROCESSINFO_TRIGGERMODE_SPINSEM        6
+
+// trigger set: when any of the input streams is updated
+#define PROCESSINFO_TRIGGERMODE_ANY            7
+
+// trigger set: when all input streams have been updated
+#define PROCESSINFO_TRIGGERMODE_ALL            8
+
+
+// default busy-poll budget for SPINSEM mode [ns]
+#define PROCESSINFO_TRIGGERSPIN_NS_DEFAULT 20000
+
 
 // trigger is currently waiting for input
 #define PROCESSINFO_TRIGGERSTATUS_WAITING      1
@@ -55,6 +71,28 @@ errno_t processinfo_waitoninputstream(
     PROCESSINFO *processinfo
 );
 
+errno_t processinfo_triggerset_init(
+    PROCESSINFO   *processinfo,
+    int            NBin,
+    const imageID *trigID,
+    const int     *semindexrequested,
+    int            triggermode,
+    long           tolerance_ns
+);
+
+errno_t processinfo_triggerset_free(
+    PROCESSINFO *processinfo
+);
+
+long processinfo_trigger_wakelat_percentile(
+    PROCESSINFO *processinfo,
+    double       fraction
+);
+
+errno_t processinfo_trigger_wakelat_reset(
+    PROCESSINFO *processinfo
+);
+
 
 
 
@@ -73,6 +73,8 @@ void quick_sort_long(long *array, long count);
 #include "fps_load.h"
 #include "fps_loadstream.h"
 #include "fps_outlog.h"
+#include "fps_notify.h"
+#include "fps_paramhandle.h"
 #include "fps_paramvalue.h"
 #include "fps_PrintParameterInfo.h"
 #include "fps_printparameter_valuestring.h"
@@ -57,6 +57,7 @@ typedef int errno_t;
 #include <errno.h>
 
 #include <pthread.h>
+#include <sys/inotify.h>
 
 
 #include "CommandLineInterface/timeutils.h"
@@ -239,6 +240,102 @@ struct streamCTRLarg_struct {
 
 
 
+/** @brief Stream info from shared memory directory entry
+ *
+ * Resolves sym link name and stream inode.
+ * If filter is set to 1, require stream name to contain namefilter string.
+ *
+ * @return 1 if entry is a readable stream, 0 otherwise
+ */
+static int streaminfo_from_direntry(
+    const char *d_name,
+    int         filter,
+    const char *namefilter,
+    STREAMINFO *sinfo
+)
+{
+    char *pch = strstr(d_name, ".im.shm");
+    if(pch == NULL)
+    {
+        return 0;
+    }
+
+    // name filtering (first pass, not exclusive to stream name, includes path and extension
+    if((filter == 1) && (strstr(d_name, namefilter) == NULL))
+    {
+        return 0;
+    }
+
+    // is file sym link ?
+    struct stat buf;
+    char fullname[STRINGMAXLEN_FULLFILENAME];
+
+    WRITE_FULLFILENAME(fullname, "%s/%s", SHAREDSHMDIR, d_name);
+    if(lstat(fullname, &buf) == -1)
+    {
+        // file removed since directory listing
+        return 0;
+    }
+
+    if(S_ISLNK(buf.st_mode))  // resolve link name
+    {
+        char *linknamefull;
+        char linkname[STRINGMAXLEN_FULLFILENAME];
+
+        sinfo->SymLink = 1;
+        linknamefull = realpath(fullname, NULL);
+
+        if((linknamefull == NULL) || (access(linknamefull, R_OK)))
+        {
+            // file cannot be read
+            free(linknamefull);
+            return 0;
+        }
+
+        strncpy(linkname, basename(linknamefull), STRINGMAXLEN_FULLFILENAME - 1);
+        linkname[STRINGMAXLEN_FULLFILENAME - 1] = '\0';
+        char *pdot = strchr(linkname, '.');
+        if(pdot != NULL)
+        {
+            *pdot = '\0';
+        }
+        strncpy(sinfo->linkname, linkname, STRINGMAXLEN_STREAMINFO_NAME - 1);
+        sinfo->linkname[STRINGMAXLEN_STREAMINFO_NAME - 1] = '\0';
+
+        free(linknamefull);
+
+        if(stat(fullname, &buf) == -1)
+        {
+            return 0;
+        }
+    }
+    else
+    {
+        sinfo->SymLink = 0;
+    }
+    sinfo->inode = buf.st_ino;
+
+
+    // get stream name
+    int strlencp = (int)(pch - d_name);
+    if(strlencp > STRINGMAXLEN_STREAMINFO_NAME - 1)
+    {
+        strlencp = STRINGMAXLEN_STREAMINFO_NAME - 1;
+    }
+    strncpy(sinfo->sname, d_name, strlencp);
+    sinfo->sname[strlencp] = '\0';
+
+    if((filter == 1) && (strstr(sinfo->sname, namefilter) == NULL))
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+
+
+
 /** @brief find shared memory streams on system
  *
  * If filter is set to 1, require stream name to contain namefilter string
@@ -261,150 +358,680 @@ int find_streams(
     if(d)
     {
         int sindex = 0;
-        while(((dir = readdir(d)) != NULL))
+        while(((dir = readdir(d)) != NULL) && (sindex < streamNBID_MAX))
+        {
+            sindex += streaminfo_from_direntry(dir->d_name, filter, namefilter,
+                                               &streaminfo[sindex]);
+        }
+        NBstream = sindex;
+        closedir(d);
+    }
+
+
+    return NBstream;
+}
+
+
+
+
+// FNV-1a
+static uint64_t streamregistry_hash(
+    const char *sname
+)
+{
+    uint64_t hash = 14695981039346656037UL;
+
+    for(const char *ptr = sname; *ptr != '\0'; ptr++)
+    {
+        hash ^= (uint8_t) * ptr;
+        hash *= 1099511628211UL;
+    }
+    return hash;
+}
+
+
+
+/** @brief STREAMINFO index of stream name, -1 if not in registry
+ */
+static long streamregistry_find(
+    STREAMINFOPROC *streaminfoproc,
+    const char     *sname
+)
+{
+    long *hashtable = streaminfoproc->registry.hashtable;
+    uint64_t slot = streamregistry_hash(sname) & (STREAMREGISTRY_HASHSIZE - 1);
+
+    while(hashtable[slot] != -1)
+    {
+        long sindex = hashtable[slot];
+        if(strcmp(streaminfoproc->sinfo[sindex].sname, sname) == 0)
+        {
+            return sindex;
+        }
+        slot = (slot + 1) & (STREAMREGISTRY_HASHSIZE - 1);
+    }
+
+    return -1;
+}
+
+
+
+static void streamregistry_hashinsert(
+    STREAMINFOPROC *streaminfoproc,
+    long            sindex
+)
+{
+    long *hashtable = streaminfoproc->registry.hashtable;
+    uint64_t slot = streamregistry_hash(streaminfoproc->sinfo[sindex].sname)
+                    & (STREAMREGISTRY_HASHSIZE - 1);
+
+    while(hashtable[slot] != -1)
+    {
+        slot = (slot + 1) & (STREAMREGISTRY_HASHSIZE - 1);
+    }
+    hashtable[slot] = sindex;
+}
+
+
+
+static void streamregistry_hashrebuild(
+    STREAMINFOPROC *streaminfoproc
+)
+{
+    for(long slot = 0; slot < STREAMREGISTRY_HASHSIZE; slot++)
+    {
+        streaminfoproc->registry.hashtable[slot] = -1;
+    }
+    for(long sindex = 0; sindex < streaminfoproc->NBstream; sindex++)
+    {
+        streamregistry_hashinsert(streaminfoproc, sindex);
+    }
+}
+
+
+
+
+/** @brief Connect to stream and append it to registry
+ *
+ * @return STREAMINFO index, -1 if stream cannot be read
+ */
+static long streamregistry_connect(
+    STREAMINFOPROC   *streaminfoproc,
+    IMAGE            *images,
+    const STREAMINFO *sinfonew
+)
+{
+    if(streaminfoproc->NBstream >= streamNBID_MAX)
+    {
+        return -1;
+    }
+
+    imageID ID = image_get_first_ID_available_from_images(images);
+    if(ID < 0)
+    {
+        return -1;
+    }
+    if(ImageStreamIO_read_sharedmem_image_toIMAGE(sinfonew->sname,
+            &images[ID]) != IMAGESTREAMIO_SUCCESS)
+    {
+        images[ID].used = 0;
+        return -1;
+    }
+
+    long sindex = streaminfoproc->NBstream;
+    STREAMINFO *sinfo = &streaminfoproc->sinfo[sindex];
+
+    strcpy(sinfo->sname, sinfonew->sname);
+    sinfo->SymLink = sinfonew->SymLink;
+    strcpy(sinfo->linkname, sinfonew->linkname);
+    sinfo->inode = sinfonew->inode;
+    sinfo->scanflag = 1;
+
+    sinfo->ID = ID;
+    sinfo->datatype = images[ID].md[0].datatype;
+    sinfo->cnt0 = images[ID].md[0].cnt0;
+    sinfo->deltacnt0 = 1;
+    sinfo->updatevalue = 1.0;
+    sinfo->updatevalue_frozen = 1.0;
+    sinfo->streamOpenPID_status = 0;
+    sinfo->streamOpenPID_cnt = 0;
+    sinfo->streamOpenPID_cnt1 = 0;
+
+    streamregistry_hashinsert(streaminfoproc, sindex);
+    streaminfoproc->NBstream++;
+
+    return sindex;
+}
+
+
+
+
+/** @brief Remove stream from registry
+ *
+ * Last entry is moved to sindex. The stream is unmapped
+ * STREAMREGISTRY_RETIRE_NBSCAN scans later, as the display thread may
+ * still access it.
+ */
+static void streamregistry_remove(
+    STREAMINFOPROC *streaminfoproc,
+    long            sindex
+)
+{
+    STREAMREGISTRY *reg = &streaminfoproc->registry;
+    STREAMINFO *sinfo = streaminfoproc->sinfo;
+
+    if(reg->NBretire < STREAMREGISTRY_NBRETIRE_MAX)
+    {
+        reg->retireID[reg->NBretire] = sinfo[sindex].ID;
+        reg->retireinode[reg->NBretire] = sinfo[sindex].inode;
+        reg->retireloopcnt[reg->NBretire] = streaminfoproc->loopcnt;
+        reg->NBretire++;
+    }
+
+    long sindexlast = streaminfoproc->NBstream - 1;
+    streaminfoproc->NBstream--;
+    if(sindex != sindexlast)
+    {
+        sinfo[sindex] = sinfo[sindexlast];
+    }
+
+    streamregistry_hashrebuild(streaminfoproc);
+}
+
+
+
+
+static void streamregistry_pending_remove(
+    STREAMREGISTRY *reg,
+    long            pindex
+)
+{
+    reg->NBpending--;
+    if(pindex != reg->NBpending)
+    {
+        strcpy(reg->pendingname[pindex], reg->pendingname[reg->NBpending]);
+    }
+}
+
+
+
+
+/** @brief Add stream file to registry
+ *
+ * If stream cannot be read yet, it is added to the pending list and
+ * connection is retried at next update.
+ *
+ * @return 1 if stream added or already in registry, 0 otherwise
+ */
+static int streamregistry_add(
+    STREAMINFOPROC *streaminfoproc,
+    IMAGE          *images,
+    const char     *d_name
+)
+{
+    STREAMREGISTRY *reg = &streaminfoproc->registry;
+    STREAMINFO sinfonew;
+
+    if(streaminfo_from_direntry(d_name, reg->filter, reg->namefilter,
+                                &sinfonew) == 0)
+    {
+        return 0;
+    }
+
+    long sindex = streamregistry_find(streaminfoproc, sinfonew.sname);
+    if(sindex != -1)
+    {
+        if(streaminfoproc->sinfo[sindex].inode == sinfonew.inode)
+        {
+            streaminfoproc->sinfo[sindex].scanflag = 1;
+            return 1;
+        }
+        // re-created under same name
+        streamregistry_remove(streaminfoproc, sindex);
+    }
+
+    if(streamregistry_connect(streaminfoproc, images, &sinfonew) != -1)
+    {
+        return 1;
+    }
+
+    for(long pindex = 0; pindex < reg->NBpending; pindex++)
+    {
+        if(strcmp(reg->pendingname[pindex], d_name) == 0)
+        {
+            return 0;
+        }
+    }
+    if((reg->NBpending < STREAMREGISTRY_NBPENDING_MAX)
+            && (strlen(d_name) < STRINGMAXLEN_STREAMINFO_NAME))
+    {
+        strcpy(reg->pendingname[reg->NBpending], d_name);
+        reg->NBpending++;
+    }
+
+    return 0;
+}
+
+
+
+
+static void streamregistry_delete(
+    STREAMINFOPROC *streaminfoproc,
+    const char     *d_name
+)
+{
+    STREAMREGISTRY *reg = &streaminfoproc->registry;
+    char sname[STRINGMAXLEN_STREAMINFO_NAME];
+
+    for(long pindex = 0; pindex < reg->NBpending; pindex++)
+    {
+        if(strcmp(reg->pendingname[pindex], d_name) == 0)
+        {
+            streamregistry_pending_remove(reg, pindex);
+            break;
+        }
+    }
+
+    int strlencp = (int)(strstr(d_name, ".im.shm") - d_name);
+    if(strlencp > STRINGMAXLEN_STREAMINFO_NAME - 1)
+    {
+        strlencp = STRINGMAXLEN_STREAMINFO_NAME - 1;
+    }
+    strncpy(sname, d_name, strlencp);
+    sname[strlencp] = '\0';
+
+    long sindex = streamregistry_find(streaminfoproc, sname);
+    if(sindex != -1)
+    {
+        streamregistry_remove(streaminfoproc, sindex);
+    }
+}
+
+
+
+
+/** @brief Synchronize registry with full directory scan
+ */
+static void streamregistry_sync(
+    STREAMINFOPROC *streaminfoproc,
+    IMAGE          *images
+)
+{
+    DIR *d;
+    struct dirent *dir;
+
+    for(long sindex = 0; sindex < streaminfoproc->NBstream; sindex++)
+    {
+        streaminfoproc->sinfo[sindex].scanflag = 0;
+    }
+    streaminfoproc->registry.NBpending = 0;
+
+    d = opendir(SHAREDSHMDIR);
+    if(d == NULL)
+    {
+        return;
+    }
+    while((dir = readdir(d)) != NULL)
+    {
+        if(strstr(dir->d_name, ".im.shm") != NULL)
+        {
+            streamregistry_add(streaminfoproc, images, dir->d_name);
+        }
+    }
+    closedir(d);
+
+    // remove streams not found
+    for(long sindex = streaminfoproc->NBstream - 1; sindex >= 0; sindex--)
+    {
+        if(streaminfoproc->sinfo[sindex].scanflag == 0)
+        {
+            streamregistry_remove(streaminfoproc, sindex);
+        }
+    }
+}
+
+
+
+
+static errno_t streamregistry_init(
+    STREAMINFOPROC *streaminfoproc
+)
+{
+    STREAMREGISTRY *reg = &streaminfoproc->registry;
+
+    reg->hashtable = (long *) malloc(sizeof(long) * STREAMREGISTRY_HASHSIZE);
+    if(reg->hashtable == NULL)
+    {
+        PRINT_ERROR("malloc error");
+        abort();
+    }
+    streaminfoproc->NBstream = 0;
+    streamregistry_hashrebuild(streaminfoproc);
+
+    reg->NBpending = 0;
+    reg->NBretire = 0;
+    reg->filter = streaminfoproc->filter;
+    strcpy(reg->namefilter, streaminfoproc->namefilter);
+    reg->rescan = 1;
+
+    reg->inotifywd = -1;
+    reg->inotifyfd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(reg->inotifyfd != -1)
+    {
+        reg->inotifywd = inotify_add_watch(reg->inotifyfd, SHAREDSHMDIR,
+                                           IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+        if(reg->inotifywd == -1)
         {
-            int scanentryOK = 1;
-            char *pch = strstr(dir->d_name, ".im.shm");
+            close(reg->inotifyfd);
+            reg->inotifyfd = -1;
+        }
+    }
+
+    return RETURN_SUCCESS;
+}
+
+
+
+static errno_t streamregistry_free(
+    STREAMINFOPROC *streaminfoproc
+)
+{
+    STREAMREGISTRY *reg = &streaminfoproc->registry;
+
+    if(reg->inotifyfd != -1)
+    {
+        close(reg->inotifyfd);
+        reg->inotifyfd = -1;
+    }
+    free(reg->hashtable);
+    reg->hashtable = NULL;
+
+    return RETURN_SUCCESS;
+}
+
 
-            int matchOK = 0;
 
-            // name filtering (first pass, not exclusive to stream name, includes path and extension
-            if(filter == 1)
+
+/** @brief Update stream registry
+ *
+ * Applies shared memory directory changes reported by inotify since last
+ * update. Rescans directory on first call, on filter change, on inotify
+ * queue overflow, and at every call if inotify is unavailable.
+ */
+static void streamregistry_update(
+    STREAMINFOPROC *streaminfoproc,
+    IMAGE          *images
+)
+{
+    STREAMREGISTRY *reg = &streaminfoproc->registry;
+
+    if((streaminfoproc->filter != reg->filter)
+            || (strcmp(streaminfoproc->namefilter, reg->namefilter) != 0))
+    {
+        reg->filter = streaminfoproc->filter;
+        strncpy(reg->namefilter, streaminfoproc->namefilter, STRINGLENMAX - 1);
+        reg->namefilter[STRINGLENMAX - 1] = '\0';
+        reg->rescan = 1;
+    }
+
+    if(reg->inotifyfd == -1)
+    {
+        reg->rescan = 1;
+    }
+    else
+    {
+        char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        ssize_t len;
+
+        while((len = read(reg->inotifyfd, buf, sizeof(buf))) > 0)
+        {
+            const struct inotify_event *event;
+
+            for(char *ptr = buf; ptr < buf + len;
+                    ptr += sizeof(struct inotify_event) + event->len)
             {
-                if(strstr(dir->d_name, namefilter) != NULL)
+                event = (const struct inotify_event *) ptr;
+
+                if(event->mask & IN_Q_OVERFLOW)
+                {
+                    reg->rescan = 1;
+                }
+                if((reg->rescan == 1) || (event->len == 0)
+                        || (strstr(event->name, ".im.shm") == NULL))
+                {
+                    continue;
+                }
+
+                if(event->mask & (IN_CREATE | IN_MOVED_TO))
                 {
-                    matchOK = 1;
+                    streamregistry_add(streaminfoproc, images, event->name);
+                }
+                else if(event->mask & (IN_DELETE | IN_MOVED_FROM))
+                {
+                    streamregistry_delete(streaminfoproc, event->name);
                 }
             }
-            else
+        }
+    }
+
+    if(reg->rescan == 1)
+    {
+        reg->rescan = 0;
+        streamregistry_sync(streaminfoproc, images);
+    }
+
+
+    // retry streams not yet readable
+    for(long pindex = reg->NBpending - 1; pindex >= 0; pindex--)
+    {
+        char d_name[STRINGMAXLEN_STREAMINFO_NAME];
+
+        strcpy(d_name, reg->pendingname[pindex]);
+        streamregistry_pending_remove(reg, pindex);
+        streamregistry_add(streaminfoproc, images, d_name);
+    }
+
+
+    // unmap deleted streams
+    for(long rindex = reg->NBretire - 1; rindex >= 0; rindex--)
+    {
+        if(streaminfoproc->loopcnt - reg->retireloopcnt[rindex] >
+                STREAMREGISTRY_RETIRE_NBSCAN)
+        {
+            imageID ID = reg->retireID[rindex];
+
+            // skip if already destroyed, and slot possibly re-used
+            if((images[ID].used == 1) && (images[ID].md != NULL)
+                    && (images[ID].md[0].inode == reg->retireinode[rindex]))
             {
-                matchOK = 1;
+                ImageStreamIO_closeIm(&images[ID]);
+                images[ID].used = 0;
             }
 
+            reg->NBretire--;
+            reg->retireID[rindex] = reg->retireID[reg->NBretire];
+            reg->retireinode[rindex] = reg->retireinode[reg->NBretire];
+            reg->retireloopcnt[rindex] = reg->retireloopcnt[reg->NBretire];
+        }
+    }
+}
+
+
+
+
+/** @brief Publish stream update rates to shared memory table
+ */
+static void streamCTRL_ratetable_publish(
+    STREAMINFOPROC *streaminfoproc,
+    IMAGE          *images
+)
+{
+    STREAMRATE_TABLE *ratetable = streaminfoproc->ratetable;
+    uint64_t seq = ratetable->seq;
+
+    __atomic_store_n(&ratetable->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    long NBstream = streaminfoproc->NBstream;
+    if(NBstream > ratetable->NBstreamMAX)
+    {
+        NBstream = ratetable->NBstreamMAX;
+    }
+    for(long sindex = 0; sindex < NBstream; sindex++)
+    {
+        STREAMINFO *sinfo = &streaminfoproc->sinfo[sindex];
+
+        strcpy(ratetable->entry[sindex].sname, sinfo->sname);
+        ratetable->entry[sindex].inode = images[sinfo->ID].md[0].inode;
+        ratetable->entry[sindex].cnt0 = sinfo->cnt0;
+        ratetable->entry[sindex].updatefreq = sinfo->updatevalue;
+    }
+    ratetable->NBstream = NBstream;
+    ratetable->dtscan = streaminfoproc->dtscan;
+    clock_gettime(CLOCK_REALTIME, &ratetable->tupdate);
+
+    __atomic_store_n(&ratetable->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+
+
+
+/** @brief Consistent copy of stream update rate table entries
+ *
+ * @return number of entries copied, -1 if table is not being updated
+ */
+long streamCTRL_ratetable_read(
+    const STREAMRATE_TABLE *ratetable,
+    STREAMRATE_ENTRY       *entry,
+    long                    NBentryMAX
+)
+{
+    for(int trycnt = 0; trycnt < 1000; trycnt++)
+    {
+        uint64_t seq0 = __atomic_load_n(&ratetable->seq, __ATOMIC_ACQUIRE);
+        if(seq0 & 1)
+        {
+            usleep(10);
+            continue;
+        }
+
+        long NBentry = ratetable->NBstream;
+        if(NBentry > NBentryMAX)
+        {
+            NBentry = NBentryMAX;
+        }
+        memcpy(entry, ratetable->entry, sizeof(STREAMRATE_ENTRY) * NBentry);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&ratetable->seq, __ATOMIC_RELAXED) == seq0)
+        {
+            return NBentry;
+        }
+    }
+
+    return -1;
+}
 
-            if((pch) && (matchOK == 1))
-            {
-                // is file sym link ?
-                struct stat buf;
-                int retv;
-                char fullname[STRINGMAXLEN_FULLFILENAME];
 
 
-                WRITE_FULLFILENAME(fullname, "%s/%s", SHAREDSHMDIR,
-                                   dir->d_name);
-                retv = lstat(fullname, &buf);
-                if(retv == -1)
-                {
-                    endwin();
-                    printf("File \"%s\"", dir->d_name);
-                    perror("Error running lstat on file ");
-                    exit(EXIT_FAILURE);
-                }
 
-                if(S_ISLNK(buf.st_mode))  // resolve link name
-                {
-                    char fullname[STRINGMAXLEN_FULLFILENAME];
-                    char *linknamefull;
-                    char linkname[STRINGMAXLEN_FULLFILENAME];
-                    int pathOK = 1;
+/** @brief Map stream update rate table, read-only
+ *
+ * @return NULL if table does not exist
+ */
+STREAMRATE_TABLE *streamCTRL_ratetable_link(
+    size_t *tablesize
+)
+{
+    char fname[STRINGMAXLEN_FULLFILENAME];
+    struct stat buf;
 
+    WRITE_FULLFILENAME(fname, "%s/%s", SHAREDSHMDIR, STREAMRATE_FNAME);
 
-                    streaminfo[sindex].SymLink = 1;
-                    WRITE_FULLFILENAME(fullname, "%s/%s", SHAREDSHMDIR,
-                                       dir->d_name);
-                    linknamefull = realpath(fullname, NULL);
+    int fd = open(fname, O_RDONLY);
+    if(fd == -1)
+    {
+        return NULL;
+    }
+    if((fstat(fd, &buf) == -1) || (buf.st_size < (off_t) sizeof(STREAMRATE_TABLE)))
+    {
+        close(fd);
+        return NULL;
+    }
 
-                    if(linknamefull == NULL)
-                    {
-                        pathOK = 0;
-                    }
-                    else if(access(linknamefull, R_OK))     // file cannot be read
-                    {
-                        pathOK = 0;
-                    }
+    STREAMRATE_TABLE *ratetable = (STREAMRATE_TABLE *) mmap(NULL, buf.st_size,
+                                  PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(ratetable == MAP_FAILED)
+    {
+        return NULL;
+    }
+    if((ratetable->magic != STREAMRATE_MAGIC)
+            || (ratetable->version != STREAMRATE_VERSION))
+    {
+        munmap(ratetable, buf.st_size);
+        return NULL;
+    }
 
-                    if(pathOK == 0)   // file cannot be read
-                    {
-                        scanentryOK = 0;
-                    }
-                    else
-                    {
-                        strcpy(linkname, basename(linknamefull));
+    *tablesize = buf.st_size;
 
-                        int lOK = 1;
-                        unsigned int ii = 0;
-                        while((lOK == 1) && (ii < strlen(linkname)))
-                        {
-                            if(linkname[ii] == '.')
-                            {
-                                linkname[ii] = '\0';
-                                lOK = 0;
-                            }
-                            ii++;
-                        }
-                        strncpy(streaminfo[sindex].linkname, linkname, STRINGMAXLEN_STREAMINFO_NAME-1);
-                    }
+    return ratetable;
+}
 
-                    if(linknamefull != NULL)
-                    {
-                        free(linknamefull);
-                    }
 
-                }
-                else
-                {
-                    streaminfo[sindex].SymLink = 0;
-                }
 
 
-                // get stream name
-                if(scanentryOK == 1)
-                {
-                    int strlencp1 = STRINGMAXLEN_STREAMINFO_NAME;
-                    int strlencp = strlen(dir->d_name) - strlen(".im.shm");
-                    if(strlencp < strlencp1)
-                    {
-                        strlencp1 = strlencp;
-                    }
-                    strncpy(streaminfo[sindex].sname, dir->d_name, strlencp1);
-                    streaminfo[sindex].sname[strlen(dir->d_name) - strlen(".im.shm")] = '\0';
+static STREAMRATE_TABLE *streamCTRL_ratetable_create(
+    long    NBstreamMAX,
+    size_t *tablesize
+)
+{
+    char fname[STRINGMAXLEN_FULLFILENAME];
 
+    WRITE_FULLFILENAME(fname, "%s/%s", SHAREDSHMDIR, STREAMRATE_FNAME);
 
-                    if(filter == 1)
-                    {
-                        if(strstr(streaminfo[sindex].sname, namefilter) != NULL)
-                        {
-                            sindex++;
-                        }
-                    }
-                    else
-                    {
-                        sindex++;
-                    }
+    *tablesize = sizeof(STREAMRATE_TABLE) + sizeof(STREAMRATE_ENTRY) * NBstreamMAX;
 
-                }
-            }
-        }
+    umask(0);
+    int fd = open(fname, O_RDWR | O_CREAT | O_TRUNC, FILEMODE);
+    if(fd == -1)
+    {
+        PRINT_ERROR("cannot create %s", fname);
+        return NULL;
+    }
+    if(ftruncate(fd, *tablesize) == -1)
+    {
+        PRINT_ERROR("ftruncate error %s", fname);
+        close(fd);
+        return NULL;
+    }
 
-        NBstream = sindex;
+    STREAMRATE_TABLE *ratetable = (STREAMRATE_TABLE *) mmap(NULL, *tablesize,
+                                  PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(ratetable == MAP_FAILED)
+    {
+        PRINT_ERROR("mmap error %s", fname);
+        return NULL;
     }
-    closedir(d);
 
+    ratetable->version = STREAMRATE_VERSION;
+    ratetable->PID = getpid();
+    ratetable->NBstreamMAX = NBstreamMAX;
+    ratetable->seq = 0;
+    ratetable->NBstream = 0;
+    __atomic_store_n(&ratetable->magic, STREAMRATE_MAGIC, __ATOMIC_RELEASE);
 
-    return NBstream;
+    return ratetable;
 }
 
 
 
 
-
-
-
 void *streamCTRL_scan(
     void *argptr
 )
 {
-    long NBsindex = 0;
     long sindex = 0;
     long scancnt = 0;
 
@@ -413,8 +1040,8 @@ void *streamCTRL_scan(
 
 
     // timing
-    static int firstIter = 1;
-    static struct timespec t0;
+    int firstIter = 1;
+    struct timespec t0;
     struct timespec t1;
     double tdiffv;
     struct timespec tdiff;
@@ -429,9 +1056,7 @@ void *streamCTRL_scan(
 
     streaminfoproc->loopcnt = 0;
 
-
-    // if set, write file list to file on first scan
-    //int WriteFlistToFile = 1;
+    streamregistry_init(streaminfoproc);
 
 
     FILE *fpfscan;
@@ -454,288 +1079,57 @@ void *streamCTRL_scan(
         streaminfoproc->dtscan = tdiffv;
 
 
+        // new streams are connected by registry update,
+        // existing streams keep their image ID
+        streamregistry_update(streaminfoproc, images);
+        long NBsindex = streaminfoproc->NBstream;
 
-        int mode = 0;
-        if(mode == 0) // preferred mode
-        {
-            NBsindex = find_streams(
-                           streaminfo,
-                           streaminfoproc->filter,
-                           streaminfoproc->namefilter);
-
-
-
-            // write stream list to file if applicable
-            // ususally used for debugging only
-            //
-            if(streaminfoproc->WriteFlistToFile == 1)
-            {
-                fpfscan = fopen("streamCTRL_filescan.dat", "w");
-                fprintf(fpfscan, "# stream scan result\n");
-                fprintf(fpfscan, "filter: %d %s\n", streaminfoproc->filter,
-                        streaminfoproc->namefilter);
-                fprintf(fpfscan, "NBsindex = %ld\n", NBsindex);
-
-                for(sindex = 0; sindex < NBsindex; sindex++)
-                {
-                    //fprintf(fpfscan, "%4ld  %20s ", sindex, dir->d_name);
-
-                    if(streaminfo[sindex].SymLink == 1)
-                    {
-                        fprintf(fpfscan, "| %12s -> [ %12s ] ", streaminfo[sindex].sname,
-                                streaminfo[sindex].linkname);
-                    }
-                    else
-                    {
-                        fprintf(fpfscan, "| %12s -> [ %12s ] ", streaminfo[sindex].sname, " ");
-                    }
-                    fprintf(fpfscan, "\n");
-                }
-                fclose(fpfscan);
-            }
 
+        // write stream list to file if applicable
+        // ususally used for debugging only
+        //
+        if(streaminfoproc->WriteFlistToFile == 1)
+        {
+            fpfscan = fopen("streamCTRL_filescan.dat", "w");
+            fprintf(fpfscan, "# stream scan result\n");
+            fprintf(fpfscan, "filter: %d %s\n", streaminfoproc->filter,
+                    streaminfoproc->namefilter);
+            fprintf(fpfscan, "NBsindex = %ld\n", NBsindex);
 
-            // Load into memory
             for(sindex = 0; sindex < NBsindex; sindex++)
             {
-                imageID ID;
-
-                ID = image_ID_from_images(images, streaminfo[sindex].sname);
-
-                // connect to stream
-                if(ID == -1)
+                if(streaminfo[sindex].SymLink == 1)
                 {
-                    ID = image_get_first_ID_available_from_images(images);
-                    if(ID < 0)
-                    {
-                        return NULL;
-                    }
-                    ImageStreamIO_read_sharedmem_image_toIMAGE(streaminfo[sindex].sname,
-                            &images[ID]);
-                    streaminfo[sindex].deltacnt0 = 1;
-                    streaminfo[sindex].updatevalue = 1.0;
-                    streaminfo[sindex].updatevalue_frozen = 1.0;
+                    fprintf(fpfscan, "| %12s -> [ %12s ] ", streaminfo[sindex].sname,
+                            streaminfo[sindex].linkname);
                 }
                 else
                 {
-                    float gainv = 1.0;
-                    if(firstIter == 0)
-                    {
-                        streaminfo[sindex].deltacnt0 = images[ID].md[0].cnt0 - streaminfo[sindex].cnt0;
-                        streaminfo[sindex].updatevalue = (1.0 - gainv) * streaminfo[sindex].updatevalue
-                                                         + gainv * (1.0 * streaminfo[sindex].deltacnt0 / tdiffv);
-                    }
-
-                    streaminfo[sindex].cnt0 = images[ID].md[0].cnt0; // keep memory of cnt0
-                    streaminfo[sindex].ID = ID;
-                    streaminfo[sindex].datatype = images[ID].md[0].datatype;
+                    fprintf(fpfscan, "| %12s -> [ %12s ] ", streaminfo[sindex].sname, " ");
                 }
-
+                fprintf(fpfscan, "\n");
             }
+            fclose(fpfscan);
         }
-        else // candidate for removal
-        {
-            //---------------------------------------
-            DIR *d;
-            struct dirent *dir;
-
-            d = opendir(SHAREDSHMDIR);
-            if(d)
-            {
-                sindex = 0;
-
-                while(((dir = readdir(d)) != NULL))
-                {
-                    int scanentryOK = 1;
-                    char *pch = strstr(dir->d_name, ".im.shm");
-
-                    int matchOK = 0;
-
-                    // name filtering
-                    if(streaminfoproc->filter == 1)
-                    {
-                        if(strstr(dir->d_name, streaminfoproc->namefilter) != NULL)
-                        {
-                            matchOK = 1;
-                        }
-                    }
-                    else
-                    {
-                        matchOK = 1;
-                    }
-
-
-
-                    if((pch) && (matchOK == 1))
-                    {
-                        imageID ID;
-
-                        // is file sym link ?
-                        struct stat buf;
-                        int retv;
-                        char fullname[STRINGMAXLEN_FULLFILENAME];
-
-
-                        if(streaminfoproc->WriteFlistToFile == 1)
-                        {
-                            fprintf(fpfscan, "%4ld  %20s ", sindex, dir->d_name);
-                        }
-
-                        WRITE_FULLFILENAME(fullname, "%s/%s", SHAREDSHMDIR,
-                                           dir->d_name);
-                        retv = lstat(fullname, &buf);
-                        if(retv == -1)
-                        {
-                            endwin();
-                            printf("File \"%s\"", dir->d_name);
-                            perror("Error running lstat on file ");
-                            exit(EXIT_FAILURE);
-                        }
-
-
-
-                        if(S_ISLNK(buf.st_mode))  // resolve link name
-                        {
-                            char fullname[STRINGMAXLEN_FULLFILENAME];
-                            char *linknamefull;
-                            char linkname[STRINGMAXLEN_FULLFILENAME];
-                            int pathOK = 1;
-
-
-                            streaminfo[sindex].SymLink = 1;
-                            WRITE_FULLFILENAME(fullname, "%s/%s", SHAREDSHMDIR,
-                                               dir->d_name);
-                            //                        readlink (fullname, linknamefull, 200-1);
-                            linknamefull = realpath(fullname, NULL);
-
-                            if(linknamefull == NULL)
-                            {
-                                pathOK = 0;
-                            }
-                            else if(access(linknamefull, R_OK))     // file cannot be read
-                            {
-                                pathOK = 0;
-                            }
 
-                            if(pathOK == 0)   // file cannot be read
-                            {
-                                if(streaminfoproc->WriteFlistToFile == 1)
-                                {
-                                    fprintf(fpfscan, " %s <-> LINK %s CANNOT BE READ -> off", fullname,
-                                            linknamefull);
-                                }
-                                scanentryOK = 0;
-                            }
-                            else
-                            {
-                                strcpy(linkname, basename(linknamefull));
-
-                                int lOK = 1;
-                                unsigned int ii = 0;
-                                while((lOK == 1) && (ii < strlen(linkname)))
-                                {
-                                    if(linkname[ii] == '.')
-                                    {
-                                        linkname[ii] = '\0';
-                                        lOK = 0;
-                                    }
-                                    ii++;
-                                }
-                                strncpy(streaminfo[sindex].linkname, linkname, STRINGMAXLEN_STREAMINFO_NAME-1);
-                            }
-
-                            if(linknamefull != NULL)
-                            {
-                                free(linknamefull);
-                            }
-
-                        }
-                        else
-                        {
-                            streaminfo[sindex].SymLink = 0;
-                        }
-
-
-
-                        // get stream name and ID
-                        if(scanentryOK == 1)
-                        {
-                            int strlencp1 = STRINGMAXLEN_STREAMINFO_NAME;
-                            int strlencp = strlen(dir->d_name) - strlen(".im.shm");
-                            if(strlencp < strlencp1)
-                            {
-                                strlencp1 = strlencp;
-                            }
-                            strncpy(streaminfo[sindex].sname, dir->d_name, strlencp1);
-                            streaminfo[sindex].sname[strlen(dir->d_name) - strlen(".im.shm")] = '\0';
-
-                            if(streaminfoproc->WriteFlistToFile == 1)
-                            {
-                                if(streaminfo[sindex].SymLink == 1)
-                                {
-                                    fprintf(fpfscan, "| %12s -> [ %12s ] ", streaminfo[sindex].sname,
-                                            streaminfo[sindex].linkname);
-                                }
-                                else
-                                {
-                                    fprintf(fpfscan, "| %12s -> [ %12s ] ", streaminfo[sindex].sname, " ");
-                                }
-                            }
-                        }
-
-
-                        if(scanentryOK == 1)
-                        {
-
-                            ID = image_ID_from_images(images, streaminfo[sindex].sname);
-
-                            // connect to stream
-                            if(ID == -1)
-                            {
-                                ID = image_get_first_ID_available_from_images(images);
-                                if(ID < 0)
-                                {
-                                    return NULL;
-                                }
-                                ImageStreamIO_read_sharedmem_image_toIMAGE(streaminfo[sindex].sname,
-                                        &images[ID]);
-                                streaminfo[sindex].deltacnt0 = 1;
-                                streaminfo[sindex].updatevalue = 1.0;
-                                streaminfo[sindex].updatevalue_frozen = 1.0;
-                            }
-                            else
-                            {
-                                float gainv = 1.0;
-                                if(firstIter == 0)
-                                {
-                                    streaminfo[sindex].deltacnt0 = images[ID].md[0].cnt0 - streaminfo[sindex].cnt0;
-                                    streaminfo[sindex].updatevalue = (1.0 - gainv) * streaminfo[sindex].updatevalue
-                                                                     + gainv * (1.0 * streaminfo[sindex].deltacnt0 / tdiffv);
-                                }
 
-                                streaminfo[sindex].cnt0 = images[ID].md[0].cnt0; // keep memory of cnt0
-                                streaminfo[sindex].ID = ID;
-                                streaminfo[sindex].datatype = images[ID].md[0].datatype;
-
-                                sindex++;
-                            }
-                        }
-                        if(streaminfoproc->WriteFlistToFile == 1)
-                        {
-                            fprintf(fpfscan, "\n");
-                        }
-                    }
-                }
+        // update rates
+        if(firstIter == 0)
+        {
+            for(sindex = 0; sindex < NBsindex; sindex++)
+            {
+                imageID ID = streaminfo[sindex].ID;
+                long long cnt0 = images[ID].md[0].cnt0;
 
-                NBsindex = sindex;
+                streaminfo[sindex].deltacnt0 = cnt0 - streaminfo[sindex].cnt0;
+                streaminfo[sindex].updatevalue = 1.0 * streaminfo[sindex].deltacnt0 / tdiffv;
+                streaminfo[sindex].cnt0 = cnt0; // keep memory of cnt0
             }
-            closedir(d);
+        }
 
-            if(streaminfoproc->WriteFlistToFile == 1)
-            {
-                fclose(fpfscan);
-            }
-            //---------------------------------------
+        if(streaminfoproc->ratetable != NULL)
+        {
+            streamCTRL_ratetable_publish(streaminfoproc, images);
         }
 
         streaminfoproc->WriteFlistToFile = 0;
@@ -746,7 +1140,6 @@ void *streamCTRL_scan(
 
 
 
-
         if(streaminfoproc->fuserUpdate == 1)
         {
             FILE *fp;
@@ -900,7 +1293,6 @@ void *streamCTRL_scan(
 
         streaminfoproc->fuserUpdate0 = 0;
 
-        streaminfoproc->NBstream = NBsindex;
         streaminfoproc->loopcnt++;
 
 
@@ -909,6 +1301,7 @@ void *streamCTRL_scan(
         scancnt ++;
     }
 
+    streamregistry_free(streaminfoproc);
 
 
     return NULL;
@@ -1214,6 +1607,23 @@ static errno_t streamCTRL_print_SPTRACE_details(
             TUI_printfw("%*s", Disp_type_NBchar, "DELAY");
             break;
 
+        case PROCESSINFO_TRIGGERMODE_SPINWAIT:
+            TUI_printfw("%*s", Disp_type_NBchar, "SPIN");
+            break;
+
+        case PROCESSINFO_TRIGGERMODE_SPINSEM:
+            TUI_printfw("%*s", Disp_type_NBchar-3, "SPS");
+            TUI_printfw(" %2d", sem);
+            break;
+
+        case PROCESSINFO_TRIGGERMODE_ANY:
+            TUI_printfw("%*s", Disp_type_NBchar, "ANY");
+            break;
+
+        case PROCESSINFO_TRIGGERMODE_ALL:
+            TUI_printfw("%*s", Disp_type_NBchar, "ALL");
+            break;
+
         default:
             TUI_printfw("%*s", Disp_type_NBchar, "UNKNOWN");
             break;
@@ -1349,6 +1759,7 @@ errno_t streamCTRL_CTRLscreen()
         streaminfo[sindex].streamOpenPID_status = 0;
     }
     streaminfoproc.PIDtable = PIDname_array;
+    streaminfoproc.ratetable = NULL;
 
 
     IMAGE *streamCTRLimages = (IMAGE *) malloc(sizeof(IMAGE) * streamNBID_MAX);
@@ -2639,6 +3050,22 @@ errno_t streamCTRL_CTRLscreen()
                                 sprintf(string, "(%7lu DL ", inode);
                                 break;
 
+                            case PROCESSINFO_TRIGGERMODE_SPINWAIT:
+                                sprintf(string, "(%7lu SP ", inode);
+                                break;
+
+                            case PROCESSINFO_TRIGGERMODE_SPINSEM:
+                                sprintf(string, "(%7lu S%1d ", inode, sem);
+                                break;
+
+                            case PROCESSINFO_TRIGGERMODE_ANY:
+                                sprintf(string, "(%7lu AN ", inode);
+                                break;
+
+                            case PROCESSINFO_TRIGGERMODE_ALL:
+                                sprintf(string, "(%7lu AL ", inode);
+                                break;
+
                             default:
                                 sprintf(string, "(%7lu ?? ", inode);
                                 break;
@@ -2801,3 +3228,97 @@ errno_t streamCTRL_CTRLscreen()
 
     return EXIT_SUCCESS;
 }
+
+
+
+
+
+/**
+ * ## Purpose
+ *
+ * Headless stream scanner
+ *
+ * ## Description
+ *
+ * Runs the stream scan thread without display, publishing stream update
+ * rates to shared memory table STREAMRATE_FNAME at each scan, until
+ * SIGINT or SIGTERM.
+ *
+ */
+errno_t streamCTRL_headless()
+{
+    STREAMINFOPROC streaminfoproc;
+    pthread_t threadscan;
+    size_t tablesize;
+
+    streaminfoproc.ratetable = streamCTRL_ratetable_create(streamNBID_MAX,
+                               &tablesize);
+    if(streaminfoproc.ratetable == NULL)
+    {
+        return RETURN_FAILURE;
+    }
+
+    streaminfoproc.sinfo = (STREAMINFO *) malloc(sizeof(STREAMINFO) * streamNBID_MAX);
+    IMAGE *images = (IMAGE *) malloc(sizeof(IMAGE) * streamNBID_MAX);
+    if((streaminfoproc.sinfo == NULL) || (images == NULL))
+    {
+        PRINT_ERROR("malloc error");
+        abort();
+    }
+    for(imageID imID = 0; imID < streamNBID_MAX; imID++)
+    {
+        images[imID].used    = 0;
+        images[imID].shmfd   = -1;
+        images[imID].memsize = 0;
+        images[imID].semptr  = NULL;
+        images[imID].semlog  = NULL;
+    }
+
+    streaminfoproc.PIDtable = NULL;
+    streaminfoproc.WriteFlistToFile = 0;
+    streaminfoproc.fuserUpdate = 0;
+    streaminfoproc.fuserUpdate0 = 0;
+    streaminfoproc.filter = 0;
+    streaminfoproc.namefilter[0] = '\0';
+    streaminfoproc.NBstream = 0;
+    streaminfoproc.twaitus = 100000; // 10 Hz
+
+    struct streamCTRLarg_struct streamCTRLdata;
+    streamCTRLdata.streaminfoproc = &streaminfoproc;
+    streamCTRLdata.images         = images;
+
+    printf("Publishing stream update rates to %s/%s\n", SHAREDSHMDIR,
+           STREAMRATE_FNAME);
+    printf("CTRL-C to stop\n");
+
+    streaminfoproc.loop = 1;
+    pthread_create(&threadscan, NULL, streamCTRL_scan, (void *) &streamCTRLdata);
+
+    while((data.signal_INT == 0) && (data.signal_TERM == 0))
+    {
+        usleep(100000);
+    }
+
+    streaminfoproc.loop = 0;
+    pthread_join(threadscan, NULL);
+
+    printf("%ld streams, %ld scans\n", streaminfoproc.NBstream,
+           streaminfoproc.loopcnt);
+
+    char fname[STRINGMAXLEN_FULLFILENAME];
+    WRITE_FULLFILENAME(fname, "%s/%s", SHAREDSHMDIR, STREAMRATE_FNAME);
+    munmap(streaminfoproc.ratetable, tablesize);
+    unlink(fname);
+
+    for(imageID ID = 0; ID < streamNBID_MAX; ID++)
+    {
+        if(images[ID].used == 1)
+        {
+            ImageStreamIO_closeIm(&images[ID]);
+        }
+    }
+    free(images);
+    free(streaminfoproc.sinfo);
+
+    return RETURN_SUCCESS;
+}
@@ -20,6 +20,7 @@
 
 #include <stdint.h>
 #include <unistd.h>    // getpid()
+#include <time.h>
 
 
 /* =============================================================================================== */
@@ -37,6 +38,17 @@
 
 #define PIDnameStringLen 12
 
+// stream registry
+#define STREAMREGISTRY_HASHSIZE       32768  // power of 2, > 2 x streamNBID_MAX
+#define STREAMREGISTRY_NBPENDING_MAX  256    // streams created, not yet readable
+#define STREAMREGISTRY_NBRETIRE_MAX   1000   // streams deleted, not yet unmapped
+#define STREAMREGISTRY_RETIRE_NBSCAN  20     // scans before deleted stream is unmapped
+
+// stream update rate table, published by streamCTRL headless mode
+#define STREAMRATE_FNAME    "streamCTRL.rate.shm"  // in shared memory directory
+#define STREAMRATE_MAGIC    0x53545252             // "STRR"
+#define STREAMRATE_VERSION  1
+
 
 
 /* =============================================================================================== */
@@ -68,10 +80,78 @@ typedef struct
     long long cnt0; // used to check if cnt0 has changed
     long deltacnt0;
 
+    ino_t inode;
+    int scanflag;   // set when found by directory scan
+
 } STREAMINFO;
 
 
 
+/**
+ * Stream registry
+ *
+ * Streams in shared memory directory, kept up to date from inotify
+ * events instead of rescanning the directory. Maps stream name to
+ * STREAMINFO index.
+ */
+typedef struct
+{
+    int  inotifyfd;       // -1 if inotify unavailable: rescan at each update
+    int  inotifywd;
+    int  rescan;          // 1 if full directory scan required
+
+    int  filter;          // filter applied to registry content
+    char namefilter[STRINGLENMAX];
+
+    long *hashtable;      // STREAMREGISTRY_HASHSIZE entries, STREAMINFO index or -1
+
+    // created, not yet readable (file being initialized)
+    long NBpending;
+    char pendingname[STREAMREGISTRY_NBPENDING_MAX][STRINGMAXLEN_STREAMINFO_NAME];
+
+    // deleted, unmapped after STREAMREGISTRY_RETIRE_NBSCAN scans
+    long    NBretire;
+    imageID retireID[STREAMREGISTRY_NBRETIRE_MAX];
+    ino_t   retireinode[STREAMREGISTRY_NBRETIRE_MAX];
+    long    retireloopcnt[STREAMREGISTRY_NBRETIRE_MAX];
+
+} STREAMREGISTRY;
+
+
+
+/**
+ * Stream update rate table
+ *
+ * Shared memory file STREAMRATE_FNAME, header followed by NBstreamMAX
+ * entries. Single writer, readers use the seq counter (seqlock):
+ * seq is odd while the table is written, readers retry if seq is odd or
+ * changed while copying. See streamCTRL_ratetable_read().
+ */
+typedef struct
+{
+    char     sname[STRINGMAXLEN_STREAMINFO_NAME];
+    ino_t    inode;
+    uint64_t cnt0;
+    double   updatefreq;  // [Hz]
+} STREAMRATE_ENTRY;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    pid_t    PID;         // writer process
+    long     NBstreamMAX;
+
+    uint64_t seq;
+    struct timespec tupdate;
+    double   dtscan;      // [s]
+    long     NBstream;
+
+    STREAMRATE_ENTRY entry[];
+} STREAMRATE_TABLE;
+
+
+
 typedef struct
 {
     int twaitus; // sleep time between scans
@@ -92,6 +172,9 @@ typedef struct
     int sindexscan;
     char **PIDtable; // stores names of PIDs
 
+    STREAMREGISTRY registry;
+    STREAMRATE_TABLE *ratetable; // published at each scan if not NULL
+
 } STREAMINFOPROC;
 
 
@@ -131,6 +214,18 @@ int find_streams(
 
 void *streamCTRL_scan(void* thptr);
 
+long streamCTRL_ratetable_read(
+    const STREAMRATE_TABLE *ratetable,
+    STREAMRATE_ENTRY       *entry,
+    long                    NBentryMAX
+);
+
+STREAMRATE_TABLE *streamCTRL_ratetable_link(
+    size_t *tablesize
+);
+
+errno_t streamCTRL_headless();
+
 /**
  * ## Purpose
  *